@@ -40,6 +40,11 @@ template <typename T>
 std::pair<typename FIELD_MAG<T>::type, typename FIELD_MAG<T>::type>
 robustMinMax(const std::vector<T>& data, typename FIELD_MAG<T>::type rangeEPS = 1e-12);
 
+// Given the min and max of some data, widen the range so it is not degenerate when the data is (nearly) constant.
+// This is the rule used by robustMinMax().
+template <typename S>
+std::pair<S, S> padRobustRange(S minVal, S maxVal, S rangeEPS);
+
 
 // Map data in to the range [0,1]
 template <typename T>
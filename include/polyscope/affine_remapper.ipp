@@ -80,14 +80,20 @@ std::pair<typename FIELD_MAG<T>::type, typename FIELD_MAG<T>::type> robustMinMax
   if (!anyFinite) {
     return std::make_pair(-1.0, 1.0);
   }
-  typename FIELD_MAG<T>::type maxMag = std::max(std::abs(minVal), std::abs(maxVal));
+
+  return padRobustRange(minVal, maxVal, rangeEPS);
+}
+
+template <typename S>
+std::pair<S, S> padRobustRange(S minVal, S maxVal, S rangeEPS) {
+  S maxMag = std::max(std::abs(minVal), std::abs(maxVal));
 
   // Hack to do less ugly things when constants (or near-constant) are passed in
   if (maxMag < rangeEPS) {
     maxVal = rangeEPS;
     minVal = -rangeEPS;
   } else if ((maxVal - minVal) / maxMag < rangeEPS) {
-    typename FIELD_MAG<T>::type mid = (minVal + maxVal) / 2.0;
+    S mid = (minVal + maxVal) / 2.0;
     maxVal = mid + maxMag * rangeEPS;
     minVal = mid - maxMag * rangeEPS;
   }
@@ -5,6 +5,7 @@
 #include "polyscope/quantity.h"
 #include "polyscope/render/color_maps.h"
 #include "polyscope/render/engine.h"
+#include "polyscope/scalar_statistics.h"
 #include "polyscope/widget.h"
 
 #include <vector>
@@ -24,6 +25,12 @@ public:
   ~ColorBar();
 
   void buildHistogram(const std::vector<float>& values, DataType datatype);
+  // integer data is binned by counting exactly, without converting it to float
+  void buildHistogram(const std::vector<uint8_t>& values, DataType datatype);
+  void buildHistogram(const std::vector<uint16_t>& values, DataType datatype);
+  void buildHistogram(const std::vector<int32_t>& values, DataType datatype);
+  // from statistics which were already computed, with rawHistBinCount bins
+  void buildHistogram(const ScalarStatistics& stats, DataType datatype);
   void updateColormap(const std::string& newColormap);
 
   // Width = -1 means set automatically
@@ -32,6 +39,8 @@ public:
   Quantity& parent;
   std::pair<double, double> colormapRange; // in DATA values, not [0,1]
 
+  static const size_t rawHistBinCount = 51;
+
   void exportColorbarToSVG(const std::string& filename);
 
   // Getters and setters
@@ -51,8 +60,8 @@ private:
   // == The inline horizontal histogram visualization in the structures bar
 
   // Manage histogram counts
+  void buildHistogramCurve(const std::vector<double>& binCounts); // bins evenly span dataRange
   void fillHistogramBuffers();
-  size_t rawHistBinCount = 51;
   std::vector<float> rawHistCurveY;
   std::vector<std::array<float, 2>> rawHistCurveX;
 
@@ -17,6 +17,9 @@ class ColorQuantity {
 public:
   ColorQuantity(QuantityT& parent, const std::vector<glm::vec3>& colors);
 
+  // 8-bit colors in [0,255] are stored natively rather than being widened to floats (as RGBA, the alpha is unused)
+  ColorQuantity(QuantityT& parent, const std::vector<glm::u8vec4>& colors);
+
   // Build the ImGUI UIs for colors
   void buildColorUI();
   virtual void buildColorOptionsUI(); // called inside of an options menu
@@ -32,7 +35,19 @@ public:
 
   // === Members
   QuantityT& quantity;
+
+  // If the quantity was created from 8-bit data, that data lives in `colorsUInt8` and `colors` is a float copy which
+  // is only computed (lazily) if something needs it.
   render::ManagedBuffer<glm::vec3> colors;
+  render::ManagedBuffer<glm::u8vec4> colorsUInt8;
+
+  bool hasByteColors();
+  size_t nColors();
+  glm::vec3 getColorValue(size_t ind); // reads from whichever buffer holds the data, in [0,1]
+
+  // The render buffer holding the data in its stored type. 8-bit colors are normalized as they are fetched by the
+  // shader, so it can be bound to the same float attributes as `colors`.
+  std::shared_ptr<render::AttributeBuffer> getColorRenderAttributeBuffer();
 
   // === Get/set visualization parameters
 
@@ -40,6 +55,10 @@ public:
 
 protected:
   std::vector<glm::vec3> colorsData;
+  std::vector<glm::u8vec4> colorsUInt8Data;
+  const bool byteColors;
+
+  void computeColorsFromBytes();
 
   // === Visualization parameters
 
@@ -4,10 +4,52 @@ namespace polyscope {
 
 template <typename QuantityT>
 ColorQuantity<QuantityT>::ColorQuantity(QuantityT& quantity_, const std::vector<glm::vec3>& colors_)
-    : quantity(quantity_), colors(&quantity, quantity.uniquePrefix() + "colors", colorsData), colorsData(colors_) {
+    : quantity(quantity_), colors(&quantity, quantity.uniquePrefix() + "colors", colorsData),
+      colorsUInt8(nullptr, quantity.uniquePrefix() + "colorsUInt8", colorsUInt8Data), colorsData(colors_),
+      byteColors(false) {
   colors.checkInvalidValues();
 }
 
+template <typename QuantityT>
+ColorQuantity<QuantityT>::ColorQuantity(QuantityT& quantity_, const std::vector<glm::u8vec4>& colors_)
+    : quantity(quantity_),
+      colors(&quantity, quantity.uniquePrefix() + "colors", colorsData, [this]() { computeColorsFromBytes(); }),
+      colorsUInt8(&quantity, quantity.uniquePrefix() + "colorsUInt8", colorsUInt8Data), colorsUInt8Data(colors_),
+      byteColors(true) {}
+
+template <typename QuantityT>
+void ColorQuantity<QuantityT>::computeColorsFromBytes() {
+  colorsUInt8.ensureHostBufferPopulated();
+  colors.data.resize(colorsUInt8.data.size());
+  for (size_t i = 0; i < colorsUInt8.data.size(); i++) {
+    colors.data[i] = glm::vec3(colorsUInt8.data[i]) / 255.f;
+  }
+  colors.markHostBufferUpdated();
+}
+
+template <typename QuantityT>
+bool ColorQuantity<QuantityT>::hasByteColors() {
+  return byteColors;
+}
+
+template <typename QuantityT>
+size_t ColorQuantity<QuantityT>::nColors() {
+  return byteColors ? colorsUInt8.size() : colors.size();
+}
+
+template <typename QuantityT>
+glm::vec3 ColorQuantity<QuantityT>::getColorValue(size_t ind) {
+  if (byteColors) {
+    return glm::vec3(colorsUInt8.getValue(ind)) / 255.f;
+  }
+  return colors.getValue(ind);
+}
+
+template <typename QuantityT>
+std::shared_ptr<render::AttributeBuffer> ColorQuantity<QuantityT>::getColorRenderAttributeBuffer() {
+  return byteColors ? colorsUInt8.getRenderAttributeBuffer() : colors.getRenderAttributeBuffer();
+}
+
 template <typename QuantityT>
 void ColorQuantity<QuantityT>::buildColorUI() {}
 
@@ -26,7 +68,19 @@ std::vector<std::string> ColorQuantity<QuantityT>::addColorRules(std::vector<std
 template <typename QuantityT>
 template <class V>
 void ColorQuantity<QuantityT>::updateData(const V& newColors) {
-  validateSize(newColors, colors.size(), "color quantity");
+  validateSize(newColors, nColors(), "color quantity");
+
+  if (byteColors) {
+    // (natively-stored colors must be updated with 8-bit data)
+    colorsUInt8.data = standardizeVectorArray<glm::u8vec4, 3>(newColors);
+    for (glm::u8vec4& c : colorsUInt8.data) {
+      c.a = 255;
+    }
+    colorsUInt8.markHostBufferUpdated();
+    colors.recomputeIfPopulated();
+    return;
+  }
+
   colors.data = standardizeVectorArray<glm::vec3, 3>(newColors);
   colors.markHostBufferUpdated();
 }
@@ -0,0 +1,44 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/render/color_maps.h"
+#include "polyscope/types.h"
+
+#include <string>
+#include <vector>
+
+namespace polyscope {
+
+// Everything which determines how the scalar shaders color a value. These mirror the colormap and isoline uniforms set
+// by ScalarQuantity::setScalarUniforms(); use ScalarQuantity::getColorMapParams() to get the current ones.
+struct ScalarColorMapParams {
+  std::string colorMap = "viridis";
+  DataType dataType = DataType::STANDARD;
+  float rangeLow = 0.f; // (unused for categorical data)
+  float rangeHigh = 1.f;
+  bool isolinesEnabled = false;
+  IsolineStyle isolineStyle = IsolineStyle::Stripe;
+  float isolinePeriod = 1.f; // absolute, in data units
+  float isolineDarkness = 0.7f;
+};
+
+// Compute the colors the scalar shaders draw for each value (the albedo, before any lighting), on the CPU and in
+// parallel. This follows the shader arithmetic step by step in single precision, including the linear filtering of the
+// colormap texture, rather than ValueColorMap::getValue().
+//
+// Contour isolines are not applied, since their width depends on screen-space derivatives of the value.
+std::vector<glm::vec3> evaluateScalarColorMap(const std::vector<float>& values, const ScalarColorMapParams& params);
+std::vector<glm::vec3> evaluateScalarColorMap(const std::vector<float>& values, const render::ValueColorMap& colorMap,
+                                              const ScalarColorMapParams& params);
+
+// As above, with an alpha of 1
+std::vector<glm::vec4> evaluateScalarColorMapRGBA(const std::vector<float>& values, const ScalarColorMapParams& params);
+
+namespace render {
+// Sample a colormap the way the shaders do: from a texture with one texel per entry, with linear filtering and
+// clamp-to-edge wrapping.
+glm::vec3 sampleColorMapTexture(const ValueColorMap& colorMap, float t);
+} // namespace render
+
+} // namespace polyscope
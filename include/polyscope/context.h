@@ -3,6 +3,7 @@
 #pragma once
 
 #include <polyscope/pick.h>
+#include <polyscope/profiler.h>
 #include <polyscope/types.h>
 #include <polyscope/weak_handle.h>
 
@@ -47,6 +48,15 @@ extern const float defaultFov;
 // unexpected order, they would reference one-another and cause platform-dependent errors. The global context solves
 // this because destruction always happens in a predictable order.
 
+// Counts of what frustum culling skipped while rendering the most recent frame. Each pass over the scene counts
+// separately, e.g. the ground plane reflection is a second pass.
+struct CullingStats {
+  size_t nStructuresDrawn = 0;
+  size_t nStructuresCulled = 0;
+  size_t nChunksDrawn = 0; // chunks of the elements of large structures
+  size_t nChunksCulled = 0;
+};
+
 struct Context {
 
   // ======================================================
@@ -70,6 +80,13 @@ struct Context {
   // === Render engine globals from engine.h
   // ======================================================
 
+  CullingStats cullingStats;
+
+  // ======================================================
+  // === Profiler globals from profiler.h
+  // ======================================================
+
+  profiler::ProfilerState profilerState;
 
   // ======================================================
   // === View globals from view.h
@@ -110,12 +127,22 @@ struct Context {
   uint64_t nextPickBufferInd = 1;
   std::unordered_map<Structure*, std::tuple<uint64_t, uint64_t>> structureRanges;
   std::unordered_map<Quantity*, std::tuple<uint64_t, uint64_t>> quantityRanges;
+  std::map<uint64_t, pick::PickBufferRange> pickRangesByStart; // the same ranges, sorted for lookups
+  uint64_t pickRangesGeneration = 0; // incremented whenever a range is requested or released
+  bool pickBufferCacheValid = false;
+  pick::PickBufferCacheKey pickBufferCacheKey;
+  bool asyncPickInFlight = false;
+  pick::AsyncPickQuery asyncPickQuery;
+  AsyncPickResult lastAsyncPickResult;
+  uint64_t lastAsyncPickFrameIndex = 0;
 
   // ======================================================
   // === Internal globals from internal.h
   // ======================================================
 
   bool renderPassIsRedraw = false;
+  uint64_t sceneGeneration = 0;
+  uint64_t frameIndex = 0; // incremented every main loop iteration
   bool pointCloudEfficiencyWarningReported = false;
   FloatingQuantityStructure* globalFloatingQuantityStructure = nullptr;
 
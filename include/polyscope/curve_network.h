@@ -35,6 +35,7 @@ struct CurveNetworkPickResult {
   CurveNetworkElement elementType; // which kind of element did we click
   int64_t index;                   // index of the clicked element
   float tEdge = -1;                // if the pick is an edge, the t-value in [0,1] along the edge
+  int64_t instanceIndex = -1;      // index of the clicked instance, if the network is instanced (then index is -1)
 };
 
 class CurveNetwork : public Structure {
@@ -57,6 +58,7 @@ public:
   virtual void drawPickDelayed() override;
 
   virtual void updateObjectSpaceBounds() override;
+  virtual float frustumCullingMargin() override;
   virtual std::string typeName() override;
 
   virtual void refresh() override;
@@ -73,6 +75,10 @@ public:
   // internally-computed geometry
   render::ManagedBuffer<glm::vec3> edgeCenters;
 
+  // instancing (empty if the network is not instanced)
+  render::ManagedBuffer<std::array<glm::vec3, 4>> instanceTransforms; // upper 3x4 block, by column [nInstances]
+  render::ManagedBuffer<glm::vec3> instanceColors;                    // [nInstances], or empty to use the color
+
   // === Quantities
 
   // Scalars
@@ -129,6 +135,32 @@ public:
   template <class V>
   void updateNodePositions2D(const V& newPositions);
 
+  // === Streaming
+  // Append nodes or edges to the end of the network. Storage grows geometrically and only the new entries are uploaded
+  // to the GPU. The bounding box and length scale are grown incrementally (conservatively), they never shrink.
+  // Appending is not supported while the curve network has quantities, since their data would no longer match.
+  template <class V>
+  void appendNodes(const V& newNodes);
+  template <class V>
+  void appendNodes2D(const V& newNodes);
+  template <class E>
+  void appendEdges(const E& newEdges); // indices may refer to any node, including ones appended previously
+
+  // === Instancing
+
+  // Draw many copies of the network in a single instanced draw call, one per transform. Each transform is applied in
+  // object space before the structure transform, and must be affine. Quantities are drawn on every instance, and
+  // picking identifies the instance rather than a node or edge.
+  void setInstances(const std::vector<glm::mat4>& transforms);
+  void clearInstances();
+  bool isInstanced();
+  size_t nInstances();
+
+  // Give each instance its own color, in place of the base color (expects vec3 array, one per instance)
+  template <class T>
+  void setInstanceColors(const T& colors);
+  void clearInstanceColors();
+
   // get data related to picking/selection
   CurveNetworkPickResult interpretPickResult(const PickResult& result);
 
@@ -168,9 +200,16 @@ private:
   std::vector<uint32_t> edgeTailIndsData;
   std::vector<uint32_t> edgeTipIndsData;
   std::vector<glm::vec3> edgeCentersData;
+  std::vector<std::array<glm::vec3, 4>> instanceTransformsData;
+  std::vector<glm::vec3> instanceColorsData;
 
   void computeEdgeCenters();
 
+  // Streaming implementations
+  void appendNodesImpl(const std::vector<glm::vec3>& newNodes);
+  void appendEdgesImpl(const std::vector<std::array<size_t, 2>>& newEdges);
+  void checkCanAppend();
+
   // === Visualization parameters
   PersistentValue<glm::vec3> color;
   PersistentValue<ScaledValue<float>> radius;
@@ -183,6 +222,19 @@ private:
   std::shared_ptr<render::ShaderProgram> edgePickProgram;
   std::shared_ptr<render::ShaderProgram> nodePickProgram;
 
+  // Pick colors, kept so that appended nodes and edges can be given pick indices without rebuilding the pick programs.
+  // The pick range holds a block of node indices then a block of edge indices, each of which may have room to spare.
+  std::shared_ptr<render::AttributeBuffer> nodePickColors;     // [nNodes]
+  std::shared_ptr<render::AttributeBuffer> edgePickTailColors; // [nEdges]
+  std::shared_ptr<render::AttributeBuffer> edgePickTipColors;  // [nEdges]
+  std::shared_ptr<render::AttributeBuffer> edgePickEdgeColors; // [nEdges]
+  size_t pickRangeStart = 0;
+  size_t pickNodeCapacity = 0;
+  size_t pickEdgeCapacity = 0;
+  void computeNodePickColors(size_t nodeStart, std::vector<glm::vec3>& colors);
+  void computeEdgePickColors(size_t edgeStart, std::vector<glm::vec3>& tailColors, std::vector<glm::vec3>& tipColors,
+                             std::vector<glm::vec3>& edgeColors);
+
   // === Helpers
 
   // Do setup work related to drawing, including allocating openGL data
@@ -173,6 +173,7 @@ void CurveNetwork::updateNodePositions(const V& newPositions) {
   nodePositions.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   nodePositions.markHostBufferUpdated();
   recomputeGeometryIfPopulated();
+  updateObjectSpaceBounds(); // keep culling bounds current, without changing the scene extents
 }
 
 
@@ -188,6 +189,40 @@ void CurveNetwork::updateNodePositions2D(const V& newPositions2D) {
   updateNodePositions(positions3D);
 }
 
+template <class V>
+void CurveNetwork::appendNodes(const V& newNodes) {
+  appendNodesImpl(standardizeVectorArray<glm::vec3, 3>(newNodes));
+}
+
+template <class V>
+void CurveNetwork::appendNodes2D(const V& newNodes2D) {
+  std::vector<glm::vec3> nodes3D = standardizeVectorArray<glm::vec3, 2>(newNodes2D);
+  for (glm::vec3& v : nodes3D) {
+    v.z = 0.;
+  }
+  appendNodesImpl(nodes3D);
+}
+
+template <class E>
+void CurveNetwork::appendEdges(const E& newEdges) {
+  appendEdgesImpl(standardizeVectorArray<std::array<size_t, 2>, 2>(newEdges));
+}
+
+template <class T>
+void CurveNetwork::setInstanceColors(const T& colors) {
+  if (!isInstanced()) exception("curve network [" + name + "] is not instanced, call setInstances() first");
+  validateSize(colors, nInstances(), "instance colors");
+  bool hadColors = !instanceColors.data.empty();
+  instanceColors.data = standardizeVectorArray<glm::vec3, 3>(colors);
+  instanceColors.markHostBufferUpdated();
+  if (!hadColors) {
+    // shade from the instance colors
+    nodeProgram.reset();
+    edgeProgram.reset();
+    requestRedraw();
+  }
+}
+
 // Shorthand to get a curve network from polyscope
 inline CurveNetwork* getCurveNetwork(std::string name) {
   return dynamic_cast<CurveNetwork*>(getStructure(CurveNetwork::structureTypeName, name));
@@ -17,6 +17,8 @@ class CurveNetworkVectorQuantity : public CurveNetworkQuantity {
 public:
   CurveNetworkVectorQuantity(std::string name, CurveNetwork& network_);
 
+  virtual bool isDrawnWithinParentBounds() override;
+
   // === Option accessors
 
 protected:
@@ -14,6 +14,7 @@ public:
   virtual ~FloatingQuantity() {};
 
   virtual void buildUI() override;
+  virtual bool isDrawnWithinParentBounds() override; // images are drawn in screen space
 };
 
 
@@ -4,6 +4,7 @@
 
 #include <cmath>
 #include <glm/glm.hpp>
+#include <glm/gtc/type_precision.hpp>
 #include <glm/gtx/compatibility.hpp>
 #include <type_traits>
 
@@ -97,6 +98,10 @@ template <>
 inline bool allComponentsFinite<glm::uvec4>(const glm::uvec4& x) {
   return true;
 }
+template <>
+inline bool allComponentsFinite<glm::u8vec4>(const glm::u8vec4& x) {
+  return true;
+}
 
 template <>
 inline bool allComponentsFinite<glm::mat2x2>(const glm::mat2x2& x) {
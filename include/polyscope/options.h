@@ -75,6 +75,10 @@ extern bool hideWindowAfterShow;
 // Give warnings for inf/nan values
 extern bool warnForInvalidValues;
 
+// When the data of a scalar quantity is updated, its histogram and data range are recomputed lazily while its UI is
+// visible, at most once per this many seconds. (default: 0.5)
+extern float scalarStatisticsRefreshPeriod;
+
 // Show warnings/errors in popup modal dialogs
 extern bool displayMessagePopups;
 
@@ -108,6 +112,29 @@ extern float uiScale;
 extern TransparencyMode transparencyMode;
 extern int transparencyRenderPasses;
 
+// Render the pick buffer as 64 bit integer IDs instead of packed floats, which makes decoding exact. Must be set before
+// polyscope::init(). (default: false)
+extern bool integerPickBuffer;
+
+// If set, compiled shader programs are cached as driver-specific binaries in this (existing) directory, which makes
+// startup much faster after the first run. Entries that the driver rejects are recompiled. Only supported by the openGL
+// backends on drivers which provide program binaries. (default: "", no cache)
+extern std::string shaderCacheDirectory;
+
+// When shader programs are warmed up ahead of their first use (see render::Engine::requestShaderWarmup()) on a driver
+// which cannot compile them in the background, at most this much time is spent compiling them each frame. At least one
+// program is always compiled per frame. (default: 4.)
+extern float shaderWarmupMillisecondsPerFrame;
+
+// Sort the draws issued by structures each frame to group those which share programs, textures, and render state,
+// rather than drawing in the order the structures were registered. (default: true)
+extern bool sortDrawCalls;
+
+// Skip drawing structures which are entirely out of view, and chunks of the elements of large point clouds and surface
+// meshes. Uses bounds computed from the geometry given on the host; disable this if you modify geometry directly in
+// the render buffers. (default: true)
+extern bool frustumCulling;
+
 // === Advanced ImGui configuration
 
 // If false, Polyscope will not create any ImGui UIs at all, but will still set up ImGui and invoke its render steps
@@ -165,5 +192,9 @@ extern bool enableRenderErrorChecks;
 // Render the pick buffer to screen rather than the regular scene
 extern bool debugDrawPickBuffer;
 
+// Record per-frame CPU and GPU timings, and show them in the profiler window (see profiler.h). Has no effect if the
+// profiler was compiled out. (default: false)
+extern bool enableProfiler;
+
 } // namespace options
 } // namespace polyscope
@@ -0,0 +1,81 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace polyscope {
+
+// Loops over fewer than this many elements are not worth spawning threads for
+const size_t defaultParallelGrainSize = 1 << 16;
+
+// The number of worker threads we are willing to use for data-parallel loops on the host
+inline size_t parallelMaxThreads() {
+  size_t n = std::thread::hardware_concurrency();
+  return n == 0 ? 1 : n;
+}
+
+// The number of chunks parallelForChunks() will split a loop of length N in to. Useful to allocate per-chunk
+// accumulators before running a reduction.
+inline size_t parallelChunkCount(size_t N, size_t grainSize = defaultParallelGrainSize) {
+  if (grainSize == 0) grainSize = 1;
+  size_t nChunks = (N + grainSize - 1) / grainSize;
+  return std::max(static_cast<size_t>(1), std::min(nChunks, parallelMaxThreads()));
+}
+
+// Call func(iChunk, iStart, iEnd) on disjoint contiguous ranges covering [0, N), using one thread per chunk.
+// Small loops run inline on the calling thread. Exceptions thrown by any chunk are rethrown on the calling thread.
+template <typename F>
+void parallelForChunks(size_t N, F func, size_t grainSize = defaultParallelGrainSize) {
+  size_t nChunks = parallelChunkCount(N, grainSize);
+  if (nChunks == 1) {
+    func(static_cast<size_t>(0), static_cast<size_t>(0), N);
+    return;
+  }
+
+  size_t chunkSize = (N + nChunks - 1) / nChunks;
+  std::vector<std::exception_ptr> errors(nChunks);
+  std::vector<std::thread> workers;
+  workers.reserve(nChunks - 1);
+
+  auto runChunk = [&](size_t iChunk) {
+    size_t iStart = std::min(N, iChunk * chunkSize);
+    size_t iEnd = std::min(N, iStart + chunkSize);
+    try {
+      func(iChunk, iStart, iEnd);
+    } catch (...) {
+      errors[iChunk] = std::current_exception();
+    }
+  };
+
+  for (size_t iChunk = 1; iChunk < nChunks; iChunk++) {
+    workers.emplace_back(runChunk, iChunk);
+  }
+  runChunk(0); // the calling thread does its share too
+  for (std::thread& t : workers) {
+    t.join();
+  }
+
+  for (std::exception_ptr& e : errors) {
+    if (e) std::rethrow_exception(e);
+  }
+}
+
+// Call func(i) for each i in [0, N), potentially in parallel.
+template <typename F>
+void parallelFor(size_t N, F func, size_t grainSize = defaultParallelGrainSize) {
+  parallelForChunks(
+      N,
+      [&](size_t iChunk, size_t iStart, size_t iEnd) {
+        for (size_t i = iStart; i < iEnd; i++) {
+          func(i);
+        }
+      },
+      grainSize);
+}
+
+} // namespace polyscope
@@ -6,6 +6,7 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 
 #include "polyscope/utilities.h"
 #include "polyscope/weak_handle.h"
@@ -45,6 +46,37 @@ struct PickResult {
 PickResult pickAtScreenCoords(glm::vec2 screenCoords); // takes screen coordinates
 PickResult pickAtBufferInds(glm::ivec2 bufferInds);    // takes indices into render buffer
 
+// Evaluate many pick queries at once. These do a single render pass and a batched readback, which is much cheaper than
+// picking at each location separately.
+std::vector<PickResult> pickAtScreenCoords(const std::vector<glm::vec2>& screenCoords);
+std::vector<PickResult> pickAtBufferInds(const std::vector<glm::ivec2>& bufferInds);
+
+// Return type for region pick queries. There is one entry for each structure (or quantity) which appears in the region.
+// Like PickResult, it can be fed into structure-specific functions like SurfaceMesh::interpretPickRegionResult().
+struct PickRegionResult {
+  Structure* structure = nullptr;
+  Quantity* quantity = nullptr;
+  WeakHandle<Structure> structureHandle; // same as .structure, but with lifetime tracking
+  std::string structureType = "";
+  std::string structureName = "";
+  std::string quantityName = "";
+  std::vector<uint64_t> localIndices; // sorted and unique
+};
+
+// Query everything visible in a region of the viewport. These do a single render pass and read back the whole region
+// at once, so they are much cheaper than picking each pixel separately.
+std::vector<PickRegionResult> pickInRect(glm::vec2 screenCornerA, glm::vec2 screenCornerB); // screen coordinates
+std::vector<PickRegionResult> pickInPolygon(const std::vector<glm::vec2>& screenPolygon);   // screen coordinates
+
+// Asynchronous picking, for queries made every frame like hover highlighting. Each call starts a new query without
+// waiting for the GPU, and returns the most recent query which has finished, typically the one from the previous frame.
+struct AsyncPickResult {
+  bool isAvailable = false; // false until the first query finishes
+  PickResult pick;
+  uint64_t framesOld = 0; // how many main loop iterations ago the query was made
+};
+AsyncPickResult pickAtScreenCoordsAsync(glm::vec2 screenCoords);
+
 
 // == Stateful picking: track and update a current selection
 
@@ -70,12 +102,55 @@ std::tuple<Structure*, Quantity*, uint64_t> evaluatePickQueryFull(int xPos,
 
 // == Helpers
 
+// Render all structures to the pick framebuffer (internal)
+// Returns false if the pick framebuffer could not be bound, in which case it should not be read.
+// If nothing has changed since the last call, the previous render is reused, see PickBufferCacheKey.
+bool renderPickBuffer();
+
+// Everything the contents of the pick buffer depend on. The scene generation is incremented by requestRedraw(), which
+// is called whenever a structure or quantity changes.
+struct PickBufferCacheKey {
+  uint64_t sceneGeneration = 0;
+  uint64_t framebufferID = 0;
+  int width = -1;
+  int height = -1;
+  glm::mat4 viewMat{0.};
+  glm::mat4 projMat{0.};
+};
+
+// Force the next pick query to re-render the pick buffer (also drops any asynchronous query in flight)
+void invalidatePickBuffer();
+
+// An allocated range of pick indices [start, end), and what it belongs to (internal)
+// Exactly one of structure and quantity is non-null.
+struct PickBufferRange {
+  uint64_t end;
+  Structure* structure;
+  Quantity* quantity;
+};
+
+// An asynchronous pick query which has been issued but not yet resolved
+struct AsyncPickQuery {
+  glm::ivec2 bufferInds;
+  glm::mat4 viewMat; // the camera when the query was issued
+  glm::mat4 projMat;
+  uint64_t frameIndex = 0;
+
+  // the pick range generation when the query was issued. If ranges have been requested or released since, the result
+  // is discarded, since the pixel may have been drawn for an old owner.
+  uint64_t pickRangesGeneration = 0;
+};
+
 // Set up picking (internal)
 // Called by a structure/quantity to figure out what data it should render to the pick buffer.
 // Request 'count' contiguous indices for drawing a pick buffer. The return value is the start of the range.
 uint64_t requestPickBufferRange(Structure* requestingStructure, uint64_t count);
 uint64_t requestPickBufferRange(Quantity* requestingQuantity, uint64_t count);
 
+// Free the range held by a structure or quantity, called when it is removed (internal)
+void releasePickBufferRange(Structure* structure);
+void releasePickBufferRange(Quantity* quantity);
+
 // Convert between global pick indexing for the whole program, and local per-structure pick indexing
 std::tuple<Structure*, Quantity*, uint64_t> globalIndexToLocal(uint64_t globalInd);
 uint64_t localIndexToGlobal(std::tuple<Structure*, Quantity*, uint64_t> localPick);
@@ -85,6 +160,11 @@ uint64_t localIndexToGlobal(std::tuple<Structure*, Quantity*, uint64_t> localPic
 inline glm::vec3 indToVec(uint64_t globalInd);
 inline uint64_t vecToInd(glm::vec3 vec);
 
+// Convert indices to the pair of 32 bit integers stored in an integer pick buffer (see options::integerPickBuffer)
+// and back. Structures still fill their pick buffers with indToVec(), the shaders do this conversion.
+inline glm::uvec2 indToUVec2(uint64_t globalInd);
+inline uint64_t uvec2ToInd(glm::uvec2 vec);
+
 } // namespace pick
 } // namespace polyscope
 
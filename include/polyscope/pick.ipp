@@ -48,5 +48,10 @@ inline uint64_t vecToInd(glm::vec3 vec) {
   return ind;
 }
 
+inline glm::uvec2 indToUVec2(uint64_t globalInd) {
+  return glm::uvec2{static_cast<uint32_t>(globalInd & 0xFFFFFFFFull), static_cast<uint32_t>(globalInd >> 32)};
+}
+inline uint64_t uvec2ToInd(glm::uvec2 vec) { return (static_cast<uint64_t>(vec.y) << 32) + vec.x; }
+
 } // namespace pick
 } // namespace polyscope
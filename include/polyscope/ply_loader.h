@@ -0,0 +1,27 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/point_cloud.h"
+#include "polyscope/surface_mesh.h"
+
+#include <string>
+
+namespace polyscope {
+
+// Load a .ply file and register its contents with Polyscope.
+//
+// Both ascii and binary (little or big endian) files are supported. Binary files are read in one pass and decoded in
+// parallel directly in to the flat arrays the structures are constructed from.
+//
+// Additional per-element properties in the file are added as quantities on the new structure:
+//   - red/green/blue become a color quantity named "color"
+//   - nx/ny/nz become a vector quantity named "normal"
+//   - u/v (or s/t, texture_u/texture_v) become a parameterization quantity named "uv"
+//   - any other scalar property becomes a scalar quantity with the property's name
+//
+// If `name` is empty, a name is guessed from the filename.
+SurfaceMesh* loadSurfaceMeshPLY(std::string name, std::string filename);
+PointCloud* loadPointCloudPLY(std::string name, std::string filename);
+
+} // namespace polyscope
@@ -37,6 +37,10 @@ struct PointCloudPickResult {
   int64_t index;
 };
 
+struct PointCloudPickRegionResult {
+  std::vector<int64_t> indices; // sorted
+};
+
 class PointCloud : public Structure {
 public:
   // === Member functions ===
@@ -57,6 +61,7 @@ public:
   virtual void drawPick() override;
   virtual void drawPickDelayed() override;
   virtual void updateObjectSpaceBounds() override;
+  virtual float frustumCullingMargin() override;
   virtual std::string typeName() override;
   virtual void refresh() override;
 
@@ -69,6 +74,14 @@ public:
   template <class T>
   PointCloudScalarQuantity* addScalarQuantity(std::string name, const T& values, DataType type = DataType::STANDARD);
 
+  // Integer scalars, which are stored and uploaded in their native type rather than as floats
+  PointCloudScalarQuantity* addIntegerScalarQuantity(std::string name, const std::vector<uint8_t>& values,
+                                                     DataType type = DataType::STANDARD);
+  PointCloudScalarQuantity* addIntegerScalarQuantity(std::string name, const std::vector<uint16_t>& values,
+                                                     DataType type = DataType::STANDARD);
+  PointCloudScalarQuantity* addIntegerScalarQuantity(std::string name, const std::vector<int32_t>& values,
+                                                     DataType type = DataType::STANDARD);
+
   // Parameterization
   template <class T>
   PointCloudParameterizationQuantity* addParameterizationQuantity(std::string name, const T& values,
@@ -81,6 +94,10 @@ public:
   template <class T>
   PointCloudColorQuantity* addColorQuantity(std::string name, const T& values);
 
+  // 8-bit colors, with components in [0,255], which are stored and uploaded as bytes
+  template <class T>
+  PointCloudColorQuantity* addByteColorQuantity(std::string name, const T& values);
+
   // Vectors
   template <class T>
   PointCloudVectorQuantity* addVectorQuantity(std::string name, const T& vectors,
@@ -95,6 +112,37 @@ public:
   template <class V>
   void updatePointPositions2D(const V& newPositions);
 
+  // === Streaming
+  // Append points to the end of the cloud. Storage grows geometrically and only the new points are uploaded to the
+  // GPU. The bounding box and length scale are grown incrementally (conservatively), they never shrink.
+  // Appending is not supported while the point cloud has quantities, since their data would no longer match.
+  template <class V>
+  void appendPoints(const V& newPoints);
+  template <class V>
+  void appendPoints2D(const V& newPoints);
+
+  // === Time series
+  // Animate the positions, scalars, or colors over a sequence of frames, with playback controls in the UI (see
+  // getTimeSeries()). Frames are given either as an array of per-frame arrays, or as a loader callback which produces
+  // frame i. Loaders run on background threads ahead of playback, so they must be thread-safe.
+  template <class V>
+  void addPointPositionFrames(const std::vector<V>& frames);
+  void addPointPositionFrameLoader(size_t nFrames, FrameLoader<glm::vec3> loader);
+  template <class T>
+  PointCloudScalarQuantity* addScalarQuantityFrames(std::string name, const std::vector<T>& frames,
+                                                    DataType type = DataType::STANDARD);
+  PointCloudScalarQuantity* addScalarQuantityFrameLoader(std::string name, size_t nFrames, FrameLoader<float> loader,
+                                                         DataType type = DataType::STANDARD);
+  template <class T>
+  PointCloudColorQuantity* addColorQuantityFrames(std::string name, const std::vector<T>& frames);
+  PointCloudColorQuantity* addColorQuantityFrameLoader(std::string name, size_t nFrames,
+                                                       FrameLoader<glm::vec3> loader);
+
+  // Cap the number of points, turning the cloud in to a ring buffer: once full, each appended point overwrites the
+  // oldest one. If there are already more points than the cap, the oldest are dropped. 0 means no limit (the default).
+  void setMaxPointCount(size_t newMax);
+  size_t getMaxPointCount();
+
   // === Set point size from a scalar quantity
   // effect is multiplicative with pointRadius
   // negative values are always clamped to 0
@@ -119,6 +167,7 @@ public:
 
   // get data related to picking/selection
   PointCloudPickResult interpretPickResult(const PickResult& result);
+  PointCloudPickRegionResult interpretPickRegionResult(const PickRegionResult& result);
 
   // Misc data
   static const std::string structureTypeName;
@@ -167,12 +216,26 @@ private:
   // if nullptr, prepare() (resp. preparePick()) needs to be called
   std::shared_ptr<render::ShaderProgram> program;
   std::shared_ptr<render::ShaderProgram> pickProgram;
+  std::shared_ptr<render::AttributeBuffer> pickColors; // [nPoints], packed pick indices
+
+  // The pick range may hold more indices than there are points, so that appended points can be given pick colors
+  // without rebuilding the pick program
+  size_t pickRangeStart = 0;
+  size_t pickRangeCapacity = 0;
 
   // === Helpers
   // Do setup work related to drawing, including allocating openGL data
   void ensureRenderProgramPrepared();
   void ensurePickProgramPrepared();
 
+  // Streaming state
+  size_t maxPointCount = 0; // 0 means unbounded
+  size_t ringNextInd = 0;   // next slot to overwrite, once the ring buffer is full
+  void appendPointsImpl(const std::vector<glm::vec3>& newPoints);
+
+  // Recompute the culling chunks which overlap points [pointStart, pointEnd)
+  void updateCullingChunkBounds(size_t pointStart, size_t pointEnd);
+
   // === Quantity adder implementations
   PointCloudScalarQuantity* addScalarQuantityImpl(std::string name, const std::vector<float>& data, DataType type);
   PointCloudParameterizationQuantity*
@@ -180,6 +243,7 @@ private:
   PointCloudParameterizationQuantity*
   addLocalParameterizationQuantityImpl(std::string name, const std::vector<glm::vec2>& param, ParamCoordsType type);
   PointCloudColorQuantity* addColorQuantityImpl(std::string name, const std::vector<glm::vec3>& colors);
+  PointCloudColorQuantity* addByteColorQuantityImpl(std::string name, const std::vector<glm::u8vec4>& colors);
   PointCloudVectorQuantity* addVectorQuantityImpl(std::string name, const std::vector<glm::vec3>& vectors,
                                                   VectorType vectorType);
 
@@ -38,6 +38,7 @@ void PointCloud::updatePointPositions(const V& newPositions) {
   validateSize(newPositions, nPoints(), "point cloud updated positions " + name);
   points.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   points.markHostBufferUpdated();
+  updateObjectSpaceBounds(); // keep culling bounds current, without changing the scene extents
 }
 
 template <class V>
@@ -52,6 +53,46 @@ void PointCloud::updatePointPositions2D(const V& newPositions2D) {
   updatePointPositions(positions3D);
 }
 
+template <class V>
+void PointCloud::appendPoints(const V& newPoints) {
+  appendPointsImpl(standardizeVectorArray<glm::vec3, 3>(newPoints));
+}
+
+template <class V>
+void PointCloud::appendPoints2D(const V& newPoints2D) {
+  std::vector<glm::vec3> points3D = standardizeVectorArray<glm::vec3, 2>(newPoints2D);
+  for (glm::vec3& v : points3D) {
+    v.z = 0.;
+  }
+  appendPointsImpl(points3D);
+}
+
+template <class V>
+void PointCloud::addPointPositionFrames(const std::vector<V>& frames) {
+  // keep a copy, conversion happens lazily on the loader threads
+  std::shared_ptr<const std::vector<V>> framesCopy(new std::vector<V>(frames));
+  addPointPositionFrameLoader(frames.size(), [framesCopy](size_t iFrame) {
+    return standardizeVectorArray<glm::vec3, 3>((*framesCopy)[iFrame]);
+  });
+}
+
+template <class T>
+PointCloudScalarQuantity* PointCloud::addScalarQuantityFrames(std::string name, const std::vector<T>& frames,
+                                                              DataType type) {
+  std::shared_ptr<const std::vector<T>> framesCopy(new std::vector<T>(frames));
+  return addScalarQuantityFrameLoader(
+      name, frames.size(),
+      [framesCopy](size_t iFrame) { return standardizeArray<float, T>((*framesCopy)[iFrame]); }, type);
+}
+
+template <class T>
+PointCloudColorQuantity* PointCloud::addColorQuantityFrames(std::string name, const std::vector<T>& frames) {
+  std::shared_ptr<const std::vector<T>> framesCopy(new std::vector<T>(frames));
+  return addColorQuantityFrameLoader(name, frames.size(), [framesCopy](size_t iFrame) {
+    return standardizeVectorArray<glm::vec3, 3>((*framesCopy)[iFrame]);
+  });
+}
+
 
 // Shorthand to get a point cloud from polyscope
 inline PointCloud* getPointCloud(std::string name) {
@@ -74,6 +115,16 @@ PointCloudColorQuantity* PointCloud::addColorQuantity(std::string name, const T&
   return addColorQuantityImpl(name, standardizeVectorArray<glm::vec3, 3>(colors));
 }
 
+template <class T>
+PointCloudColorQuantity* PointCloud::addByteColorQuantity(std::string name, const T& colors) {
+  validateSize(colors, nPoints(), "point cloud color quantity " + name);
+  std::vector<glm::u8vec4> colorsRGBA = standardizeVectorArray<glm::u8vec4, 3>(colors);
+  for (glm::u8vec4& c : colorsRGBA) {
+    c.a = 255;
+  }
+  return addByteColorQuantityImpl(name, colorsRGBA);
+}
+
 template <class T>
 PointCloudScalarQuantity* PointCloud::addScalarQuantity(std::string name, const T& data, DataType type) {
   validateSize(data, nPoints(), "point cloud scalar quantity " + name);
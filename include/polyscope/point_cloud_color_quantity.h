@@ -14,6 +14,7 @@ namespace polyscope {
 class PointCloudColorQuantity : public PointCloudQuantity, public ColorQuantity<PointCloudColorQuantity> {
 public:
   PointCloudColorQuantity(std::string name, const std::vector<glm::vec3>& values, PointCloud& pointCloud_);
+  PointCloudColorQuantity(std::string name, const std::vector<glm::u8vec4>& values, PointCloud& pointCloud_);
 
   virtual void draw() override;
 
@@ -16,6 +16,12 @@ class PointCloudScalarQuantity : public PointCloudQuantity, public ScalarQuantit
 public:
   PointCloudScalarQuantity(std::string name, const std::vector<float>& values, PointCloud& pointCloud_,
                            DataType dataType);
+  PointCloudScalarQuantity(std::string name, const std::vector<uint8_t>& values, PointCloud& pointCloud_,
+                           DataType dataType);
+  PointCloudScalarQuantity(std::string name, const std::vector<uint16_t>& values, PointCloud& pointCloud_,
+                           DataType dataType);
+  PointCloudScalarQuantity(std::string name, const std::vector<int32_t>& values, PointCloud& pointCloud_,
+                           DataType dataType);
 
   virtual void draw() override;
   virtual void buildCustomUI() override;
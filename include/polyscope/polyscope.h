@@ -175,6 +175,9 @@ void requestRedraw();
 // Has a redraw been requested for the next frame?
 bool redrawRequested();
 
+// What frustum culling skipped while rendering the most recent frame (see options::frustumCulling)
+CullingStats getCullingStats();
+
 // Managed a stack of of contexts to draw the UI. Usually contains one entry, which causes the main GUI to be drawn, but
 // in general the top callback will be called instead. Primarily exists to manage the ImGUI context, so callbacks can
 // create other contexts and circumvent the main draw loop. This is used internally to implement messages, element
@@ -0,0 +1,129 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+namespace polyscope {
+namespace profiler {
+
+// A hierarchical per-frame profiler. Polyscope wraps the main stages of each frame in timing scopes (drawing the
+// scene and each structure, picking, preparing programs and buffers, building the UI, screenshot readback). While
+// options::enableProfiler is set, the timings of recent frames are recorded; they are shown in the profiler window, and
+// can be exported as a Chrome trace.
+//
+// Some scopes also time the GPU work issued inside them. GPU timings are only known once the GPU catches up, usually a
+// frame or two later, so a frame is not available until all of its GPU timings are. When draw calls are sorted (see
+// options::sortDrawCalls), a structure's draws are deferred and actually issued while the render queue is executed, so
+// they are GPU-timed there, under the structure's name, once for each run of its draws in the sorted order.
+//
+// When polyscope is built with POLYSCOPE_ENABLE_PROFILER=OFF the scopes compile to nothing and no frames are ever
+// recorded.
+
+// The time spent in one scope during one frame
+struct ScopeTiming {
+  std::string name;
+  int depth = 0;              // nesting depth, 0 for the outermost scopes
+  double cpuStartMs = 0.;     // relative to the start of the frame
+  double cpuDurationMs = 0.;
+  double gpuDurationMs = -1.; // -1 if the scope does not time the GPU
+};
+
+struct FrameTiming {
+  uint64_t frameIndex = 0;
+  double cpuStartMs = 0.; // relative to when recording started
+  double cpuDurationMs = 0.;
+  std::vector<ScopeTiming> scopes; // in the order they were opened, so each scope is followed by the scopes within it
+};
+
+// True unless polyscope was built with the profiler compiled out
+bool isCompiledIn();
+
+// Open and close a scope (prefer the POLYSCOPE_PROFILE_SCOPE macros below). Scopes must be properly nested. A scope
+// opened outside of a frame (e.g. a screenshot taken from a script) is recorded as a frame of its own. beginScope()
+// returns false if nothing is being recorded, in which case the scope must not be closed.
+bool beginScope(const char* name, bool timeGPU = false);
+bool beginScope(const std::string& name, bool timeGPU = false);
+void endScope();
+
+class ScopedTimer {
+public:
+  ScopedTimer(const char* name, bool timeGPU = false) : active(beginScope(name, timeGPU)) {}
+  ScopedTimer(const std::string& name, bool timeGPU = false) : active(beginScope(name, timeGPU)) {}
+  ~ScopedTimer() {
+    if (active) endScope();
+  }
+  ScopedTimer(const ScopedTimer&) = delete;
+  ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+  bool active;
+};
+
+// Called by the main loop around each frame
+void beginFrame();
+void endFrame();
+
+// The most recent completed frames, oldest first
+const std::deque<FrameTiming>& getFrames();
+void clear();
+
+// Export the recorded frames in the Chrome trace event format, which can be opened in chrome://tracing or
+// https://ui.perfetto.dev. GPU timings appear as a second thread.
+std::string getChromeTrace();
+void saveChromeTrace(std::string filename);
+
+// Build the profiler window
+void buildProfilerUI();
+
+// Internal state, held in the global context
+struct ProfilerState {
+  struct OpenScope {
+    size_t iScope;
+    std::chrono::steady_clock::time_point start;
+    bool timeGPU;
+    uint32_t gpuStartQuery;
+  };
+  struct PendingGPUTiming {
+    size_t iScope;
+    uint32_t startQuery, endQuery;
+    uint64_t startNs = 0, endNs = 0;
+    bool haveStart = false, haveEnd = false;
+  };
+  struct PendingFrame {
+    FrameTiming frame;
+    std::vector<PendingGPUTiming> gpuTimings;
+  };
+
+  bool recording = false;
+  bool frameOpen = false;
+  bool implicitFrame = false; // opened by a scope outside of a frame, closes with it
+  int nestedFrameDepth = 0;
+  std::chrono::steady_clock::time_point recordingStart;
+  std::chrono::steady_clock::time_point frameStart;
+  PendingFrame currFrame;
+  std::vector<OpenScope> openScopes;
+  std::deque<PendingFrame> pendingFrames; // waiting on GPU timings
+  std::deque<FrameTiming> frames;
+};
+
+} // namespace profiler
+} // namespace polyscope
+
+#define POLYSCOPE_PROFILE_CONCAT_INNER(a, b) a##b
+#define POLYSCOPE_PROFILE_CONCAT(a, b) POLYSCOPE_PROFILE_CONCAT_INNER(a, b)
+
+// Time the rest of the enclosing block, on the CPU (and on the GPU, for the _GPU variant)
+#ifdef POLYSCOPE_PROFILER_ENABLED
+#define POLYSCOPE_PROFILE_SCOPE(name)                                                                                  \
+  ::polyscope::profiler::ScopedTimer POLYSCOPE_PROFILE_CONCAT(polyscopeProfileScope_, __LINE__)(name)
+#define POLYSCOPE_PROFILE_GPU_SCOPE(name)                                                                              \
+  ::polyscope::profiler::ScopedTimer POLYSCOPE_PROFILE_CONCAT(polyscopeProfileScope_, __LINE__)(name, true)
+#else
+#define POLYSCOPE_PROFILE_SCOPE(name)
+#define POLYSCOPE_PROFILE_GPU_SCOPE(name)
+#endif
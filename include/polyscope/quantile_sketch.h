@@ -0,0 +1,46 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace polyscope {
+
+// A KLL quantile sketch: a compact summary of a stream of values from which approximate quantiles can be read.
+//
+// It uses memory proportional to k (independent of the number of values), and adding a value takes amortized constant
+// time. The rank error of a quantile is roughly 1.7/k. Sketches built on separate parts of some data can be merged,
+// which is how they are computed in parallel.
+class QuantileSketch {
+public:
+  QuantileSketch(size_t k = 200);
+
+  void add(double val);
+  void merge(const QuantileSketch& other);
+
+  // The number of values added (including via merges)
+  size_t count() const;
+
+  // The approximate value at quantile q in [0,1] (0 is the min, 1 the max). Throws if the sketch is empty.
+  double quantile(double q) const;
+
+private:
+  size_t k;
+  size_t n = 0;
+
+  // Items on level h each stand in for 2^h of the original values
+  std::vector<std::vector<double>> levels;
+  std::vector<size_t> levelCapacities; // depend on the number of levels
+  size_t nItems = 0;                   // total over all levels
+  size_t capacity = 0;                 // total over all levels
+  uint32_t randState = 0x9e3779b9;     // fixed seed, results are deterministic
+
+  void addLevel();
+  void compress();
+  void compactLevel(size_t iLevel);
+  bool randomBit();
+};
+
+} // namespace polyscope
@@ -56,6 +56,10 @@ public:
   virtual std::string niceName();
   std::string uniquePrefix();
 
+  // False if the quantity may draw outside of the parent structure's bounds (such as vectors), which prevents the
+  // parent from being frustum culled while the quantity is enabled.
+  virtual bool isDrawnWithinParentBounds();
+
   // === Member variables ===
   Structure& parent;      // the parent structure with which this quantity is associated
   const std::string name; // a name for this quantity, which must be unique amongst quantities on `parent`
@@ -4,7 +4,9 @@
 
 #include <array>
 #include <cstdint>
+#include <deque>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "polyscope/render/color_maps.h"
@@ -13,6 +15,7 @@
 #include "polyscope/types.h"
 #include "polyscope/view.h"
 
+#include "glm/gtc/type_precision.hpp"
 #include "imgui.h"
 
 namespace polyscope {
@@ -37,7 +40,7 @@ enum class DrawMode {
 };
 
 enum class TextureFormat { RGB8 = 0, RGBA8, RG16F, RGB16F, RGBA16F, RGBA32F, RGB32F, R32F, R16F, DEPTH24 };
-enum class RenderBufferType { Color, ColorAlpha, Depth, Float4 };
+enum class RenderBufferType { Color, ColorAlpha, Depth, Float4, UInt2 }; // UInt2 is two 32 bit unsigned integers
 enum class DepthMode { Less, LEqual, LEqualReadOnly, Greater, Disable, PassReadOnly };
 enum class BlendMode { AlphaOver, OverNoWrite, AlphaUnder, Zero, WeightedAdd, Add, Source, Disable };
 enum class RenderDataType {
@@ -53,7 +56,12 @@ enum class RenderDataType {
   UInt,
   Vector2UInt,
   Vector3UInt,
-  Vector4UInt
+  Vector4UInt,
+  // Compact storage types. These can be bound to float shader attributes, and are converted when fetched: UInt8 and
+  // UInt16 to their integer value, Vector4UInt8 to a normalized [0,1] color.
+  UInt8,
+  UInt16,
+  Vector4UInt8
 };
 
 enum class DeviceBufferType { Attribute, Texture1d, Texture2d, Texture3d };
@@ -88,6 +96,9 @@ public:
   virtual void setData(const std::vector<glm::uvec2>& data) = 0;
   virtual void setData(const std::vector<glm::uvec3>& data) = 0;
   virtual void setData(const std::vector<glm::uvec4>& data) = 0;
+  virtual void setData(const std::vector<uint8_t>& data) = 0;
+  virtual void setData(const std::vector<uint16_t>& data) = 0;
+  virtual void setData(const std::vector<glm::u8vec4>& data) = 0;
 
   // Array-valued attributes
   // (adding these lazily as we need them)
@@ -96,6 +107,29 @@ public:
   virtual void setData(const std::vector<std::array<glm::vec3, 3>>& data) = 0;
   virtual void setData(const std::vector<std::array<glm::vec3, 4>>& data) = 0;
 
+  // Write `data` to entries [start, start + data.size()) of an already-set buffer, leaving the other entries as they
+  // are. The buffer grows if the range runs past its end; `start` may be at most the current size. Only the range is
+  // uploaded, so appending costs time proportional to what was appended.
+  virtual void setDataRange(const std::vector<glm::vec2>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::vec3>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::vec4>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<float>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<double>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<int32_t>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::ivec2>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::ivec3>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::ivec4>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<uint32_t>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec2>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec3>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::uvec4>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<uint8_t>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<uint16_t>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<glm::u8vec4>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t start) = 0;
+  virtual void setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t start) = 0;
+
   virtual uint32_t getNativeBufferID() = 0; // used to interop with external things, e.g. ImGui
 
   // == Getters
@@ -120,6 +154,9 @@ public:
   virtual glm::uvec2 getData_uvec2(size_t ind) = 0;
   virtual glm::uvec3 getData_uvec3(size_t ind) = 0;
   virtual glm::uvec4 getData_uvec4(size_t ind) = 0;
+  virtual uint8_t getData_uint8(size_t ind) = 0;
+  virtual uint16_t getData_uint16(size_t ind) = 0;
+  virtual glm::u8vec4 getData_u8vec4(size_t ind) = 0;
 
   // get data at a range of indices from the buffer
   virtual std::vector<float> getDataRange_float(size_t ind, size_t count) = 0;
@@ -135,6 +172,9 @@ public:
   virtual std::vector<glm::uvec2> getDataRange_uvec2(size_t ind, size_t count) = 0;
   virtual std::vector<glm::uvec3> getDataRange_uvec3(size_t ind, size_t count) = 0;
   virtual std::vector<glm::uvec4> getDataRange_uvec4(size_t ind, size_t count) = 0;
+  virtual std::vector<uint8_t> getDataRange_uint8(size_t ind, size_t count) = 0;
+  virtual std::vector<uint16_t> getDataRange_uint16(size_t ind, size_t count) = 0;
+  virtual std::vector<glm::u8vec4> getDataRange_u8vec4(size_t ind, size_t count) = 0;
 
 protected:
   RenderDataType dataType;
@@ -174,6 +214,7 @@ public:
   virtual void setData(const std::vector<glm::uvec2>& data) = 0;
   virtual void setData(const std::vector<glm::uvec3>& data) = 0;
   virtual void setData(const std::vector<glm::uvec4>& data) = 0;
+  virtual void setData(const std::vector<glm::u8vec4>& data) = 0;
 
   // Array-valued
   // NOTE: some of these are not implemented yet
@@ -237,6 +278,13 @@ protected:
 };
 
 
+// The result of an asynchronous single-pixel read, see FrameBuffer::requestAsyncReadPixel()
+struct PixelReadResult {
+  std::array<float, 4> float4 = {0., 0., 0., 0.}; // populated if the color buffer is float-valued
+  std::array<uint32_t, 2> uint2 = {0, 0};         // populated if the color buffer is RenderBufferType::UInt2
+  float depth = 1.;
+};
+
 class FrameBuffer {
 
 public:
@@ -278,6 +326,21 @@ public:
   // Query pixel
   virtual std::array<float, 4> readFloat4(int xPos, int yPos) = 0;
   virtual float readDepth(int xPos, int yPos) = 0;
+  // Read a w x h block of pixels starting at (xStart, yStart) in one transfer, as row-major RGBA values, bottom row first
+  virtual std::vector<float> readFloat4Region(int xStart, int yStart, int w, int h) = 0;
+  // Query many pixels at once. Backends may batch these in to fewer transfers than reading each pixel separately.
+  virtual std::vector<std::array<float, 4>> readFloat4Pixels(const std::vector<glm::ivec2>& positions);
+  virtual std::vector<float> readDepthPixels(const std::vector<glm::ivec2>& positions);
+  // Same as above, for integer-valued buffers (RenderBufferType::UInt2)
+  virtual std::array<uint32_t, 2> readUInt2(int xPos, int yPos) = 0;
+  virtual std::vector<uint32_t> readUInt2Region(int xStart, int yStart, int w, int h) = 0;
+  virtual std::vector<std::array<uint32_t, 2>> readUInt2Pixels(const std::vector<glm::ivec2>& positions);
+
+  // Non-blocking query of the first color buffer and the depth buffer at a pixel. The request is queued behind any
+  // pending rendering; poll until it returns true to get the result. Only one request is in flight at a time, a new
+  // request replaces any unfinished one. The default implementation reads synchronously.
+  virtual void requestAsyncReadPixel(int xPos, int yPos);
+  virtual bool pollAsyncReadPixel(PixelReadResult& result);
   virtual void blitTo(FrameBuffer* other) = 0;
   virtual std::vector<unsigned char> readBuffer() = 0;
 
@@ -297,6 +360,11 @@ protected:
   int nColorBuffers = 0;
   std::vector<std::shared_ptr<RenderBuffer>> renderBuffersColor, renderBuffersDepth;
   std::vector<std::shared_ptr<TextureBuffer>> textureBuffersColor, textureBuffersDepth;
+  bool hasIntegerColorBuffer() const;
+
+  // Default asynchronous read state
+  bool asyncReadPending = false;
+  PixelReadResult asyncReadResult;
 };
 
 // == Shaders
@@ -306,12 +374,16 @@ struct ShaderSpecUniform {
   const RenderDataType type;
 };
 struct ShaderSpecAttribute {
-  ShaderSpecAttribute(std::string name_, RenderDataType type_) : name(name_), type(type_), arrayCount(1) {}
+  ShaderSpecAttribute(std::string name_, RenderDataType type_)
+      : name(name_), type(type_), arrayCount(1), perInstance(false) {}
   ShaderSpecAttribute(std::string name_, RenderDataType type_, int arrayCount_)
-      : name(name_), type(type_), arrayCount(arrayCount_) {}
+      : name(name_), type(type_), arrayCount(arrayCount_), perInstance(false) {}
+  ShaderSpecAttribute(std::string name_, RenderDataType type_, int arrayCount_, bool perInstance_)
+      : name(name_), type(type_), arrayCount(arrayCount_), perInstance(perInstance_) {}
   const std::string name;
   const RenderDataType type;
-  const int arrayCount; // number of times this element is repeated in an array
+  const int arrayCount;   // number of times this element is repeated in an array
+  const bool perInstance; // holds one element per instance of an instanced draw, rather than one per vertex
 };
 struct ShaderSpecTexture {
   const std::string name;
@@ -334,6 +406,8 @@ struct ShaderStageSpecification {
 // the program source, which will be replaced by the string value (if many such replacements exist, the values are
 // concatenated together).
 // The uniforms/attributes/textures are unioned to the respective lists for the program.
+// A rule may also declare a uniform block which provides some uniforms; any plain declarations of those uniforms in the
+// program are removed, and setting them on the program does nothing.
 class ShaderReplacementRule {
 public:
   ShaderReplacementRule();
@@ -341,12 +415,16 @@ public:
   ShaderReplacementRule(std::string ruleName_, std::vector<std::pair<std::string, std::string>> replacements_,
                         std::vector<ShaderSpecUniform> uniforms_, std::vector<ShaderSpecAttribute> attributes_,
                         std::vector<ShaderSpecTexture> textures_);
+  ShaderReplacementRule(std::string ruleName_, std::vector<std::pair<std::string, std::string>> replacements_,
+                        std::vector<ShaderSpecUniform> uniforms_, std::vector<ShaderSpecAttribute> attributes_,
+                        std::vector<ShaderSpecTexture> textures_, std::vector<std::string> blockUniforms_);
 
   std::string ruleName;
   std::vector<std::pair<std::string, std::string>> replacements;
   std::vector<ShaderSpecUniform> uniforms;
   std::vector<ShaderSpecAttribute> attributes;
   std::vector<ShaderSpecTexture> textures;
+  std::vector<std::string> blockUniforms; // names of the uniforms provided by a uniform block in the replacements
 };
 enum class ShaderReplacementDefaults {
   SceneObject,        // an object in the scene, which gets lit via matcap (etc)
@@ -356,6 +434,31 @@ enum class ShaderReplacementDefaults {
   None                // no defaults applied
 };
 
+// A uniform of a shader program, looked up once by name so that it can be set repeatedly without searching for it
+// again. Handles are only meaningful for the program which created them.
+struct UniformHandle {
+  int32_t index = -1;
+  bool isValid() const { return index >= 0; } // false for a uniform the program does not have
+};
+
+// The name of a uniform which is set on many programs every frame. Each program resolves it to a handle the first time
+// it is asked for it (see ShaderProgram::findUniform()) and caches the result, so later frames skip the lookup.
+// Declare these once, e.g. as constants in the file which sets the uniform.
+class UniformName {
+public:
+  explicit UniformName(std::string name);
+  const std::string name;
+  const size_t slot; // index in each program's cache of resolved handles
+};
+
+// A contiguous range of the vertices drawn by a program (or of its indices, for indexed draws)
+struct DrawRange {
+  uint32_t start;
+  uint32_t count;
+};
+
+struct RenderQueueItem;
+
 // Encapsulate a shader program
 class ShaderProgram {
 
@@ -386,6 +489,32 @@ public:
   virtual void setUniform(std::string name, glm::uvec3 val) = 0;
   virtual void setUniform(std::string name, glm::uvec4 val) = 0;
 
+  // Uniforms by handle. Setting by name is equivalent to setUniform(getUniformHandle(name), ...), code which sets the
+  // same uniforms every frame can resolve the handles once and skip the lookups.
+  virtual UniformHandle getUniformHandle(std::string name) = 0; // throws if the program has no such uniform
+  virtual UniformHandle lookupUniformHandle(const std::string& name) = 0; // invalid if the program has no such uniform
+  virtual void setUniform(UniformHandle handle, int val) = 0;
+  virtual void setUniform(UniformHandle handle, unsigned int val) = 0;
+  virtual void setUniform(UniformHandle handle, float val) = 0;
+  virtual void setUniform(UniformHandle handle, double val) = 0; // WARNING casts down to float
+  virtual void setUniform(UniformHandle handle, float* val) = 0;
+  virtual void setUniform(UniformHandle handle, glm::vec2 val) = 0;
+  virtual void setUniform(UniformHandle handle, glm::vec3 val) = 0;
+  virtual void setUniform(UniformHandle handle, glm::vec4 val) = 0;
+  virtual void setUniform(UniformHandle handle, std::array<float, 3> val) = 0;
+  virtual void setUniform(UniformHandle handle, float x, float y, float z, float w) = 0;
+  virtual void setUniform(UniformHandle handle, glm::ivec2 val) = 0;
+  virtual void setUniform(UniformHandle handle, glm::ivec3 val) = 0;
+  virtual void setUniform(UniformHandle handle, glm::ivec4 val) = 0;
+  virtual void setUniform(UniformHandle handle, glm::uvec2 val) = 0;
+  virtual void setUniform(UniformHandle handle, glm::uvec3 val) = 0;
+  virtual void setUniform(UniformHandle handle, glm::uvec4 val) = 0;
+
+  // The handle of a uniform, looked up on the first call for each name and cached by the program after that. Like
+  // lookupUniformHandle(), returns an invalid handle if the program has no such uniform. (Uniforms which a program
+  // reads from a uniform block still have a valid handle, setting them does nothing.)
+  UniformHandle findUniform(const UniformName& uniform);
+
   // = Attributes
   // clang-format off
   virtual bool hasAttribute(std::string name) = 0;
@@ -421,14 +550,23 @@ public:
   virtual void setIndex(std::shared_ptr<AttributeBuffer> externalBuffer) = 0;
   virtual void setPrimitiveRestartIndex(unsigned int restartIndex) = 0;
 
-  // Indices
+  // Instancing
+  // Required for the *Instanced draw modes. For any other draw mode, setting a count draws that many instances of the
+  // geometry, and INVALID_IND_32 returns to drawing once. Per-instance attributes must have at least this many entries.
   virtual void setInstanceCount(uint32_t instanceCount) = 0;
 
+  // Restrict subsequent draws to some ranges of the vertices (indices, for indexed draw modes), e.g. to skip geometry
+  // which is out of view. The ranges must be sorted and disjoint. Instanced draws always draw everything.
+  void setDrawRanges(const std::vector<DrawRange>& ranges);
+  void clearDrawRanges(); // draw everything again
+
   // Call once to initialize GLSL code used by multiple shaders
   static void initCommonShaders(); // TODO
 
   // Draw!
+  // (if the engine has a render queue open, this records the draw to be executed when the queue closes)
   virtual void draw() = 0;
+  virtual void drawQueued(const RenderQueueItem& item) = 0; // execute a recorded draw, called by the engine
 
   virtual void validateData() = 0;
 
@@ -454,9 +592,52 @@ protected:
 
   // instancing
   uint32_t instanceCount = INVALID_IND_32;
+
+  // Partial drawing
+  bool useDrawRanges = false;
+  std::vector<DrawRange> drawRanges;
+
+  // Handles resolved by findUniform(), indexed by UniformName::slot. The flag is set once a slot has been looked up.
+  std::vector<std::pair<bool, UniformHandle>> foundUniforms;
 };
 
 
+// A draw recorded while a render queue is open (see Engine::beginRenderQueue()), along with everything needed to
+// execute it later: the render state at the time of the draw, and a snapshot of the program's uniforms.
+struct RenderQueueItem {
+  ShaderProgram* program = nullptr;
+  uint64_t programKey = 0; // draws with equal keys share a GPU program (ids count up as programs are created, so the
+                           // sorted order is the same from run to run)
+  uint64_t textureKey = 0; // draws with equal keys (and programs) bind the same textures, e.g. the same material
+  DepthMode depthMode = DepthMode::Less;
+  BlendMode blendMode = BlendMode::AlphaOver;
+  std::array<bool, 4> colorMask{{true, true, true, true}};
+  bool backfaceCull = false;
+  bool orderDependent = false; // blended differently from the rest of the queue or not writing depth, so it must be
+                               // drawn back-to-front after everything else
+  float depth = 0.;            // distance from the camera to the structure which issued the draw
+  size_t submissionIndex = 0;
+  size_t profileScope = INVALID_IND; // index in the queue's profiler scope names, if any
+  bool sameTexturesAsPrevious = false; // set while executing, the textures are still bound from the previous draw
+  bool useDrawRanges = false;
+  std::vector<DrawRange> drawRanges;
+  uint32_t instanceCount = INVALID_IND_32;
+  std::vector<TextureBuffer*> textures;                      // bound when the draw was recorded, backend-specific order
+  std::vector<std::shared_ptr<TextureBuffer>> ownedTextures; // keeps textures owned by the program alive until then
+  std::vector<uint32_t> uniformData;                         // backend-specific
+};
+
+// Camera and viewport values which are the same for every scene program, shared through a uniform buffer (see the
+// FRAME_UNIFORM_BLOCK shader rule) rather than set on each program. The layout must match the std140 block declared by
+// that rule.
+struct FrameUniforms {
+  glm::mat4 projMatrix;
+  glm::mat4 invProjMatrix;
+  glm::vec4 viewport;
+  glm::vec2 viewportDim;
+  glm::vec2 padding;
+};
+
 class Engine {
 
 public:
@@ -494,11 +675,30 @@ public:
   virtual void setColorMask(std::array<bool, 4> mask = {true, true, true, true}) = 0;
   virtual void setBackfaceCull(bool newVal = false) = 0;
 
+  // == Render queue
+  // While a render queue is open, ShaderProgram::draw() records draws rather than executing them, and the render state
+  // setters above only apply to the draws which follow. When the outermost queue is closed, the draws are sorted by
+  // program, textures, and render state, then executed with redundant state changes skipped. Draws which override the
+  // blend mode that was set when the queue opened (e.g. billboards blended over the scene), or which test or write
+  // depth without the usual read-write depth test, depend on order, and are executed last, back-to-front. Programs
+  // must not be deleted while they have draws in an open queue.
+  void beginRenderQueue();
+  void endRenderQueue();
+  bool renderQueueActive() const { return renderQueueDepth > 0 && renderQueueEnabled; }
+  void setRenderQueueDepth(float depth); // distance from the camera for the draws which follow
+  void setRenderQueueProfileScope(const std::string& name); // GPU-timed under this name when the queue executes
+  RenderQueueItem newRenderQueueItem(ShaderProgram* program); // filled with the current render state
+  void enqueueDraw(RenderQueueItem&& item);
+
   void setCurrentViewport(glm::vec4 viewport);
   glm::vec4 getCurrentViewport();
   void setCurrentPixelScaling(float scale);
   float getCurrentPixelScaling();
 
+  // Refresh the shared FrameUniforms from the current view and viewport, uploading them only if they changed. Must be
+  // called before drawing scene programs whenever the camera or render target may have changed.
+  void updateFrameUniforms();
+
   // Helpers
   void allocateGlobalBuffersAndPrograms(); // called once during startup
 
@@ -583,6 +783,24 @@ public:
   requestShader(const std::string& programName, const std::vector<std::string>& customRules,
                 ShaderReplacementDefaults defaults = ShaderReplacementDefaults::SceneObject) = 0;
 
+  // == Shader warm-up
+  // Programs can be requested ahead of their first use (e.g. every program a scene will need), so enabling a new
+  // quantity later does not stall while its program compiles. Requested programs are compiled in the background,
+  // in parallel where the driver supports it, or a few at a time each frame (see
+  // options::shaderWarmupMillisecondsPerFrame). Requesting a program which is still warming up finishes it on the spot.
+  void requestShaderWarmup(const std::string& programName, const std::vector<std::string>& customRules,
+                           ShaderReplacementDefaults defaults = ShaderReplacementDefaults::SceneObject);
+  void processShaderWarmup(); // make progress on pending warm-ups, called once per frame
+  void finishShaderWarmup();  // block until all pending warm-ups are complete
+  virtual size_t nPendingShaderWarmups();
+
+  // == GPU timestamps (used by the profiler)
+  // Records the time at which the GPU completes all of the work issued before the call. The value can be read once the
+  // GPU gets there, typically a frame or two later. Reading a timestamp releases it.
+  virtual uint32_t recordGPUTimestamp() = 0;
+  virtual bool readGPUTimestamp(uint32_t timestamp, uint64_t& nanoseconds) = 0; // false if not available yet
+  virtual void releaseGPUTimestamp(uint32_t timestamp) = 0;                    // discard without reading
+
   // === The frame buffers used in the rendering pipeline
   // The size of these buffers is always kept in sync with the screen size
   std::shared_ptr<FrameBuffer> displayBuffer, displayBufferAlt;
@@ -629,6 +847,7 @@ public:
   // Materials
   std::vector<std::unique_ptr<Material>> materials;
   Material& getMaterial(const std::string& name);
+  void ensureMaterialTexturesLoaded(Material& material); // decode and upload a lazily-loaded material, if needed
   void loadBlendableMaterial(std::string matName, std::array<std::string, 4> filenames);
   void loadBlendableMaterial(std::string matName, std::string filenameBase, std::string filenameExt);
   void loadStaticMaterial(std::string matName, std::string filename);
@@ -645,6 +864,17 @@ public:
 
   uint64_t getNextUniqueID();
 
+  // Shader programs created so far, and the time spent creating them. Programs are either compiled from source or
+  // loaded from the on-disk cache (see options::shaderCacheDirectory); comparing the two gives the cold and warm
+  // startup cost.
+  struct ShaderProgramStats {
+    size_t nCompiled = 0;
+    size_t nLoadedFromCache = 0;
+    double compileSeconds = 0.;
+    double loadFromCacheSeconds = 0.;
+  };
+  ShaderProgramStats shaderProgramStats;
+
   // ==  Implementation details and hacks
   bool lightCopy = false; // if true, when applying lighting transform does a copy instead of an alpha blend. Used
                           // internally for alpha in screenshots, but should generally be left as false.
@@ -680,6 +910,42 @@ protected:
   bool frontFaceCCW = true;
   std::vector<FrameBuffer*> renderFramebufferStack; // supports push/popBindFramebufferForRendering
 
+  // The render state most recently requested through setDepthMode() etc, backends record these
+  DepthMode currDepthMode = DepthMode::Less;
+  BlendMode currBlendMode = BlendMode::AlphaOver;
+  std::array<bool, 4> currColorMask{{true, true, true, true}};
+  bool currBackfaceCull = false;
+
+  // Render queue
+  int renderQueueDepth = 0;
+  bool renderQueueEnabled = false; // latched from options::sortDrawCalls when the outermost queue opens
+  std::vector<RenderQueueItem> renderQueue;
+  float renderQueueCurrentDepth = 0.;
+  BlendMode renderQueueBaseBlendMode = BlendMode::AlphaOver;
+  std::vector<std::string> renderQueueProfileScopes;
+  size_t renderQueueCurrentProfileScope = INVALID_IND;
+  void executeRenderQueue();
+
+  // Shared per-frame uniforms, as last uploaded
+  FrameUniforms currFrameUniforms;
+  bool frameUniformsValid = false;
+  virtual void uploadFrameUniforms(const FrameUniforms& data) = 0;
+
+  // Shader warm-up requests which have not been started yet
+  struct ShaderWarmupRequest {
+    std::string programName;
+    std::vector<std::string> customRules;
+    ShaderReplacementDefaults defaults;
+  };
+  std::deque<ShaderWarmupRequest> shaderWarmupQueue;
+
+  // Backend hooks for warm-up. If background is set the driver may keep linking after startShaderWarmup() returns, and
+  // pollShaderWarmups() finishes the programs it has completed (or all of them, if block is set). A program which fails
+  // to build is dropped from the backend's caches before the error is thrown, so it is only reported once.
+  virtual bool supportsBackgroundShaderWarmup() { return false; }
+  virtual void startShaderWarmup(const ShaderWarmupRequest& request, bool background) = 0;
+  virtual void pollShaderWarmups(bool block) {}
+
   // Cached lazy seettings for the resolve and relight program
   int currLightingSampleLevel = -1;
   TransparencyMode currLightingTransparencyMode = TransparencyMode::None;
@@ -701,8 +967,9 @@ protected:
   uint64_t uniqueID = 500;
 
   // Default rule lists (see enum for explanation)
-  std::vector<std::string> defaultRules_sceneObject{"GLSL_VERSION", "GLOBAL_FRAGMENT_FILTER"};
-  std::vector<std::string> defaultRules_pick{"GLSL_VERSION", "GLOBAL_FRAGMENT_FILTER", "SHADE_COLOR", "LIGHT_PASSTHRU"};
+  std::vector<std::string> defaultRules_sceneObject{"GLSL_VERSION", "FRAME_UNIFORM_BLOCK", "GLOBAL_FRAGMENT_FILTER"};
+  std::vector<std::string> defaultRules_pick{"GLSL_VERSION", "FRAME_UNIFORM_BLOCK", "GLOBAL_FRAGMENT_FILTER",
+                                             "SHADE_COLOR", "LIGHT_PASSTHRU"};
   std::vector<std::string> defaultRules_process{"GLSL_VERSION"};
 
   // Lists of points to support preserving resources until the end of an ImGUI frame (see note above)
@@ -120,6 +120,15 @@ public:
   // reflecting updates to the render buffer.
   void markHostBufferUpdated();
 
+  // Variants of markHostBufferUpdated() for when only part of `data` changed, which let the render buffer upload just
+  // the modified entries.
+  //   - markHostBufferRangeUpdated(): entries in [start, end) were modified (the buffer may also have grown, in which
+  //     case the new entries must lie in the range)
+  //   - markHostBufferAppended(): new entries were appended after the first `oldSize`, and nothing else changed.
+  //     Existing indexed views are left alone, since their indices cannot refer to the new entries.
+  void markHostBufferRangeUpdated(size_t start, size_t end);
+  void markHostBufferAppended(size_t oldSize);
+
   // Get the value at index `i`. It may be dynamically fetched from either the cpu-side `data` member or the render
   // buffer, depending on where the data currently lives.
   // If the data lives only on the device-side render buffer, this function is expensive, so don't call it in a
@@ -184,6 +193,10 @@ public:
   // copy (which is not cached).
   std::vector<T> getIndexedView(ManagedBuffer<uint32_t>& indices);
 
+  // Call after appending to `indices` (which previously had `oldIndexSize` entries). If an indexed view through those
+  // indices exists, only its new tail is re-uploaded.
+  void updateIndexedViewAppended(ManagedBuffer<uint32_t>& indices, size_t oldIndexSize);
+
   // ========================================================================
   // == Direct access to the GPU (device-side) render texture buffer
   // ========================================================================
@@ -302,6 +315,9 @@ public:
   ManagedBufferMap<glm::uvec2>   managedBufferMap_uvec2;
   ManagedBufferMap<glm::uvec3>   managedBufferMap_uvec3;
   ManagedBufferMap<glm::uvec4>   managedBufferMap_uvec4;
+  ManagedBufferMap<uint8_t>      managedBufferMap_uint8;
+  ManagedBufferMap<uint16_t>     managedBufferMap_uint16;
+  ManagedBufferMap<glm::u8vec4>  managedBufferMap_u8vec4;
   // clang-format on
 };
 
@@ -36,6 +36,11 @@ struct Material {
   std::array<std::shared_ptr<TextureBuffer>, 4> textureBuffers;
   std::vector<std::string> rules;                  // substitution rules to add to shaders
   std::function<void(ShaderProgram&)> setUniforms; // function to set uniforms for shaders
+
+  // The built-in materials are only decoded and uploaded the first time they are used. Until then, these hold the
+  // encoded image for each channel (channels may share an image), and textureBuffers is empty.
+  std::array<const unsigned char*, 4> encodedTextures{{nullptr, nullptr, nullptr, nullptr}};
+  std::array<size_t, 4> encodedTextureSizes{{0, 0, 0, 0}};
 };
 
 // Build an ImGui option picker in a dropdown ui
@@ -34,6 +34,9 @@ public:
   void setData(const std::vector<glm::uvec2>& data) override;
   void setData(const std::vector<glm::uvec3>& data) override;
   void setData(const std::vector<glm::uvec4>& data) override;
+  void setData(const std::vector<uint8_t>& data) override;
+  void setData(const std::vector<uint16_t>& data) override;
+  void setData(const std::vector<glm::u8vec4>& data) override;
 
   // Array-valued attributes
   // (adding these lazily as we need them)
@@ -42,6 +45,27 @@ public:
   void setData(const std::vector<std::array<glm::vec3, 3>>& data) override;
   void setData(const std::vector<std::array<glm::vec3, 4>>& data) override;
 
+  // Partial updates
+  void setDataRange(const std::vector<glm::vec2>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::vec3>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::vec4>& data, size_t start) override;
+  void setDataRange(const std::vector<float>& data, size_t start) override;
+  void setDataRange(const std::vector<double>& data, size_t start) override;
+  void setDataRange(const std::vector<int32_t>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::ivec2>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::ivec3>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::ivec4>& data, size_t start) override;
+  void setDataRange(const std::vector<uint32_t>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::uvec2>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::uvec3>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::uvec4>& data, size_t start) override;
+  void setDataRange(const std::vector<uint8_t>& data, size_t start) override;
+  void setDataRange(const std::vector<uint16_t>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::u8vec4>& data, size_t start) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t start) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t start) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t start) override;
+
   // get data at a single index from the buffer
   float getData_float(size_t ind) override;
   double getData_double(size_t ind) override;
@@ -56,6 +80,9 @@ public:
   glm::uvec2 getData_uvec2(size_t ind) override;
   glm::uvec3 getData_uvec3(size_t ind) override;
   glm::uvec4 getData_uvec4(size_t ind) override;
+  uint8_t getData_uint8(size_t ind) override;
+  uint16_t getData_uint16(size_t ind) override;
+  glm::u8vec4 getData_u8vec4(size_t ind) override;
 
   // get data at a range of indices from the buffer
   std::vector<float> getDataRange_float(size_t ind, size_t count) override;
@@ -71,6 +98,9 @@ public:
   std::vector<glm::uvec2> getDataRange_uvec2(size_t ind, size_t count) override;
   std::vector<glm::uvec3> getDataRange_uvec3(size_t ind, size_t count) override;
   std::vector<glm::uvec4> getDataRange_uvec4(size_t ind, size_t count) override;
+  std::vector<uint8_t> getDataRange_uint8(size_t ind, size_t count) override;
+  std::vector<uint16_t> getDataRange_uint16(size_t ind, size_t count) override;
+  std::vector<glm::u8vec4> getDataRange_u8vec4(size_t ind, size_t count) override;
 
   uint32_t getNativeBufferID() override;
 
@@ -83,6 +113,9 @@ private:
   template <typename T>
   void setData_helper(const std::vector<T>& data);
 
+  template <typename T>
+  void setDataRange_helper(const std::vector<T>& data, size_t start);
+
   template <typename T>
   T getData_helper(size_t ind);
 
@@ -129,6 +162,7 @@ public:
   void setData(const std::vector<glm::uvec2>& data) override;
   void setData(const std::vector<glm::uvec3>& data) override;
   void setData(const std::vector<glm::uvec4>& data) override;
+  void setData(const std::vector<glm::u8vec4>& data) override;
 
   // Array-valued
   // NOTE: some of these are not implemented yet
@@ -191,6 +225,9 @@ public:
   std::vector<unsigned char> readBuffer() override;
   std::array<float, 4> readFloat4(int xPos, int yPos) override;
   float readDepth(int xPos, int yPos) override;
+  std::vector<float> readFloat4Region(int xStart, int yStart, int w, int h) override;
+  std::array<uint32_t, 2> readUInt2(int xPos, int yPos) override;
+  std::vector<uint32_t> readUInt2Region(int xStart, int yStart, int w, int h) override;
   void blitTo(FrameBuffer* other) override;
 
   // Getters
@@ -210,6 +247,7 @@ struct GLShaderAttribute {
   std::string name;
   RenderDataType type;
   int arrayCount;
+  bool perInstance;
   std::shared_ptr<GLAttributeBuffer> buff; // the buffer that we will actually use
 };
 
@@ -233,12 +271,16 @@ public:
   std::vector<GLShaderUniform> getUniforms() const { return uniforms; }
   std::vector<GLShaderAttribute> getAttributes() const { return attributes; }
   std::vector<GLShaderTexture> getTextures() const { return textures; }
+  uint64_t getId() const { return id; } // unique, in order of creation
+  int32_t getUniformIndex(const std::string& name) const; // index in getUniforms(), or -1 if there is none
 
 private:
+  uint64_t id;
   DrawMode drawMode;
   std::vector<GLShaderUniform> uniforms;
   std::vector<GLShaderAttribute> attributes;
   std::vector<GLShaderTexture> textures;
+  std::unordered_map<std::string, int32_t> uniformIndices;
 
   void compileGLProgram(const std::vector<ShaderStageSpecification>& stages);
   void setDataLocations();
@@ -275,6 +317,24 @@ public:
   void setUniform(std::string name, glm::uvec2 val) override;
   void setUniform(std::string name, glm::uvec3 val) override;
   void setUniform(std::string name, glm::uvec4 val) override;
+  UniformHandle getUniformHandle(std::string name) override;
+  UniformHandle lookupUniformHandle(const std::string& name) override;
+  void setUniform(UniformHandle handle, int val) override;
+  void setUniform(UniformHandle handle, unsigned int val) override;
+  void setUniform(UniformHandle handle, float val) override;
+  void setUniform(UniformHandle handle, double val) override; // WARNING casts down to float
+  void setUniform(UniformHandle handle, float* val) override;
+  void setUniform(UniformHandle handle, glm::vec2 val) override;
+  void setUniform(UniformHandle handle, glm::vec3 val) override;
+  void setUniform(UniformHandle handle, glm::vec4 val) override;
+  void setUniform(UniformHandle handle, std::array<float, 3> val) override;
+  void setUniform(UniformHandle handle, float x, float y, float z, float w) override;
+  void setUniform(UniformHandle handle, glm::ivec2 val) override;
+  void setUniform(UniformHandle handle, glm::ivec3 val) override;
+  void setUniform(UniformHandle handle, glm::ivec4 val) override;
+  void setUniform(UniformHandle handle, glm::uvec2 val) override;
+  void setUniform(UniformHandle handle, glm::uvec3 val) override;
+  void setUniform(UniformHandle handle, glm::uvec4 val) override;
 
   // = Attributes
   // clang-format off
@@ -313,6 +373,7 @@ public:
 
   // Draw!
   void draw() override;
+  void drawQueued(const RenderQueueItem& item) override;
   void validateData() override;
 
 protected:
@@ -328,11 +389,15 @@ private:
   void bindVAO();
   void createBuffers();
   void ensureBufferExists(GLShaderAttribute& a);
+  GLShaderUniform* getUniformToSet(UniformHandle handle, RenderDataType type);
   void createBuffer(GLShaderAttribute& a);
   void assignBufferToVAO(GLShaderAttribute& a);
 
   // Drawing related
   void activateTextures();
+  void activateTextures(const std::vector<TextureBuffer*>& bindings);
+  uint64_t textureKey();
+  void drawGeometry(const std::vector<DrawRange>* ranges, uint32_t drawInstanceCount);
 
   std::shared_ptr<GLCompiledProgram> compiledProgram;
 };
@@ -359,6 +424,40 @@ public:
   void setColorMask(std::array<bool, 4> mask = {true, true, true, true}) override;
   void setBackfaceCull(bool newVal) override;
 
+  // Counts of the state changes which a real backend would have made, not including redundant changes which leave the
+  // state as it was. For tests, may be reset at any time.
+  struct StateChangeCounts {
+    size_t programBinds = 0;
+    size_t textureBinds = 0;
+    size_t depthModes = 0;
+    size_t blendModes = 0;
+    size_t colorMasks = 0;
+    size_t backfaceCulls = 0;
+  };
+  StateChangeCounts stateChangeCounts;
+  void recordProgramBind(const GLCompiledProgram* program); // called by programs as they draw
+
+  // The work which a real backend would have submitted to the GPU over one frame, so tests can check rendering budgets
+  // without a GPU. Counts accumulate until the display buffers are swapped at the end of the frame, which makes them
+  // available from getLastFrameStats().
+  struct FrameStats {
+    size_t drawCalls = 0;              // a draw restricted to several ranges is one call, as GL issues one multi-draw
+    size_t verticesSubmitted = 0;      // vertices (or indices) per draw, times the number of instances
+    size_t instancesSubmitted = 0;     // from setInstanceCount(), 1 for a draw without one
+    size_t attributeBytesUploaded = 0; // includes index buffers, and only the updated range of partial updates
+    size_t textureBytesUploaded = 0;
+    size_t uniformBlockBytesUploaded = 0;
+    size_t programsCompiled = 0;
+    size_t uniformLookups = 0; // uniforms resolved by name, rather than through a cached handle
+    StateChangeCounts stateChanges;
+    size_t framebufferReadbacks = 0;
+    size_t bytesReadBack = 0;
+  };
+  const FrameStats& getLastFrameStats() const { return lastFrameStats; }
+  const FrameStats& getCurrentFrameStats() const { return currentFrameStats; } // so far in the frame being drawn
+  void resetFrameStats();
+  FrameStats currentFrameStats; // updated by buffers and programs as they are used
+
   // === Windowing and framework things
   void makeContextCurrent() override;
   void focusWindow() override;
@@ -414,6 +513,9 @@ public:
   std::shared_ptr<ShaderProgram>
   requestShader(const std::string& programName, const std::vector<std::string>& customRules,
                 ShaderReplacementDefaults defaults = ShaderReplacementDefaults::SceneObject) override;
+  uint32_t recordGPUTimestamp() override;
+  bool readGPUTimestamp(uint32_t timestamp, uint64_t& nanoseconds) override;
+  void releaseGPUTimestamp(uint32_t timestamp) override;
 
   // === Implementation details
 
@@ -431,6 +533,16 @@ protected:
   // Helpers
   virtual void freeAllOwnedResources() override;
   virtual void createSlicePlaneFliterRule(std::string name) override;
+  virtual void uploadFrameUniforms(const FrameUniforms& data) override;
+
+  // The state as last applied, for stateChangeCounts
+  const GLCompiledProgram* appliedProgram = nullptr;
+  DepthMode appliedDepthMode = DepthMode::Less;
+  BlendMode appliedBlendMode = BlendMode::AlphaOver;
+  std::array<bool, 4> appliedColorMask{{true, true, true, true}};
+  bool appliedBackfaceCull = false;
+
+  FrameStats lastFrameStats;
 
   // Shader program & rule caches
   std::unordered_map<std::string, std::pair<std::vector<ShaderStageSpecification>, DrawMode>> registeredShaderPrograms;
@@ -443,6 +555,11 @@ protected:
   std::shared_ptr<GLCompiledProgram> getCompiledProgram(const std::string& programName,
                                                         const std::vector<std::string>& customRules,
                                                         ShaderReplacementDefaults defaults);
+  void startShaderWarmup(const ShaderWarmupRequest& request, bool background) override;
+
+  // GPU timestamps are taken from the CPU clock, and are available immediately
+  std::unordered_map<uint32_t, uint64_t> timestamps;
+  uint32_t nextTimestamp = 1;
 };
 
 } // namespace backend_openGL_mock
@@ -6,6 +6,7 @@
 #include "polyscope/render/engine.h"
 #include "polyscope/utilities.h"
 
+#include <functional>
 #include <unordered_map>
 
 // Note: DO NOT include this header throughout polyscope, and do not directly make openGL calls. This header should only
@@ -41,6 +42,14 @@ typedef GLint UniformLocation;
 typedef GLint AttributeLocation;
 typedef GLint TextureLocation;
 
+// Resolve the optional openGL functions which the bundled loader does not provide (currently the program binary
+// functions used by options::shaderCacheDirectory, and parallel shader compilation). Called by the windowing backends
+// once the context is current.
+void loadOptionalGLFunctions(std::function<void*(const char* name)> getProcAddress);
+
+// The uniform buffer binding point used for the shared FrameUniforms
+const GLuint frameUniformBlockBinding = 0;
+
 class GLAttributeBuffer : public AttributeBuffer {
 public:
   GLAttributeBuffer(RenderDataType dataType_, int arrayCount_);
@@ -62,6 +71,9 @@ public:
   void setData(const std::vector<glm::uvec2>& data) override;
   void setData(const std::vector<glm::uvec3>& data) override;
   void setData(const std::vector<glm::uvec4>& data) override;
+  void setData(const std::vector<uint8_t>& data) override;
+  void setData(const std::vector<uint16_t>& data) override;
+  void setData(const std::vector<glm::u8vec4>& data) override;
 
   // Array-valued attributes
   // (adding these lazily as we need them)
@@ -70,6 +82,27 @@ public:
   void setData(const std::vector<std::array<glm::vec3, 3>>& data) override;
   void setData(const std::vector<std::array<glm::vec3, 4>>& data) override;
 
+  // Partial updates, which upload only the given range
+  void setDataRange(const std::vector<glm::vec2>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::vec3>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::vec4>& data, size_t start) override;
+  void setDataRange(const std::vector<float>& data, size_t start) override;
+  void setDataRange(const std::vector<double>& data, size_t start) override;
+  void setDataRange(const std::vector<int32_t>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::ivec2>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::ivec3>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::ivec4>& data, size_t start) override;
+  void setDataRange(const std::vector<uint32_t>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::uvec2>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::uvec3>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::uvec4>& data, size_t start) override;
+  void setDataRange(const std::vector<uint8_t>& data, size_t start) override;
+  void setDataRange(const std::vector<uint16_t>& data, size_t start) override;
+  void setDataRange(const std::vector<glm::u8vec4>& data, size_t start) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t start) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t start) override;
+  void setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t start) override;
+
   // get data at a single index from the buffer
   float getData_float(size_t ind) override;
   double getData_double(size_t ind) override;
@@ -84,6 +117,9 @@ public:
   glm::uvec2 getData_uvec2(size_t ind) override;
   glm::uvec3 getData_uvec3(size_t ind) override;
   glm::uvec4 getData_uvec4(size_t ind) override;
+  uint8_t getData_uint8(size_t ind) override;
+  uint16_t getData_uint16(size_t ind) override;
+  glm::u8vec4 getData_u8vec4(size_t ind) override;
 
   // get data at a range of indices from the buffer
   std::vector<float> getDataRange_float(size_t ind, size_t count) override;
@@ -99,6 +135,9 @@ public:
   std::vector<glm::uvec2> getDataRange_uvec2(size_t ind, size_t count) override;
   std::vector<glm::uvec3> getDataRange_uvec3(size_t ind, size_t count) override;
   std::vector<glm::uvec4> getDataRange_uvec4(size_t ind, size_t count) override;
+  std::vector<uint8_t> getDataRange_uint8(size_t ind, size_t count) override;
+  std::vector<uint16_t> getDataRange_uint16(size_t ind, size_t count) override;
+  std::vector<glm::u8vec4> getDataRange_u8vec4(size_t ind, size_t count) override;
 
   uint32_t getNativeBufferID() override;
 
@@ -115,6 +154,9 @@ private:
   template <typename T>
   void setData_helper(const std::vector<T>& data);
 
+  template <typename T>
+  void setDataRange_helper(const std::vector<T>& data, size_t start);
+
   template <typename T>
   T getData_helper(size_t ind);
 
@@ -161,6 +203,7 @@ public:
   void setData(const std::vector<glm::uvec2>& data) override;
   void setData(const std::vector<glm::uvec3>& data) override;
   void setData(const std::vector<glm::uvec4>& data) override;
+  void setData(const std::vector<glm::u8vec4>& data) override;
 
   // Array-valued
   // NOTE: some of these are not implemented yet
@@ -228,6 +271,14 @@ public:
   std::vector<unsigned char> readBuffer() override;
   std::array<float, 4> readFloat4(int xPos, int yPos) override;
   float readDepth(int xPos, int yPos) override;
+  std::vector<float> readFloat4Region(int xStart, int yStart, int w, int h) override;
+  std::vector<std::array<float, 4>> readFloat4Pixels(const std::vector<glm::ivec2>& positions) override;
+  std::vector<float> readDepthPixels(const std::vector<glm::ivec2>& positions) override;
+  std::array<uint32_t, 2> readUInt2(int xPos, int yPos) override;
+  std::vector<uint32_t> readUInt2Region(int xStart, int yStart, int w, int h) override;
+  std::vector<std::array<uint32_t, 2>> readUInt2Pixels(const std::vector<glm::ivec2>& positions) override;
+  void requestAsyncReadPixel(int xPos, int yPos) override;
+  bool pollAsyncReadPixel(PixelReadResult& result) override;
   void blitTo(FrameBuffer* other) override;
 
   // Getters
@@ -235,6 +286,12 @@ public:
   uint32_t getNativeBufferID() override;
 
   FrameBufferHandle handle;
+
+private:
+  // Asynchronous reads copy in to these pixel buffers, and the fence signals when the copy is done
+  GLuint asyncColorPBO = 0;
+  GLuint asyncDepthPBO = 0;
+  GLsync asyncReadFence = nullptr;
 };
 
 // Classes to keep track of attributes and uniforms
@@ -243,12 +300,14 @@ struct GLShaderUniform {
   RenderDataType type;
   bool isSet;               // has a value been assigned to this uniform?
   UniformLocation location; // -1 means "no location", usually because it was optimized out
+  std::array<uint32_t, 16> value; // raw value as last set, uploaded when drawing
 };
 
 struct GLShaderAttribute {
   std::string name;
   RenderDataType type;
   int arrayCount;
+  bool perInstance;
   AttributeLocation location;              // -1 means "no location", usually because it was optimized out
   std::shared_ptr<GLAttributeBuffer> buff; // the buffer that we will actually use
 };
@@ -267,23 +326,49 @@ struct GLShaderTexture {
 // This class takes ownership and handles program deletion in its destructor
 class GLCompiledProgram {
 public:
-  GLCompiledProgram(const std::vector<ShaderStageSpecification>& stages, DrawMode dm);
+  // If deferLink is set, the shaders are submitted to the driver but the program is not ready to use until
+  // finishLinking() is called. This lets the driver compile in the background, where it supports that.
+  GLCompiledProgram(const std::vector<ShaderStageSpecification>& stages, DrawMode dm, bool deferLink = false);
   ~GLCompiledProgram();
 
+  bool isLinked() const { return linked; }
+  bool linkCompletePending(); // true if finishLinking() would not block on the driver
+  void finishLinking();
+
   ProgramHandle getHandle() const { return programHandle; }
   DrawMode getDrawMode() const { return drawMode; }
   std::vector<GLShaderUniform> getUniforms() const { return uniforms; }
   std::vector<GLShaderAttribute> getAttributes() const { return attributes; }
   std::vector<GLShaderTexture> getTextures() const { return textures; }
+  uint64_t getId() const { return id; } // unique, in order of creation
+  int32_t getUniformIndex(const std::string& name) const; // index in getUniforms(), or -1 if there is none
+
+  // Upload the value of the i'th uniform, unless the GL program already holds it. The program must be bound. Programs
+  // are shared by all of the GLShaderPrograms which request the same shader, so the values are tracked here.
+  void pushUniform(size_t iUniform, const uint32_t* value);
 
 private:
+  uint64_t id;
   ProgramHandle programHandle;
   DrawMode drawMode;
   std::vector<GLShaderUniform> uniforms;
   std::vector<GLShaderAttribute> attributes;
   std::vector<GLShaderTexture> textures;
-
-  void compileGLProgram(const std::vector<ShaderStageSpecification>& stages);
+  std::unordered_map<std::string, int32_t> uniformIndices;
+  std::vector<std::array<uint32_t, 16>> pushedUniformValues;
+  std::vector<char> pushedUniformValid;
+
+  // Compilation state, between beginCompileGLProgram() and finishCompileGLProgram()
+  bool linked = false;
+  bool compilePending = false;
+  std::vector<ShaderHandle> pendingShaderHandles;
+  std::vector<std::string> pendingShaderSources; // kept to print errors
+  bool pendingUseCache = false;
+  uint64_t pendingCacheKey = 0;
+  double pendingCompileSeconds = 0.;
+
+  void beginCompileGLProgram(const std::vector<ShaderStageSpecification>& stages); // does not wait on the driver
+  void finishCompileGLProgram(); // checks the results, throws if compilation failed
   void setDataLocations();
 
   void addUniqueAttribute(ShaderSpecAttribute attribute);
@@ -318,6 +403,24 @@ public:
   void setUniform(std::string name, glm::uvec2 val) override;
   void setUniform(std::string name, glm::uvec3 val) override;
   void setUniform(std::string name, glm::uvec4 val) override;
+  UniformHandle getUniformHandle(std::string name) override;
+  UniformHandle lookupUniformHandle(const std::string& name) override;
+  void setUniform(UniformHandle handle, int val) override;
+  void setUniform(UniformHandle handle, unsigned int val) override;
+  void setUniform(UniformHandle handle, float val) override;
+  void setUniform(UniformHandle handle, double val) override; // WARNING casts down to float
+  void setUniform(UniformHandle handle, float* val) override;
+  void setUniform(UniformHandle handle, glm::vec2 val) override;
+  void setUniform(UniformHandle handle, glm::vec3 val) override;
+  void setUniform(UniformHandle handle, glm::vec4 val) override;
+  void setUniform(UniformHandle handle, std::array<float, 3> val) override;
+  void setUniform(UniformHandle handle, float x, float y, float z, float w) override;
+  void setUniform(UniformHandle handle, glm::ivec2 val) override;
+  void setUniform(UniformHandle handle, glm::ivec3 val) override;
+  void setUniform(UniformHandle handle, glm::ivec4 val) override;
+  void setUniform(UniformHandle handle, glm::uvec2 val) override;
+  void setUniform(UniformHandle handle, glm::uvec3 val) override;
+  void setUniform(UniformHandle handle, glm::uvec4 val) override;
 
   // = Attributes
   // clang-format off
@@ -357,6 +460,7 @@ public:
 
   // Draw!
   void draw() override;
+  void drawQueued(const RenderQueueItem& item) override;
   void validateData() override;
 
 protected:
@@ -372,11 +476,17 @@ private:
   void bindVAO();
   void createBuffers();
   void ensureBufferExists(GLShaderAttribute& a);
+  GLShaderUniform* getUniformToSet(UniformHandle handle, RenderDataType type); // null if optimized out
   void createBuffer(GLShaderAttribute& a);
   void assignBufferToVAO(GLShaderAttribute& a);
 
   // Drawing related
   void activateTextures();
+  void activateTextures(const std::vector<TextureBuffer*>& bindings); // as recorded in a RenderQueueItem
+  uint64_t textureKey(); // identifies the set of bound textures
+
+  // With the program bound, uniforms uploaded, and textures bound. Ranges may be null to draw everything.
+  void drawGeometry(const std::vector<DrawRange>* ranges, uint32_t drawInstanceCount);
 
   // GL pointers for various useful things
   std::shared_ptr<GLCompiledProgram> compiledProgram;
@@ -432,6 +542,10 @@ public:
   std::shared_ptr<ShaderProgram>
   requestShader(const std::string& programName, const std::vector<std::string>& customRules,
                 ShaderReplacementDefaults defaults = ShaderReplacementDefaults::SceneObject) override;
+  size_t nPendingShaderWarmups() override;
+  uint32_t recordGPUTimestamp() override;
+  bool readGPUTimestamp(uint32_t timestamp, uint64_t& nanoseconds) override;
+  void releaseGPUTimestamp(uint32_t timestamp) override;
 
   // === Implementation details
 
@@ -449,6 +563,10 @@ protected:
   // Helpers
   virtual void freeAllOwnedResources() override;
   virtual void createSlicePlaneFliterRule(std::string name) override;
+  virtual void uploadFrameUniforms(const FrameUniforms& data) override;
+
+  // Uniform buffer for the FRAME_UNIFORM_BLOCK rule, bound to frameUniformBlockBinding
+  GLuint frameUniformBuffer = 0;
 
   // Shader program & rule caches
   std::unordered_map<std::string, std::pair<std::vector<ShaderStageSpecification>, DrawMode>> registeredShaderPrograms;
@@ -460,7 +578,19 @@ protected:
                                   ShaderReplacementDefaults defaults);
   std::shared_ptr<GLCompiledProgram> getCompiledProgram(const std::string& programName,
                                                         const std::vector<std::string>& customRules,
-                                                        ShaderReplacementDefaults defaults);
+                                                        ShaderReplacementDefaults defaults, bool deferLink = false);
+
+  // Warm-up programs which have been submitted to the driver, but not yet linked (they are also in the cache)
+  std::vector<std::shared_ptr<GLCompiledProgram>> linkingShaderWarmups;
+  bool supportsBackgroundShaderWarmup() override;
+  void startShaderWarmup(const ShaderWarmupRequest& request, bool background) override;
+  void pollShaderWarmups(bool block) override;
+
+  // Finish linking a program. If that fails, drop it from the cache and the warm-ups before rethrowing.
+  void finishLinkingOrEvict(std::shared_ptr<GLCompiledProgram> program);
+
+  // Released timestamp queries, for reuse
+  std::vector<GLuint> freeTimestampQueries;
 };
 
 } // namespace backend_openGL3
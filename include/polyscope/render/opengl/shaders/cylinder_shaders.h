@@ -18,6 +18,7 @@ extern const ShaderReplacementRule CYLINDER_PROPAGATE_VALUE;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_BLEND_VALUE;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_NEAREST_VALUE;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_COLOR;
+extern const ShaderReplacementRule CYLINDER_PROPAGATE_INSTANCE_COLOR;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_BLEND_COLOR;
 extern const ShaderReplacementRule CYLINDER_PROPAGATE_PICK;
 extern const ShaderReplacementRule CYLINDER_CULLPOS_FROM_MID;
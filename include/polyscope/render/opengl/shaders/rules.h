@@ -11,6 +11,7 @@ namespace render {
 namespace backend_openGL3 {
 
 extern const ShaderReplacementRule GLSL_VERSION;
+extern const ShaderReplacementRule FRAME_UNIFORM_BLOCK;         // camera & viewport uniforms from the shared FrameUniforms
 extern const ShaderReplacementRule GLOBAL_FRAGMENT_FILTER;
 extern const ShaderReplacementRule LIGHT_MATCAP;
 extern const ShaderReplacementRule LIGHT_PASSTHRU;
@@ -36,6 +37,7 @@ extern const ShaderReplacementRule PREMULTIPLY_COLOR;
 
 // Positions, culling, etc
 extern const ShaderReplacementRule GENERATE_VIEW_POS;          // computes viewPos, position in viewspace for fragment
+extern const ShaderReplacementRule INSTANCE_TRANSFORM;         // applies per-instance transforms in the vertex shader
 extern const ShaderReplacementRule PROJ_AND_INV_PROJ_MAT;
 extern const ShaderReplacementRule COMPUTE_SHADE_NORMAL_FROM_POSITION;
 extern const ShaderReplacementRule PREMULTIPLY_LIT_COLOR;
@@ -22,6 +22,7 @@ extern const ShaderReplacementRule SPHERE_PROPAGATE_VALUE;
 extern const ShaderReplacementRule SPHERE_PROPAGATE_VALUEALPHA;
 extern const ShaderReplacementRule SPHERE_PROPAGATE_VALUE2;
 extern const ShaderReplacementRule SPHERE_PROPAGATE_COLOR;
+extern const ShaderReplacementRule SPHERE_PROPAGATE_INSTANCE_COLOR;
 extern const ShaderReplacementRule SPHERE_VARIABLE_SIZE;
 extern const ShaderReplacementRule SPHERE_CULLPOS_FROM_CENTER;
 extern const ShaderReplacementRule SPHERE_CULLPOS_FROM_CENTER_QUAD;
@@ -31,6 +31,7 @@ extern const ShaderReplacementRule MESH_PROPAGATE_INT;
 extern const ShaderReplacementRule MESH_PROPAGATE_VALUE2;
 extern const ShaderReplacementRule MESH_PROPAGATE_TCOORD;
 extern const ShaderReplacementRule MESH_PROPAGATE_COLOR;
+extern const ShaderReplacementRule MESH_PROPAGATE_INSTANCE_COLOR;
 extern const ShaderReplacementRule MESH_PROPAGATE_HALFEDGE_VALUE;
 extern const ShaderReplacementRule MESH_PROPAGATE_CULLPOS;
 extern const ShaderReplacementRule MESH_PROPAGATE_PICK;
@@ -11,5 +11,19 @@ std::vector<ShaderStageSpecification>
 applyShaderReplacements(const std::vector<ShaderStageSpecification>& stages,
                         const std::vector<ShaderReplacementRule>& replacementRules);
 
+// Rewrite the fragment stage of a pick program to write 64 bit integer IDs (as a uvec2) instead of a packed float color,
+// for rendering to a RenderBufferType::UInt2 pick buffer. The original shader is kept as-is, its output color is
+// converted at the end.
+std::vector<ShaderStageSpecification> convertToIntegerPickOutput(const std::vector<ShaderStageSpecification>& stages);
+
+// Entries in the on-disk program binary cache (see options::shaderCacheDirectory). An entry records the driver which
+// produced the binary, and the binary's length and checksum, so that truncated or corrupt files can be detected.
+std::string encodeProgramBinaryCacheEntry(uint32_t format, const std::string& driver, const std::vector<char>& binary);
+
+// Returns false if the entry is truncated, corrupt, or was produced by a different driver, in which case the program
+// must be compiled normally.
+bool decodeProgramBinaryCacheEntry(const std::string& entry, const std::string& driver, uint32_t& formatOut,
+                                   std::vector<char>& binaryOut);
+
 }
 } // namespace polyscope
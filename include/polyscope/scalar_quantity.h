@@ -4,17 +4,23 @@
 
 #include "polyscope/affine_remapper.h"
 #include "polyscope/color_bar.h"
+#include "polyscope/colormap_evaluation.h"
 #include "polyscope/persistent_value.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/render/managed_buffer.h"
+#include "polyscope/scalar_statistics.h"
 #include "polyscope/scaled_value.h"
 #include "polyscope/standardize_data_array.h"
 
+#include <chrono>
 #include <utility>
 
 namespace polyscope {
 
+// How the values of a scalar quantity are stored (see ScalarQuantity::values)
+enum class ScalarStorageType { Float = 0, UInt8, UInt16, Int32 };
+
 // Encapsulates logic which is common to all scalar quantities
 
 template <typename QuantityT>
@@ -22,6 +28,11 @@ class ScalarQuantity {
 public:
   ScalarQuantity(QuantityT& quantity, const std::vector<float>& values, DataType dataType);
 
+  // Integer data (labels, masks, 8-bit channels, etc) is stored natively rather than being widened to floats
+  ScalarQuantity(QuantityT& quantity, const std::vector<uint8_t>& values, DataType dataType);
+  ScalarQuantity(QuantityT& quantity, const std::vector<uint16_t>& values, DataType dataType);
+  ScalarQuantity(QuantityT& quantity, const std::vector<int32_t>& values, DataType dataType);
+
   // Build the ImGUI UIs for scalars
   void buildScalarUI();
   virtual void buildScalarOptionsUI(); // called inside of an options menu
@@ -32,18 +43,45 @@ public:
   // Set uniforms in rendering programs for scalars
   void setScalarUniforms(render::ShaderProgram& p);
 
+  // Updating the data does not immediately recompute the histogram and data range. That happens lazily while the UI
+  // is visible, throttled by options::scalarStatisticsRefreshPeriod, or when they are requested.
   template <class V>
   void updateData(const V& newValues);
 
+  // Update just the entries [start, start + newValues.size()). Only that part of the data is uploaded, and the
+  // histogram counts are adjusted incrementally rather than rebuilt.
+  template <class V>
+  void updateDataPartial(size_t start, const V& newValues);
+
   // Export the current colorbar as an SVG file
   void exportColorbarToSVG(const std::string& filename);
 
+  // The current settings which determine how values are colored, and the color of each value as the shaders would
+  // draw it, evaluated on the CPU (see colormap_evaluation.h)
+  ScalarColorMapParams getColorMapParams();
+  std::vector<glm::vec3> evaluateColors();
+
   // === Members
   QuantityT& quantity;
 
   // Wrapper around the actual buffer of scalar data stored in the class.
   // Interaction with the data (updating it on CPU or GPU side, accessing it, etc) happens through this wrapper.
+  //
+  // If the quantity was created from integer data, that data lives in the matching native buffer below, and `values`
+  // is a float copy which is only computed (lazily) if something needs it. Quantities which support native storage
+  // draw directly from the native buffer via getValueRenderAttributeBuffer().
   render::ManagedBuffer<float> values;
+  render::ManagedBuffer<uint8_t> valuesUInt8;
+  render::ManagedBuffer<uint16_t> valuesUInt16;
+  render::ManagedBuffer<int32_t> valuesInt32;
+
+  ScalarStorageType getStorageType();
+  size_t nValues();
+  float getScalarValue(size_t ind); // reads from whichever buffer holds the data
+
+  // The render buffer holding the data in its stored type. The conversion to float happens as it is fetched by the
+  // shader, so it can be bound to the same float attributes as `values`.
+  std::shared_ptr<render::AttributeBuffer> getValueRenderAttributeBuffer();
 
   // === Get/set visualization parameters
 
@@ -58,6 +96,15 @@ public:
   QuantityT* resetMapRange(); // reset to full range
   ScalarRange getDataRange();
 
+  // Percentile range mode: the data range (which bounds the histogram and the default map range) spans the given
+  // percentiles of the data, e.g. 1 and 99, rather than its full min/max, so a few outliers do not wash out the colors.
+  QuantityT* setPercentileRange(double lowerPercentile, double upperPercentile);
+  QuantityT* clearPercentileRange(); // back to the full min/max
+  bool getPercentileRangeEnabled();
+
+  // Finiteness, range, and histogram of the data
+  ScalarStatistics getStatistics();
+
   // Color bar options (it is always displayed inline in the structures panel)
   QuantityT* setOnscreenColorbarEnabled(bool newEnabled);
   bool getOnscreenColorbarEnabled();
@@ -86,12 +133,26 @@ public:
 
 protected:
   std::vector<float> valuesData;
+  std::vector<uint8_t> valuesUInt8Data;
+  std::vector<uint16_t> valuesUInt16Data;
+  std::vector<int32_t> valuesInt32Data;
+  const ScalarStorageType storageType;
   const DataType dataType;
 
   // === Visualization parameters
 
   // Affine data maps and limits
+  ScalarStatistics statistics;
   std::pair<double, double> dataRange;
+  bool percentileRangeEnabled = false;
+  std::pair<double, double> percentileRange{1., 99.};
+  // The histogram is only computed once something needs it (the UI, or getStatistics()). Until then `statistics`
+  // holds just the range of the data.
+  bool statisticsStale = false; // the data changed, statistics must be recomputed
+  bool histogramStale = false;  // the color bar must be rebuilt, computing the histogram if it is missing
+  std::chrono::steady_clock::time_point lastStatisticsRefresh;
+  void refreshDataRange();
+  void refreshStatistics(bool throttle);
   PersistentValue<float> vizRangeMin;
   PersistentValue<float> vizRangeMax;
 
@@ -104,6 +165,13 @@ protected:
   PersistentValue<ScaledValue<float>> isolinePeriod;
   PersistentValue<float> isolineDarkness;
   PersistentValue<float> isolineContourThickness;
+
+private:
+  // shared by the constructors for natively-stored integer data
+  ScalarQuantity(QuantityT& quantity, ScalarStorageType storageType, const ScalarStatistics& statistics,
+                 DataType dataType);
+  void computeValuesFromNative();
+  ScalarStatistics computeStatistics(bool withHistogram);
 };
 
 } // namespace polyscope
@@ -8,8 +8,13 @@ namespace polyscope {
 
 template <typename QuantityT>
 ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vector<float>& values_, DataType dataType_)
-    : quantity(quantity_), values(&quantity, quantity.uniquePrefix() + "values", valuesData), valuesData(values_),
-      dataType(dataType_), dataRange(robustMinMax(values.data, 1e-5)),
+    : quantity(quantity_), values(&quantity, quantity.uniquePrefix() + "values", valuesData),
+      valuesUInt8(nullptr, quantity.uniquePrefix() + "valuesUInt8", valuesUInt8Data),
+      valuesUInt16(nullptr, quantity.uniquePrefix() + "valuesUInt16", valuesUInt16Data),
+      valuesInt32(nullptr, quantity.uniquePrefix() + "valuesInt32", valuesInt32Data), valuesData(values_),
+      storageType(ScalarStorageType::Float), dataType(dataType_),
+      statistics(computeScalarStatistics(values.data, 0)), // histogram is deferred until needed
+      dataRange(statistics.robustRange(1e-5)),
       vizRangeMin(quantity.uniquePrefix() + "vizRangeMin", -777.), // set later,
       vizRangeMax(quantity.uniquePrefix() + "vizRangeMax", -777.), // including clearing cache
       colorBar(quantity), cMap(quantity.uniquePrefix() + "cmap", defaultColorMap(dataType)),
@@ -21,10 +26,11 @@ ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vecto
       isolineContourThickness(quantity.uniquePrefix() + "isolineContourThickness", 0.3)
 
 {
-  values.checkInvalidValues();
+  if (!statistics.allFinite() && options::warnForInvalidValues) {
+    info("Invalid +-inf or NaN values detected in buffer: " + values.name);
+  }
   colorBar.updateColormap(cMap.get());
-  colorBar.buildHistogram(values.data, dataType);
-  // TODO: I think we might be building the histogram ^^^ twice for many quantities
+  histogramStale = true;
 
   if (vizRangeMin.holdsDefaultValue()) { // min and max should always have same cache state
     // dynamically compute a viz range from the data min/max
@@ -33,9 +39,143 @@ ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vecto
   }
 }
 
+template <typename QuantityT>
+ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, ScalarStorageType storageType_,
+                                          const ScalarStatistics& statistics_, DataType dataType_)
+    : quantity(quantity_),
+      values(&quantity, quantity.uniquePrefix() + "values", valuesData, [this]() { computeValuesFromNative(); }),
+      valuesUInt8(storageType_ == ScalarStorageType::UInt8 ? &quantity : nullptr,
+                  quantity.uniquePrefix() + "valuesUInt8", valuesUInt8Data),
+      valuesUInt16(storageType_ == ScalarStorageType::UInt16 ? &quantity : nullptr,
+                   quantity.uniquePrefix() + "valuesUInt16", valuesUInt16Data),
+      valuesInt32(storageType_ == ScalarStorageType::Int32 ? &quantity : nullptr,
+                  quantity.uniquePrefix() + "valuesInt32", valuesInt32Data),
+      storageType(storageType_), dataType(dataType_), statistics(statistics_), dataRange(statistics.histogramRange),
+      vizRangeMin(quantity.uniquePrefix() + "vizRangeMin", -777.), // set later,
+      vizRangeMax(quantity.uniquePrefix() + "vizRangeMax", -777.), // including clearing cache
+      colorBar(quantity), cMap(quantity.uniquePrefix() + "cmap", defaultColorMap(dataType)),
+      isolinesEnabled(quantity.uniquePrefix() + "isolinesEnabled", false),
+      isolineStyle(quantity.uniquePrefix() + "isolinesStyle", IsolineStyle::Stripe),
+      isolinePeriod(quantity.uniquePrefix() + "isolinePeriod",
+                    absoluteValue((dataRange.second - dataRange.first) * 0.02)),
+      isolineDarkness(quantity.uniquePrefix() + "isolineDarkness", 0.7),
+      isolineContourThickness(quantity.uniquePrefix() + "isolineContourThickness", 0.3)
+
+{
+  colorBar.updateColormap(cMap.get());
+  histogramStale = true;
+
+  if (vizRangeMin.holdsDefaultValue()) { // min and max should always have same cache state
+    resetMapRange();
+  }
+}
+
+template <typename QuantityT>
+ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vector<uint8_t>& values_,
+                                          DataType dataType_)
+    : ScalarQuantity(quantity_, ScalarStorageType::UInt8, computeScalarStatistics(values_, 0), dataType_) {
+  valuesUInt8Data = values_;
+}
+
+template <typename QuantityT>
+ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vector<uint16_t>& values_,
+                                          DataType dataType_)
+    : ScalarQuantity(quantity_, ScalarStorageType::UInt16, computeScalarStatistics(values_, 0), dataType_) {
+  valuesUInt16Data = values_;
+}
+
+template <typename QuantityT>
+ScalarQuantity<QuantityT>::ScalarQuantity(QuantityT& quantity_, const std::vector<int32_t>& values_,
+                                          DataType dataType_)
+    : ScalarQuantity(quantity_, ScalarStorageType::Int32, computeScalarStatistics(values_, 0), dataType_) {
+  valuesInt32Data = values_;
+}
+
+namespace {
+template <typename T>
+void widenScalarBuffer(render::ManagedBuffer<T>& nativeBuffer, std::vector<float>& out) {
+  nativeBuffer.ensureHostBufferPopulated();
+  out.resize(nativeBuffer.data.size());
+  for (size_t i = 0; i < nativeBuffer.data.size(); i++) {
+    out[i] = static_cast<float>(nativeBuffer.data[i]);
+  }
+}
+} // namespace
+
+template <typename QuantityT>
+void ScalarQuantity<QuantityT>::computeValuesFromNative() {
+  switch (storageType) {
+  case ScalarStorageType::Float:
+    exception("scalar quantity " + quantity.name + " does not have native storage");
+    break;
+  case ScalarStorageType::UInt8:
+    widenScalarBuffer(valuesUInt8, values.data);
+    break;
+  case ScalarStorageType::UInt16:
+    widenScalarBuffer(valuesUInt16, values.data);
+    break;
+  case ScalarStorageType::Int32:
+    widenScalarBuffer(valuesInt32, values.data);
+    break;
+  }
+  values.markHostBufferUpdated();
+}
+
+template <typename QuantityT>
+ScalarStorageType ScalarQuantity<QuantityT>::getStorageType() {
+  return storageType;
+}
+
+template <typename QuantityT>
+size_t ScalarQuantity<QuantityT>::nValues() {
+  switch (storageType) {
+  case ScalarStorageType::Float:
+    return values.size();
+  case ScalarStorageType::UInt8:
+    return valuesUInt8.size();
+  case ScalarStorageType::UInt16:
+    return valuesUInt16.size();
+  case ScalarStorageType::Int32:
+    return valuesInt32.size();
+  }
+  return 0;
+}
+
+template <typename QuantityT>
+float ScalarQuantity<QuantityT>::getScalarValue(size_t ind) {
+  switch (storageType) {
+  case ScalarStorageType::Float:
+    return values.getValue(ind);
+  case ScalarStorageType::UInt8:
+    return static_cast<float>(valuesUInt8.getValue(ind));
+  case ScalarStorageType::UInt16:
+    return static_cast<float>(valuesUInt16.getValue(ind));
+  case ScalarStorageType::Int32:
+    return static_cast<float>(valuesInt32.getValue(ind));
+  }
+  return 0.;
+}
+
+template <typename QuantityT>
+std::shared_ptr<render::AttributeBuffer> ScalarQuantity<QuantityT>::getValueRenderAttributeBuffer() {
+  switch (storageType) {
+  case ScalarStorageType::Float:
+    return values.getRenderAttributeBuffer();
+  case ScalarStorageType::UInt8:
+    return valuesUInt8.getRenderAttributeBuffer();
+  case ScalarStorageType::UInt16:
+    return valuesUInt16.getRenderAttributeBuffer();
+  case ScalarStorageType::Int32:
+    return valuesInt32.getRenderAttributeBuffer();
+  }
+  return nullptr;
+}
+
 template <typename QuantityT>
 void ScalarQuantity<QuantityT>::buildScalarUI() {
 
+  refreshStatistics(true);
+
   if (render::buildColormapSelector(cMap.get())) {
     quantity.refresh();
     colorBar.updateColormap(cMap.get());
@@ -217,6 +357,13 @@ void ScalarQuantity<QuantityT>::buildScalarUI() {
 template <typename QuantityT>
 void ScalarQuantity<QuantityT>::buildScalarOptionsUI() {
   if (ImGui::MenuItem("Reset colormap range")) resetMapRange();
+  if (ImGui::MenuItem("Percentile range", NULL, percentileRangeEnabled)) {
+    if (percentileRangeEnabled) {
+      clearPercentileRange();
+    } else {
+      setPercentileRange(percentileRange.first, percentileRange.second);
+    }
+  }
   if (dataType != DataType::CATEGORICAL) {
     if (ImGui::MenuItem("Enable isolines", NULL, isolinesEnabled.get())) setIsolinesEnabled(!isolinesEnabled.get());
   }
@@ -278,6 +425,7 @@ void ScalarQuantity<QuantityT>::setScalarUniforms(render::ShaderProgram& p) {
 
 template <typename QuantityT>
 QuantityT* ScalarQuantity<QuantityT>::resetMapRange() {
+  refreshDataRange();
   switch (dataType) {
   case DataType::STANDARD:
   case DataType::CATEGORICAL:
@@ -308,12 +456,110 @@ void ScalarQuantity<QuantityT>::exportColorbarToSVG(const std::string& filename)
   colorBar.exportColorbarToSVG(filename);
 }
 
+template <typename QuantityT>
+ScalarColorMapParams ScalarQuantity<QuantityT>::getColorMapParams() {
+  // (these are the same values setScalarUniforms() passes to the shaders)
+  ScalarColorMapParams params;
+  params.colorMap = cMap.get();
+  params.dataType = dataType;
+  params.rangeLow = vizRangeMin.get();
+  params.rangeHigh = vizRangeMax.get();
+  params.isolinesEnabled = isolinesEnabled.get();
+  params.isolineStyle = isolineStyle.get();
+  params.isolinePeriod = getIsolinePeriod();
+  params.isolineDarkness = getIsolineDarkness();
+  return params;
+}
+
+template <typename QuantityT>
+std::vector<glm::vec3> ScalarQuantity<QuantityT>::evaluateColors() {
+  values.ensureHostBufferPopulated();
+  return evaluateScalarColorMap(values.data, getColorMapParams());
+}
+
 template <typename QuantityT>
 template <class V>
 void ScalarQuantity<QuantityT>::updateData(const V& newValues) {
-  validateSize(newValues, values.size(), "scalar quantity " + quantity.name);
-  values.data = standardizeArray<float, V>(newValues);
-  values.markHostBufferUpdated();
+  validateSize(newValues, nValues(), "scalar quantity " + quantity.name);
+
+  // keep natively-stored data in its native type
+  switch (storageType) {
+  case ScalarStorageType::Float:
+    values.data = standardizeArray<float, V>(newValues);
+    values.markHostBufferUpdated();
+    break;
+  case ScalarStorageType::UInt8:
+    valuesUInt8.data = standardizeArray<uint8_t, V>(newValues);
+    valuesUInt8.markHostBufferUpdated();
+    break;
+  case ScalarStorageType::UInt16:
+    valuesUInt16.data = standardizeArray<uint16_t, V>(newValues);
+    valuesUInt16.markHostBufferUpdated();
+    break;
+  case ScalarStorageType::Int32:
+    valuesInt32.data = standardizeArray<int32_t, V>(newValues);
+    valuesInt32.markHostBufferUpdated();
+    break;
+  }
+  if (storageType != ScalarStorageType::Float) {
+    values.recomputeIfPopulated();
+  }
+
+  statisticsStale = true;
+}
+
+namespace {
+// Overwrite entries [start, start + newData.size()) of a scalar buffer. If trackStatistics is set, the statistics are
+// adjusted for each replaced value; returns whether they are still exact.
+template <typename T>
+bool replaceScalarBufferRange(render::ManagedBuffer<T>& buffer, size_t start, const std::vector<T>& newData,
+                              ScalarStatistics& statistics, bool trackStatistics) {
+  if (start + newData.size() > buffer.size()) {
+    exception("partial update of [" + std::to_string(start) + "," + std::to_string(start + newData.size()) +
+              ") is out of bounds for " + buffer.name + ", which has " + std::to_string(buffer.size()) + " entries");
+  }
+
+  buffer.ensureHostBufferPopulated();
+  bool exact = trackStatistics;
+  for (size_t i = 0; i < newData.size(); i++) {
+    T& val = buffer.data[start + i];
+    if (exact) exact = statistics.replaceValue(val, newData[i]);
+    val = newData[i];
+  }
+  buffer.markHostBufferRangeUpdated(start, start + newData.size());
+  return exact;
+}
+} // namespace
+
+template <typename QuantityT>
+template <class V>
+void ScalarQuantity<QuantityT>::updateDataPartial(size_t start, const V& newValues) {
+
+  bool exact = !statisticsStale;
+  switch (storageType) {
+  case ScalarStorageType::Float:
+    exact = replaceScalarBufferRange(values, start, standardizeArray<float, V>(newValues), statistics, exact);
+    break;
+  case ScalarStorageType::UInt8:
+    exact = replaceScalarBufferRange(valuesUInt8, start, standardizeArray<uint8_t, V>(newValues), statistics, exact);
+    break;
+  case ScalarStorageType::UInt16:
+    exact = replaceScalarBufferRange(valuesUInt16, start, standardizeArray<uint16_t, V>(newValues), statistics, exact);
+    break;
+  case ScalarStorageType::Int32:
+    exact = replaceScalarBufferRange(valuesInt32, start, standardizeArray<int32_t, V>(newValues), statistics, exact);
+    break;
+  }
+  if (storageType != ScalarStorageType::Float) {
+    values.recomputeIfPopulated();
+  }
+
+  // (percentile bounds can't be updated in place, they need a full recompute)
+  if (exact && !percentileRangeEnabled) {
+    histogramStale = true;
+  } else {
+    statisticsStale = true;
+  }
 }
 
 
@@ -367,9 +613,105 @@ typename ScalarQuantity<QuantityT>::ScalarRange ScalarQuantity<QuantityT>::getMa
 }
 template <typename QuantityT>
 typename ScalarQuantity<QuantityT>::ScalarRange ScalarQuantity<QuantityT>::getDataRange() {
+  refreshDataRange();
   return dataRange;
 }
 
+template <typename QuantityT>
+QuantityT* ScalarQuantity<QuantityT>::setPercentileRange(double lowerPercentile, double upperPercentile) {
+  if (!(lowerPercentile >= 0. && lowerPercentile < upperPercentile && upperPercentile <= 100.)) {
+    exception("scalar quantity " + quantity.name + " percentile range should be increasing and in [0,100]");
+  }
+  percentileRangeEnabled = true;
+  percentileRange = std::make_pair(lowerPercentile, upperPercentile);
+  statisticsStale = true;
+  resetMapRange();
+  return &quantity;
+}
+
+template <typename QuantityT>
+QuantityT* ScalarQuantity<QuantityT>::clearPercentileRange() {
+  if (!percentileRangeEnabled) return &quantity;
+  percentileRangeEnabled = false;
+  statisticsStale = true;
+  resetMapRange();
+  return &quantity;
+}
+
+template <typename QuantityT>
+bool ScalarQuantity<QuantityT>::getPercentileRangeEnabled() {
+  return percentileRangeEnabled;
+}
+
+template <typename QuantityT>
+ScalarStatistics ScalarQuantity<QuantityT>::getStatistics() {
+  refreshStatistics(false);
+  return statistics;
+}
+
+namespace {
+// If percentiles are given, the histogram spans them rather than the full range of the data
+template <typename T>
+ScalarStatistics computeBufferStatistics(render::ManagedBuffer<T>& buffer, const std::pair<double, double>* percentiles,
+                                         bool withHistogram) {
+  buffer.ensureHostBufferPopulated();
+  ScalarStatistics stats = computeScalarStatistics(buffer.data, withHistogram ? ColorBar::rawHistBinCount : 0);
+  if (percentiles) {
+    std::pair<double, double> range = computeScalarPercentiles(buffer.data, percentiles->first, percentiles->second);
+    rebinScalarStatistics(stats, buffer.data, padRobustRange(range.first, range.second, 1e-5));
+  }
+  return stats;
+}
+} // namespace
+
+template <typename QuantityT>
+ScalarStatistics ScalarQuantity<QuantityT>::computeStatistics(bool withHistogram) {
+  const std::pair<double, double>* percentiles = percentileRangeEnabled ? &percentileRange : nullptr;
+  switch (storageType) {
+  case ScalarStorageType::Float:
+    return computeBufferStatistics(values, percentiles, withHistogram);
+  case ScalarStorageType::UInt8:
+    return computeBufferStatistics(valuesUInt8, percentiles, withHistogram);
+  case ScalarStorageType::UInt16:
+    return computeBufferStatistics(valuesUInt16, percentiles, withHistogram);
+  case ScalarStorageType::Int32:
+    return computeBufferStatistics(valuesInt32, percentiles, withHistogram);
+  }
+  return ScalarStatistics(); // unreachable
+}
+
+template <typename QuantityT>
+void ScalarQuantity<QuantityT>::refreshDataRange() {
+  if (statisticsStale) {
+    // just the range, the histogram is left for refreshStatistics()
+    statistics = computeStatistics(false);
+    statisticsStale = false;
+    histogramStale = true;
+  }
+  bool exactRange = storageType == ScalarStorageType::Float && !percentileRangeEnabled;
+  dataRange = exactRange ? statistics.robustRange(1e-5) : statistics.histogramRange;
+}
+
+template <typename QuantityT>
+void ScalarQuantity<QuantityT>::refreshStatistics(bool throttle) {
+  if (!statisticsStale && !histogramStale) return;
+
+  // (the first histogram is never throttled, the color bar has nothing to show without it)
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::duration<float> refreshPeriod(options::scalarStatisticsRefreshPeriod);
+  bool hasHistogram = !statistics.histogramBinCounts.empty() && !statisticsStale;
+  if (throttle && hasHistogram && now - lastStatisticsRefresh < refreshPeriod) return;
+  lastStatisticsRefresh = now;
+
+  if (statisticsStale || statistics.histogramBinCounts.empty()) {
+    statistics = computeStatistics(true);
+    statisticsStale = false;
+  }
+  refreshDataRange();
+  colorBar.buildHistogram(statistics, dataType);
+  histogramStale = false;
+}
+
 template <typename QuantityT>
 QuantityT* ScalarQuantity<QuantityT>::setIsolinePeriod(double size, bool isRelative) {
   isolinePeriod = ScaledValue<float>(size, isRelative);
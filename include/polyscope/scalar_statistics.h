@@ -0,0 +1,71 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace polyscope {
+
+// Summary statistics of an array of scalar data: how much of it is finite, its range, and a histogram.
+//
+// These are all gathered together by computeScalarStatistics(), which makes one parallel sweep over the data to find
+// the range and one to fill the bins, rather than having each consumer scan the data separately.
+struct ScalarStatistics {
+  size_t nValues = 0;
+  size_t nNonFinite = 0; // NaN and +-inf entries, which are excluded from everything below
+
+  // Extent of the finite values, (0,0) if there are none
+  double minVal = 0.;
+  double maxVal = 0.;
+
+  // Bins of equal width, evenly spanning histogramRange
+  std::pair<double, double> histogramRange{-1., 1.};
+  std::vector<double> histogramBinCounts;
+
+  bool allFinite() const { return nNonFinite == 0; }
+
+  // The range of the finite values, widened if the data is (nearly) constant as in robustMinMax()
+  std::pair<double, double> robustRange(double rangeEPS) const;
+
+  // The histogram bin a finite value falls in (values outside histogramRange are clamped to the end bins)
+  size_t histogramBinOf(double val) const;
+
+  // Account for one entry of the data changing from oldVal to newVal, without rescanning the data. Returns false
+  // (having made no changes) if newVal lies outside histogramRange, or oldVal was the minimum or maximum, in which case
+  // the statistics must be recomputed from scratch.
+  bool replaceValue(double oldVal, double newVal);
+};
+
+// The histogram spans robustRange(1e-12)
+ScalarStatistics computeScalarStatistics(const std::vector<float>& values, size_t nBins);
+
+// Integer data is ranged and binned exactly, in integer arithmetic. The histogram spans exactly [min, max], or a range
+// of width 1 centered on the value if the data is constant.
+ScalarStatistics computeScalarStatistics(const std::vector<uint8_t>& values, size_t nBins);
+ScalarStatistics computeScalarStatistics(const std::vector<uint16_t>& values, size_t nBins);
+ScalarStatistics computeScalarStatistics(const std::vector<int32_t>& values, size_t nBins);
+
+// Re-count the histogram over a different range, leaving the other statistics alone. Values outside the range are
+// counted in the end bins.
+void rebinScalarStatistics(ScalarStatistics& stats, const std::vector<float>& values, std::pair<double, double> range);
+void rebinScalarStatistics(ScalarStatistics& stats, const std::vector<uint8_t>& values, std::pair<double, double> range);
+void rebinScalarStatistics(ScalarStatistics& stats, const std::vector<uint16_t>& values, std::pair<double, double> range);
+void rebinScalarStatistics(ScalarStatistics& stats, const std::vector<int32_t>& values, std::pair<double, double> range);
+
+// The values at a lower and upper percentile (in [0,100]) of the finite entries of the data, for ranges which are not
+// thrown off by a few outliers. Estimated in linear time and bounded memory with a QuantileSketch per thread, so they
+// are approximate, except that percentiles of 0 and 100 give the exact min and max. Returns (-1,1) if there are no
+// finite values.
+std::pair<double, double> computeScalarPercentiles(const std::vector<float>& values, double lowerPercentile,
+                                                   double upperPercentile);
+std::pair<double, double> computeScalarPercentiles(const std::vector<uint8_t>& values, double lowerPercentile,
+                                                   double upperPercentile);
+std::pair<double, double> computeScalarPercentiles(const std::vector<uint16_t>& values, double lowerPercentile,
+                                                   double upperPercentile);
+std::pair<double, double> computeScalarPercentiles(const std::vector<int32_t>& values, double lowerPercentile,
+                                                   double upperPercentile);
+
+} // namespace polyscope
@@ -28,6 +28,7 @@ void SimpleTriangleMesh::updateVertices(const V& newPositions) {
   validateSize(newPositions, vertices.size(), "newPositions");
   vertices.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   vertices.markHostBufferUpdated();
+  updateObjectSpaceBounds(); // keep culling bounds current, without changing the scene extents
 }
 
 template <class V, class F>
@@ -38,6 +39,7 @@ void SimpleTriangleMesh::update(const V& newPositions, const F& newFaces) {
 
   faces.data = standardizeVectorArray<glm::uvec3, 3>(newFaces);
   faces.markHostBufferUpdated();
+  updateObjectSpaceBounds(); // keep culling bounds current, without changing the scene extents
 }
 
 // Shorthand to get a mesh from polyscope
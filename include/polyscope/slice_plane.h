@@ -110,6 +110,10 @@ protected:
 
   std::shared_ptr<render::ShaderProgram> planeProgram;
 
+  // The scene object uniforms for this plane, see setSceneObjectUniforms()
+  const render::UniformName sliceNormalUniform;
+  const render::UniformName sliceCenterUniform;
+
   // Helpers
   void setSliceAttributes(render::ShaderProgram& p);
   void createVolumeSliceProgram();
@@ -2,6 +2,7 @@
 
 #pragma once
 
+#include <array>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -14,6 +15,7 @@
 #include "polyscope/pick.h"
 #include "polyscope/quantity.h"
 #include "polyscope/render/engine.h"
+#include "polyscope/time_series.h"
 #include "polyscope/transformation_gizmo.h"
 #include "polyscope/weak_handle.h"
 
@@ -119,6 +121,10 @@ public:
   float lengthScale();                            // get characteristic length
   virtual bool hasExtents();                      // bounding box and length scale are only meaningful if true
 
+  // Conservatively test whether any of the structure could be visible in the current view. Always true if
+  // options::frustumCulling is off, or if the structure cannot bound what it draws.
+  bool mayBeInView();
+
   // ====================================================================
   // ==== Enabling, Selection, and Groups ===============================
   // ====================================================================
@@ -131,6 +137,16 @@ public:
   void addToGroup(std::string groupName);
   void addToGroup(Group& group);
 
+  // ====================================================================
+  // ==== Time series ===================================================
+  // ====================================================================
+
+  // Playback controls for animated data on this structure (which is added via the structure-specific *Frames() and
+  // *FrameLoader() functions). A scrubber is shown in the structure's UI whenever there are frames.
+  TimeSeries& getTimeSeries();
+  bool hasTimeSeries(); // true if there are any animated values
+  void updateTimeSeries(); // advance playback, called once per main loop iteration
+
   // ====================================================================
   // ==== Options =======================================================
   // ====================================================================
@@ -275,6 +291,9 @@ protected:
 
   PersistentValue<std::vector<std::string>> ignoredSlicePlaneNames;
 
+  // Animated data, created on first use
+  std::unique_ptr<TimeSeries> timeSeries;
+
   // Manage the bounding box & length scale
   // (this is defined _before_ the object transform is applied. To get the scale/bounding box after transforms, use the
   // boundingBox() and lengthScale() member function)
@@ -282,6 +301,39 @@ protected:
   std::tuple<glm::vec3, glm::vec3> objectSpaceBoundingBox;
   float objectSpaceLengthScale;
   virtual void updateObjectSpaceBounds() = 0;
+
+  // Grow the bounds above to also contain `newPoints`, without revisiting existing geometry. The length scale which
+  // results is conservative (it may be larger than updateObjectSpaceBounds() would give).
+  void growObjectSpaceBounds(const std::vector<glm::vec3>& newPoints);
+
+  // = Frustum culling
+
+  // How far (in world units) drawing may extend beyond objectSpaceBoundingBox, e.g. the radius of points. Negative if
+  // there is no bound, which disables culling. By default this is 0, or -1 if any enabled quantity draws outside of
+  // the structure's bounds.
+  virtual float frustumCullingMargin();
+
+  // Large structures may split their elements in to chunks of cullingChunkSize consecutive elements, and fill
+  // cullingChunkBounds with the object-space bounds of each chunk. Before drawing, updateVisibleChunks() tests each
+  // chunk against the view, then applyChunkCulling() restricts a program to the chunks which may be visible.
+  static const size_t cullingChunkSize;
+  std::vector<std::tuple<glm::vec3, glm::vec3>> cullingChunkBounds;
+  void updateVisibleChunks(uint32_t verticesPerElement, bool countStats = true);
+  void applyChunkCulling(render::ShaderProgram& p);
+
+  // = Instancing
+
+  // Pack affine transforms as the columns of their upper 3x4 block, which is the layout of the a_instanceTransform
+  // attribute. Throws if any transform is not affine.
+  static std::vector<std::array<glm::vec3, 4>> packInstanceTransforms(const std::vector<glm::mat4>& transforms);
+
+  // Replace the object space bounds with the bounds of every instance of them
+  void applyInstancesToObjectSpaceBounds(const std::vector<std::array<glm::vec3, 4>>& instances);
+
+private:
+  bool boxMayBeInView(const std::tuple<glm::vec3, glm::vec3>& objectSpaceBox, float margin);
+  bool allChunksVisible = true;
+  std::vector<render::DrawRange> visibleChunkRanges; // in vertices, merged where consecutive chunks are visible
 };
 
 
@@ -50,6 +50,17 @@ struct SurfaceMeshPickResult {
   MeshElement elementType;                        // which kind of element did we click
   int64_t index;                                  // index of the clicked element
   glm::vec3 baryCoords = glm::vec3{-1., -1., -1}; // coordinates in face, populated only for triangular face picks
+  int64_t instanceIndex = -1; // index of the clicked instance, if the mesh is instanced (then index is -1)
+};
+
+// The elements found by a region pick, each list sorted
+struct SurfaceMeshPickRegionResult {
+  std::vector<int64_t> vertices;
+  std::vector<int64_t> faces;
+  std::vector<int64_t> edges;
+  std::vector<int64_t> halfedges;
+  std::vector<int64_t> corners;
+  std::vector<int64_t> instances; // populated instead of the above if the mesh is instanced
 };
 
 // === The grand surface mesh class
@@ -122,6 +133,10 @@ public:
   render::ManagedBuffer<glm::vec3> defaultFaceTangentBasisX;
   render::ManagedBuffer<glm::vec3> defaultFaceTangentBasisY;
 
+  // instancing (empty if the mesh is not instanced)
+  render::ManagedBuffer<std::array<glm::vec3, 4>> instanceTransforms; // upper 3x4 block, by column [nInstances]
+  render::ManagedBuffer<glm::vec3> instanceColors;                    // [nInstances], or empty to use the surface color
+
 
   // === Quantity-related
   // clang-format off
@@ -167,6 +182,7 @@ public:
 
   // get data related to picking/selection
   SurfaceMeshPickResult interpretPickResult(const PickResult& result);
+  SurfaceMeshPickRegionResult interpretPickRegionResult(const PickRegionResult& result);
 
   // Make a one-time selection
   long long int selectVertex();
@@ -179,6 +195,21 @@ public:
   template <class V>
   void updateVertexPositions2D(const V& newPositions2D);
 
+  // === Instancing
+
+  // Draw many copies of the mesh in a single instanced draw call, one per transform. Each transform is applied in
+  // object space before the structure transform, and must be affine. Quantities on the surface are drawn on every
+  // instance, and picking identifies the instance rather than an element of the mesh.
+  void setInstances(const std::vector<glm::mat4>& transforms);
+  void clearInstances();
+  bool isInstanced();
+  size_t nInstances();
+
+  // Give each instance its own color, in place of the surface color (expects vec3 array, one per instance)
+  template <class T>
+  void setInstanceColors(const T& colors);
+  void clearInstanceColors();
+
   // === Set transparency alpha from a scalar quantity
   // effect is multiplicative with other transparency values
   // values are clamped to [0,1]
@@ -342,6 +373,10 @@ private:
   std::vector<glm::vec3> defaultFaceTangentBasisXData;
   std::vector<glm::vec3> defaultFaceTangentBasisYData;
 
+  // instancing
+  std::vector<std::array<glm::vec3, 4>> instanceTransformsData;
+  std::vector<glm::vec3> instanceColorsData;
+
 
   // Derived connectivity quantities
   bool halfedgesHaveBeenUsed = false;
@@ -350,6 +385,10 @@ private:
   std::vector<uint32_t>
       halfedgeEdgeCorrespondence; // ugly hack used to save a pick buffer attr, filled out lazily w/ edge indices
 
+  // Frustum culling chunk bounds are computed lazily, the first time they are needed after the geometry changes
+  bool cullingChunkBoundsStale = true;
+  void ensureCullingChunkBoundsComputed();
+
 
   // Visualization settings
   PersistentValue<glm::vec3> surfaceColor;
@@ -386,6 +425,7 @@ private:
   // Within each set, uses the implicit ordering from the mesh data structure
   // These starts are LOCAL indices, indexing elements only with the mesh
   size_t facePickIndStart, edgePickIndStart, halfedgePickIndStart, cornerPickIndStart;
+  void setMeshInstancePickAttributes(render::ShaderProgram& p); // when instanced, each instance gets one index
   void buildVertexInfoGui(const SurfaceMeshPickResult& result);
   void buildFaceInfoGui(const SurfaceMeshPickResult& result);
   void buildEdgeInfoGui(const SurfaceMeshPickResult& result);
@@ -66,6 +66,7 @@ void SurfaceMesh::updateVertexPositions(const V& newPositions) {
   vertexPositions.data = standardizeVectorArray<glm::vec3, 3>(newPositions);
   vertexPositions.markHostBufferUpdated();
   recomputeGeometryIfPopulated();
+  updateObjectSpaceBounds(); // keep culling bounds current, without changing the scene extents
 }
 
 
@@ -81,6 +82,19 @@ void SurfaceMesh::updateVertexPositions2D(const V& newPositions2D) {
   updateVertexPositions(positions3D);
 }
 
+template <class T>
+void SurfaceMesh::setInstanceColors(const T& colors) {
+  if (!isInstanced()) exception("surface mesh [" + name + "] is not instanced, call setInstances() first");
+  validateSize(colors, nInstances(), "instance colors");
+  bool hadColors = !instanceColors.data.empty();
+  instanceColors.data = standardizeVectorArray<glm::vec3, 3>(colors);
+  instanceColors.markHostBufferUpdated();
+  if (!hadColors) {
+    program.reset(); // shade from the instance colors
+    requestRedraw();
+  }
+}
+
 // Shorthand to get a mesh from polyscope
 inline SurfaceMesh* getSurfaceMesh(std::string name) {
   return dynamic_cast<SurfaceMesh*>(getStructure(SurfaceMesh::structureTypeName, name));
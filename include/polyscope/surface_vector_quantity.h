@@ -21,6 +21,8 @@ class SurfaceVectorQuantity : public SurfaceMeshQuantity {
 public:
   SurfaceVectorQuantity(std::string name, SurfaceMesh& mesh_, MeshElement definedOn_);
 
+  virtual bool isDrawnWithinParentBounds() override;
+
   // === Members
 
   // === Option accessors
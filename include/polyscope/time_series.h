@@ -0,0 +1,125 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace polyscope {
+
+// Produces frame `iFrame` of some per-element data. Loaders are called on background threads, possibly several at
+// once, so they must be thread-safe.
+template <typename T>
+using FrameLoader = std::function<std::vector<T>(size_t iFrame)>;
+
+// One animated value on a structure, such as its positions or the data of one of its quantities.
+//
+// Frames are loaded and converted on background threads in to a small ring of slots ahead of playback. When a frame
+// becomes current it is handed to the structure, which uploads it to the existing render buffers.
+class TimeSeriesTrack {
+public:
+  TimeSeriesTrack(std::string name, size_t nFrames);
+  virtual ~TimeSeriesTrack();
+
+  const std::string name;
+  const size_t nFrames;
+
+  // Start loading a frame in the background, if it is not already loaded or loading
+  virtual void prefetch(size_t iFrame) = 0;
+
+  // Make a frame current, blocking until it has been loaded
+  virtual void setFrame(size_t iFrame) = 0;
+
+  // How many frames can be held at once (the current frame, plus those prefetched)
+  virtual size_t ringSize() = 0;
+};
+
+template <typename T>
+class TypedTimeSeriesTrack : public TimeSeriesTrack {
+public:
+  TypedTimeSeriesTrack(std::string name, size_t nFrames, FrameLoader<T> loader,
+                       std::function<void(const std::vector<T>&)> applyFrame, size_t ringSize = 4);
+
+  void prefetch(size_t iFrame) override;
+  void setFrame(size_t iFrame) override;
+  size_t ringSize() override;
+
+  // Provide a frame which has already been loaded elsewhere (e.g. the first frame, used to create a quantity), so it
+  // does not get loaded a second time
+  void seedFrame(size_t iFrame, std::vector<T> data);
+
+private:
+  FrameLoader<T> loader;
+  std::function<void(const std::vector<T>&)> applyFrame;
+
+  // frame i lives in slot i % ring.size()
+  struct Slot {
+    size_t iFrame;
+    std::shared_future<std::vector<T>> data;
+  };
+  std::vector<Slot> ring;
+  Slot& requestFrame(size_t iFrame);
+
+  // Loads which were evicted from the ring before they finished. They are held here rather than dropped, because
+  // destroying the last reference to an std::async future blocks until it completes.
+  std::vector<std::shared_future<std::vector<T>>> retired;
+  void retire(Slot& slot);
+};
+
+// The name of the track which animates the data of a quantity. Structures remove this track when the quantity is
+// removed.
+std::string quantityTrackName(std::string quantityName);
+
+// Playback state for all of the animated values on a structure. Manages the current frame, advancing it while playing,
+// and keeping the tracks prefetched ahead of it.
+class TimeSeries {
+public:
+  TimeSeries();
+  ~TimeSeries();
+
+  // Add a track, replacing any existing track with the same name. The track is immediately set to the current frame.
+  void addTrack(std::unique_ptr<TimeSeriesTrack> track);
+  void removeTrack(std::string name);
+  bool hasTrack(std::string name);
+
+  // The number of frames is the longest of any track. Shorter tracks hold their last frame.
+  size_t nFrames();
+
+  void setFrame(size_t iFrame);
+  size_t getFrame();
+
+  void setPlaying(bool newVal);
+  bool getPlaying();
+
+  // The maximum playback rate. Playback may be slower if loading the frames cannot keep up.
+  void setFramesPerSecond(float newVal);
+  float getFramesPerSecond();
+
+  // When playing, wrap around to the first frame after the last (otherwise stop)
+  void setLoop(bool newVal);
+  bool getLoop();
+
+  // Advance the current frame if playing and enough time has elapsed. Called once per main loop iteration.
+  void update();
+
+  void buildUI();
+
+private:
+  std::vector<std::unique_ptr<TimeSeriesTrack>> tracks;
+
+  size_t currentFrame = 0;
+  bool playing = false;
+  float framesPerSecond = 30.;
+  bool loop = true;
+  std::chrono::steady_clock::time_point lastAdvanceTime;
+
+  void prefetchAhead();
+};
+
+} // namespace polyscope
+
+#include "polyscope/time_series.ipp"
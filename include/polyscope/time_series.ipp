@@ -0,0 +1,92 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#pragma once
+
+#include "polyscope/messages.h"
+#include "polyscope/utilities.h"
+
+#include <algorithm>
+
+namespace polyscope {
+
+template <typename T>
+TypedTimeSeriesTrack<T>::TypedTimeSeriesTrack(std::string name_, size_t nFrames_, FrameLoader<T> loader_,
+                                              std::function<void(const std::vector<T>&)> applyFrame_,
+                                              size_t ringSize_)
+    : TimeSeriesTrack(name_, nFrames_), loader(loader_), applyFrame(applyFrame_) {
+  if (ringSize_ == 0) exception("time series track [" + name + "] must have a ring size of at least 1");
+  ring.resize(ringSize_);
+  for (Slot& s : ring) {
+    s.iFrame = INVALID_IND;
+  }
+}
+
+template <typename T>
+typename TypedTimeSeriesTrack<T>::Slot& TypedTimeSeriesTrack<T>::requestFrame(size_t iFrame) {
+  if (iFrame >= nFrames) {
+    exception("time series track [" + name + "] requested frame " + std::to_string(iFrame) + ", but it has only " +
+              std::to_string(nFrames) + " frames");
+  }
+
+  Slot& slot = ring[iFrame % ring.size()];
+  if (slot.iFrame != iFrame) {
+    retire(slot);
+    slot.iFrame = iFrame;
+    slot.data = std::async(std::launch::async, loader, iFrame).share();
+  }
+  return slot;
+}
+
+template <typename T>
+void TypedTimeSeriesTrack<T>::retire(Slot& slot) {
+
+  // drop any retired loads which have since finished
+  retired.erase(std::remove_if(retired.begin(), retired.end(),
+                               [](const std::shared_future<std::vector<T>>& f) -> bool {
+                                 return f.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+                               }),
+                retired.end());
+
+  if (slot.data.valid() && slot.data.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+    retired.push_back(slot.data);
+  }
+  slot.data = std::shared_future<std::vector<T>>();
+}
+
+template <typename T>
+void TypedTimeSeriesTrack<T>::seedFrame(size_t iFrame, std::vector<T> data) {
+  if (iFrame >= nFrames) {
+    exception("time series track [" + name + "] seeded frame " + std::to_string(iFrame) + ", but it has only " +
+              std::to_string(nFrames) + " frames");
+  }
+
+  Slot& slot = ring[iFrame % ring.size()];
+  retire(slot);
+  std::promise<std::vector<T>> ready;
+  ready.set_value(std::move(data));
+  slot.iFrame = iFrame;
+  slot.data = ready.get_future().share();
+}
+
+template <typename T>
+void TypedTimeSeriesTrack<T>::prefetch(size_t iFrame) {
+  requestFrame(iFrame);
+}
+
+template <typename T>
+void TypedTimeSeriesTrack<T>::setFrame(size_t iFrame) {
+  Slot& slot = requestFrame(iFrame);
+  try {
+    applyFrame(slot.data.get()); // rethrows anything the loader threw
+  } catch (...) {
+    slot.iFrame = INVALID_IND; // don't cache failures
+    throw;
+  }
+}
+
+template <typename T>
+size_t TypedTimeSeriesTrack<T>::ringSize() {
+  return ring.size();
+}
+
+} // namespace polyscope
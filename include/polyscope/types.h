@@ -233,7 +233,10 @@ enum class ManagedBufferType {
   UInt32,
   UVec2,
   UVec3,
-  UVec4
+  UVec4,
+  UInt8,
+  UInt16,
+  U8Vec4
 };
 POLYSCOPE_DEFINE_ENUM_NAMES(ManagedBufferType,
     {ManagedBufferType::Float, "Float"},
@@ -251,7 +254,10 @@ POLYSCOPE_DEFINE_ENUM_NAMES(ManagedBufferType,
     {ManagedBufferType::UInt32, "UInt32"},
     {ManagedBufferType::UVec2, "UVec2"},
     {ManagedBufferType::UVec3, "UVec3"},
-    {ManagedBufferType::UVec4, "UVec4"}
+    {ManagedBufferType::UVec4, "UVec4"},
+    {ManagedBufferType::UInt8, "UInt8"},
+    {ManagedBufferType::UInt16, "UInt16"},
+    {ManagedBufferType::U8Vec4, "U8Vec4"}
 );
 
 
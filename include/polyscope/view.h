@@ -5,6 +5,7 @@
 #include <array>
 #include <string>
 #include <tuple>
+#include <vector>
 
 #include "polyscope/camera_parameters.h"
 #include "polyscope/types.h"
@@ -167,6 +168,15 @@ bool getWindowResizable();
 glm::vec3 screenCoordsToWorldRay(glm::vec2 screenCoords);
 glm::vec3 bufferIndsToWorldRay(glm::ivec2 bufferInds);
 glm::vec3 screenCoordsAndDepthToWorldPosition(glm::vec2 screenCoords, float clipDepth);
+std::vector<glm::vec3> screenCoordsAndDepthToWorldPosition(const std::vector<glm::vec2>& screenCoords,
+                                                           const std::vector<float>& clipDepths); // many at once
+glm::vec3 screenCoordsAndDepthToWorldPosition(glm::vec2 screenCoords, float clipDepth, const glm::mat4& viewMat,
+                                              const glm::mat4& projMat); // for a camera other than the current one
+
+// Could any part of an object-space box (placed in the scene by objectTransform) be visible in the current view? This
+// is conservative: it is false only if the box is entirely outside one of the clip planes, and true for boxes which
+// are empty or not finite.
+bool boxMayBeVisible(const glm::mat4& objectTransform, glm::vec3 boxMin, glm::vec3 boxMax);
 
 // Get and set camera from json string
 std::string getViewAsJson();
@@ -5,6 +5,7 @@
 #include "polyscope/file_helpers.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "polyscope/point_cloud_color_quantity.h"
@@ -152,6 +153,7 @@ void CameraView::drawPickDelayed() {
 }
 
 void CameraView::prepare() {
+  POLYSCOPE_PROFILE_SCOPE("prepare");
 
   {
     std::vector<std::string> rules =
@@ -178,6 +180,7 @@ void CameraView::prepare() {
 
 
 void CameraView::preparePick() {
+  POLYSCOPE_PROFILE_SCOPE("prepare pick");
 
   // Request pick indices if we don't already have them
   if (pickStart == INVALID_IND) {
@@ -440,6 +443,8 @@ void CameraView::updateObjectSpaceBounds() {
 }
 
 
+float CameraView::frustumCullingMargin() { return -1.; }
+
 std::string CameraView::typeName() { return structureTypeName; }
 
 
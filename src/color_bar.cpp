@@ -20,64 +20,64 @@ ColorBar::ColorBar(Quantity& parent_)
 
 ColorBar::~ColorBar() {}
 
+const size_t ColorBar::rawHistBinCount;
+
 void ColorBar::buildHistogram(const std::vector<float>& values, DataType dataType_) {
-  dataType = dataType_;
+  buildHistogram(computeScalarStatistics(values, rawHistBinCount), dataType_);
+}
+void ColorBar::buildHistogram(const std::vector<uint8_t>& values, DataType dataType_) {
+  buildHistogram(computeScalarStatistics(values, rawHistBinCount), dataType_);
+}
+void ColorBar::buildHistogram(const std::vector<uint16_t>& values, DataType dataType_) {
+  buildHistogram(computeScalarStatistics(values, rawHistBinCount), dataType_);
+}
+void ColorBar::buildHistogram(const std::vector<int32_t>& values, DataType dataType_) {
+  buildHistogram(computeScalarStatistics(values, rawHistBinCount), dataType_);
+}
 
-  // Build arrays of values
-  size_t N = values.size();
+void ColorBar::buildHistogram(const ScalarStatistics& stats, DataType dataType_) {
+  if (stats.histogramBinCounts.size() != rawHistBinCount) {
+    exception("color bar histogram expects statistics with " + std::to_string(rawHistBinCount) + " bins");
+  }
 
-  // == Build histogram
-  dataRange = robustMinMax(values);
+  dataType = dataType_;
+  dataRange = stats.histogramRange;
   colormapRange = dataRange;
+  buildHistogramCurve(stats.histogramBinCounts);
 
-  // Helper to build the four histogram variants
-  auto buildCurve = [&](size_t binCount, std::vector<std::array<float, 2>>& curveX, std::vector<float>& curveY) {
-    // linspace coords
-    double range = dataRange.second - dataRange.first;
-    double inc = range / binCount;
-    std::vector<double> sumBin(binCount, 0.0);
-
-    // count values in buckets
-    for (size_t iData = 0; iData < N; iData++) {
-
-      double iBinf = binCount * (values[iData] - dataRange.first) / range;
-      size_t iBin = std::floor(glm::clamp(iBinf, 0.0, (double)binCount - 1));
-
-      // NaN values and finite values near the bottom of float range lead to craziness, so only increment bins if we got
-      // something reasonable
-      if (iBin < binCount) {
-        sumBin[iBin] += 1.0;
-      }
-    }
-
+  // when rebuilding, update the existing inline histogram too
+  if (inlineHistogramProgram) {
+    fillHistogramBuffers();
+  }
+}
 
-    // build histogram coords
-    curveX = std::vector<std::array<float, 2>>(binCount);
-    curveY = std::vector<float>(binCount);
-    double prevSumU = 0.0;
-    double prevSumW = 0.0;
-    double prevXEnd = dataRange.first;
-    for (size_t iBin = 0; iBin < binCount; iBin++) {
-      // y value
-      curveY[iBin] = sumBin[iBin];
-
-      // x value
-      double xEnd = prevXEnd + inc;
-      curveX[iBin] = {{static_cast<float>(prevXEnd), static_cast<float>(xEnd)}};
-      prevXEnd = xEnd;
-    }
+void ColorBar::buildHistogramCurve(const std::vector<double>& binCounts) {
+  size_t binCount = binCounts.size();
+  double range = dataRange.second - dataRange.first;
+  double inc = range / binCount;
+
+  // build histogram coords
+  rawHistCurveX = std::vector<std::array<float, 2>>(binCount);
+  rawHistCurveY = std::vector<float>(binCount);
+  double prevXEnd = dataRange.first;
+  for (size_t iBin = 0; iBin < binCount; iBin++) {
+    // y value
+    rawHistCurveY[iBin] = binCounts[iBin];
+
+    // x value
+    double xEnd = prevXEnd + inc;
+    rawHistCurveX[iBin] = {{static_cast<float>(prevXEnd), static_cast<float>(xEnd)}};
+    prevXEnd = xEnd;
+  }
 
-    { // Rescale curves to [0,1] in both dimensions
-      double maxHeight = *std::max_element(curveY.begin(), curveY.end());
-      for (size_t i = 0; i < binCount; i++) {
-        curveX[i][0] = (curveX[i][0] - dataRange.first) / range;
-        curveX[i][1] = (curveX[i][1] - dataRange.first) / range;
-        curveY[i] /= maxHeight;
-      }
+  { // Rescale curves to [0,1] in both dimensions
+    double maxHeight = *std::max_element(rawHistCurveY.begin(), rawHistCurveY.end());
+    for (size_t i = 0; i < binCount; i++) {
+      rawHistCurveX[i][0] = (rawHistCurveX[i][0] - dataRange.first) / range;
+      rawHistCurveX[i][1] = (rawHistCurveX[i][1] - dataRange.first) / range;
+      rawHistCurveY[i] /= maxHeight;
     }
-  };
-
-  buildCurve(rawHistBinCount, rawHistCurveX, rawHistCurveY);
+  }
 }
 
 
@@ -0,0 +1,103 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/colormap_evaluation.h"
+
+#include "polyscope/parallel_helpers.h"
+#include "polyscope/render/engine.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace polyscope {
+
+namespace render {
+glm::vec3 sampleColorMapTexture(const ValueColorMap& colorMap, float t) {
+  const std::vector<glm::vec3>& texels = colorMap.values;
+  int n = static_cast<int>(texels.size());
+  if (n == 0) return glm::vec3{0., 0., 0.};
+
+  // texel i is centered at (i + 0.5) / n
+  float u = t * n - 0.5f;
+  float lowerF = std::floor(u);
+  float blend = u - lowerF;
+  int lower = std::min(std::max(static_cast<int>(lowerF), 0), n - 1);
+  int upper = std::min(std::max(static_cast<int>(lowerF) + 1, 0), n - 1);
+  return texels[lower] * (1.f - blend) + texels[upper] * blend;
+}
+} // namespace render
+
+namespace {
+
+// GLSL mod(), which differs from fmod() for negative values
+float glslMod(float x, float y) { return x - y * std::floor(x / y); }
+
+// Must match intToDistinctReal() in the shader common code
+float intToDistinctReal(float start, int index) {
+  const int NBitsUntilRepeat = 10;
+
+  if (index < 0) {
+    return 0.0f;
+  }
+
+  float val = 0.f;
+  float p = 0.5f;
+  for (int iShift = 0; iShift < NBitsUntilRepeat; iShift++) {
+    val += float((index % 2) == 1) * p;
+    index = index >> 1;
+    p /= 2.0f;
+  }
+
+  val = glslMod(val + start, 1.0f);
+  return std::min(std::max(val, 0.f), 1.f);
+}
+
+// One value, following the SHADE_COLORMAP_VALUE / SHADE_CATEGORICAL_COLORMAP and ISOLINE_STRIPE_VALUECOLOR rules
+glm::vec3 evaluateOne(float shadeValue, const render::ValueColorMap& colorMap, const ScalarColorMapParams& params) {
+  glm::vec3 albedoColor;
+  if (params.dataType == DataType::CATEGORICAL) {
+    int shadeInt = static_cast<int>(std::round(shadeValue));
+    float startOffset = 0.;
+    if (shadeInt < 0) {
+      shadeInt = -shadeInt;
+      startOffset = 1.f / 3.f;
+    }
+    float catVal = intToDistinctReal(startOffset, shadeInt);
+    albedoColor = render::sampleColorMapTexture(colorMap, catVal);
+  } else {
+    float rangeTVal = (shadeValue - params.rangeLow) / (params.rangeHigh - params.rangeLow);
+    rangeTVal = std::min(std::max(rangeTVal, 0.f), 1.f);
+    albedoColor = render::sampleColorMapTexture(colorMap, rangeTVal);
+  }
+
+  if (params.isolinesEnabled && params.isolineStyle == IsolineStyle::Stripe) {
+    float modVal = glslMod(shadeValue, 2.0f * params.isolinePeriod);
+    if (modVal > params.isolinePeriod) {
+      albedoColor *= params.isolineDarkness;
+    }
+  }
+
+  return albedoColor;
+}
+
+} // namespace
+
+std::vector<glm::vec3> evaluateScalarColorMap(const std::vector<float>& values, const render::ValueColorMap& colorMap,
+                                              const ScalarColorMapParams& params) {
+  std::vector<glm::vec3> colors(values.size());
+  parallelFor(values.size(), [&](size_t i) { colors[i] = evaluateOne(values[i], colorMap, params); });
+  return colors;
+}
+
+std::vector<glm::vec3> evaluateScalarColorMap(const std::vector<float>& values, const ScalarColorMapParams& params) {
+  return evaluateScalarColorMap(values, render::engine->getColorMap(params.colorMap), params);
+}
+
+std::vector<glm::vec4> evaluateScalarColorMapRGBA(const std::vector<float>& values,
+                                                  const ScalarColorMapParams& params) {
+  const render::ValueColorMap& colorMap = render::engine->getColorMap(params.colorMap);
+  std::vector<glm::vec4> colors(values.size());
+  parallelFor(values.size(), [&](size_t i) { colors[i] = glm::vec4(evaluateOne(values[i], colorMap, params), 1.f); });
+  return colors;
+}
+
+} // namespace polyscope
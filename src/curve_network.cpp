@@ -5,6 +5,7 @@
 #include "polyscope/elementary_geometry.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "imgui.h"
@@ -25,6 +26,8 @@ CurveNetwork::CurveNetwork(std::string name, std::vector<glm::vec3> nodes_, std:
       edgeTailInds(this, uniquePrefix() + "edgeTailInds", edgeTailIndsData),
       edgeTipInds(this, uniquePrefix() + "edgeTipInds", edgeTipIndsData),
       edgeCenters(this, uniquePrefix() + "edgeCenters", edgeCentersData, std::bind(&CurveNetwork::computeEdgeCenters, this)),         
+      instanceTransforms(this, uniquePrefix() + "instanceTransforms", instanceTransformsData),
+      instanceColors(this, uniquePrefix() + "instanceColors", instanceColorsData),
       nodePositionsData(std::move(nodes_)), 
       color(uniquePrefix() + "#color", getNextUniqueColor()), 
       radius(uniquePrefix() + "#radius", relativeValue(0.005)),
@@ -64,6 +67,16 @@ CurveNetwork::CurveNetwork(std::string name, std::vector<glm::vec3> nodes_, std:
   updateObjectSpaceBounds();
 }
 
+float CurveNetwork::frustumCullingMargin() {
+  float margin = Structure::frustumCullingMargin();
+  if (margin < 0.) return margin;
+
+  // radius quantities without autoscaling set absolute radii, otherwise they are at most the radius
+  if (nodeRadiusQuantityName != "" && !nodeRadiusQuantityAutoscale) return -1.;
+  if (edgeRadiusQuantityName != "" && !edgeRadiusQuantityAutoscale) return -1.;
+  return margin + getRadius();
+}
+
 float CurveNetwork::computeNodeRadiusMultiplierUniform() {
   float scalarQScale = 1.;
   if (nodeRadiusQuantityName != "") {
@@ -108,21 +121,32 @@ float CurveNetwork::computeEdgeRadiusMultiplierUniform() {
   return getRadius() / scalarQScale;
 }
 
+namespace {
+// Set every frame, so their handles are cached by each program
+const render::UniformName uInvProjMatrix("u_invProjMatrix");
+const render::UniformName uViewport("u_viewport");
+const render::UniformName uPointRadius("u_pointRadius");
+const render::UniformName uRadius("u_radius");
+const render::UniformName uBaseColor("u_baseColor");
+} // namespace
+
 // Helper to set uniforms
 void CurveNetwork::setCurveNetworkNodeUniforms(render::ShaderProgram& p) {
   glm::mat4 P = view::getCameraPerspectiveMatrix();
   glm::mat4 Pinv = glm::inverse(P);
-  p.setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
-  p.setUniform("u_viewport", render::engine->getCurrentViewport());
-  p.setUniform("u_pointRadius", computeNodeRadiusMultiplierUniform());
+  p.setUniform(p.findUniform(uInvProjMatrix), glm::value_ptr(Pinv));
+  p.setUniform(p.findUniform(uViewport), render::engine->getCurrentViewport());
+  p.setUniform(p.findUniform(uPointRadius), computeNodeRadiusMultiplierUniform());
+  p.setInstanceCount(isInstanced() ? nInstances() : INVALID_IND_32);
 }
 
 void CurveNetwork::setCurveNetworkEdgeUniforms(render::ShaderProgram& p) {
   glm::mat4 P = view::getCameraPerspectiveMatrix();
   glm::mat4 Pinv = glm::inverse(P);
-  p.setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
-  p.setUniform("u_viewport", render::engine->getCurrentViewport());
-  p.setUniform("u_radius", computeEdgeRadiusMultiplierUniform());
+  p.setUniform(p.findUniform(uInvProjMatrix), glm::value_ptr(Pinv));
+  p.setUniform(p.findUniform(uViewport), render::engine->getCurrentViewport());
+  p.setUniform(p.findUniform(uRadius), computeEdgeRadiusMultiplierUniform());
+  p.setInstanceCount(isInstanced() ? nInstances() : INVALID_IND_32);
 }
 
 void CurveNetwork::draw() {
@@ -145,8 +169,8 @@ void CurveNetwork::draw() {
     setCurveNetworkEdgeUniforms(*edgeProgram);
     setCurveNetworkNodeUniforms(*nodeProgram);
 
-    edgeProgram->setUniform("u_baseColor", getColor());
-    nodeProgram->setUniform("u_baseColor", getColor());
+    edgeProgram->setUniform(edgeProgram->findUniform(uBaseColor), getColor());
+    nodeProgram->setUniform(nodeProgram->findUniform(uBaseColor), getColor());
 
     render::engine->setMaterialUniforms(*edgeProgram, getMaterial());
     render::engine->setMaterialUniforms(*nodeProgram, getMaterial());
@@ -230,6 +254,9 @@ std::vector<std::string> CurveNetwork::addCurveNetworkNodeRules(std::vector<std:
   if (wantsCullPosition()) {
     initRules.push_back("SPHERE_CULLPOS_FROM_CENTER");
   }
+  if (isInstanced()) {
+    initRules.push_back("INSTANCE_TRANSFORM");
+  }
   return initRules;
 }
 std::vector<std::string> CurveNetwork::addCurveNetworkEdgeRules(std::vector<std::string> initRules) {
@@ -245,21 +272,27 @@ std::vector<std::string> CurveNetwork::addCurveNetworkEdgeRules(std::vector<std:
   if (wantsCullPosition()) {
     initRules.push_back("CYLINDER_CULLPOS_FROM_MID");
   }
+  if (isInstanced()) {
+    initRules.push_back("INSTANCE_TRANSFORM");
+  }
   return initRules;
 }
 
 void CurveNetwork::prepare() {
+  POLYSCOPE_PROFILE_SCOPE("prepare");
   if (dominantQuantity != nullptr) {
     return;
   }
 
-  // It no quantity is coloring the network, draw with a default color
+  // It no quantity is coloring the network, draw with a default color (or the instance colors)
+  bool useInstanceColors = !instanceColors.data.empty();
 
   // clang-format off
   nodeProgram = render::engine->requestShader("RAYCAST_SPHERE",  
       render::engine->addMaterialRules(getMaterial(),
         addCurveNetworkNodeRules(
-          {"SHADE_BASECOLOR"}
+          useInstanceColors ? std::vector<std::string>{"SPHERE_PROPAGATE_INSTANCE_COLOR", "SHADE_COLOR"} :
+                              std::vector<std::string>{"SHADE_BASECOLOR"}
         )
       )
     );
@@ -268,7 +301,8 @@ void CurveNetwork::prepare() {
   edgeProgram = render::engine->requestShader("RAYCAST_CYLINDER", 
       render::engine->addMaterialRules(getMaterial(),
         addCurveNetworkEdgeRules(
-          {"SHADE_BASECOLOR"}
+          useInstanceColors ? std::vector<std::string>{"CYLINDER_PROPAGATE_INSTANCE_COLOR", "SHADE_COLOR"} :
+                              std::vector<std::string>{"SHADE_BASECOLOR"}
         )
       )
     );
@@ -280,20 +314,47 @@ void CurveNetwork::prepare() {
   // Fill out the geometry data for the programs
   fillNodeGeometryBuffers(*nodeProgram);
   fillEdgeGeometryBuffers(*edgeProgram);
+  if (useInstanceColors) {
+    nodeProgram->setAttribute("a_instanceColor", instanceColors.getRenderAttributeBuffer());
+    edgeProgram->setAttribute("a_instanceColor", instanceColors.getRenderAttributeBuffer());
+  }
 }
 
 void CurveNetwork::preparePick() {
-  edgeTailInds.ensureHostBufferPopulated();
-  edgeTipInds.ensureHostBufferPopulated();
+  POLYSCOPE_PROFILE_SCOPE("prepare pick");
+
+  if (isInstanced()) {
+    // the whole of each instance is picked as one
+    size_t pickStart = pick::requestPickBufferRange(this, nInstances());
+    std::vector<glm::vec3> instancePickColors(nInstances());
+    for (size_t iInst = 0; iInst < nInstances(); iInst++) {
+      instancePickColors[iInst] = pick::indToVec(pickStart + iInst);
+    }
+
+    nodePickProgram = render::engine->requestShader(
+        "RAYCAST_SPHERE", addCurveNetworkNodeRules({"SPHERE_PROPAGATE_INSTANCE_COLOR"}),
+        render::ShaderReplacementDefaults::Pick);
+    nodePickProgram->setAttribute("a_instanceColor", instancePickColors);
+    fillNodeGeometryBuffers(*nodePickProgram);
+
+    edgePickProgram = render::engine->requestShader(
+        "RAYCAST_CYLINDER", addCurveNetworkEdgeRules({"CYLINDER_PROPAGATE_INSTANCE_COLOR"}),
+        render::ShaderReplacementDefaults::Pick);
+    edgePickProgram->setAttribute("a_instanceColor", instancePickColors);
+    fillEdgeGeometryBuffers(*edgePickProgram);
+    return;
+  }
 
   // Pick index layout (local indices):
   //   |     --- nodes ---     |      --- edges ---      |
   //   ^                       ^
-  //   0                    nNodes()
+  //   0               pickNodeCapacity
+  // Each block may be larger than needed, to leave room for appended nodes and edges.
 
   // Request pick indices
-  size_t totalPickElements = nNodes() + nEdges();
-  size_t pickStart = pick::requestPickBufferRange(this, totalPickElements);
+  pickNodeCapacity = std::max(pickNodeCapacity, nNodes());
+  pickEdgeCapacity = std::max(pickEdgeCapacity, nEdges());
+  pickRangeStart = pick::requestPickBufferRange(this, pickNodeCapacity + pickEdgeCapacity);
 
   { // Set up node picking program
     nodePickProgram =
@@ -302,14 +363,12 @@ void CurveNetwork::preparePick() {
 
     // Fill color buffer with packed point indices
     std::vector<glm::vec3> pickColors;
-    pickColors.reserve(nNodes());
-    for (size_t i = pickStart; i < pickStart + nNodes(); i++) {
-      glm::vec3 val = pick::indToVec(i);
-      pickColors.push_back(pick::indToVec(i));
-    }
+    computeNodePickColors(0, pickColors);
 
     // Store data in buffers
-    nodePickProgram->setAttribute("a_color", pickColors);
+    nodePickColors = render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
+    nodePickColors->setData(pickColors);
+    nodePickProgram->setAttribute("a_color", nodePickColors);
 
     fillNodeGeometryBuffers(*nodePickProgram);
   }
@@ -320,32 +379,52 @@ void CurveNetwork::preparePick() {
                                       render::ShaderReplacementDefaults::Pick);
 
     // Fill color buffer with packed node/edge indices
-    std::vector<glm::vec3> edgePickTail(nEdges());
-    std::vector<glm::vec3> edgePickTip(nEdges());
-    std::vector<glm::vec3> edgePickEdge(nEdges());
-
-    // Fill posiiton and pick index buffers
-    for (size_t iE = 0; iE < nEdges(); iE++) {
-      size_t eTail = edgeTailInds.data[iE];
-      size_t eTip = edgeTipInds.data[iE];
-
-      glm::vec3 colorValTail = pick::indToVec(pickStart + eTail);
-      glm::vec3 colorValTip = pick::indToVec(pickStart + eTip);
-      glm::vec3 colorValEdge = pick::indToVec(pickStart + nNodes() + iE);
-      edgePickTail[iE] = colorValTail;
-      edgePickTip[iE] = colorValTip;
-      edgePickEdge[iE] = colorValEdge;
-    }
-    edgePickProgram->setAttribute("a_color_tail", edgePickTail);
-    edgePickProgram->setAttribute("a_color_tip", edgePickTip);
-    edgePickProgram->setAttribute("a_color_edge", edgePickEdge);
+    std::vector<glm::vec3> edgePickTail, edgePickTip, edgePickEdge;
+    computeEdgePickColors(0, edgePickTail, edgePickTip, edgePickEdge);
+
+    edgePickTailColors = render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
+    edgePickTipColors = render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
+    edgePickEdgeColors = render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
+    edgePickTailColors->setData(edgePickTail);
+    edgePickTipColors->setData(edgePickTip);
+    edgePickEdgeColors->setData(edgePickEdge);
+    edgePickProgram->setAttribute("a_color_tail", edgePickTailColors);
+    edgePickProgram->setAttribute("a_color_tip", edgePickTipColors);
+    edgePickProgram->setAttribute("a_color_edge", edgePickEdgeColors);
 
     fillEdgeGeometryBuffers(*edgePickProgram);
   }
 }
 
+void CurveNetwork::computeNodePickColors(size_t nodeStart, std::vector<glm::vec3>& colors) {
+  colors.clear();
+  colors.reserve(nNodes() - nodeStart);
+  for (size_t iN = nodeStart; iN < nNodes(); iN++) {
+    colors.push_back(pick::indToVec(pickRangeStart + iN));
+  }
+}
+
+void CurveNetwork::computeEdgePickColors(size_t edgeStart, std::vector<glm::vec3>& tailColors,
+                                         std::vector<glm::vec3>& tipColors, std::vector<glm::vec3>& edgeColors) {
+  edgeTailInds.ensureHostBufferPopulated();
+  edgeTipInds.ensureHostBufferPopulated();
+
+  size_t count = nEdges() - edgeStart;
+  tailColors.resize(count);
+  tipColors.resize(count);
+  edgeColors.resize(count);
+  for (size_t iE = edgeStart; iE < nEdges(); iE++) {
+    tailColors[iE - edgeStart] = pick::indToVec(pickRangeStart + edgeTailInds.data[iE]);
+    tipColors[iE - edgeStart] = pick::indToVec(pickRangeStart + edgeTipInds.data[iE]);
+    edgeColors[iE - edgeStart] = pick::indToVec(pickRangeStart + pickNodeCapacity + iE);
+  }
+}
+
 void CurveNetwork::fillNodeGeometryBuffers(render::ShaderProgram& program) {
   program.setAttribute("a_position", nodePositions.getRenderAttributeBuffer());
+  if (isInstanced()) {
+    program.setAttribute("a_instanceTransform", instanceTransforms.getRenderAttributeBuffer());
+  }
 
   bool haveNodeRadiusQuantity = (nodeRadiusQuantityName != "");
   bool haveEdgeRadiusQuantity = (edgeRadiusQuantityName != "");
@@ -365,6 +444,9 @@ void CurveNetwork::fillNodeGeometryBuffers(render::ShaderProgram& program) {
 void CurveNetwork::fillEdgeGeometryBuffers(render::ShaderProgram& program) {
   program.setAttribute("a_position_tail", nodePositions.getIndexedRenderAttributeBuffer(edgeTailInds));
   program.setAttribute("a_position_tip", nodePositions.getIndexedRenderAttributeBuffer(edgeTipInds));
+  if (isInstanced()) {
+    program.setAttribute("a_instanceTransform", instanceTransforms.getRenderAttributeBuffer());
+  }
 
   bool haveNodeRadiusQuantity = (nodeRadiusQuantityName != "");
   bool haveEdgeRadiusQuantity = (edgeRadiusQuantityName != "");
@@ -416,6 +498,11 @@ void CurveNetwork::buildPickUI(const PickResult& rawResult) {
 
   CurveNetworkPickResult result = interpretPickResult(rawResult);
 
+  if (result.instanceIndex >= 0) {
+    ImGui::TextUnformatted(("instance #" + std::to_string(result.instanceIndex)).c_str());
+    return;
+  }
+
   switch (result.elementType) {
   case CurveNetworkElement::NODE: {
     buildNodePickUI(result);
@@ -531,6 +618,104 @@ void CurveNetwork::buildCustomOptionsUI() {
   }
 }
 
+void CurveNetwork::checkCanAppend() {
+  if (!quantities.empty()) {
+    exception("Cannot append to curve network [" + name + "], it has quantities. Remove them first.");
+  }
+}
+
+void CurveNetwork::appendNodesImpl(const std::vector<glm::vec3>& newNodes) {
+  checkCanAppend();
+  if (newNodes.empty()) return;
+
+  nodePositions.ensureHostBufferPopulated();
+  size_t oldSize = nodePositions.data.size();
+  nodePositions.data.insert(nodePositions.data.end(), newNodes.begin(), newNodes.end());
+  nodeDegrees.resize(nodePositions.data.size(), 0);
+
+  // existing edges cannot refer to the new nodes, so the indexed views are unchanged
+  nodePositions.markHostBufferAppended(oldSize);
+
+  // Give the new nodes pick indices, if there is room for them before the edge indices. Otherwise the pick programs
+  // are rebuilt with twice the room, so the cost of appending stays proportional to the number of appended nodes.
+  // (Instances are picked as a whole, so instanced pick colors do not change.)
+  if (nodePickProgram && !isInstanced()) {
+    if (nNodes() <= pickNodeCapacity) {
+      std::vector<glm::vec3> newPickColors;
+      computeNodePickColors(oldSize, newPickColors);
+      nodePickColors->setDataRange(newPickColors, oldSize);
+    } else {
+      pickNodeCapacity = 2 * nNodes();
+      nodePickProgram.reset();
+      edgePickProgram.reset();
+    }
+  }
+
+  if (oldSize == 0 || isInstanced()) {
+    updateObjectSpaceBounds();
+  } else {
+    growObjectSpaceBounds(newNodes);
+  }
+  updateStructureExtents();
+}
+
+void CurveNetwork::appendEdgesImpl(const std::vector<std::array<size_t, 2>>& newEdges) {
+  checkCanAppend();
+  if (newEdges.empty()) return;
+
+  size_t maxInd = nNodes();
+  size_t oldNEdges = nEdges();
+  for (size_t iE = 0; iE < newEdges.size(); iE++) {
+    size_t nA = newEdges[iE][0];
+    size_t nB = newEdges[iE][1];
+    if (nA >= maxInd || nB >= maxInd) {
+      exception("CurveNetwork [" + name + "] appended edge " + std::to_string(oldNEdges + iE) +
+                " has bad node indices { " + std::to_string(nA) + " , " + std::to_string(nB) + " } but there are " +
+                std::to_string(maxInd) + " nodes.");
+    }
+  }
+
+  edgeTailInds.ensureHostBufferPopulated();
+  edgeTipInds.ensureHostBufferPopulated();
+  for (const std::array<size_t, 2>& edge : newEdges) {
+    edgeTailInds.data.push_back(edge[0]);
+    edgeTipInds.data.push_back(edge[1]);
+    nodeDegrees[edge[0]]++;
+    nodeDegrees[edge[1]]++;
+  }
+  edgeTailInds.markHostBufferAppended(oldNEdges);
+  edgeTipInds.markHostBufferAppended(oldNEdges);
+
+  // extend the node positions as viewed through the edges
+  nodePositions.updateIndexedViewAppended(edgeTailInds, oldNEdges);
+  nodePositions.updateIndexedViewAppended(edgeTipInds, oldNEdges);
+
+  // if the edge centers have already been computed, only compute the new ones
+  if (edgeCenters.hasData()) {
+    edgeCenters.ensureHostBufferPopulated();
+    nodePositions.ensureHostBufferPopulated();
+    for (const std::array<size_t, 2>& edge : newEdges) {
+      edgeCenters.data.push_back(0.5f * (nodePositions.data[edge[0]] + nodePositions.data[edge[1]]));
+    }
+    edgeCenters.markHostBufferAppended(oldNEdges);
+  }
+
+  // Give the new edges pick indices, as for nodes in appendNodesImpl()
+  if (edgePickProgram && !isInstanced()) {
+    if (nEdges() <= pickEdgeCapacity) {
+      std::vector<glm::vec3> newTail, newTip, newEdge;
+      computeEdgePickColors(oldNEdges, newTail, newTip, newEdge);
+      edgePickTailColors->setDataRange(newTail, oldNEdges);
+      edgePickTipColors->setDataRange(newTip, oldNEdges);
+      edgePickEdgeColors->setDataRange(newEdge, oldNEdges);
+    } else {
+      pickEdgeCapacity = 2 * nEdges();
+      nodePickProgram.reset();
+      edgePickProgram.reset();
+    }
+  }
+}
+
 void CurveNetwork::updateObjectSpaceBounds() {
   nodePositions.ensureHostBufferPopulated();
 
@@ -550,6 +735,8 @@ void CurveNetwork::updateObjectSpaceBounds() {
     lengthScale = std::max(lengthScale, glm::length2(p - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+
+  applyInstancesToObjectSpaceBounds(instanceTransforms.data);
 }
 
 CurveNetworkPickResult CurveNetwork::interpretPickResult(const PickResult& rawResult) {
@@ -562,12 +749,20 @@ CurveNetworkPickResult CurveNetwork::interpretPickResult(const PickResult& rawRe
 
   CurveNetworkPickResult result;
 
+  if (isInstanced()) {
+    if (rawResult.localIndex >= nInstances()) exception("Bad pick index in curve network");
+    result.elementType = CurveNetworkElement::NODE;
+    result.index = -1;
+    result.instanceIndex = rawResult.localIndex;
+    return result;
+  }
+
   if (rawResult.localIndex < nNodes()) {
     result.elementType = CurveNetworkElement::NODE;
     result.index = rawResult.localIndex;
-  } else if (rawResult.localIndex < nNodes() + nEdges()) {
+  } else if (rawResult.localIndex >= pickNodeCapacity && rawResult.localIndex - pickNodeCapacity < nEdges()) {
     result.elementType = CurveNetworkElement::EDGE;
-    result.index = rawResult.localIndex - nNodes();
+    result.index = rawResult.localIndex - pickNodeCapacity;
 
     // compute the t \in [0,1] along the edge
     int32_t iStart = edgeTailInds.getValue(result.index);
@@ -582,6 +777,43 @@ CurveNetworkPickResult CurveNetwork::interpretPickResult(const PickResult& rawRe
   return result;
 }
 
+void CurveNetwork::setInstances(const std::vector<glm::mat4>& transforms) {
+  if (transforms.empty()) exception("curve network [" + name + "] needs at least one instance, use clearInstances()");
+  bool sameCount = transforms.size() == nInstances();
+
+  instanceTransforms.data = packInstanceTransforms(transforms);
+  instanceTransforms.markHostBufferUpdated();
+
+  if (sameCount) {
+    // the programs are unchanged, only the transforms need uploading
+    updateObjectSpaceBounds();
+    requestRedraw();
+    return;
+  }
+
+  instanceColors.data.clear(); // no longer one per instance
+  refresh();
+}
+
+void CurveNetwork::clearInstances() {
+  if (!isInstanced()) return;
+  instanceTransforms.data.clear();
+  instanceColors.data.clear();
+  refresh();
+}
+
+bool CurveNetwork::isInstanced() { return !instanceTransforms.data.empty(); }
+
+size_t CurveNetwork::nInstances() { return instanceTransforms.data.size(); }
+
+void CurveNetwork::clearInstanceColors() {
+  if (instanceColors.data.empty()) return;
+  instanceColors.data.clear();
+  nodeProgram.reset();
+  edgeProgram.reset();
+  requestRedraw();
+}
+
 CurveNetwork* CurveNetwork::setColor(glm::vec3 newVal) {
   color = newVal;
   polyscope::requestRedraw();
@@ -16,6 +16,8 @@ namespace polyscope {
 CurveNetworkVectorQuantity::CurveNetworkVectorQuantity(std::string name, CurveNetwork& network_)
     : CurveNetworkQuantity(name, network_) {}
 
+bool CurveNetworkVectorQuantity::isDrawnWithinParentBounds() { return false; }
+
 
 // ========================================================
 // ==========           Node Vector            ==========
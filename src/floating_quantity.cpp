@@ -29,4 +29,6 @@ void FloatingQuantity::buildUI() {
   }
 }
 
+bool FloatingQuantity::isDrawnWithinParentBounds() { return false; }
+
 } // namespace polyscope
@@ -31,6 +31,7 @@ bool invokeUserCallbackForNestedShow = false;
 bool giveFocusOnShow = false;
 bool hideWindowAfterShow = true;
 bool warnForInvalidValues = true;
+float scalarStatisticsRefreshPeriod = 0.5;
 bool displayMessagePopups = true;
 
 bool screenshotTransparency = true;
@@ -57,6 +58,17 @@ int ssaaFactor = 1;
 TransparencyMode transparencyMode = TransparencyMode::None;
 int transparencyRenderPasses = 8;
 
+// Picking
+bool integerPickBuffer = false;
+
+// Shaders
+std::string shaderCacheDirectory = "";
+float shaderWarmupMillisecondsPerFrame = 4.;
+
+// Rendering
+bool sortDrawCalls = true;
+bool frustumCulling = true;
+
 // === Advanced ImGui configuration
 
 bool buildGui = true;
@@ -79,5 +91,7 @@ bool enableRenderErrorChecks = false;
 bool enableRenderErrorChecks = true;
 #endif
 
+bool enableProfiler = false;
+
 } // namespace options
 } // namespace polyscope
@@ -2,37 +2,41 @@
 
 #include "polyscope/pick.h"
 
+#include "polyscope/parallel_helpers.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 
+#include <algorithm>
 #include <limits>
+#include <map>
 #include <tuple>
 #include <unordered_map>
 
 namespace polyscope {
 
+namespace {
+bool pickBufferIsInteger() { return render::engine->pickColorBuffer->getType() == RenderBufferType::UInt2; }
+} // namespace
+
 PickResult pickAtScreenCoords(glm::vec2 screenCoords) {
   int xInd, yInd;
   glm::ivec2 bufferInds = view::screenCoordsToBufferIndsVec(screenCoords);
   return pickAtBufferInds(bufferInds);
 }
 
-PickResult pickAtBufferInds(glm::ivec2 bufferInds) {
-  PickResult result;
-
-  // Query the pick buffer
-  // (this necessarily renders to pickFrameBuffer)
-  std::tuple<Structure*, Quantity*, uint64_t> rawPickResult = pick::evaluatePickQueryFull(bufferInds.x, bufferInds.y);
+namespace {
 
-  // Query the depth buffer populated above
-  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
-  float clipDepth = pickFramebuffer->readDepth(bufferInds.x, view::bufferHeight - bufferInds.y);
+// Transcribe a raw pick query into a PickResult, given the world position under the pixel
+PickResult buildPickResult(glm::ivec2 bufferInds, const std::tuple<Structure*, Quantity*, uint64_t>& rawPickResult,
+                           glm::vec3 position) {
+  PickResult result;
 
   // Transcribe result into return tuple
   result.structure = std::get<0>(rawPickResult);
   result.quantity = std::get<1>(rawPickResult);
   result.bufferInds = bufferInds;
   result.screenCoords = view::bufferIndsToScreenCoords(bufferInds);
-  result.position = view::screenCoordsAndDepthToWorldPosition(result.screenCoords, clipDepth);
+  result.position = position;
   result.depth = glm::length(result.position - view::getCameraWorldPosition());
 
 
@@ -61,6 +65,283 @@ PickResult pickAtBufferInds(glm::ivec2 bufferInds) {
   return result;
 }
 
+} // namespace
+
+PickResult pickAtBufferInds(glm::ivec2 bufferInds) {
+
+  // Query the pick buffer
+  // (this necessarily renders to pickFrameBuffer)
+  std::tuple<Structure*, Quantity*, uint64_t> rawPickResult = pick::evaluatePickQueryFull(bufferInds.x, bufferInds.y);
+
+  // Query the depth buffer populated above
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+  float clipDepth = pickFramebuffer->readDepth(bufferInds.x, view::bufferHeight - bufferInds.y);
+
+  glm::vec2 screenCoords = view::bufferIndsToScreenCoords(bufferInds);
+  glm::vec3 position = view::screenCoordsAndDepthToWorldPosition(screenCoords, clipDepth);
+  return buildPickResult(bufferInds, rawPickResult, position);
+}
+
+std::vector<PickResult> pickAtScreenCoords(const std::vector<glm::vec2>& screenCoords) {
+  std::vector<glm::ivec2> bufferInds(screenCoords.size());
+  for (size_t i = 0; i < screenCoords.size(); i++) {
+    bufferInds[i] = view::screenCoordsToBufferIndsVec(screenCoords[i]);
+  }
+  return pickAtBufferInds(bufferInds);
+}
+
+std::vector<PickResult> pickAtBufferInds(const std::vector<glm::ivec2>& bufferInds) {
+  size_t nQueries = bufferInds.size();
+
+  std::tuple<Structure*, Quantity*, uint64_t> noPick(nullptr, nullptr, 0);
+  std::vector<std::tuple<Structure*, Quantity*, uint64_t>> rawPickResults(nQueries, noPick);
+  std::vector<glm::vec2> screenCoords(nQueries);
+  std::vector<float> clipDepths(nQueries, 1.);
+
+  // Gather the queries which lie in the buffer, in framebuffer coordinates
+  std::vector<size_t> readQueries;
+  std::vector<glm::ivec2> readInds;
+  for (size_t i = 0; i < nQueries; i++) {
+    screenCoords[i] = view::bufferIndsToScreenCoords(bufferInds[i]);
+    if (bufferInds[i].x < 0 || bufferInds[i].x >= view::bufferWidth || bufferInds[i].y < 0 ||
+        bufferInds[i].y >= view::bufferHeight) {
+      continue;
+    }
+    readQueries.push_back(i);
+    readInds.push_back(glm::ivec2{bufferInds[i].x, view::bufferHeight - bufferInds[i].y});
+  }
+
+  // Render once, then read back just the queried pixels
+  if (!readInds.empty() && pick::renderPickBuffer()) {
+    render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+    std::vector<uint64_t> globalInds(readInds.size());
+    if (pickBufferIsInteger()) {
+      std::vector<std::array<uint32_t, 2>> pickValues = pickFramebuffer->readUInt2Pixels(readInds);
+      for (size_t iRead = 0; iRead < readInds.size(); iRead++) {
+        globalInds[iRead] = pick::uvec2ToInd(glm::uvec2{pickValues[iRead][0], pickValues[iRead][1]});
+      }
+    } else {
+      std::vector<std::array<float, 4>> pickValues = pickFramebuffer->readFloat4Pixels(readInds);
+      for (size_t iRead = 0; iRead < readInds.size(); iRead++) {
+        const std::array<float, 4>& val = pickValues[iRead];
+        globalInds[iRead] = pick::vecToInd(glm::vec3{val[0], val[1], val[2]});
+      }
+    }
+    std::vector<float> readDepths = pickFramebuffer->readDepthPixels(readInds);
+
+    for (size_t iRead = 0; iRead < readQueries.size(); iRead++) {
+      size_t i = readQueries[iRead];
+      rawPickResults[i] = pick::globalIndexToLocal(globalInds[iRead]);
+      clipDepths[i] = readDepths[iRead];
+    }
+  }
+
+  std::vector<glm::vec3> positions = view::screenCoordsAndDepthToWorldPosition(screenCoords, clipDepths);
+
+  std::vector<PickResult> results(nQueries);
+  for (size_t i = 0; i < nQueries; i++) {
+    results[i] = buildPickResult(bufferInds[i], rawPickResults[i], positions[i]);
+  }
+  return results;
+}
+
+// == Asynchronous picking
+namespace {
+
+// The range containing a global index (the last range starting at or before it), or ranges.end() if there is none
+std::map<uint64_t, pick::PickBufferRange>::const_iterator
+findPickRange(const std::map<uint64_t, pick::PickBufferRange>& ranges, uint64_t globalInd) {
+  auto it = ranges.upper_bound(globalInd);
+  if (it == ranges.begin()) return ranges.end();
+  --it;
+  if (globalInd >= it->second.end) return ranges.end();
+  return it;
+}
+
+} // namespace
+
+AsyncPickResult pickAtScreenCoordsAsync(glm::vec2 screenCoords) {
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+  pick::AsyncPickQuery& query = state::globalContext.asyncPickQuery;
+
+  // Resolve the query in flight, if it has finished
+  render::PixelReadResult pixel;
+  if (state::globalContext.asyncPickInFlight && pickFramebuffer->pollAsyncReadPixel(pixel)) {
+    state::globalContext.asyncPickInFlight = false;
+
+    uint64_t globalInd;
+    if (pickBufferIsInteger()) {
+      globalInd = pick::uvec2ToInd(glm::uvec2{pixel.uint2[0], pixel.uint2[1]});
+    } else {
+      globalInd = pick::vecToInd(glm::vec3{pixel.float4[0], pixel.float4[1], pixel.float4[2]});
+    }
+    std::tuple<Structure*, Quantity*, uint64_t> rawPickResult(nullptr, nullptr, 0);
+    if (query.pickRangesGeneration == state::globalContext.pickRangesGeneration) { // (otherwise ranges have moved)
+      rawPickResult = pick::globalIndexToLocal(globalInd);
+    }
+
+    glm::vec2 queryScreenCoords = view::bufferIndsToScreenCoords(query.bufferInds);
+    glm::vec3 position =
+        view::screenCoordsAndDepthToWorldPosition(queryScreenCoords, pixel.depth, query.viewMat, query.projMat);
+
+    // (unless a later query outside of the buffer has already been answered)
+    if (query.frameIndex >= state::globalContext.lastAsyncPickFrameIndex) {
+      state::globalContext.lastAsyncPickResult.isAvailable = true;
+      state::globalContext.lastAsyncPickResult.pick = buildPickResult(query.bufferInds, rawPickResult, position);
+      state::globalContext.lastAsyncPickFrameIndex = query.frameIndex;
+    }
+  }
+
+  // Queries outside of the buffer hit nothing, answer them immediately
+  glm::ivec2 bufferInds = view::screenCoordsToBufferIndsVec(screenCoords);
+  if (bufferInds.x < 0 || bufferInds.x >= view::bufferWidth || bufferInds.y < 0 ||
+      bufferInds.y >= view::bufferHeight) {
+    std::tuple<Structure*, Quantity*, uint64_t> noPick(nullptr, nullptr, 0);
+    glm::vec3 position = view::screenCoordsAndDepthToWorldPosition(screenCoords, 1.);
+    state::globalContext.lastAsyncPickResult.isAvailable = true;
+    state::globalContext.lastAsyncPickResult.pick = buildPickResult(bufferInds, noPick, position);
+    state::globalContext.lastAsyncPickFrameIndex = state::globalContext.frameIndex;
+    AsyncPickResult result = state::globalContext.lastAsyncPickResult;
+    result.framesOld = 0;
+    return result;
+  }
+
+  // Start a new query, unless the last one is still going
+  if (!state::globalContext.asyncPickInFlight && pick::renderPickBuffer()) {
+    query.bufferInds = bufferInds;
+    query.viewMat = view::getCameraViewMatrix();
+    query.projMat = view::getCameraPerspectiveMatrix();
+    query.frameIndex = state::globalContext.frameIndex;
+    query.pickRangesGeneration = state::globalContext.pickRangesGeneration;
+    pickFramebuffer->requestAsyncReadPixel(query.bufferInds.x, view::bufferHeight - query.bufferInds.y);
+    state::globalContext.asyncPickInFlight = true;
+  }
+
+  AsyncPickResult result = state::globalContext.lastAsyncPickResult;
+  result.framesOld = state::globalContext.frameIndex - state::globalContext.lastAsyncPickFrameIndex;
+  return result;
+}
+
+// == Region picking
+namespace {
+
+// Even-odd rule
+bool pointInPolygon(glm::vec2 p, const std::vector<glm::vec2>& polygon) {
+  bool inside = false;
+  for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+    const glm::vec2& a = polygon[i];
+    const glm::vec2& b = polygon[j];
+    if ((a.y > p.y) != (b.y > p.y) && p.x < (b.x - a.x) * (p.y - a.y) / (b.y - a.y) + a.x) {
+      inside = !inside;
+    }
+  }
+  return inside;
+}
+
+// Pick everything in the block of buffer indices between lower and upper (inclusive). If polygon is non-null, only
+// pixels whose screen coordinates lie inside of it are kept.
+std::vector<PickRegionResult> pickInBufferRegion(glm::ivec2 lower, glm::ivec2 upper,
+                                                 const std::vector<glm::vec2>* polygon) {
+
+  // Convert to framebuffer rows, which count from the bottom (as in evaluatePickQueryFull())
+  // and clamp to the buffer, so the readback never leaves it
+  int xStart = std::max(lower.x, 0);
+  int xEnd = std::min(upper.x, view::bufferWidth - 1);
+  int yStart = std::max(view::bufferHeight - upper.y, 0);
+  int yEnd = std::min(view::bufferHeight - lower.y, view::bufferHeight - 1);
+  int w = xEnd - xStart + 1;
+  int h = yEnd - yStart + 1;
+  if (w <= 0 || h <= 0) return {};
+
+  if (!pick::renderPickBuffer()) return {};
+  bool integerPick = pickBufferIsInteger();
+  std::vector<float> floatPixels;
+  std::vector<uint32_t> intPixels;
+  if (integerPick) {
+    intPixels = render::engine->pickFramebuffer->readUInt2Region(xStart, yStart, w, h);
+  } else {
+    floatPixels = render::engine->pickFramebuffer->readFloat4Region(xStart, yStart, w, h);
+  }
+
+  // Decode in parallel, each chunk gathering the distinct global indices it sees
+  size_t nPixels = static_cast<size_t>(w) * h;
+  std::vector<std::vector<uint64_t>> chunkInds(parallelChunkCount(nPixels));
+  parallelForChunks(nPixels, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    std::vector<uint64_t>& inds = chunkInds[iChunk];
+    for (size_t iPix = iStart; iPix < iEnd; iPix++) {
+      uint64_t globalInd;
+      if (integerPick) {
+        globalInd = pick::uvec2ToInd(glm::uvec2{intPixels[2 * iPix], intPixels[2 * iPix + 1]});
+      } else {
+        const float* px = &floatPixels[4 * iPix];
+        globalInd = pick::vecToInd(glm::vec3{px[0], px[1], px[2]});
+      }
+      if (globalInd == 0) continue;                             // background
+      if (!inds.empty() && inds.back() == globalInd) continue; // neighboring pixels usually agree
+      if (polygon != nullptr) {
+        int xInd = xStart + static_cast<int>(iPix % w);
+        int yInd = view::bufferHeight - (yStart + static_cast<int>(iPix / w));
+        if (!pointInPolygon(view::bufferIndsToScreenCoords(xInd, yInd), *polygon)) continue;
+      }
+      inds.push_back(globalInd);
+    }
+    std::sort(inds.begin(), inds.end());
+    inds.erase(std::unique(inds.begin(), inds.end()), inds.end());
+  });
+
+  std::vector<uint64_t> globalInds;
+  for (std::vector<uint64_t>& inds : chunkInds) {
+    globalInds.insert(globalInds.end(), inds.begin(), inds.end());
+  }
+  std::sort(globalInds.begin(), globalInds.end());
+  globalInds.erase(std::unique(globalInds.begin(), globalInds.end()), globalInds.end());
+
+  // Group by owner. Each owner has one contiguous range of indices, so in sorted order the groups are runs.
+  std::vector<PickRegionResult> results;
+  for (uint64_t globalInd : globalInds) {
+    std::tuple<Structure*, Quantity*, uint64_t> localPick = pick::globalIndexToLocal(globalInd);
+    Structure* structure = std::get<0>(localPick);
+    Quantity* quantity = std::get<1>(localPick);
+    if (structure == nullptr) continue;
+
+    if (results.empty() || results.back().structure != structure || results.back().quantity != quantity) {
+      results.emplace_back();
+      PickRegionResult& newResult = results.back();
+      newResult.structure = structure;
+      newResult.quantity = quantity;
+      newResult.structureHandle = structure->getWeakHandle<Structure>();
+      newResult.structureType = structure->subtypeName;
+      newResult.structureName = structure->name;
+      if (quantity != nullptr) newResult.quantityName = quantity->name;
+    }
+    results.back().localIndices.push_back(std::get<2>(localPick));
+  }
+
+  return results;
+}
+
+} // namespace
+
+std::vector<PickRegionResult> pickInRect(glm::vec2 screenCornerA, glm::vec2 screenCornerB) {
+  glm::ivec2 indsA = view::screenCoordsToBufferIndsVec(screenCornerA);
+  glm::ivec2 indsB = view::screenCoordsToBufferIndsVec(screenCornerB);
+  return pickInBufferRegion(glm::min(indsA, indsB), glm::max(indsA, indsB), nullptr);
+}
+
+std::vector<PickRegionResult> pickInPolygon(const std::vector<glm::vec2>& screenPolygon) {
+  if (screenPolygon.size() < 3) return {};
+
+  glm::vec2 lower = screenPolygon[0];
+  glm::vec2 upper = screenPolygon[0];
+  for (const glm::vec2& p : screenPolygon) {
+    lower = glm::min(lower, p);
+    upper = glm::max(upper, p);
+  }
+
+  return pickInBufferRegion(view::screenCoordsToBufferIndsVec(lower), view::screenCoordsToBufferIndsVec(upper),
+                            &screenPolygon);
+}
+
 // == Manage stateful picking
 
 void resetSelection() {
@@ -118,6 +399,10 @@ uint64_t requestPickBufferRange(Structure* requestingStructure, Quantity* reques
               "enumerating structure elements for pick buffer.)");
   }
 
+  // A new request replaces any range the requester already holds
+  if (requestingStructure != nullptr) releasePickBufferRange(requestingStructure);
+  if (requestingQuantity != nullptr) releasePickBufferRange(requestingQuantity);
+
   uint64_t ret = state::globalContext.nextPickBufferInd;
   state::globalContext.nextPickBufferInd += count;
   if (requestingStructure != nullptr) {
@@ -128,6 +413,11 @@ uint64_t requestPickBufferRange(Structure* requestingStructure, Quantity* reques
     state::globalContext.quantityRanges[requestingQuantity] =
         std::make_tuple(ret, state::globalContext.nextPickBufferInd);
   }
+  if (count > 0) {
+    state::globalContext.pickRangesByStart[ret] =
+        PickBufferRange{state::globalContext.nextPickBufferInd, requestingStructure, requestingQuantity};
+  }
+  state::globalContext.pickRangesGeneration++;
   return ret;
 }
 } // namespace
@@ -140,42 +430,40 @@ uint64_t requestPickBufferRange(Quantity* requestingQuantity, uint64_t count) {
   return requestPickBufferRange(nullptr, requestingQuantity, count);
 }
 
-// == Helpers
-
-std::tuple<Structure*, Quantity*, uint64_t> globalIndexToLocal(uint64_t globalInd) {
+void releasePickBufferRange(Structure* structure) {
+  auto it = state::globalContext.structureRanges.find(structure);
+  if (it == state::globalContext.structureRanges.end()) return;
+  state::globalContext.pickRangesByStart.erase(std::get<0>(it->second));
+  state::globalContext.structureRanges.erase(it);
+  state::globalContext.pickRangesGeneration++;
+}
 
-  // ONEDAY: this could be asymptotically better if we cared
+void releasePickBufferRange(Quantity* quantity) {
+  auto it = state::globalContext.quantityRanges.find(quantity);
+  if (it == state::globalContext.quantityRanges.end()) return;
+  state::globalContext.pickRangesByStart.erase(std::get<0>(it->second));
+  state::globalContext.quantityRanges.erase(it);
+  state::globalContext.pickRangesGeneration++;
+}
 
-  // Loop through the ranges that we have allocated to find the one corresponding to this structure.
-  for (const auto& x : state::globalContext.structureRanges) {
+// == Helpers
 
-    Structure* structure = x.first;
-    uint64_t rangeStart = std::get<0>(x.second);
-    uint64_t rangeEnd = std::get<1>(x.second);
+std::tuple<Structure*, Quantity*, uint64_t> globalIndexToLocal(uint64_t globalInd) {
 
-    if (globalInd >= rangeStart && globalInd < rangeEnd) {
-      return {structure, nullptr, globalInd - rangeStart};
-    }
+  const std::map<uint64_t, PickBufferRange>& ranges = state::globalContext.pickRangesByStart;
+  auto it = findPickRange(ranges, globalInd);
+  if (it == ranges.end()) {
+    return {nullptr, nullptr, 0};
   }
 
+  uint64_t rangeStart = it->first;
+  const PickBufferRange& range = it->second;
 
-  // Look through quantity ranges
-  for (const auto& x : state::globalContext.quantityRanges) {
-
-    Quantity* quantity = x.first;
-    uint64_t rangeStart = std::get<0>(x.second);
-    uint64_t rangeEnd = std::get<1>(x.second);
-
-    if (globalInd >= rangeStart && globalInd < rangeEnd) {
-
-      // look up the structure that goes with this quantity
-      Structure* structure = &quantity->parent;
-
-      return {structure, quantity, globalInd - rangeStart};
-    }
+  if (range.quantity != nullptr) {
+    // look up the structure that goes with this quantity
+    return {&range.quantity->parent, range.quantity, globalInd - rangeStart};
   }
-
-  return {nullptr, nullptr, 0};
+  return {range.structure, nullptr, globalInd - rangeStart};
 }
 
 uint64_t localIndexToGlobal(std::tuple<Structure*, Quantity*, uint64_t> localPick) {
@@ -212,15 +500,41 @@ std::pair<Structure*, uint64_t> pickAtScreenCoords(glm::vec2 screenCoords) {
 
 std::pair<Structure*, uint64_t> pickAtBufferCoords(int xPos, int yPos) { return evaluatePickQuery(xPos, yPos); }
 
-std::tuple<Structure*, Quantity*, uint64_t> evaluatePickQueryFull(int xPos, int yPos) {
+namespace {
 
-  // NOTE: hack used for debugging: if xPos == yPos == -1 we do a pick render but do not query the value.
+PickBufferCacheKey currentPickBufferCacheKey() {
+  PickBufferCacheKey key;
+  key.sceneGeneration = state::globalContext.sceneGeneration;
+  key.framebufferID = render::engine->pickFramebuffer->getUniqueID();
+  key.width = view::bufferWidth;
+  key.height = view::bufferHeight;
+  key.viewMat = view::getCameraViewMatrix();
+  key.projMat = view::getCameraPerspectiveMatrix();
+  return key;
+}
 
-  // Be sure not to pick outside of buffer
-  if (xPos < -1 || xPos >= view::bufferWidth || yPos < -1 || yPos >= view::bufferHeight) {
-    return {nullptr, nullptr, 0};
+bool operator==(const PickBufferCacheKey& a, const PickBufferCacheKey& b) {
+  return a.sceneGeneration == b.sceneGeneration && a.framebufferID == b.framebufferID && a.width == b.width &&
+         a.height == b.height && a.viewMat == b.viewMat && a.projMat == b.projMat;
+}
+
+} // namespace
+
+void invalidatePickBuffer() {
+  state::globalContext.pickBufferCacheValid = false;
+  state::globalContext.asyncPickInFlight = false;
+}
+
+bool renderPickBuffer() {
+
+  // Reuse the last render if nothing has changed since
+  PickBufferCacheKey key = currentPickBufferCacheKey();
+  if (state::globalContext.pickBufferCacheValid && state::globalContext.pickBufferCacheKey == key) {
+    return true;
   }
+  state::globalContext.pickBufferCacheValid = false;
 
+  POLYSCOPE_PROFILE_GPU_SCOPE("draw pick");
   render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
 
   render::engine->setDepthMode(DepthMode::Less);
@@ -229,29 +543,58 @@ std::tuple<Structure*, Quantity*, uint64_t> evaluatePickQueryFull(int xPos, int
   pickFramebuffer->resize(view::bufferWidth, view::bufferHeight);
   pickFramebuffer->setViewport(0, 0, view::bufferWidth, view::bufferHeight);
   pickFramebuffer->clearColor = glm::vec3{0., 0., 0.};
-  if (!pickFramebuffer->bindForRendering()) return {nullptr, nullptr, 0};
+  if (!pickFramebuffer->bindForRendering()) return false;
   pickFramebuffer->clear();
+  render::engine->updateFrameUniforms();
 
-  // Render pick buffer
+  // Render pick buffer (queued like the scene draws, the delayed draws below go on top)
+  render::engine->beginRenderQueue();
   for (auto& cat : state::structures) {
     for (auto& x : cat.second) {
+      if (!x.second->mayBeInView()) continue;
+      POLYSCOPE_PROFILE_SCOPE(x.second->name);
       x.second->drawPick();
     }
   }
+  render::engine->endRenderQueue();
   for (auto& catMap : state::structures) {
     for (auto& s : catMap.second) {
       s.second->drawPickDelayed();
     }
   }
 
+  // Drawing may have lazily populated buffers and requested a redraw, so take the key as it stands after the render
+  state::globalContext.pickBufferCacheKey = currentPickBufferCacheKey();
+  state::globalContext.pickBufferCacheValid = true;
+
+  return true;
+}
+
+std::tuple<Structure*, Quantity*, uint64_t> evaluatePickQueryFull(int xPos, int yPos) {
+
+  // NOTE: hack used for debugging: if xPos == yPos == -1 we do a pick render but do not query the value.
+
+  // Be sure not to pick outside of buffer
+  if (xPos < -1 || xPos >= view::bufferWidth || yPos < -1 || yPos >= view::bufferHeight) {
+    return {nullptr, nullptr, 0};
+  }
+
+  if (!renderPickBuffer()) return {nullptr, nullptr, 0};
 
   if (xPos == -1 || yPos == -1) {
     return {nullptr, nullptr, 0};
   }
 
   // Read from the pick buffer
-  std::array<float, 4> result = pickFramebuffer->readFloat4(xPos, view::bufferHeight - yPos);
-  uint64_t globalInd = pick::vecToInd(glm::vec3{result[0], result[1], result[2]});
+  render::FrameBuffer* pickFramebuffer = render::engine->pickFramebuffer.get();
+  uint64_t globalInd;
+  if (pickBufferIsInteger()) {
+    std::array<uint32_t, 2> result = pickFramebuffer->readUInt2(xPos, view::bufferHeight - yPos);
+    globalInd = pick::uvec2ToInd(glm::uvec2{result[0], result[1]});
+  } else {
+    std::array<float, 4> result = pickFramebuffer->readFloat4(xPos, view::bufferHeight - yPos);
+    globalInd = pick::vecToInd(glm::vec3{result[0], result[1], result[2]});
+  }
 
   return pick::globalIndexToLocal(globalInd);
 }
@@ -0,0 +1,631 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/ply_loader.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/parallel_helpers.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/utilities.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace polyscope {
+
+namespace {
+
+// == A minimal .ply reader
+//
+// The whole file is read in to memory in a single transfer. For binary files, element records are then decoded in
+// parallel straight from that buffer in to the flat arrays we hand to the structures, with no intermediate per-property
+// storage. Elements with list properties (faces) need one cheap sequential pass to locate the records, after which
+// decoding is parallel too. Ascii files are tokenized sequentially, then share the same decoding path.
+
+enum class PlyFormat { Ascii, BinaryLittleEndian, BinaryBigEndian };
+enum class PlyType { Int8, UInt8, Int16, UInt16, Int32, UInt32, Float32, Float64 };
+
+size_t plyTypeSize(PlyType t) {
+  switch (t) {
+  case PlyType::Int8:
+  case PlyType::UInt8:
+    return 1;
+  case PlyType::Int16:
+  case PlyType::UInt16:
+    return 2;
+  case PlyType::Int32:
+  case PlyType::UInt32:
+  case PlyType::Float32:
+    return 4;
+  case PlyType::Float64:
+    return 8;
+  }
+  return 0;
+}
+
+PlyType parsePlyType(const std::string& s) {
+  if (s == "char" || s == "int8") return PlyType::Int8;
+  if (s == "uchar" || s == "uint8") return PlyType::UInt8;
+  if (s == "short" || s == "int16") return PlyType::Int16;
+  if (s == "ushort" || s == "uint16") return PlyType::UInt16;
+  if (s == "int" || s == "int32") return PlyType::Int32;
+  if (s == "uint" || s == "uint32") return PlyType::UInt32;
+  if (s == "float" || s == "float32") return PlyType::Float32;
+  if (s == "double" || s == "float64") return PlyType::Float64;
+  exception("ply loader: unrecognized property type [" + s + "]");
+  return PlyType::Float32;
+}
+
+bool plyTypeIsInteger(PlyType t) { return t != PlyType::Float32 && t != PlyType::Float64; }
+
+bool hostIsLittleEndian() {
+  const uint16_t probe = 1;
+  unsigned char firstByte;
+  std::memcpy(&firstByte, &probe, 1);
+  return firstByte == 1;
+}
+
+struct PlyProperty {
+  std::string name;
+  PlyType type;
+  bool isList = false;
+  PlyType listCountType = PlyType::UInt8;
+};
+
+struct PlyElement {
+  std::string name;
+  size_t count = 0;
+  std::vector<PlyProperty> properties;
+
+  // Where each record lives in the file. Locations are byte offsets for binary files, and token indices for ascii
+  // files. Records have a fixed stride unless the element has lists whose lengths vary from record to record (e.g. a
+  // mix of triangles and quads), in which case we store where each record starts.
+  bool hasLists = false;
+  bool fixedStride = true;
+  size_t dataBegin = 0;
+  size_t recordStride = 0;
+  std::vector<size_t> propertyOffsets; // within a record, only if fixedStride
+  std::vector<size_t> recordStarts;    // count, only if !fixedStride
+
+  size_t propertyIndex(const std::string& propName) const {
+    for (size_t i = 0; i < properties.size(); i++) {
+      if (properties[i].name == propName) return i;
+    }
+    return INVALID_IND;
+  }
+};
+
+struct PlyFile {
+  std::string filename;
+  PlyFormat format = PlyFormat::Ascii;
+  bool swapBytes = false;
+  std::vector<PlyElement> elements;
+
+  std::vector<char> bytes;          // raw file contents (binary files)
+  std::vector<double> asciiTokens; // parsed body (ascii files)
+
+  const PlyElement* getElement(const std::string& elemName) const {
+    for (const PlyElement& e : elements) {
+      if (e.name == elemName) return &e;
+    }
+    return nullptr;
+  }
+
+  // Size of a value in the units which locations are measured in
+  size_t unitSize(PlyType t) const { return format == PlyFormat::Ascii ? 1 : plyTypeSize(t); }
+
+  template <typename T>
+  T readRaw(size_t loc) const {
+    T val;
+    if (swapBytes) {
+      char tmp[sizeof(T)];
+      for (size_t i = 0; i < sizeof(T); i++) tmp[i] = bytes[loc + sizeof(T) - 1 - i];
+      std::memcpy(&val, tmp, sizeof(T));
+    } else {
+      std::memcpy(&val, &bytes[loc], sizeof(T));
+    }
+    return val;
+  }
+
+  double readValue(size_t loc, PlyType t) const {
+    if (format == PlyFormat::Ascii) return asciiTokens[loc];
+    switch (t) {
+    case PlyType::Int8:
+      return readRaw<int8_t>(loc);
+    case PlyType::UInt8:
+      return readRaw<uint8_t>(loc);
+    case PlyType::Int16:
+      return readRaw<int16_t>(loc);
+    case PlyType::UInt16:
+      return readRaw<uint16_t>(loc);
+    case PlyType::Int32:
+      return readRaw<int32_t>(loc);
+    case PlyType::UInt32:
+      return readRaw<uint32_t>(loc);
+    case PlyType::Float32:
+      return readRaw<float>(loc);
+    case PlyType::Float64:
+      return readRaw<double>(loc);
+    }
+    return 0.;
+  }
+
+  size_t dataSize() const { return format == PlyFormat::Ascii ? asciiTokens.size() : bytes.size(); }
+
+  // Read the length of a list, which must fit in the file after the count
+  size_t readListLength(size_t loc, const PlyProperty& prop) const {
+    size_t countSize = unitSize(prop.listCountType);
+    if (loc + countSize > dataSize()) exception("ply loader: file " + filename + " is truncated");
+    double rawLen = readValue(loc, prop.listCountType);
+    if (!(rawLen >= 0.) || rawLen != std::floor(rawLen)) { // also catches NaN
+      exception("ply loader: file " + filename + " has an invalid list length");
+    }
+    size_t remaining = (dataSize() - loc - countSize) / unitSize(prop.type);
+    if (rawLen > static_cast<double>(remaining)) exception("ply loader: file " + filename + " is truncated");
+    return static_cast<size_t>(rawLen);
+  }
+
+  // Size of a property value, including the entries of a list
+  size_t propertySize(size_t loc, const PlyProperty& prop) const {
+    if (!prop.isList) return unitSize(prop.type);
+    return unitSize(prop.listCountType) + readListLength(loc, prop) * unitSize(prop.type);
+  }
+
+  size_t location(const PlyElement& elem, size_t iRecord, size_t iProp) const {
+    if (elem.fixedStride) return elem.dataBegin + iRecord * elem.recordStride + elem.propertyOffsets[iProp];
+
+    // walk over the preceding properties of the record, there are usually none or a few
+    size_t loc = elem.recordStarts[iRecord];
+    for (size_t iP = 0; iP < iProp; iP++) {
+      loc += propertySize(loc, elem.properties[iP]);
+    }
+    return loc;
+  }
+};
+
+void parsePlyHeader(PlyFile& ply, size_t& bodyStart) {
+
+  // Find the end of the header
+  const std::string endTag = "end_header";
+  std::string headerText;
+  size_t pos = 0;
+  while (true) {
+    size_t lineEnd = pos;
+    while (lineEnd < ply.bytes.size() && ply.bytes[lineEnd] != '\n') lineEnd++;
+    if (lineEnd == ply.bytes.size()) {
+      exception("ply loader: could not find end_header in " + ply.filename);
+    }
+    std::string line(&ply.bytes[pos], &ply.bytes[lineEnd]);
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+    pos = lineEnd + 1;
+
+    if (line == endTag) break;
+    headerText += line + "\n";
+  }
+  bodyStart = pos;
+
+  std::istringstream headerStream(headerText);
+  std::string line;
+  bool first = true;
+  bool foundFormat = false;
+  while (std::getline(headerStream, line)) {
+    std::istringstream lineStream(line);
+    std::string keyword;
+    lineStream >> keyword;
+
+    if (first) {
+      if (keyword != "ply") exception("ply loader: " + ply.filename + " is not a .ply file");
+      first = false;
+      continue;
+    }
+
+    if (keyword == "format") {
+      std::string fmt;
+      lineStream >> fmt;
+      if (fmt == "ascii") {
+        ply.format = PlyFormat::Ascii;
+      } else if (fmt == "binary_little_endian") {
+        ply.format = PlyFormat::BinaryLittleEndian;
+        ply.swapBytes = !hostIsLittleEndian();
+      } else if (fmt == "binary_big_endian") {
+        ply.format = PlyFormat::BinaryBigEndian;
+        ply.swapBytes = hostIsLittleEndian();
+      } else {
+        exception("ply loader: unrecognized format [" + fmt + "]");
+      }
+      foundFormat = true;
+    } else if (keyword == "element") {
+      PlyElement elem;
+      lineStream >> elem.name >> elem.count;
+      ply.elements.push_back(elem);
+    } else if (keyword == "property") {
+      if (ply.elements.empty()) exception("ply loader: property declared before any element");
+      PlyProperty prop;
+      std::string typeStr;
+      lineStream >> typeStr;
+      if (typeStr == "list") {
+        std::string countTypeStr, entryTypeStr;
+        lineStream >> countTypeStr >> entryTypeStr;
+        prop.isList = true;
+        prop.listCountType = parsePlyType(countTypeStr);
+        prop.type = parsePlyType(entryTypeStr);
+        ply.elements.back().hasLists = true;
+      } else {
+        prop.type = parsePlyType(typeStr);
+      }
+      lineStream >> prop.name;
+      ply.elements.back().properties.push_back(prop);
+    }
+    // everything else (comment, obj_info) is ignored
+  }
+
+  if (!foundFormat) exception("ply loader: missing format line in " + ply.filename);
+}
+
+void tokenizeAsciiBody(PlyFile& ply, size_t bodyStart) {
+  ply.bytes.push_back('\0'); // strtod needs a terminator
+  const char* cursor = &ply.bytes[bodyStart];
+  while (true) {
+    char* next;
+    double val = std::strtod(cursor, &next);
+    if (next == cursor) break;
+    ply.asciiTokens.push_back(val);
+    cursor = next;
+  }
+  ply.bytes.clear();
+  ply.bytes.shrink_to_fit();
+}
+
+// Work out where every element's records live
+void locatePlyRecords(PlyFile& ply, size_t bodyStart) {
+  size_t cursor = ply.format == PlyFormat::Ascii ? 0 : bodyStart;
+  size_t dataSize = ply.dataSize();
+
+  for (PlyElement& elem : ply.elements) {
+    elem.dataBegin = cursor;
+    size_t nProps = elem.properties.size();
+    if (elem.count == 0) continue;
+
+    // Lay out the first record. Without lists, every record looks the same.
+    elem.propertyOffsets.resize(nProps);
+    std::vector<size_t> firstListLengths(nProps, 0);
+    elem.recordStride = 0;
+    for (size_t iP = 0; iP < nProps; iP++) {
+      const PlyProperty& prop = elem.properties[iP];
+      elem.propertyOffsets[iP] = elem.recordStride;
+      if (prop.isList) firstListLengths[iP] = ply.readListLength(cursor + elem.recordStride, prop);
+      elem.recordStride += ply.propertySize(cursor + elem.recordStride, prop);
+    }
+
+    if (!elem.hasLists) {
+      if (elem.recordStride > 0 && elem.count > (dataSize - cursor) / elem.recordStride) {
+        exception("ply loader: file " + ply.filename + " is truncated");
+      }
+      cursor += elem.count * elem.recordStride;
+      continue;
+    }
+
+    // Walk the records once to find their length. If all lists have the same length as in the first record (e.g. an
+    // all-triangle mesh) the stride is still fixed, and nothing is stored per record.
+    std::vector<size_t> recordStarts(elem.count);
+    for (size_t iR = 0; iR < elem.count; iR++) {
+      recordStarts[iR] = cursor;
+      for (size_t iP = 0; iP < nProps; iP++) {
+        const PlyProperty& prop = elem.properties[iP];
+        if (prop.isList) {
+          size_t listLen = ply.readListLength(cursor, prop);
+          if (listLen != firstListLengths[iP]) elem.fixedStride = false;
+          cursor += ply.unitSize(prop.listCountType) + listLen * ply.unitSize(prop.type);
+        } else {
+          if (cursor + ply.unitSize(prop.type) > dataSize) {
+            exception("ply loader: file " + ply.filename + " is truncated");
+          }
+          cursor += ply.unitSize(prop.type);
+        }
+      }
+    }
+
+    if (elem.fixedStride) {
+      recordStarts.clear();
+    } else {
+      elem.propertyOffsets.clear();
+      elem.recordStarts = std::move(recordStarts);
+    }
+  }
+}
+
+PlyFile readPlyFile(const std::string& filename) {
+  PlyFile ply;
+  ply.filename = filename;
+
+  // Read the entire file in one go
+  std::ifstream inStream(filename, std::ios::binary | std::ios::ate);
+  if (!inStream) exception("ply loader: could not open file " + filename);
+  std::streamsize fileSize = inStream.tellg();
+  inStream.seekg(0, std::ios::beg);
+  ply.bytes.resize(static_cast<size_t>(fileSize));
+  if (fileSize > 0 && !inStream.read(&ply.bytes[0], fileSize)) {
+    exception("ply loader: failed to read file " + filename);
+  }
+
+  size_t bodyStart = 0;
+  parsePlyHeader(ply, bodyStart);
+  if (ply.format == PlyFormat::Ascii) {
+    tokenizeAsciiBody(ply, bodyStart);
+  }
+  locatePlyRecords(ply, bodyStart);
+
+  return ply;
+}
+
+// Decode a scalar property of every record in an element
+std::vector<float> readPlyScalarProperty(const PlyFile& ply, const PlyElement& elem, size_t iProp) {
+  std::vector<float> vals(elem.count);
+  PlyType t = elem.properties[iProp].type;
+  parallelForChunks(elem.count, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) {
+      vals[i] = static_cast<float>(ply.readValue(ply.location(elem, i, iProp), t));
+    }
+  });
+  return vals;
+}
+
+// Decode three scalar properties at once, e.g. x/y/z
+std::vector<glm::vec3> readPlyVec3Property(const PlyFile& ply, const PlyElement& elem, std::array<size_t, 3> iProps) {
+  std::vector<glm::vec3> vals(elem.count);
+  parallelForChunks(elem.count, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) {
+      for (int j = 0; j < 3; j++) {
+        PlyType t = elem.properties[iProps[j]].type;
+        vals[i][j] = static_cast<float>(ply.readValue(ply.location(elem, i, iProps[j]), t));
+      }
+    }
+  });
+  return vals;
+}
+
+// Decode a list property in to flat entries + start offsets, as used by SurfaceMesh
+void readPlyListProperty(const PlyFile& ply, const PlyElement& elem, size_t iProp, std::vector<uint32_t>& entries,
+                         std::vector<uint32_t>& starts) {
+  const PlyProperty& prop = elem.properties[iProp];
+  size_t countSize = ply.unitSize(prop.listCountType);
+  size_t entrySize = ply.unitSize(prop.type);
+
+  // sequential prefix sum over the list lengths (which were validated when the records were located)
+  starts.resize(elem.count + 1);
+  starts[0] = 0;
+  for (size_t i = 0; i < elem.count; i++) {
+    uint64_t end = static_cast<uint64_t>(starts[i]) + ply.readListLength(ply.location(elem, i, iProp), prop);
+    if (end > std::numeric_limits<uint32_t>::max()) {
+      exception("ply loader: too many list entries in element " + elem.name + " of " + ply.filename);
+    }
+    starts[i + 1] = static_cast<uint32_t>(end);
+  }
+
+  entries.resize(starts.back());
+  parallelForChunks(elem.count, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    for (size_t i = iStart; i < iEnd; i++) {
+      size_t loc = ply.location(elem, i, iProp) + countSize;
+      for (uint32_t j = starts[i]; j < starts[i + 1]; j++) {
+        double val = ply.readValue(loc, prop.type);
+        if (!(val >= 0.) || val != std::floor(val) || val > std::numeric_limits<uint32_t>::max()) { // also catches NaN
+          exception("ply loader: file " + ply.filename + " has an invalid list entry in element " + elem.name);
+        }
+        entries[j] = static_cast<uint32_t>(val);
+        loc += entrySize;
+      }
+    }
+  });
+}
+
+// Integer color channels span the full range of their type, map them to [0,1] as val * scale + offset
+void plyColorScaleOffset(PlyType t, float& scale, float& offset) {
+  scale = 1.f;
+  offset = 0.f;
+  switch (t) {
+  case PlyType::UInt8:
+    scale = 1.f / 255.f;
+    break;
+  case PlyType::Int8:
+    scale = 1.f / 255.f;
+    offset = 128.f / 255.f;
+    break;
+  case PlyType::UInt16:
+    scale = 1.f / 65535.f;
+    break;
+  case PlyType::Int16:
+    scale = 1.f / 65535.f;
+    offset = 32768.f / 65535.f;
+    break;
+  default:
+    break;
+  }
+}
+
+// Sort the properties of an element in to the kinds of quantities we will create from them
+struct PlyQuantityProperties {
+  std::array<size_t, 3> color{{INVALID_IND, INVALID_IND, INVALID_IND}};
+  std::array<size_t, 3> normal{{INVALID_IND, INVALID_IND, INVALID_IND}};
+  std::array<size_t, 2> uv{{INVALID_IND, INVALID_IND}};
+  std::vector<size_t> scalars;
+
+  bool hasColor() const { return color[0] != INVALID_IND && color[1] != INVALID_IND && color[2] != INVALID_IND; }
+  bool hasNormal() const { return normal[0] != INVALID_IND && normal[1] != INVALID_IND && normal[2] != INVALID_IND; }
+  bool hasUV() const { return uv[0] != INVALID_IND && uv[1] != INVALID_IND; }
+};
+
+PlyQuantityProperties classifyPlyProperties(const PlyElement& elem, const std::vector<std::string>& skipNames) {
+  PlyQuantityProperties result;
+
+  auto findFirst = [&](std::vector<std::string> names) -> size_t {
+    for (const std::string& n : names) {
+      size_t ind = elem.propertyIndex(n);
+      if (ind != INVALID_IND && !elem.properties[ind].isList) return ind;
+    }
+    return INVALID_IND;
+  };
+
+  result.color = {{findFirst({"red", "diffuse_red"}), findFirst({"green", "diffuse_green"}),
+                   findFirst({"blue", "diffuse_blue"})}};
+  result.normal = {{findFirst({"nx", "normal_x"}), findFirst({"ny", "normal_y"}), findFirst({"nz", "normal_z"})}};
+  result.uv = {{findFirst({"u", "s", "texture_u", "texture_s"}), findFirst({"v", "t", "texture_v", "texture_t"})}};
+
+  for (size_t iP = 0; iP < elem.properties.size(); iP++) {
+    const PlyProperty& prop = elem.properties[iP];
+    if (prop.isList) continue;
+    if (std::find(skipNames.begin(), skipNames.end(), prop.name) != skipNames.end()) continue;
+    if (result.hasColor() && std::find(result.color.begin(), result.color.end(), iP) != result.color.end()) continue;
+    if (result.hasNormal() && std::find(result.normal.begin(), result.normal.end(), iP) != result.normal.end())
+      continue;
+    if (result.hasUV() && std::find(result.uv.begin(), result.uv.end(), iP) != result.uv.end()) continue;
+    result.scalars.push_back(iP);
+  }
+
+  return result;
+}
+
+std::vector<glm::vec3> readPlyColors(const PlyFile& ply, const PlyElement& elem, const PlyQuantityProperties& props) {
+  std::vector<glm::vec3> colors = readPlyVec3Property(ply, elem, props.color);
+  float scale, offset;
+  plyColorScaleOffset(elem.properties[props.color[0]].type, scale, offset);
+  if (scale != 1.f || offset != 0.f) {
+    parallelFor(colors.size(), [&](size_t i) { colors[i] = colors[i] * scale + offset; });
+  }
+  return colors;
+}
+
+std::vector<glm::vec2> readPlyUVs(const PlyFile& ply, const PlyElement& elem, const PlyQuantityProperties& props) {
+  std::vector<float> u = readPlyScalarProperty(ply, elem, props.uv[0]);
+  std::vector<float> v = readPlyScalarProperty(ply, elem, props.uv[1]);
+  std::vector<glm::vec2> uvs(elem.count);
+  for (size_t i = 0; i < elem.count; i++) uvs[i] = glm::vec2{u[i], v[i]};
+  return uvs;
+}
+
+DataType guessPlyScalarDataType(const PlyProperty& prop) {
+  // integer-valued properties are most often labels
+  return plyTypeIsInteger(prop.type) ? DataType::CATEGORICAL : DataType::STANDARD;
+}
+
+const PlyElement& getVertexElement(const PlyFile& ply) {
+  const PlyElement* vertElem = ply.getElement("vertex");
+  if (vertElem == nullptr) exception("ply loader: file " + ply.filename + " has no vertex element");
+  return *vertElem;
+}
+
+std::vector<glm::vec3> readPlyPositions(const PlyFile& ply, const PlyElement& vertElem) {
+  std::array<size_t, 3> posInds{
+      {vertElem.propertyIndex("x"), vertElem.propertyIndex("y"), vertElem.propertyIndex("z")}};
+  if (posInds[0] == INVALID_IND || posInds[1] == INVALID_IND) {
+    exception("ply loader: vertex element in " + ply.filename + " does not have x/y properties");
+  }
+  if (posInds[2] == INVALID_IND) {
+    // 2D data, read x twice and zero it out below
+    posInds[2] = posInds[0];
+    std::vector<glm::vec3> positions = readPlyVec3Property(ply, vertElem, posInds);
+    for (glm::vec3& p : positions) p.z = 0.;
+    return positions;
+  }
+  return readPlyVec3Property(ply, vertElem, posInds);
+}
+
+std::string resolvePlyStructureName(std::string name, const std::string& filename) {
+  if (name == "") return guessNiceNameFromPath(filename);
+  return name;
+}
+
+} // namespace
+
+
+SurfaceMesh* loadSurfaceMeshPLY(std::string name, std::string filename) {
+  checkInitialized();
+
+  PlyFile ply = readPlyFile(filename);
+  const PlyElement& vertElem = getVertexElement(ply);
+
+  const PlyElement* faceElem = ply.getElement("face");
+  if (faceElem == nullptr) exception("ply loader: file " + filename + " has no face element");
+  size_t faceIndsProp = faceElem->propertyIndex("vertex_indices");
+  if (faceIndsProp == INVALID_IND) faceIndsProp = faceElem->propertyIndex("vertex_index");
+  if (faceIndsProp == INVALID_IND || !faceElem->properties[faceIndsProp].isList) {
+    exception("ply loader: face element in " + filename + " does not have a vertex_indices list");
+  }
+
+  // Build the mesh directly from the flat arrays
+  std::vector<glm::vec3> positions = readPlyPositions(ply, vertElem);
+  std::vector<uint32_t> faceIndsEntries, faceIndsStart;
+  readPlyListProperty(ply, *faceElem, faceIndsProp, faceIndsEntries, faceIndsStart);
+
+  SurfaceMesh* mesh = new SurfaceMesh(resolvePlyStructureName(name, filename), positions, faceIndsEntries, faceIndsStart);
+  bool success = registerStructure(mesh);
+  if (!success) {
+    safeDelete(mesh);
+    return mesh;
+  }
+
+  // Vertex quantities
+  PlyQuantityProperties vertProps = classifyPlyProperties(vertElem, {"x", "y", "z"});
+  if (vertProps.hasColor()) mesh->addVertexColorQuantity("color", readPlyColors(ply, vertElem, vertProps));
+  if (vertProps.hasNormal()) {
+    mesh->addVertexVectorQuantity("normal", readPlyVec3Property(ply, vertElem, vertProps.normal));
+  }
+  if (vertProps.hasUV()) mesh->addVertexParameterizationQuantity("uv", readPlyUVs(ply, vertElem, vertProps));
+  for (size_t iP : vertProps.scalars) {
+    const PlyProperty& prop = vertElem.properties[iP];
+    mesh->addVertexScalarQuantity(prop.name, readPlyScalarProperty(ply, vertElem, iP), guessPlyScalarDataType(prop));
+  }
+
+  // Face quantities (prefixed if they would collide with a vertex quantity)
+  auto faceQuantityName = [&](const std::string& propName) -> std::string {
+    if (mesh->getQuantity(propName) != nullptr) return "face_" + propName;
+    return propName;
+  };
+  PlyQuantityProperties faceProps = classifyPlyProperties(*faceElem, {});
+  if (faceProps.hasColor()) {
+    mesh->addFaceColorQuantity(faceQuantityName("color"), readPlyColors(ply, *faceElem, faceProps));
+  }
+  for (size_t iP : faceProps.scalars) {
+    const PlyProperty& prop = faceElem->properties[iP];
+    mesh->addFaceScalarQuantity(faceQuantityName(prop.name), readPlyScalarProperty(ply, *faceElem, iP),
+                                guessPlyScalarDataType(prop));
+  }
+
+  return mesh;
+}
+
+PointCloud* loadPointCloudPLY(std::string name, std::string filename) {
+  checkInitialized();
+
+  PlyFile ply = readPlyFile(filename);
+  const PlyElement& vertElem = getVertexElement(ply);
+
+  PointCloud* cloud = new PointCloud(resolvePlyStructureName(name, filename), readPlyPositions(ply, vertElem));
+  bool success = registerStructure(cloud);
+  if (!success) {
+    safeDelete(cloud);
+    return cloud;
+  }
+
+  PlyQuantityProperties vertProps = classifyPlyProperties(vertElem, {"x", "y", "z"});
+  if (vertProps.hasColor()) cloud->addColorQuantity("color", readPlyColors(ply, vertElem, vertProps));
+  if (vertProps.hasNormal()) {
+    cloud->addVectorQuantity("normal", readPlyVec3Property(ply, vertElem, vertProps.normal));
+  }
+  if (vertProps.hasUV()) cloud->addParameterizationQuantity("uv", readPlyUVs(ply, vertElem, vertProps));
+  for (size_t iP : vertProps.scalars) {
+    const PlyProperty& prop = vertElem.properties[iP];
+    cloud->addScalarQuantity(prop.name, readPlyScalarProperty(ply, vertElem, iP), guessPlyScalarDataType(prop));
+  }
+
+  return cloud;
+}
+
+} // namespace polyscope
@@ -5,6 +5,7 @@
 #include "polyscope/file_helpers.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "polyscope/point_cloud_color_quantity.h"
@@ -38,19 +39,27 @@ PointCloud::PointCloud(std::string name, std::vector<glm::vec3> points_)
   updateObjectSpaceBounds();
 }
 
+namespace {
+// Set every frame, so their handles are cached by each program
+const render::UniformName uInvProjMatrix("u_invProjMatrix");
+const render::UniformName uViewport("u_viewport");
+const render::UniformName uPointRadius("u_pointRadius");
+const render::UniformName uBaseColor("u_baseColor");
+} // namespace
+
 // Helper to set uniforms
 void PointCloud::setPointCloudUniforms(render::ShaderProgram& p) {
   glm::mat4 P = view::getCameraPerspectiveMatrix();
   glm::mat4 Pinv = glm::inverse(P);
 
   if (getPointRenderMode() == PointRenderMode::Sphere) {
-    p.setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
-    p.setUniform("u_viewport", render::engine->getCurrentViewport());
+    p.setUniform(p.findUniform(uInvProjMatrix), glm::value_ptr(Pinv));
+    p.setUniform(p.findUniform(uViewport), render::engine->getCurrentViewport());
   }
 
   if (pointRadiusQuantityName != "" && !pointRadiusQuantityAutoscale) {
     // special case: ignore radius uniform
-    p.setUniform("u_pointRadius", 1.);
+    p.setUniform(p.findUniform(uPointRadius), 1.);
   } else {
     // common case
 
@@ -60,8 +69,10 @@ void PointCloud::setPointCloudUniforms(render::ShaderProgram& p) {
       scalarQScale = std::max(0., radQ.getDataRange().second);
     }
 
-    p.setUniform("u_pointRadius", pointRadius.get().asAbsolute() / scalarQScale);
+    p.setUniform(p.findUniform(uPointRadius), pointRadius.get().asAbsolute() / scalarQScale);
   }
+
+  applyChunkCulling(p);
 }
 
 void PointCloud::draw() {
@@ -69,6 +80,8 @@ void PointCloud::draw() {
     return;
   }
 
+  updateVisibleChunks(1);
+
   // If the user creates a very big point cloud using sphere mode, print a warning
   // (this warning is only printed once, and only if verbosity is high enough)
   if (nPoints() > 500000 && getPointRenderMode() == PointRenderMode::Sphere &&
@@ -89,7 +102,7 @@ void PointCloud::draw() {
     setStructureUniforms(*program);
     setPointCloudUniforms(*program);
     render::engine->setMaterialUniforms(*program, material.get());
-    program->setUniform("u_baseColor", pointColor.get());
+    program->setUniform(program->findUniform(uBaseColor), pointColor.get());
 
     // Draw the actual point cloud
     program->draw();
@@ -122,6 +135,8 @@ void PointCloud::drawPick() {
     return;
   }
 
+  updateVisibleChunks(1, false);
+
   // Ensure we have prepared buffers
   ensurePickProgramPrepared();
 
@@ -155,6 +170,7 @@ void PointCloud::drawPickDelayed() {
 void PointCloud::ensureRenderProgramPrepared() {
   // If already prepared, do nothing
   if (program) return;
+  POLYSCOPE_PROFILE_SCOPE("prepare");
 
   // clang-format off
   program = render::engine->requestShader( getShaderNameForRenderMode(), 
@@ -172,11 +188,15 @@ void PointCloud::ensureRenderProgramPrepared() {
 }
 
 void PointCloud::ensurePickProgramPrepared() {
+  // If already prepared, do nothing
+  if (pickProgram) return;
+  POLYSCOPE_PROFILE_SCOPE("prepare pick");
   ensureRenderProgramPrepared();
 
   // Request pick indices
   size_t pickCount = nPoints();
-  size_t pickStart = pick::requestPickBufferRange(this, pickCount);
+  pickRangeCapacity = std::max(pickRangeCapacity, pickCount);
+  pickRangeStart = pick::requestPickBufferRange(this, pickRangeCapacity);
 
   // Create a new pick program
   // clang-format off
@@ -190,12 +210,14 @@ void PointCloud::ensurePickProgramPrepared() {
   setPointProgramGeometryAttributes(*pickProgram);
 
   // Fill color buffer with packed point indices
-  std::vector<glm::vec3> pickColors(pickCount);
+  std::vector<glm::vec3> pickColorData(pickCount);
   for (size_t i = 0; i < pickCount; i++) {
-    pickColors[i] = pick::indToVec(i + pickStart);
+    pickColorData[i] = pick::indToVec(i + pickRangeStart);
   }
 
   // Store data in buffers
+  pickColors = render::engine->generateAttributeBuffer(RenderDataType::Vector3Float);
+  pickColors->setData(pickColorData);
   pickProgram->setAttribute("a_color", pickColors);
 }
 
@@ -203,11 +225,11 @@ void PointCloud::setPointProgramGeometryAttributes(render::ShaderProgram& p) {
   p.setAttribute("a_position", points.getRenderAttributeBuffer());
   if (pointRadiusQuantityName != "") {
     PointCloudScalarQuantity& radQ = resolvePointRadiusQuantity();
-    p.setAttribute("a_pointRadius", radQ.values.getRenderAttributeBuffer());
+    p.setAttribute("a_pointRadius", radQ.getValueRenderAttributeBuffer());
   }
   if (transparencyQuantityName != "") {
     PointCloudScalarQuantity& transparencyQ = resolveTransparencyQuantity();
-    p.setAttribute("a_valueAlpha", transparencyQ.values.getRenderAttributeBuffer());
+    p.setAttribute("a_valueAlpha", transparencyQ.getValueRenderAttributeBuffer());
   }
 }
 
@@ -242,6 +264,21 @@ PointCloudPickResult PointCloud::interpretPickResult(const PickResult& rawResult
   return result;
 }
 
+PointCloudPickRegionResult PointCloud::interpretPickRegionResult(const PickRegionResult& rawResult) {
+  if (rawResult.structure != this) {
+    exception("called interpretPickRegionResult(), but the pick result is not from this structure");
+  }
+
+  PointCloudPickRegionResult result;
+  result.indices.reserve(rawResult.localIndices.size());
+  for (uint64_t localInd : rawResult.localIndices) {
+    if (localInd >= nPoints()) exception("Bad pick index in point cloud");
+    result.indices.push_back(localInd);
+  }
+
+  return result;
+}
+
 
 std::vector<std::string> PointCloud::addPointCloudRules(std::vector<std::string> initRules, bool withPointCloud) {
   initRules = addStructureRules(initRules);
@@ -399,8 +436,178 @@ void PointCloud::updateObjectSpaceBounds() {
     lengthScale = std::max(lengthScale, glm::length2(p - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+
+  updateCullingChunkBounds(0, points.data.size());
+}
+
+void PointCloud::updateCullingChunkBounds(size_t pointStart, size_t pointEnd) {
+  const std::vector<glm::vec3>& data = points.data;
+  size_t nChunks = (data.size() + cullingChunkSize - 1) / cullingChunkSize;
+  if (nChunks < 2) {
+    cullingChunkBounds.clear();
+    return;
+  }
+  if (cullingChunkBounds.size() < 2) {
+    pointStart = 0; // not previously chunked
+  }
+  cullingChunkBounds.resize(nChunks);
+
+  for (size_t iChunk = pointStart / cullingChunkSize; iChunk < nChunks && iChunk * cullingChunkSize < pointEnd;
+       iChunk++) {
+    glm::vec3 min = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
+    glm::vec3 max = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
+    size_t iEnd = std::min((iChunk + 1) * cullingChunkSize, data.size());
+    for (size_t i = iChunk * cullingChunkSize; i < iEnd; i++) {
+      min = componentwiseMin(min, data[i]);
+      max = componentwiseMax(max, data[i]);
+    }
+    cullingChunkBounds[iChunk] = std::make_tuple(min, max);
+  }
 }
 
+float PointCloud::frustumCullingMargin() {
+  float margin = Structure::frustumCullingMargin();
+  if (margin < 0.) return margin;
+
+  // a radius quantity without autoscaling sets absolute radii, otherwise they are at most the point radius
+  if (pointRadiusQuantityName != "" && !pointRadiusQuantityAutoscale) return -1.;
+  return margin + pointRadius.get().asAbsolute();
+}
+
+void PointCloud::appendPointsImpl(const std::vector<glm::vec3>& newPoints) {
+  if (!quantities.empty()) {
+    exception("Cannot append points to point cloud [" + name + "], it has quantities. Remove them first.");
+  }
+  if (newPoints.empty()) return;
+
+  points.ensureHostBufferPopulated();
+  std::vector<glm::vec3>& data = points.data;
+  size_t oldSize = data.size();
+
+  // Add to the end while there is room, then wrap around and overwrite the oldest points
+  size_t overwriteStart = INVALID_IND;
+  size_t overwriteEnd = 0;
+  for (const glm::vec3& p : newPoints) {
+    if (maxPointCount == 0 || data.size() < maxPointCount) {
+      data.push_back(p);
+    } else {
+      data[ringNextInd] = p;
+      overwriteStart = std::min(overwriteStart, ringNextInd);
+      overwriteEnd = std::max(overwriteEnd, ringNextInd + 1);
+      ringNextInd = (ringNextInd + 1) % maxPointCount;
+    }
+  }
+
+  size_t changedStart = oldSize;
+  size_t changedEnd = data.size();
+  if (overwriteStart == INVALID_IND) {
+    points.markHostBufferAppended(oldSize);
+  } else {
+    changedStart = std::min(overwriteStart, oldSize);
+    changedEnd = std::max(overwriteEnd, data.size());
+    points.markHostBufferRangeUpdated(changedStart, changedEnd);
+  }
+
+  // Give new points the next pick indices in the range. Overwritten points keep the index of their slot. If the range
+  // is full, the pick program is rebuilt with twice the room, so the cost of appending stays proportional to the
+  // number of appended points.
+  if (pickProgram) {
+    if (data.size() <= pickRangeCapacity) {
+      std::vector<glm::vec3> newPickColors;
+      for (size_t i = oldSize; i < data.size(); i++) {
+        newPickColors.push_back(pick::indToVec(i + pickRangeStart));
+      }
+      pickColors->setDataRange(newPickColors, oldSize);
+    } else {
+      pickRangeCapacity = 2 * data.size();
+      pickProgram.reset();
+    }
+  }
+
+  if (oldSize == 0) {
+    updateObjectSpaceBounds();
+  } else {
+    growObjectSpaceBounds(newPoints);
+    updateCullingChunkBounds(changedStart, changedEnd);
+  }
+  updateStructureExtents();
+}
+
+void PointCloud::setMaxPointCount(size_t newMax) {
+  points.ensureHostBufferPopulated();
+  std::vector<glm::vec3>& data = points.data;
+
+  bool needsReorder = ringNextInd != 0;
+  bool needsTruncate = newMax != 0 && data.size() > newMax;
+  if ((needsReorder || needsTruncate) && !quantities.empty()) {
+    exception("Cannot change max point count of point cloud [" + name + "], it has quantities. Remove them first.");
+  }
+
+  if (needsReorder || needsTruncate) {
+    // put the points back in the order they were added, then drop the oldest
+    std::rotate(data.begin(), data.begin() + ringNextInd, data.end());
+    ringNextInd = 0;
+    if (needsTruncate) {
+      data.erase(data.begin(), data.begin() + (data.size() - newMax));
+    }
+    points.markHostBufferUpdated();
+    pickProgram.reset();
+    updateObjectSpaceBounds();
+    updateStructureExtents();
+  }
+
+  maxPointCount = newMax;
+}
+
+size_t PointCloud::getMaxPointCount() { return maxPointCount; }
+
+void PointCloud::addPointPositionFrameLoader(size_t nFrames, FrameLoader<glm::vec3> loader) {
+  std::function<void(const std::vector<glm::vec3>&)> applyFrame = [this](const std::vector<glm::vec3>& frame) {
+    updatePointPositions(frame);
+  };
+  getTimeSeries().addTrack(std::unique_ptr<TimeSeriesTrack>(
+      new TypedTimeSeriesTrack<glm::vec3>("positions", nFrames, loader, applyFrame)));
+}
+
+PointCloudScalarQuantity* PointCloud::addScalarQuantityFrameLoader(std::string name, size_t nFrames,
+                                                                   FrameLoader<float> loader, DataType type) {
+  if (nFrames == 0) exception("point cloud scalar quantity [" + name + "] has no frames");
+
+  // the quantity is created from the first frame, then frames are swapped in to it
+  std::vector<float> firstFrame = loader(0);
+  validateSize(firstFrame, nPoints(), "point cloud scalar quantity " + name);
+  PointCloudScalarQuantity* q = addScalarQuantityImpl(name, firstFrame, type);
+
+  // (removing or replacing the quantity removes this track, so q stays valid for as long as it is called)
+  std::function<void(const std::vector<float>&)> applyFrame = [q](const std::vector<float>& frame) {
+    q->updateData(frame);
+  };
+  std::unique_ptr<TypedTimeSeriesTrack<float>> track(
+      new TypedTimeSeriesTrack<float>(quantityTrackName(name), nFrames, loader, applyFrame));
+  track->seedFrame(0, std::move(firstFrame));
+  getTimeSeries().addTrack(std::move(track));
+
+  return q;
+}
+
+PointCloudColorQuantity* PointCloud::addColorQuantityFrameLoader(std::string name, size_t nFrames,
+                                                                 FrameLoader<glm::vec3> loader) {
+  if (nFrames == 0) exception("point cloud color quantity [" + name + "] has no frames");
+
+  std::vector<glm::vec3> firstFrame = loader(0);
+  validateSize(firstFrame, nPoints(), "point cloud color quantity " + name);
+  PointCloudColorQuantity* q = addColorQuantityImpl(name, firstFrame);
+
+  std::function<void(const std::vector<glm::vec3>&)> applyFrame = [q](const std::vector<glm::vec3>& frame) {
+    q->updateData(frame);
+  };
+  std::unique_ptr<TypedTimeSeriesTrack<glm::vec3>> track(
+      new TypedTimeSeriesTrack<glm::vec3>(quantityTrackName(name), nFrames, loader, applyFrame));
+  track->seedFrame(0, std::move(firstFrame));
+  getTimeSeries().addTrack(std::move(track));
+
+  return q;
+}
 
 std::string PointCloud::typeName() { return structureTypeName; }
 
@@ -486,6 +693,14 @@ PointCloudColorQuantity* PointCloud::addColorQuantityImpl(std::string name, cons
   return q;
 }
 
+PointCloudColorQuantity* PointCloud::addByteColorQuantityImpl(std::string name,
+                                                              const std::vector<glm::u8vec4>& colors) {
+  checkForQuantityWithNameAndDeleteOrError(name);
+  PointCloudColorQuantity* q = new PointCloudColorQuantity(name, colors, *this);
+  addQuantity(q);
+  return q;
+}
+
 PointCloudScalarQuantity* PointCloud::addScalarQuantityImpl(std::string name, const std::vector<float>& data,
                                                             DataType type) {
   checkForQuantityWithNameAndDeleteOrError(name);
@@ -494,6 +709,33 @@ PointCloudScalarQuantity* PointCloud::addScalarQuantityImpl(std::string name, co
   return q;
 }
 
+PointCloudScalarQuantity* PointCloud::addIntegerScalarQuantity(std::string name, const std::vector<uint8_t>& data,
+                                                               DataType type) {
+  validateSize(data, nPoints(), "point cloud scalar quantity " + name);
+  checkForQuantityWithNameAndDeleteOrError(name);
+  PointCloudScalarQuantity* q = new PointCloudScalarQuantity(name, data, *this, type);
+  addQuantity(q);
+  return q;
+}
+
+PointCloudScalarQuantity* PointCloud::addIntegerScalarQuantity(std::string name, const std::vector<uint16_t>& data,
+                                                               DataType type) {
+  validateSize(data, nPoints(), "point cloud scalar quantity " + name);
+  checkForQuantityWithNameAndDeleteOrError(name);
+  PointCloudScalarQuantity* q = new PointCloudScalarQuantity(name, data, *this, type);
+  addQuantity(q);
+  return q;
+}
+
+PointCloudScalarQuantity* PointCloud::addIntegerScalarQuantity(std::string name, const std::vector<int32_t>& data,
+                                                               DataType type) {
+  validateSize(data, nPoints(), "point cloud scalar quantity " + name);
+  checkForQuantityWithNameAndDeleteOrError(name);
+  PointCloudScalarQuantity* q = new PointCloudScalarQuantity(name, data, *this, type);
+  addQuantity(q);
+  return q;
+}
+
 PointCloudParameterizationQuantity* PointCloud::addParameterizationQuantityImpl(std::string name,
                                                                                 const std::vector<glm::vec2>& param,
                                                                                 ParamCoordsType type) {
@@ -13,6 +13,10 @@ PointCloudColorQuantity::PointCloudColorQuantity(std::string name, const std::ve
                                                  PointCloud& pointCloud_)
     : PointCloudQuantity(name, pointCloud_, true), ColorQuantity(*this, values_) {}
 
+PointCloudColorQuantity::PointCloudColorQuantity(std::string name, const std::vector<glm::u8vec4>& values_,
+                                                 PointCloud& pointCloud_)
+    : PointCloudQuantity(name, pointCloud_, true), ColorQuantity(*this, values_) {}
+
 void PointCloudColorQuantity::draw() {
   if (!isEnabled()) return;
 
@@ -47,7 +51,7 @@ void PointCloudColorQuantity::createPointProgram() {
   // clang-format on
 
   parent.setPointProgramGeometryAttributes(*pointProgram);
-  pointProgram->setAttribute("a_color", colors.getRenderAttributeBuffer());
+  pointProgram->setAttribute("a_color", getColorRenderAttributeBuffer());
 
   // Fill buffers
   render::engine->setMaterial(*pointProgram, parent.getMaterial());
@@ -64,7 +68,7 @@ void PointCloudColorQuantity::buildPickUI(size_t ind) {
   ImGui::TextUnformatted(name.c_str());
   ImGui::NextColumn();
 
-  glm::vec3 color = colors.getValue(ind);
+  glm::vec3 color = getColorValue(ind);
   ImGui::ColorEdit3("", &color[0], ImGuiColorEditFlags_NoInputs | ImGuiColorEditFlags_NoPicker);
   ImGui::SameLine();
   std::string colorStr = to_string_short(color);
@@ -13,6 +13,18 @@ PointCloudScalarQuantity::PointCloudScalarQuantity(std::string name, const std::
                                                    PointCloud& pointCloud_, DataType dataType_)
     : PointCloudQuantity(name, pointCloud_, true), ScalarQuantity(*this, values_, dataType_) {}
 
+PointCloudScalarQuantity::PointCloudScalarQuantity(std::string name, const std::vector<uint8_t>& values_,
+                                                   PointCloud& pointCloud_, DataType dataType_)
+    : PointCloudQuantity(name, pointCloud_, true), ScalarQuantity(*this, values_, dataType_) {}
+
+PointCloudScalarQuantity::PointCloudScalarQuantity(std::string name, const std::vector<uint16_t>& values_,
+                                                   PointCloud& pointCloud_, DataType dataType_)
+    : PointCloudQuantity(name, pointCloud_, true), ScalarQuantity(*this, values_, dataType_) {}
+
+PointCloudScalarQuantity::PointCloudScalarQuantity(std::string name, const std::vector<int32_t>& values_,
+                                                   PointCloud& pointCloud_, DataType dataType_)
+    : PointCloudQuantity(name, pointCloud_, true), ScalarQuantity(*this, values_, dataType_) {}
+
 void PointCloudScalarQuantity::draw() {
   if (!isEnabled()) return;
 
@@ -66,7 +78,7 @@ void PointCloudScalarQuantity::createProgram() {
   // clang-format on
 
   parent.setPointProgramGeometryAttributes(*pointProgram);
-  pointProgram->setAttribute("a_value", values.getRenderAttributeBuffer());
+  pointProgram->setAttribute("a_value", getValueRenderAttributeBuffer());
 
   // Fill buffers
   pointProgram->setTextureFromColormap("t_colormap", cMap.get());
@@ -82,7 +94,7 @@ void PointCloudScalarQuantity::refresh() {
 void PointCloudScalarQuantity::buildPickUI(size_t ind) {
   ImGui::TextUnformatted(name.c_str());
   ImGui::NextColumn();
-  ImGui::Text("%g", values.getValue(ind));
+  ImGui::Text("%g", getScalarValue(ind));
   ImGui::NextColumn();
 }
 
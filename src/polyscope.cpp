@@ -3,6 +3,7 @@
 #include "polyscope/polyscope.h"
 
 #include <chrono>
+#include <cmath>
 #include <fstream>
 #include <iostream>
 #include <thread>
@@ -14,6 +15,7 @@
 #include "polyscope/imgui_config.h"
 #include "polyscope/options.h"
 #include "polyscope/pick.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/utilities.h"
 #include "polyscope/view.h"
@@ -413,20 +415,60 @@ void frameTick() {
   frameTickStack--;
 }
 
-void requestRedraw() { redrawNextFrame = true; }
+void requestRedraw() {
+  redrawNextFrame = true;
+  state::globalContext.sceneGeneration++;
+}
 bool redrawRequested() { return redrawNextFrame; }
 
+CullingStats getCullingStats() { return state::globalContext.cullingStats; }
+
+namespace {
+
+// Distance along the view direction to the center of a structure's bounding box
+float structureViewDepth(Structure& s) {
+  std::tuple<glm::vec3, glm::vec3> bbox = s.boundingBox();
+  glm::vec3 center = 0.5f * (std::get<0>(bbox) + std::get<1>(bbox));
+  float depth = -(view::viewMat * glm::vec4(center, 1.)).z;
+  return std::isfinite(depth) ? depth : 0.f;
+}
+
+} // namespace
+
 void drawStructures() {
+  POLYSCOPE_PROFILE_SCOPE("draw structures");
 
-  // Draw all off the structures registered with polyscope
+  // The view or render target may have changed since the last draw (e.g. the ground plane's reflected view)
+  render::engine->updateFrameUniforms();
 
+  // Draw all off the structures registered with polyscope. Their draws are queued and reordered to share state
+  // between them, the depth of each structure orders any draws which must be blended back-to-front.
+  render::engine->beginRenderQueue();
+  CullingStats& stats = state::globalContext.cullingStats;
   for (auto& catMap : state::structures) {
     for (auto& s : catMap.second) {
+      if (s.second->isEnabled()) {
+        if (!s.second->mayBeInView()) {
+          stats.nStructuresCulled++;
+          continue;
+        }
+        stats.nStructuresDrawn++;
+      }
+      render::engine->setRenderQueueDepth(structureViewDepth(*s.second));
+      render::engine->setRenderQueueProfileScope(s.second->name);
+#ifdef POLYSCOPE_PROFILER_ENABLED
+      // when draws are queued they are only issued (and GPU-timed) while the queue executes
+      profiler::ScopedTimer structureTimer(s.second->name, !render::engine->renderQueueActive());
+#endif
       s.second->draw();
     }
   }
+  {
+    POLYSCOPE_PROFILE_GPU_SCOPE("execute render queue");
+    render::engine->endRenderQueue();
+  }
 
-  // Also render any slice plane geometry
+  // Also render any slice plane geometry (after the structures, it may be translucent)
   for (std::unique_ptr<SlicePlane>& s : state::slicePlanes) {
     s->drawGeometry();
   }
@@ -435,6 +477,7 @@ void drawStructures() {
 void drawStructuresDelayed() {
   // "delayed" drawing allows structures to render things which should be rendered after most of the scene has been
   // drawn
+  render::engine->updateFrameUniforms();
   for (auto& catMap : state::structures) {
     for (auto& s : catMap.second) {
       s.second->drawDelayed();
@@ -609,7 +652,9 @@ void renderSlicePlanes() {
 }
 
 void renderScene() {
+  POLYSCOPE_PROFILE_GPU_SCOPE("render scene");
 
+  state::globalContext.cullingStats = CullingStats();
   render::engine->applyTransparencySettings();
 
   render::engine->sceneBuffer->clearColor = {0., 0., 0.};
@@ -640,6 +685,7 @@ void renderScene() {
 
 
     for (int iPass = 0; iPass < options::transparencyRenderPasses; iPass++) {
+      POLYSCOPE_PROFILE_GPU_SCOPE("depth peeling pass");
       bool isRedraw = iPass > 0;
       internal::renderPassIsRedraw = isRedraw;
 
@@ -693,7 +739,9 @@ void renderSceneToScreen() {
   if (options::debugDrawPickBuffer) {
     // special debug draw
     pick::evaluatePickQuery(-1, -1); // populate the buffer
-    render::engine->pickFramebuffer->blitTo(render::engine->displayBuffer.get());
+    if (render::engine->pickColorBuffer->getType() != RenderBufferType::UInt2) { // integer buffers can't be blitted
+      render::engine->pickFramebuffer->blitTo(render::engine->displayBuffer.get());
+    }
   } else {
     render::engine->applyLightingTransform(render::engine->sceneColorFinal);
   }
@@ -891,8 +939,17 @@ void buildPolyscopeGui() {
     if (ImGui::Button("Force refresh")) {
       refresh();
     }
+    ImGui::SameLine();
+    ImGui::Checkbox("Profiler", &options::enableProfiler);
     ImGui::Checkbox("Show pick buffer", &options::debugDrawPickBuffer);
     ImGui::Checkbox("Always redraw", &options::alwaysRedraw);
+    if (ImGui::Checkbox("Frustum culling", &options::frustumCulling)) {
+      requestRedraw();
+    }
+    const CullingStats& stats = state::globalContext.cullingStats;
+    ImGui::Text("  culled %zu/%zu structures, %zu/%zu chunks", stats.nStructuresCulled,
+                stats.nStructuresCulled + stats.nStructuresDrawn, stats.nChunksCulled,
+                stats.nChunksCulled + stats.nChunksDrawn);
 
     static bool showDebugTextures = false;
     ImGui::Checkbox("Show debug textures", &showDebugTextures);
@@ -1053,6 +1110,7 @@ void buildUserGuiAndInvokeCallback() {
 }
 
 void draw(bool withUI, bool withContextCallback) {
+  POLYSCOPE_PROFILE_SCOPE("draw");
   processLazyProperties();
 
   // Update buffer and context
@@ -1072,6 +1130,7 @@ void draw(bool withUI, bool withContextCallback) {
 
   // Build the GUI components
   if (withUI) {
+    POLYSCOPE_PROFILE_SCOPE("build UI");
     if (contextStack.back().drawDefaultUI) {
 
       // Note: It is important to build the user GUI first, because it is likely that callbacks there will modify
@@ -1092,10 +1151,21 @@ void draw(bool withUI, bool withContextCallback) {
             w.buildUI();
           }
         }
+
+        if (options::enableProfiler) {
+          profiler::buildProfilerUI();
+        }
       }
     }
   }
 
+  // Advance any animated structures
+  for (auto& cat : state::structures) {
+    for (auto& x : cat.second) {
+      x.second->updateTimeSeries();
+    }
+  }
+
   // Execute the context callback, if there is one.
   // This callback is a Polyscope implementation detail, which is distinct from the userCallback (which gets called
   // above)
@@ -1114,6 +1184,8 @@ void draw(bool withUI, bool withContextCallback) {
 
   // Draw the GUI
   if (withUI) {
+    POLYSCOPE_PROFILE_GPU_SCOPE("render UI");
+
     // render widgets
     render::engine->bindDisplay();
     for (WeakHandle<Widget> wHandle : state::widgets) {
@@ -1131,6 +1203,8 @@ void draw(bool withUI, bool withContextCallback) {
 
 void mainLoopIteration() {
   markLastFrameTime();
+  state::globalContext.frameIndex++;
+  profiler::beginFrame();
 
   processLazyProperties();
   processLazyPropertiesOutsideOfImGui();
@@ -1146,7 +1220,13 @@ void mainLoopIteration() {
 
   // Rendering
   draw();
+  {
+    POLYSCOPE_PROFILE_SCOPE("shader warm-up");
+    render::engine->processShaderWarmup(); // after the frame's own work, so warm-up does not delay it
+  }
   render::engine->swapDisplayBuffers();
+
+  profiler::endFrame();
 }
 
 void show(size_t forFrames) {
@@ -1236,6 +1316,7 @@ void shutdown(bool allowMidFrameShutdown) {
   }
 
   removeEverything();
+  profiler::clear(); // pending GPU timings belong to the engine
 
   // Shut down the render engine
   render::engine->shutdown();
@@ -1355,8 +1436,16 @@ void removeStructure(std::string type, std::string name, bool errorIfAbsent) {
     g.second->removeChildStructure(*s);
   }
   resetSelectionIfStructure(s);
+  for (auto& q : s->quantities) {
+    pick::releasePickBufferRange(q.second.get());
+  }
+  for (auto& q : s->floatingQuantities) {
+    pick::releasePickBufferRange(q.second.get());
+  }
+  pick::releasePickBufferRange(s);
   sMap.erase(s->name);
   updateStructureExtents();
+  requestRedraw();
   return;
 }
 
@@ -1480,6 +1569,7 @@ void refresh() {
 }
 
 void processLazyProperties() {
+  POLYSCOPE_PROFILE_SCOPE("processLazyProperties");
 
   // Note: This function essentially represents lazy software design, and it's an ugly and error-prone part of the
   // system. The reason for it that some settings require action on a change (e..g re-drawing the scene), but we want to
@@ -0,0 +1,336 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/profiler.h"
+
+#include "polyscope/messages.h"
+#include "polyscope/options.h"
+#include "polyscope/polyscope.h"
+#include "polyscope/render/engine.h"
+
+#include "imgui.h"
+
+#include "nlohmann/json.hpp"
+using json = nlohmann::json;
+
+#include <cfloat>
+#include <cstdio>
+#include <fstream>
+
+namespace polyscope {
+namespace profiler {
+
+namespace {
+
+// How many completed frames are kept
+const size_t maxRecordedFrames = 300;
+
+// Frames still waiting on GPU timings after this many newer frames are dropped (the timings should never take that
+// long, but don't hold on to frames forever if they do)
+const size_t maxPendingFrames = 16;
+
+ProfilerState& profilerState() { return state::globalContext.profilerState; }
+
+double millisecondsBetween(std::chrono::steady_clock::time_point start, std::chrono::steady_clock::time_point end) {
+  return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+bool shouldRecord() { return isCompiledIn() && options::enableProfiler; }
+
+void releaseGPUTimings(ProfilerState::PendingFrame& pending) {
+  if (render::engine == nullptr) return;
+  for (ProfilerState::PendingGPUTiming& t : pending.gpuTimings) {
+    if (!t.haveStart) render::engine->releaseGPUTimestamp(t.startQuery);
+    if (!t.haveEnd) render::engine->releaseGPUTimestamp(t.endQuery);
+  }
+}
+
+// Move frames whose GPU timings have all arrived to the list of completed frames
+void resolvePendingFrames() {
+  ProfilerState& p = profilerState();
+
+  while (p.pendingFrames.size() > maxPendingFrames) {
+    releaseGPUTimings(p.pendingFrames.front());
+    p.pendingFrames.pop_front();
+  }
+
+  while (!p.pendingFrames.empty()) {
+    ProfilerState::PendingFrame& pending = p.pendingFrames.front();
+
+    bool allResolved = true;
+    for (ProfilerState::PendingGPUTiming& t : pending.gpuTimings) {
+      if (render::engine == nullptr) break;
+      if (!t.haveStart) t.haveStart = render::engine->readGPUTimestamp(t.startQuery, t.startNs);
+      if (!t.haveEnd) t.haveEnd = render::engine->readGPUTimestamp(t.endQuery, t.endNs);
+      allResolved = allResolved && t.haveStart && t.haveEnd;
+    }
+    if (!allResolved) break; // the GPU finishes frames in order, later frames can't be ready either
+
+    for (ProfilerState::PendingGPUTiming& t : pending.gpuTimings) {
+      uint64_t elapsedNs = t.endNs > t.startNs ? t.endNs - t.startNs : 0;
+      pending.frame.scopes[t.iScope].gpuDurationMs = 1e-6 * static_cast<double>(elapsedNs);
+    }
+    p.frames.push_back(std::move(pending.frame));
+    p.pendingFrames.pop_front();
+  }
+
+  while (p.frames.size() > maxRecordedFrames) {
+    p.frames.pop_front();
+  }
+}
+
+} // namespace
+
+bool isCompiledIn() {
+#ifdef POLYSCOPE_PROFILER_ENABLED
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool beginScope(const char* name, bool timeGPU) {
+  // check before building a string, scopes are opened many times per frame whether or not they are recorded
+  if (!profilerState().frameOpen && !shouldRecord()) return false;
+  return beginScope(std::string(name), timeGPU);
+}
+
+bool beginScope(const std::string& name, bool timeGPU) {
+  ProfilerState& p = profilerState();
+
+  if (!p.frameOpen) {
+    if (!shouldRecord()) return false;
+    beginFrame();
+    if (!p.frameOpen) return false;
+    p.implicitFrame = true;
+  }
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+  ScopeTiming scope;
+  scope.name = name;
+  scope.depth = static_cast<int>(p.openScopes.size());
+  scope.cpuStartMs = millisecondsBetween(p.frameStart, now);
+
+  ProfilerState::OpenScope open{p.currFrame.frame.scopes.size(), now, false, 0};
+  if (timeGPU && render::engine != nullptr) {
+    open.timeGPU = true;
+    open.gpuStartQuery = render::engine->recordGPUTimestamp();
+  }
+
+  p.currFrame.frame.scopes.push_back(scope);
+  p.openScopes.push_back(open);
+  return true;
+}
+
+void endScope() {
+  ProfilerState& p = profilerState();
+  if (p.openScopes.empty()) return;
+
+  ProfilerState::OpenScope open = p.openScopes.back();
+  p.openScopes.pop_back();
+
+  ScopeTiming& scope = p.currFrame.frame.scopes[open.iScope];
+  scope.cpuDurationMs = millisecondsBetween(open.start, std::chrono::steady_clock::now());
+  if (open.timeGPU && render::engine != nullptr) {
+    ProfilerState::PendingGPUTiming t;
+    t.iScope = open.iScope;
+    t.startQuery = open.gpuStartQuery;
+    t.endQuery = render::engine->recordGPUTimestamp();
+    p.currFrame.gpuTimings.push_back(t);
+    scope.gpuDurationMs = 0.; // filled in once the GPU gets there
+  }
+
+  if (p.openScopes.empty() && p.implicitFrame) {
+    endFrame();
+  }
+}
+
+void beginFrame() {
+  ProfilerState& p = profilerState();
+
+  // GPU timings from earlier frames may have arrived since, even if we are no longer recording
+  resolvePendingFrames();
+
+  // a nested main loop (show() called from a callback) is recorded as part of the outer frame
+  if (p.frameOpen) {
+    p.nestedFrameDepth++;
+    return;
+  }
+
+  bool wasRecording = p.recording;
+  p.recording = shouldRecord();
+  if (!p.recording) return;
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  if (!wasRecording) {
+    p.recordingStart = now;
+  }
+
+  p.frameOpen = true;
+  p.implicitFrame = false;
+  p.frameStart = now;
+  p.currFrame = ProfilerState::PendingFrame();
+  p.currFrame.frame.frameIndex = state::globalContext.frameIndex;
+  p.currFrame.frame.cpuStartMs = millisecondsBetween(p.recordingStart, now);
+}
+
+void endFrame() {
+  ProfilerState& p = profilerState();
+  if (!p.frameOpen) return;
+  if (p.nestedFrameDepth > 0) {
+    p.nestedFrameDepth--;
+    return;
+  }
+
+  // close anything left open (which can only happen if a scope was opened without the macros)
+  p.implicitFrame = false;
+  while (!p.openScopes.empty()) {
+    endScope();
+  }
+
+  p.currFrame.frame.cpuDurationMs = millisecondsBetween(p.frameStart, std::chrono::steady_clock::now());
+  p.frameOpen = false;
+
+  p.pendingFrames.push_back(std::move(p.currFrame));
+  p.currFrame = ProfilerState::PendingFrame();
+  resolvePendingFrames();
+}
+
+const std::deque<FrameTiming>& getFrames() { return profilerState().frames; }
+
+void clear() {
+  ProfilerState& p = profilerState();
+  for (ProfilerState::PendingFrame& pending : p.pendingFrames) {
+    releaseGPUTimings(pending);
+  }
+  p.pendingFrames.clear();
+  p.frames.clear();
+}
+
+std::string getChromeTrace() {
+  // Scopes are "complete" events ("ph": "X"), with times in microseconds. Metadata events name the two threads.
+  const int cpuThread = 1;
+  const int gpuThread = 2;
+
+  json events = json::array();
+  events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", cpuThread}, {"args", {{"name", "CPU"}}}});
+  events.push_back({{"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", gpuThread}, {"args", {{"name", "GPU"}}}});
+
+  for (const FrameTiming& frame : profilerState().frames) {
+    double frameStartUs = 1000. * frame.cpuStartMs;
+    events.push_back({{"name", "frame"},
+                      {"ph", "X"},
+                      {"pid", 1},
+                      {"tid", cpuThread},
+                      {"ts", frameStartUs},
+                      {"dur", 1000. * frame.cpuDurationMs},
+                      {"args", {{"frameIndex", frame.frameIndex}}}});
+
+    for (const ScopeTiming& scope : frame.scopes) {
+      double startUs = frameStartUs + 1000. * scope.cpuStartMs;
+      events.push_back({{"name", scope.name},
+                        {"ph", "X"},
+                        {"pid", 1},
+                        {"tid", cpuThread},
+                        {"ts", startUs},
+                        {"dur", 1000. * scope.cpuDurationMs}});
+
+      // the GPU clock can't be related to the CPU clock, so GPU work is shown starting along with the scope which
+      // issued it
+      if (scope.gpuDurationMs >= 0.) {
+        events.push_back({{"name", scope.name},
+                          {"ph", "X"},
+                          {"pid", 1},
+                          {"tid", gpuThread},
+                          {"ts", startUs},
+                          {"dur", 1000. * scope.gpuDurationMs}});
+      }
+    }
+  }
+
+  json trace = {{"traceEvents", events}, {"displayTimeUnit", "ms"}};
+  return trace.dump();
+}
+
+void saveChromeTrace(std::string filename) {
+  std::ofstream outFile(filename);
+  if (!outFile) {
+    exception("could not open profiler trace file " + filename + " for writing");
+  }
+  outFile << getChromeTrace();
+  info("saved profiler trace to " + filename);
+}
+
+void buildProfilerUI() {
+  ProfilerState& p = profilerState();
+
+  ImGui::SetNextWindowSize(ImVec2(420, 360), ImGuiCond_FirstUseEver);
+  if (!ImGui::Begin("Profiler", &options::enableProfiler)) {
+    ImGui::End();
+    return;
+  }
+
+  if (!isCompiledIn()) {
+    ImGui::TextWrapped("The profiler was compiled out of this build (see POLYSCOPE_ENABLE_PROFILER).");
+    ImGui::End();
+    return;
+  }
+
+  if (ImGui::Button("Clear")) {
+    clear();
+  }
+  ImGui::SameLine();
+  if (ImGui::Button("Save trace")) {
+    saveChromeTrace("polyscope_trace.json");
+  }
+  ImGui::SameLine();
+  ImGui::Text("%zu frames recorded", p.frames.size());
+
+  if (p.frames.empty()) {
+    ImGui::TextUnformatted("waiting for frames...");
+    ImGui::End();
+    return;
+  }
+
+  // Frame time history
+  std::vector<float> frameTimes;
+  for (const FrameTiming& frame : p.frames) {
+    frameTimes.push_back(static_cast<float>(frame.cpuDurationMs));
+  }
+  const FrameTiming& lastFrame = p.frames.back();
+  char overlay[64];
+  std::snprintf(overlay, sizeof(overlay), "last frame %.2f ms", lastFrame.cpuDurationMs);
+  ImGui::PlotLines("##frame times", &frameTimes[0], static_cast<int>(frameTimes.size()), 0, overlay, 0.f, FLT_MAX,
+                   ImVec2(-1, 50));
+
+  // Scopes in the most recent frame
+  ImGuiTableFlags flags = ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_ScrollY;
+  if (ImGui::BeginTable("profiler scopes", 3, flags)) {
+    ImGui::TableSetupScrollFreeze(0, 1);
+    ImGui::TableSetupColumn("scope", ImGuiTableColumnFlags_WidthStretch);
+    ImGui::TableSetupColumn("CPU ms", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableSetupColumn("GPU ms", ImGuiTableColumnFlags_WidthFixed);
+    ImGui::TableHeadersRow();
+
+    for (const ScopeTiming& scope : lastFrame.scopes) {
+      ImGui::TableNextRow();
+      ImGui::TableNextColumn();
+      ImGui::Text("%*s%s", 2 * scope.depth, "", scope.name.c_str());
+      ImGui::TableNextColumn();
+      ImGui::Text("%.3f", scope.cpuDurationMs);
+      ImGui::TableNextColumn();
+      if (scope.gpuDurationMs >= 0.) {
+        ImGui::Text("%.3f", scope.gpuDurationMs);
+      } else {
+        ImGui::TextUnformatted("-");
+      }
+    }
+
+    ImGui::EndTable();
+  }
+
+  ImGui::End();
+}
+
+} // namespace profiler
+} // namespace polyscope
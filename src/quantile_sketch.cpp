@@ -0,0 +1,123 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/quantile_sketch.h"
+
+#include "polyscope/messages.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+namespace polyscope {
+
+QuantileSketch::QuantileSketch(size_t k_) : k(std::max(k_, static_cast<size_t>(8))) { addLevel(); }
+
+void QuantileSketch::addLevel() {
+  levels.emplace_back();
+
+  // Capacities shrink geometrically from the top level down, so lower levels (whose items carry less weight) hold
+  // fewer items
+  levelCapacities.resize(levels.size());
+  capacity = 0;
+  for (size_t iLevel = 0; iLevel < levels.size(); iLevel++) {
+    size_t depth = levels.size() - 1 - iLevel;
+    double cap = std::ceil(k * std::pow(2. / 3., static_cast<double>(depth)));
+    levelCapacities[iLevel] = std::max(static_cast<size_t>(2), static_cast<size_t>(cap));
+    capacity += levelCapacities[iLevel];
+  }
+}
+
+bool QuantileSketch::randomBit() {
+  // xorshift32
+  randState ^= randState << 13;
+  randState ^= randState >> 17;
+  randState ^= randState << 5;
+  return (randState & 1) != 0;
+}
+
+void QuantileSketch::compactLevel(size_t iLevel) {
+  if (iLevel + 1 == levels.size()) {
+    addLevel();
+  }
+  std::vector<double>& level = levels[iLevel];
+  std::vector<double>& above = levels[iLevel + 1];
+
+  // An odd item out stays behind
+  double leftover = 0.;
+  bool hasLeftover = level.size() % 2 == 1;
+  if (hasLeftover) {
+    leftover = level.back();
+    level.pop_back();
+  }
+
+  // Keep every other item (starting at a random offset), each now standing in for twice as many values
+  std::sort(level.begin(), level.end());
+  for (size_t i = randomBit() ? 1 : 0; i < level.size(); i += 2) {
+    above.push_back(level[i]);
+  }
+  nItems -= level.size() / 2;
+  level.clear();
+  if (hasLeftover) level.push_back(leftover);
+}
+
+void QuantileSketch::compress() {
+  while (nItems > capacity) {
+    for (size_t iLevel = 0; iLevel < levels.size(); iLevel++) {
+      if (levels[iLevel].size() >= levelCapacities[iLevel]) {
+        compactLevel(iLevel);
+        break;
+      }
+    }
+  }
+}
+
+void QuantileSketch::add(double val) {
+  levels[0].push_back(val);
+  n++;
+  nItems++;
+  if (nItems > capacity) {
+    compress();
+  }
+}
+
+void QuantileSketch::merge(const QuantileSketch& other) {
+  while (levels.size() < other.levels.size()) {
+    addLevel();
+  }
+  for (size_t iLevel = 0; iLevel < other.levels.size(); iLevel++) {
+    levels[iLevel].insert(levels[iLevel].end(), other.levels[iLevel].begin(), other.levels[iLevel].end());
+  }
+  n += other.n;
+  nItems += other.nItems;
+  compress();
+}
+
+size_t QuantileSketch::count() const { return n; }
+
+double QuantileSketch::quantile(double q) const {
+  if (n == 0) exception("cannot take a quantile of an empty sketch");
+  q = std::min(std::max(q, 0.), 1.);
+
+  // Gather weighted items in sorted order
+  std::vector<std::pair<double, uint64_t>> items;
+  items.reserve(nItems);
+  uint64_t totalWeight = 0;
+  for (size_t iLevel = 0; iLevel < levels.size(); iLevel++) {
+    uint64_t weight = static_cast<uint64_t>(1) << iLevel;
+    for (double v : levels[iLevel]) {
+      items.emplace_back(v, weight);
+      totalWeight += weight;
+    }
+  }
+  std::sort(items.begin(), items.end());
+
+  double targetWeight = q * totalWeight;
+  uint64_t cumWeight = 0;
+  for (const std::pair<double, uint64_t>& item : items) {
+    cumWeight += item.second;
+    if (cumWeight >= targetWeight) return item.first;
+  }
+  return items.back().first;
+}
+
+} // namespace polyscope
@@ -83,4 +83,6 @@ std::string Quantity::niceName() { return name; }
 
 std::string Quantity::uniquePrefix() { return parent.uniquePrefix() + name + "#"; }
 
+bool Quantity::isDrawnWithinParentBounds() { return true; }
+
 } // namespace polyscope
@@ -4,12 +4,20 @@
 #include "polyscope/render/engine.h"
 
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/colormap_defs.h"
 #include "polyscope/render/material_defs.h"
 
 #include "imgui.h"
 #include "stb_image.h"
 
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <future>
+#include <memory>
+#include <tuple>
+
 namespace polyscope {
 
 int dimension(const TextureFormat& x) {
@@ -77,6 +85,12 @@ std::string renderDataTypeName(const RenderDataType& r) {
     return "Vector3UInt";
   case RenderDataType::Vector4UInt:
     return "Vector4UInt";
+  case RenderDataType::UInt8:
+    return "UInt8";
+  case RenderDataType::UInt16:
+    return "UInt16";
+  case RenderDataType::Vector4UInt8:
+    return "Vector4UInt8";
   }
   return "";
 }
@@ -109,6 +123,12 @@ int sizeInBytes(const RenderDataType& r) {
     return 3 * 4;
   case RenderDataType::Vector4UInt:
     return 4 * 4;
+  case RenderDataType::UInt8:
+    return 1;
+  case RenderDataType::UInt16:
+    return 2;
+  case RenderDataType::Vector4UInt8:
+    return 4 * 1;
   }
   return -1;
 }
@@ -129,6 +149,13 @@ int renderDataTypeCountCompatbility(const RenderDataType r1, const RenderDataTyp
   if (r1 == RenderDataType::Vector3UInt && r2 == RenderDataType::UInt) return 3;
   if (r1 == RenderDataType::Vector4UInt && r2 == RenderDataType::UInt) return 4;
 
+  // compact storage types, converted to float as they are fetched
+  if (r1 == RenderDataType::Float && r2 == RenderDataType::UInt8) return 1;
+  if (r1 == RenderDataType::Float && r2 == RenderDataType::UInt16) return 1;
+  if (r1 == RenderDataType::Float && r2 == RenderDataType::Int) return 1;
+  if (r1 == RenderDataType::Vector3Float && r2 == RenderDataType::Vector4UInt8) return 1;
+  if (r1 == RenderDataType::Vector4Float && r2 == RenderDataType::Vector4UInt8) return 1;
+
   // there are other combinations of types which could be compatible, we don't handle them yet
   //
   return 0;
@@ -252,6 +279,52 @@ void FrameBuffer::resize(unsigned int newXSize, unsigned int newYSize) {
   sizeY = newYSize;
 }
 
+std::vector<std::array<float, 4>> FrameBuffer::readFloat4Pixels(const std::vector<glm::ivec2>& positions) {
+  std::vector<std::array<float, 4>> result(positions.size());
+  for (size_t i = 0; i < positions.size(); i++) {
+    result[i] = readFloat4(positions[i].x, positions[i].y);
+  }
+  return result;
+}
+
+std::vector<float> FrameBuffer::readDepthPixels(const std::vector<glm::ivec2>& positions) {
+  std::vector<float> result(positions.size());
+  for (size_t i = 0; i < positions.size(); i++) {
+    result[i] = readDepth(positions[i].x, positions[i].y);
+  }
+  return result;
+}
+
+std::vector<std::array<uint32_t, 2>> FrameBuffer::readUInt2Pixels(const std::vector<glm::ivec2>& positions) {
+  std::vector<std::array<uint32_t, 2>> result(positions.size());
+  for (size_t i = 0; i < positions.size(); i++) {
+    result[i] = readUInt2(positions[i].x, positions[i].y);
+  }
+  return result;
+}
+
+bool FrameBuffer::hasIntegerColorBuffer() const {
+  return !renderBuffersColor.empty() && renderBuffersColor[0]->getType() == RenderBufferType::UInt2;
+}
+
+void FrameBuffer::requestAsyncReadPixel(int xPos, int yPos) {
+  asyncReadResult = PixelReadResult();
+  if (hasIntegerColorBuffer()) {
+    asyncReadResult.uint2 = readUInt2(xPos, yPos);
+  } else {
+    asyncReadResult.float4 = readFloat4(xPos, yPos);
+  }
+  asyncReadResult.depth = readDepth(xPos, yPos);
+  asyncReadPending = true;
+}
+
+bool FrameBuffer::pollAsyncReadPixel(PixelReadResult& result) {
+  if (!asyncReadPending) return false;
+  result = asyncReadResult;
+  asyncReadPending = false;
+  return true;
+}
+
 void FrameBuffer::verifyBufferSizes() {
   for (auto& b : renderBuffersColor) {
     if (b->getSizeX() != getSizeX() || b->getSizeY() != getSizeY())
@@ -273,6 +346,24 @@ ShaderReplacementRule::ShaderReplacementRule(std::string ruleName_,
     : ruleName(ruleName_), replacements(replacements_), uniforms(uniforms_), attributes(attributes_),
       textures(textures_) {}
 
+ShaderReplacementRule::ShaderReplacementRule(std::string ruleName_,
+                                             std::vector<std::pair<std::string, std::string>> replacements_,
+                                             std::vector<ShaderSpecUniform> uniforms_,
+                                             std::vector<ShaderSpecAttribute> attributes_,
+                                             std::vector<ShaderSpecTexture> textures_,
+                                             std::vector<std::string> blockUniforms_)
+    : ruleName(ruleName_), replacements(replacements_), uniforms(uniforms_), attributes(attributes_),
+      textures(textures_), blockUniforms(blockUniforms_) {}
+
+namespace {
+size_t nextUniformNameSlot() {
+  static size_t nextSlot = 0;
+  return nextSlot++;
+}
+} // namespace
+
+UniformName::UniformName(std::string name_) : name(name_), slot(nextUniformNameSlot()) {}
+
 ShaderProgram::ShaderProgram(DrawMode dm) : drawMode(dm), uniqueID(render::engine->getNextUniqueID()) {
 
   drawMode = dm;
@@ -286,6 +377,26 @@ ShaderProgram::ShaderProgram(DrawMode dm) : drawMode(dm), uniqueID(render::engin
   }
 }
 
+UniformHandle ShaderProgram::findUniform(const UniformName& uniform) {
+  if (uniform.slot >= foundUniforms.size()) foundUniforms.resize(uniform.slot + 1);
+  std::pair<bool, UniformHandle>& found = foundUniforms[uniform.slot];
+  if (!found.first) {
+    found.second = lookupUniformHandle(uniform.name);
+    found.first = true;
+  }
+  return found.second;
+}
+
+void ShaderProgram::setDrawRanges(const std::vector<DrawRange>& ranges) {
+  drawRanges = ranges;
+  useDrawRanges = true;
+}
+
+void ShaderProgram::clearDrawRanges() {
+  drawRanges.clear();
+  useDrawRanges = false;
+}
+
 
 Engine::Engine() {}
 Engine::~Engine() {}
@@ -438,6 +549,16 @@ void Engine::buildEngineGui() {
       ImGui::TreePop();
     }
 
+    // == Shader programs
+    ImGui::SetNextItemOpen(false, ImGuiCond_FirstUseEver);
+    if (ImGui::TreeNode("Shader Programs")) {
+      ImGui::Text("compiled: %d (%.3f sec)", static_cast<int>(shaderProgramStats.nCompiled),
+                  shaderProgramStats.compileSeconds);
+      ImGui::Text("loaded from cache: %d (%.3f sec)", static_cast<int>(shaderProgramStats.nLoadedFromCache),
+                  shaderProgramStats.loadFromCacheSeconds);
+      ImGui::TreePop();
+    }
+
     ImGui::TreePop();
   }
 }
@@ -459,8 +580,129 @@ void Engine::setBackgroundAlpha(float newAlpha) {
 void Engine::setCurrentViewport(glm::vec4 val) { currViewport = val; }
 glm::vec4 Engine::getCurrentViewport() { return currViewport; }
 void Engine::setCurrentPixelScaling(float val) { currPixelScale = val; }
+
+void Engine::updateFrameUniforms() {
+  FrameUniforms data;
+  data.projMatrix = view::getCameraPerspectiveMatrix();
+  data.invProjMatrix = glm::inverse(data.projMatrix);
+  data.viewport = getCurrentViewport();
+  data.viewportDim = glm::vec2{data.viewport[2], data.viewport[3]};
+  data.padding = glm::vec2{0., 0.};
+
+  if (frameUniformsValid && std::memcmp(&data, &currFrameUniforms, sizeof(FrameUniforms)) == 0) return;
+
+  uploadFrameUniforms(data);
+  currFrameUniforms = data;
+  frameUniformsValid = true;
+}
 float Engine::getCurrentPixelScaling() { return currPixelScale; }
 
+void Engine::beginRenderQueue() {
+  if (renderQueueDepth == 0) {
+    renderQueueEnabled = options::sortDrawCalls;
+    renderQueueBaseBlendMode = currBlendMode;
+    renderQueueCurrentDepth = 0.;
+    renderQueueProfileScopes.clear();
+    renderQueueCurrentProfileScope = INVALID_IND;
+  }
+  renderQueueDepth++;
+}
+
+void Engine::endRenderQueue() {
+  if (renderQueueDepth == 0) exception("endRenderQueue() called without a matching beginRenderQueue()");
+  renderQueueDepth--;
+  if (renderQueueDepth == 0 && renderQueueEnabled) {
+    executeRenderQueue();
+  }
+}
+
+void Engine::setRenderQueueDepth(float depth) { renderQueueCurrentDepth = depth; }
+
+void Engine::setRenderQueueProfileScope(const std::string& name) {
+  if (!renderQueueActive()) return;
+  renderQueueCurrentProfileScope = renderQueueProfileScopes.size();
+  renderQueueProfileScopes.push_back(name);
+}
+
+RenderQueueItem Engine::newRenderQueueItem(ShaderProgram* program) {
+  RenderQueueItem item;
+  item.program = program;
+  item.depthMode = currDepthMode;
+  item.blendMode = currBlendMode;
+  item.colorMask = currColorMask;
+  item.backfaceCull = currBackfaceCull;
+  bool depthReadWrite = currDepthMode == DepthMode::Less || currDepthMode == DepthMode::LEqual ||
+                        currDepthMode == DepthMode::Greater;
+  item.orderDependent = currBlendMode != renderQueueBaseBlendMode || !depthReadWrite;
+  item.depth = renderQueueCurrentDepth;
+  item.submissionIndex = renderQueue.size();
+  item.profileScope = renderQueueCurrentProfileScope;
+  return item;
+}
+
+void Engine::enqueueDraw(RenderQueueItem&& item) { renderQueue.push_back(std::move(item)); }
+
+void Engine::executeRenderQueue() {
+
+  // Draws which can be reordered come first, grouped so that as little state as possible changes between them. The
+  // rest are drawn back-to-front. Ties keep the order in which they were submitted.
+  std::stable_sort(renderQueue.begin(), renderQueue.end(), [](const RenderQueueItem& a, const RenderQueueItem& b) {
+    if (a.orderDependent != b.orderDependent) return !a.orderDependent;
+    if (a.orderDependent) return a.depth > b.depth;
+    return std::tie(a.programKey, a.textureKey, a.blendMode, a.depthMode, a.backfaceCull, a.colorMask) <
+           std::tie(b.programKey, b.textureKey, b.blendMode, b.depthMode, b.backfaceCull, b.colorMask);
+  });
+
+  // The state requested when the queue closed, which is restored afterwards
+  DepthMode requestedDepthMode = currDepthMode;
+  BlendMode requestedBlendMode = currBlendMode;
+  std::array<bool, 4> requestedColorMask = currColorMask;
+  bool requestedBackfaceCull = currBackfaceCull;
+
+  // Nothing was applied while the queue was open, so the actual state is unknown until the first draw sets it
+  bool stateKnown = false;
+  const RenderQueueItem* prevItem = nullptr;
+
+#ifdef POLYSCOPE_PROFILER_ENABLED
+  // Each run of consecutive draws from one structure is timed on the GPU under that structure's name, since its draws
+  // are only issued here. Sorting may split a structure's draws into several runs.
+  std::unique_ptr<profiler::ScopedTimer> profileTimer;
+#endif
+
+  for (RenderQueueItem& item : renderQueue) {
+#ifdef POLYSCOPE_PROFILER_ENABLED
+    if (prevItem == nullptr || item.profileScope != prevItem->profileScope) {
+      profileTimer.reset();
+      if (item.profileScope != INVALID_IND) {
+        profileTimer.reset(new profiler::ScopedTimer(renderQueueProfileScopes[item.profileScope], true));
+      }
+    }
+#endif
+
+    if (!stateKnown || item.depthMode != currDepthMode) setDepthMode(item.depthMode);
+    if (!stateKnown || item.blendMode != currBlendMode) setBlendMode(item.blendMode);
+    if (!stateKnown || item.colorMask != currColorMask) setColorMask(item.colorMask);
+    if (!stateKnown || item.backfaceCull != currBackfaceCull) setBackfaceCull(item.backfaceCull);
+    stateKnown = true;
+
+    item.sameTexturesAsPrevious =
+        prevItem != nullptr && prevItem->programKey == item.programKey && prevItem->textureKey == item.textureKey;
+    item.program->drawQueued(item);
+    prevItem = &item;
+  }
+#ifdef POLYSCOPE_PROFILER_ENABLED
+  profileTimer.reset();
+#endif
+  renderQueue.clear();
+  renderQueueProfileScopes.clear();
+  renderQueueCurrentProfileScope = INVALID_IND;
+
+  if (!stateKnown || requestedDepthMode != currDepthMode) setDepthMode(requestedDepthMode);
+  if (!stateKnown || requestedBlendMode != currBlendMode) setBlendMode(requestedBlendMode);
+  if (!stateKnown || requestedColorMask != currColorMask) setColorMask(requestedColorMask);
+  if (!stateKnown || requestedBackfaceCull != currBackfaceCull) setBackfaceCull(requestedBackfaceCull);
+}
+
 void Engine::bindDisplay() {
   FrameBuffer& targetBuffer = getDisplayBuffer();
   targetBuffer.bindForRendering();
@@ -572,7 +814,8 @@ void Engine::setTonemapUniforms(ShaderProgram& p) {
 }
 
 void Engine::setMaterial(ShaderProgram& program, const std::string& mat) {
-  const Material& m = getMaterial(mat);
+  Material& m = getMaterial(mat);
+  ensureMaterialTexturesLoaded(m);
   if (m.textureBuffers[0]) program.setTextureFromBuffer("t_mat_r", m.textureBuffers[0].get());
   if (m.textureBuffers[1]) program.setTextureFromBuffer("t_mat_g", m.textureBuffers[1].get());
   if (m.textureBuffers[2]) program.setTextureFromBuffer("t_mat_b", m.textureBuffers[2].get());
@@ -726,13 +969,15 @@ void Engine::allocateGlobalBuffersAndPrograms() {
   }
 
   { // Pick buffer
-    pickColorBuffer = generateRenderBuffer(RenderBufferType::Float4, view::bufferWidth, view::bufferHeight);
+    RenderBufferType pickType = options::integerPickBuffer ? RenderBufferType::UInt2 : RenderBufferType::Float4;
+    pickColorBuffer = generateRenderBuffer(pickType, view::bufferWidth, view::bufferHeight);
     pickDepthBuffer = generateRenderBuffer(RenderBufferType::Depth, view::bufferWidth, view::bufferHeight);
 
     pickFramebuffer = generateFrameBuffer(view::bufferWidth, view::bufferHeight);
     pickFramebuffer->addColorBuffer(pickColorBuffer);
     pickFramebuffer->addDepthBuffer(pickDepthBuffer);
     pickFramebuffer->setDrawBuffers();
+    pick::invalidatePickBuffer();
   }
 
   // Make sure all the buffer sizes are up to date
@@ -774,6 +1019,44 @@ uint64_t Engine::getNextUniqueID() {
   return thisID;
 }
 
+void Engine::requestShaderWarmup(const std::string& programName, const std::vector<std::string>& customRules,
+                                 ShaderReplacementDefaults defaults) {
+  shaderWarmupQueue.push_back(ShaderWarmupRequest{programName, customRules, defaults});
+}
+
+void Engine::processShaderWarmup() {
+  if (nPendingShaderWarmups() == 0) return;
+
+  std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+  std::chrono::duration<double, std::milli> budget(options::shaderWarmupMillisecondsPerFrame);
+
+  // In the background, hand everything to the driver right away. Otherwise compile as many as fit in this frame's
+  // budget (but always at least one).
+  bool background = supportsBackgroundShaderWarmup();
+  while (!shaderWarmupQueue.empty()) {
+    ShaderWarmupRequest request = shaderWarmupQueue.front();
+    shaderWarmupQueue.pop_front();
+    startShaderWarmup(request, background);
+    if (!background && std::chrono::steady_clock::now() - startTime > budget) break;
+  }
+
+  pollShaderWarmups(false);
+}
+
+void Engine::finishShaderWarmup() {
+  // Submit everything before waiting on anything, so the driver can work on all of them at once
+  bool background = supportsBackgroundShaderWarmup();
+  while (!shaderWarmupQueue.empty()) {
+    ShaderWarmupRequest request = shaderWarmupQueue.front();
+    shaderWarmupQueue.pop_front();
+    startShaderWarmup(request, background);
+  }
+
+  pollShaderWarmups(true);
+}
+
+size_t Engine::nPendingShaderWarmups() { return shaderWarmupQueue.size(); }
+
 void Engine::pushBindFramebufferForRendering(FrameBuffer& f) {
   if (currRenderFramebuffer == nullptr) exception("tried to push current framebuff on to stack, but it is null");
   renderFramebufferStack.push_back(currRenderFramebuffer);
@@ -919,9 +1202,11 @@ void Engine::freeAllOwnedResources() {
   groundPlane.freeAllOwnedResources();
   materials.clear();
   resourcesPreservedForImGuiFrame.clear();
+  shaderWarmupQueue.clear();
 }
 
 // Helper (TODO rework to load custom materials)
+// Only records where the encoded images live, they are decoded by ensureMaterialTexturesLoaded() on first use.
 void Engine::loadDefaultMaterial(std::string name) {
 
   Material* newMaterial = new Material();
@@ -979,17 +1264,79 @@ void Engine::loadDefaultMaterial(std::string name) {
   }
   // clang-format on
 
+  newMaterial->encodedTextures = buff;
+  newMaterial->encodedTextureSizes = buffSize;
+
+  materials.emplace_back(newMaterial);
+}
+
+namespace {
+
+struct DecodedMaterialImage {
+  float* data = nullptr;
+  int width = 0;
+  int height = 0;
+};
+
+DecodedMaterialImage decodeMaterialImage(const unsigned char* buff, size_t buffSize) {
+  DecodedMaterialImage image;
+  int nComp;
+  image.data = stbi_loadf_from_memory(buff, static_cast<int>(buffSize), &image.width, &image.height, &nComp, 3);
+  return image;
+}
+
+} // namespace
+
+void Engine::ensureMaterialTexturesLoaded(Material& material) {
+
+  // Channels which share an image with an earlier channel also share its texture
+  std::array<int, 4> sourceChannel{{-1, -1, -1, -1}};
+  bool anyEncoded = false;
   for (int i = 0; i < 4; i++) {
-    if (buff[i]) {
-      int width, height, nComp;
-      float* data = stbi_loadf_from_memory(buff[i], buffSize[i], &width, &height, &nComp, 3);
-      if (!data) exception("failed to load material");
-      newMaterial->textureBuffers[i] = loadMaterialTexture(data, width, height);
-      stbi_image_free(data);
+    if (!material.encodedTextures[i]) continue;
+    anyEncoded = true;
+    sourceChannel[i] = i;
+    for (int j = 0; j < i; j++) {
+      if (material.encodedTextures[j] == material.encodedTextures[i]) {
+        sourceChannel[i] = j;
+        break;
+      }
     }
   }
+  if (!anyEncoded) return;
 
-  materials.emplace_back(newMaterial);
+  // Decode the distinct images in parallel
+  std::array<std::future<DecodedMaterialImage>, 4> decodeJobs;
+  for (int i = 0; i < 4; i++) {
+    if (sourceChannel[i] != i) continue;
+    decodeJobs[i] = std::async(std::launch::async, decodeMaterialImage, material.encodedTextures[i],
+                               material.encodedTextureSizes[i]);
+  }
+  std::array<DecodedMaterialImage, 4> images;
+  for (int i = 0; i < 4; i++) {
+    if (decodeJobs[i].valid()) images[i] = decodeJobs[i].get();
+  }
+
+  // Upload from this thread, which owns the render context
+  bool success = true;
+  for (int i = 0; i < 4; i++) {
+    if (sourceChannel[i] != i) continue;
+    if (!images[i].data) {
+      success = false;
+      continue;
+    }
+    material.textureBuffers[i] = loadMaterialTexture(images[i].data, images[i].width, images[i].height);
+    stbi_image_free(images[i].data);
+  }
+  if (!success) exception("failed to load material " + material.name);
+
+  for (int i = 0; i < 4; i++) {
+    if (sourceChannel[i] >= 0 && sourceChannel[i] != i) {
+      material.textureBuffers[i] = material.textureBuffers[sourceChannel[i]];
+    }
+    material.encodedTextures[i] = nullptr;
+    material.encodedTextureSizes[i] = 0;
+  }
 }
 
 void Engine::loadBlendableMaterial(std::string matName, std::array<std::string, 4> filenames) {
@@ -152,6 +152,40 @@ void ManagedBuffer<T>::markHostBufferUpdated() {
   }
 }
 
+template <typename T>
+void ManagedBuffer<T>::markHostBufferRangeUpdated(size_t start, size_t end) {
+  hostBufferIsPopulated = true;
+
+  if (renderAttributeBuffer) {
+    renderAttributeBuffer->setDataRange(std::vector<T>(data.begin() + start, data.begin() + end), start);
+    requestRedraw();
+  }
+
+  if (renderTextureBuffer) {
+    // no partial texture updates, just set the whole thing
+    renderTextureBuffer->setData(data);
+    requestRedraw();
+  }
+
+  if (deviceBufferType == DeviceBufferType::Attribute) {
+    // any index could point in to the modified range, so views get fully rebuilt
+    updateIndexedViews();
+    requestRedraw();
+  }
+}
+
+template <typename T>
+void ManagedBuffer<T>::markHostBufferAppended(size_t oldSize) {
+  checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
+  hostBufferIsPopulated = true;
+
+  if (renderAttributeBuffer) {
+    renderAttributeBuffer->setDataRange(std::vector<T>(data.begin() + oldSize, data.end()), oldSize);
+  }
+
+  requestRedraw();
+}
+
 template <typename T>
 T ManagedBuffer<T>::getValue(size_t ind) {
 
@@ -407,6 +441,32 @@ std::vector<T> ManagedBuffer<T>::getIndexedView(ManagedBuffer<uint32_t>& indices
   return gather(data, indices.data);
 }
 
+template <typename T>
+void ManagedBuffer<T>::updateIndexedViewAppended(ManagedBuffer<uint32_t>& indices, size_t oldIndexSize) {
+  checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
+
+  removeDeletedIndexedViews(); // periodic filtering
+
+  for (std::tuple<render::ManagedBuffer<uint32_t>*, std::weak_ptr<render::AttributeBuffer>>& existingViewTup :
+       existingIndexedViews) {
+
+    std::shared_ptr<render::AttributeBuffer> viewBufferPtr = std::get<1>(existingViewTup).lock();
+    if (!viewBufferPtr) continue;
+    if (std::get<0>(existingViewTup)->uniqueID != indices.uniqueID) continue;
+
+    // gather and upload only the new tail of the view
+    ensureHostBufferPopulated();
+    indices.ensureHostBufferPopulated();
+    std::vector<T> tailData(indices.data.size() - oldIndexSize);
+    for (size_t i = oldIndexSize; i < indices.data.size(); i++) {
+      tailData[i - oldIndexSize] = data[indices.data[i]];
+    }
+    viewBufferPtr->setDataRange(tailData, oldIndexSize);
+  }
+
+  requestRedraw();
+}
+
 template <typename T>
 void ManagedBuffer<T>::updateIndexedViews() {
   checkDeviceBufferTypeIs(DeviceBufferType::Attribute);
@@ -545,6 +605,10 @@ std::tuple<bool, ManagedBufferType> ManagedBufferRegistry::hasManagedBufferType(
   if (hasManagedBuffer<glm::uvec3>(name)) return std::make_tuple(true, ManagedBufferType::UVec3);
   if (hasManagedBuffer<glm::uvec4>(name)) return std::make_tuple(true, ManagedBufferType::UVec4);
 
+  if (hasManagedBuffer<uint8_t>(name))  return std::make_tuple(true, ManagedBufferType::UInt8);
+  if (hasManagedBuffer<uint16_t>(name)) return std::make_tuple(true, ManagedBufferType::UInt16);
+  if (hasManagedBuffer<glm::u8vec4>(name)) return std::make_tuple(true, ManagedBufferType::U8Vec4);
+
   // clang-format on
 
   return std::make_tuple(false, ManagedBufferType::Float);
@@ -575,6 +639,10 @@ template class ManagedBuffer<glm::uvec2>;
 template class ManagedBuffer<glm::uvec3>;
 template class ManagedBuffer<glm::uvec4>;
 
+template class ManagedBuffer<uint8_t>;
+template class ManagedBuffer<uint16_t>;
+template class ManagedBuffer<glm::u8vec4>;
+
 // Buffer maps
 
 template struct ManagedBufferMap<float>;
@@ -598,6 +666,10 @@ template struct ManagedBufferMap<glm::uvec2>;
 template struct ManagedBufferMap<glm::uvec3>;
 template struct ManagedBufferMap<glm::uvec4>;
 
+template struct ManagedBufferMap<uint8_t>;
+template struct ManagedBufferMap<uint16_t>;
+template struct ManagedBufferMap<glm::u8vec4>;
+
 
 // clang-format off
 
@@ -617,6 +689,9 @@ template<> ManagedBufferMap<uint32_t>&                 ManagedBufferMap<uint32_t
 template<> ManagedBufferMap<glm::uvec2>&               ManagedBufferMap<glm::uvec2>::getManagedBufferMapRef              (ManagedBufferRegistry* r) { return r->managedBufferMap_uvec2; }
 template<> ManagedBufferMap<glm::uvec3>&               ManagedBufferMap<glm::uvec3>::getManagedBufferMapRef              (ManagedBufferRegistry* r) { return r->managedBufferMap_uvec3; }
 template<> ManagedBufferMap<glm::uvec4>&               ManagedBufferMap<glm::uvec4>::getManagedBufferMapRef              (ManagedBufferRegistry* r) { return r->managedBufferMap_uvec4; }
+template<> ManagedBufferMap<uint8_t>&                  ManagedBufferMap<uint8_t>::getManagedBufferMapRef                 (ManagedBufferRegistry* r) { return r->managedBufferMap_uint8; }
+template<> ManagedBufferMap<uint16_t>&                 ManagedBufferMap<uint16_t>::getManagedBufferMapRef                (ManagedBufferRegistry* r) { return r->managedBufferMap_uint16; }
+template<> ManagedBufferMap<glm::u8vec4>&              ManagedBufferMap<glm::u8vec4>::getManagedBufferMapRef             (ManagedBufferRegistry* r) { return r->managedBufferMap_u8vec4; }
 
 // clang-format on
 
@@ -32,6 +32,8 @@
 
 #include "stb_image.h"
 
+#include <chrono>
+
 namespace polyscope {
 namespace render {
 namespace backend_openGL_mock {
@@ -47,6 +49,21 @@ void initializeRenderEngine() {
 
 void checkGLError(bool fatal = true) {}
 
+// == Per-frame stats
+
+namespace {
+
+MockGLEngine::FrameStats& frameStats() { return static_cast<MockGLEngine*>(render::engine)->currentFrameStats; }
+
+void recordTextureUpload(size_t nBytes) { frameStats().textureBytesUploaded += nBytes; }
+
+void recordReadback(size_t nBytes) {
+  frameStats().framebufferReadbacks++;
+  frameStats().bytesReadBack += nBytes;
+}
+
+} // namespace
+
 // =============================================================
 // =================== Attribute buffer ========================
 // =============================================================
@@ -87,6 +104,7 @@ void GLAttributeBuffer::setData_helper(const std::vector<T>& data) {
 
   // do the actual copy
   dataSize = data.size();
+  frameStats().attributeBytesUploaded += data.size() * sizeof(T);
 
   checkGLError();
 }
@@ -173,7 +191,128 @@ void GLAttributeBuffer::setData(const std::vector<glm::uvec4>& data) {
   checkType(RenderDataType::Vector4UInt);
   setData_helper(data);
 }
+void GLAttributeBuffer::setData(const std::vector<uint8_t>& data) {
+  checkType(RenderDataType::UInt8);
+  setData_helper(data);
+}
+void GLAttributeBuffer::setData(const std::vector<uint16_t>& data) {
+  checkType(RenderDataType::UInt16);
+  setData_helper(data);
+}
+void GLAttributeBuffer::setData(const std::vector<glm::u8vec4>& data) {
+  checkType(RenderDataType::Vector4UInt8);
+  setData_helper(data);
+}
+
 
+// === set ranges of values
+
+template <typename T>
+void GLAttributeBuffer::setDataRange_helper(const std::vector<T>& data, size_t start) {
+  if (!isSet()) exception("setDataRange() called on a buffer which has not been set");
+  if (start > static_cast<size_t>(dataSize)) exception("setDataRange() would leave a gap in the buffer");
+
+  bind();
+
+  // grow if needed (at-least doubling), keeping the existing entries
+  size_t end = start + data.size();
+  if (end > bufferSize) {
+    bufferSize = std::max(static_cast<uint64_t>(end), 2 * bufferSize);
+  }
+
+  // copy only the range
+  dataSize = std::max(static_cast<size_t>(dataSize), end);
+  frameStats().attributeBytesUploaded += (end - start) * sizeof(T);
+
+  checkGLError();
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec2>& data, size_t start) {
+  checkType(RenderDataType::Vector2Float);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec3>& data, size_t start) {
+  checkType(RenderDataType::Vector3Float);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec4>& data, size_t start) {
+  checkType(RenderDataType::Vector4Float);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<float>& data, size_t start) {
+  checkType(RenderDataType::Float);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<double>& data, size_t start) {
+  checkType(RenderDataType::Float);
+
+  // Convert input data to floats
+  std::vector<float> floatData(data.size());
+  for (unsigned int i = 0; i < data.size(); i++) {
+    floatData[i] = static_cast<float>(data[i]);
+  }
+
+  setDataRange_helper(floatData, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<int32_t>& data, size_t start) {
+  checkType(RenderDataType::Int);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::ivec2>& data, size_t start) {
+  checkType(RenderDataType::Vector2Int);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::ivec3>& data, size_t start) {
+  checkType(RenderDataType::Vector3Int);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::ivec4>& data, size_t start) {
+  checkType(RenderDataType::Vector4Int);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<uint32_t>& data, size_t start) {
+  checkType(RenderDataType::UInt);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec2>& data, size_t start) {
+  checkType(RenderDataType::Vector2UInt);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec3>& data, size_t start) {
+  checkType(RenderDataType::Vector3UInt);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec4>& data, size_t start) {
+  checkType(RenderDataType::Vector4UInt);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<uint8_t>& data, size_t start) {
+  checkType(RenderDataType::UInt8);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<uint16_t>& data, size_t start) {
+  checkType(RenderDataType::UInt16);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::u8vec4>& data, size_t start) {
+  checkType(RenderDataType::Vector4UInt8);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t start) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(2);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t start) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(3);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t start) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(4);
+  setDataRange_helper(data, start);
+}
 
 // === get single data values
 
@@ -236,6 +375,18 @@ glm::uvec4 GLAttributeBuffer::getData_uvec4(size_t ind) {
   if (getType() != RenderDataType::Vector4UInt) exception("bad getData type");
   return getData_helper<glm::uvec4>(ind);
 }
+uint8_t GLAttributeBuffer::getData_uint8(size_t ind) {
+  if (getType() != RenderDataType::UInt8) exception("bad getData type");
+  return getData_helper<uint8_t>(ind);
+}
+uint16_t GLAttributeBuffer::getData_uint16(size_t ind) {
+  if (getType() != RenderDataType::UInt16) exception("bad getData type");
+  return getData_helper<uint16_t>(ind);
+}
+glm::u8vec4 GLAttributeBuffer::getData_u8vec4(size_t ind) {
+  if (getType() != RenderDataType::Vector4UInt8) exception("bad getData type");
+  return getData_helper<glm::u8vec4>(ind);
+}
 
 // === get ranges of values
 
@@ -305,6 +456,18 @@ std::vector<glm::uvec4> GLAttributeBuffer::getDataRange_uvec4(size_t start, size
   if (getType() != RenderDataType::Vector4UInt) exception("bad getData type");
   return getDataRange_helper<glm::uvec4>(start, count);
 }
+std::vector<uint8_t> GLAttributeBuffer::getDataRange_uint8(size_t start, size_t count) {
+  if (getType() != RenderDataType::UInt8) exception("bad getData type");
+  return getDataRange_helper<uint8_t>(start, count);
+}
+std::vector<uint16_t> GLAttributeBuffer::getDataRange_uint16(size_t start, size_t count) {
+  if (getType() != RenderDataType::UInt16) exception("bad getData type");
+  return getDataRange_helper<uint16_t>(start, count);
+}
+std::vector<glm::u8vec4> GLAttributeBuffer::getDataRange_u8vec4(size_t start, size_t count) {
+  if (getType() != RenderDataType::Vector4UInt8) exception("bad getData type");
+  return getDataRange_helper<glm::u8vec4>(start, count);
+}
 
 
 uint32_t GLAttributeBuffer::getNativeBufferID() { return 777; }
@@ -423,6 +586,7 @@ void GLTextureBuffer::setData(const std::vector<glm::vec3>& data) {
   case 3:
     break;
   }
+  recordTextureUpload(data.size() * sizeof(data[0]));
 
   checkGLError();
 }
@@ -443,6 +607,7 @@ void GLTextureBuffer::setData(const std::vector<glm::vec4>& data) {
   case 3:
     break;
   }
+  recordTextureUpload(data.size() * sizeof(data[0]));
 
   checkGLError();
 }
@@ -462,6 +627,7 @@ void GLTextureBuffer::setData(const std::vector<float>& data) {
   case 3:
     break;
   }
+  recordTextureUpload(data.size() * sizeof(data[0]));
 
   checkGLError();
 }
@@ -481,6 +647,7 @@ void GLTextureBuffer::setData(const std::vector<double>& data) {
   case 3:
     break;
   }
+  recordTextureUpload(data.size() * sizeof(float)); // uploaded as floats
 
   checkGLError();
 };
@@ -492,6 +659,18 @@ void GLTextureBuffer::setData(const std::vector<uint32_t>& data) { exception("no
 void GLTextureBuffer::setData(const std::vector<glm::uvec2>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<glm::uvec3>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<glm::uvec4>& data) { exception("not implemented"); };
+
+void GLTextureBuffer::setData(const std::vector<glm::u8vec4>& data) {
+  bind();
+
+  if (data.size() != getTotalSize()) {
+    exception("OpenGL error: texture buffer data is not the right size.");
+  }
+  if (format != TextureFormat::RGBA8) {
+    exception("OpenGL error: byte color data can only be uploaded to an RGBA8 texture.");
+  }
+  recordTextureUpload(data.size() * sizeof(glm::u8vec4));
+}
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 2>>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 3>>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 4>>& data) { exception("not implemented"); };
@@ -683,6 +862,7 @@ void GLFrameBuffer::clear() {
 std::array<float, 4> GLFrameBuffer::readFloat4(int xPos, int yPos) {
   // Read from the buffer
   std::array<float, 4> result = {1., 2., 3., 4.};
+  recordReadback(sizeof(result));
 
   return result;
 }
@@ -690,6 +870,34 @@ std::array<float, 4> GLFrameBuffer::readFloat4(int xPos, int yPos) {
 float GLFrameBuffer::readDepth(int xPos, int yPos) {
   // Read from the buffer
   float result = 0.5;
+  recordReadback(sizeof(result));
+  return result;
+}
+
+std::vector<float> GLFrameBuffer::readFloat4Region(int xStart, int yStart, int w, int h) {
+  // Read from the buffer
+  std::vector<float> result;
+  for (int i = 0; i < w * h; i++) {
+    result.insert(result.end(), {1.f, 2.f, 3.f, 4.f});
+  }
+  recordReadback(result.size() * sizeof(float));
+  return result;
+}
+
+std::array<uint32_t, 2> GLFrameBuffer::readUInt2(int xPos, int yPos) {
+  // Read from the buffer
+  std::array<uint32_t, 2> result = {1, 2};
+  recordReadback(sizeof(result));
+  return result;
+}
+
+std::vector<uint32_t> GLFrameBuffer::readUInt2Region(int xStart, int yStart, int w, int h) {
+  // Read from the buffer
+  std::vector<uint32_t> result;
+  for (int i = 0; i < w * h; i++) {
+    result.insert(result.end(), {1u, 2u});
+  }
+  recordReadback(result.size() * sizeof(uint32_t));
   return result;
 }
 
@@ -702,6 +910,7 @@ std::vector<unsigned char> GLFrameBuffer::readBuffer() {
   // Read from openGL
   size_t buffSize = w * h * 4;
   std::vector<unsigned char> buff(buffSize);
+  recordReadback(buffSize);
 
   return buff;
 }
@@ -723,7 +932,12 @@ uint32_t GLFrameBuffer::getNativeBufferID() { return 0; }
 // ==================  Shader Program  =========================
 // =============================================================
 
-GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>& stages, DrawMode dm) : drawMode(dm) {
+namespace {
+uint64_t nextCompiledProgramId = 1;
+} // namespace
+
+GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>& stages, DrawMode dm)
+    : id(nextCompiledProgramId++), drawMode(dm) {
 
   // Collect attributes and uniforms from all of the shaders
   for (const ShaderStageSpecification& s : stages) {
@@ -737,6 +951,9 @@ GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>
       addUniqueTexture(t);
     }
   }
+  for (size_t i = 0; i < uniforms.size(); i++) {
+    uniformIndices[uniforms[i].name] = static_cast<int32_t>(i);
+  }
 
   if (attributes.size() == 0) {
     throw std::invalid_argument("Uh oh... GLProgram has no attributes");
@@ -749,7 +966,16 @@ GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>
 
 GLCompiledProgram::~GLCompiledProgram() {}
 
-void GLCompiledProgram::compileGLProgram(const std::vector<ShaderStageSpecification>& stages) {}
+int32_t GLCompiledProgram::getUniformIndex(const std::string& name) const {
+  std::unordered_map<std::string, int32_t>::const_iterator it = uniformIndices.find(name);
+  if (it == uniformIndices.end()) return -1;
+  return it->second;
+}
+
+void GLCompiledProgram::compileGLProgram(const std::vector<ShaderStageSpecification>& stages) {
+  render::engine->shaderProgramStats.nCompiled++;
+  frameStats().programsCompiled++;
+}
 
 void GLCompiledProgram::setDataLocations() {
   // Uniforms
@@ -772,11 +998,14 @@ void GLCompiledProgram::addUniqueAttribute(ShaderSpecAttribute newAttribute) {
       // if it occurs twice, confirm that the occurences match
       if (a.type != newAttribute.type)
         exception("attribute " + a.name + " appears twice in program with different types");
+      if (a.perInstance != newAttribute.perInstance)
+        exception("attribute " + a.name + " appears twice in program, both per-vertex and per-instance");
 
       return;
     }
   }
-  attributes.push_back(GLShaderAttribute{newAttribute.name, newAttribute.type, newAttribute.arrayCount, nullptr});
+  attributes.push_back(GLShaderAttribute{newAttribute.name, newAttribute.type, newAttribute.arrayCount,
+                                        newAttribute.perInstance, nullptr});
 }
 
 void GLCompiledProgram::addUniqueUniform(ShaderSpecUniform newUniform) {
@@ -930,268 +1159,149 @@ void GLShaderProgram::ensureBufferExists(GLShaderAttribute& a) {
 }
 
 bool GLShaderProgram::hasUniform(std::string name) {
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      return true;
-    }
+  frameStats().uniformLookups++;
+  int32_t index = compiledProgram->getUniformIndex(name);
+  return index != -1;
+}
+
+UniformHandle GLShaderProgram::getUniformHandle(std::string name) {
+  UniformHandle handle = lookupUniformHandle(name);
+  if (!handle.isValid()) {
+    throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
   }
-  return false;
+  return handle;
 }
 
-// Set an integer
-void GLShaderProgram::setUniform(std::string name, int val) {
+UniformHandle GLShaderProgram::lookupUniformHandle(const std::string& name) {
+  frameStats().uniformLookups++;
+  UniformHandle handle;
+  handle.index = compiledProgram->getUniformIndex(name);
+  return handle;
+}
 
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Int) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
+GLShaderUniform* GLShaderProgram::getUniformToSet(UniformHandle handle, RenderDataType type) {
+  if (handle.index < 0 || static_cast<size_t>(handle.index) >= uniforms.size()) {
+    throw std::invalid_argument("Tried to set uniform with invalid handle");
   }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+  GLShaderUniform& u = uniforms[handle.index];
+  if (u.type != type) {
+    throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
+  }
+  return &u;
+}
+
+// Set an integer
+void GLShaderProgram::setUniform(UniformHandle handle, int val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Int);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, int val) { setUniform(getUniformHandle(name), val); }
 
 // Set an unsigned integer
-void GLShaderProgram::setUniform(std::string name, unsigned int val) {
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::UInt) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, unsigned int val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::UInt);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, unsigned int val) { setUniform(getUniformHandle(name), val); }
 
 // Set a float
-void GLShaderProgram::setUniform(std::string name, float val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Float) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, float val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Float);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, float val) { setUniform(getUniformHandle(name), val); }
 
 // Set a double --- WARNING casts down to float
-void GLShaderProgram::setUniform(std::string name, double val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Float) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, double val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Float);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, double val) { setUniform(getUniformHandle(name), val); }
 
 // Set a 4x4 uniform matrix
-void GLShaderProgram::setUniform(std::string name, float* val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Matrix44Float) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+// TODO why do we use a pointer here... makes no sense
+void GLShaderProgram::setUniform(UniformHandle handle, float* val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Matrix44Float);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, float* val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vector2 uniform
-void GLShaderProgram::setUniform(std::string name, glm::vec2 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector2Float) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::vec2 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector2Float);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::vec2 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vector3 uniform
-void GLShaderProgram::setUniform(std::string name, glm::vec3 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector3Float) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::vec3 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector3Float);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::vec3 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vector4 uniform
-void GLShaderProgram::setUniform(std::string name, glm::vec4 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector4Float) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::vec4 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector4Float);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::vec4 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vector3 uniform from a float array
-void GLShaderProgram::setUniform(std::string name, std::array<float, 3> val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector3Float) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, std::array<float, 3> val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector3Float);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, std::array<float, 3> val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vec4 uniform
-void GLShaderProgram::setUniform(std::string name, float x, float y, float z, float w) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector4Float) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, float x, float y, float z, float w) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector4Float);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, float x, float y, float z, float w) { setUniform(getUniformHandle(name), x, y, z, w); }
 
 // Set a int vector2 uniform
-void GLShaderProgram::setUniform(std::string name, glm::ivec2 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector2Int) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::ivec2 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector2Int);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::ivec2 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a int vector3 uniform
-void GLShaderProgram::setUniform(std::string name, glm::ivec3 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector3Int) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::ivec3 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector3Int);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::ivec3 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a int vector4 uniform
-void GLShaderProgram::setUniform(std::string name, glm::ivec4 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector4Int) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::ivec4 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector4Int);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::ivec4 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a uint vector2 uniform
-void GLShaderProgram::setUniform(std::string name, glm::uvec2 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector2UInt) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::uvec2 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector2UInt);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::uvec2 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a uint vector3 uniform
-void GLShaderProgram::setUniform(std::string name, glm::uvec3 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector3UInt) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::uvec3 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector3UInt);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::uvec3 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a uint vector4 uniform
-void GLShaderProgram::setUniform(std::string name, glm::uvec4 val) {
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.type == RenderDataType::Vector4UInt) {
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::uvec4 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector4UInt);
+  u->isSet = true;
 }
+void GLShaderProgram::setUniform(std::string name, glm::uvec4 val) { setUniform(getUniformHandle(name), val); }
 
 bool GLShaderProgram::hasAttribute(std::string name) {
   for (GLShaderAttribute& a : attributes) {
@@ -1560,6 +1670,11 @@ void GLShaderProgram::setIndex(std::shared_ptr<AttributeBuffer> externalBuffer)
   case RenderDataType::Matrix44Float:
     throw std::invalid_argument("index buffer should be integer type");
     break;
+  case RenderDataType::UInt8:
+  case RenderDataType::UInt16:
+  case RenderDataType::Vector4UInt8:
+    throw std::invalid_argument("index buffer should be 32-bit integer type");
+    break;
   }
 
   indexBuffer = engineExtBuff;
@@ -1591,6 +1706,10 @@ void GLShaderProgram::validateData() {
 
     int compatCount = renderDataTypeCountCompatbility(a.type, a.buff->getType());
 
+    if (a.perInstance) { // sized by the instance count instead, checked below
+      continue;
+    }
+
     if (attributeSize == -1) { // first one we've seen
       attributeSize = a.buff->getDataSize() / (compatCount);
     } else { // not the first one we've seen
@@ -1623,11 +1742,25 @@ void GLShaderProgram::validateData() {
   }
 
   // Check instanced (if applicable)
-  if (drawMode == DrawMode::TrianglesInstanced || drawMode == DrawMode::TriangleStripInstanced) {
+  bool hasPerInstanceAttributes = false;
+  for (GLShaderAttribute& a : attributes) {
+    if (a.perInstance && a.buff) hasPerInstanceAttributes = true;
+  }
+  if (drawMode == DrawMode::TrianglesInstanced || drawMode == DrawMode::TriangleStripInstanced ||
+      hasPerInstanceAttributes) {
     if (instanceCount == INVALID_IND_32) {
       throw std::invalid_argument("Must set instance count to use instanced drawing");
     }
   }
+  for (GLShaderAttribute& a : attributes) {
+    if (!a.perInstance || !a.buff) continue;
+    int compatCount = renderDataTypeCountCompatbility(a.type, a.buff->getType());
+    if (a.buff->getDataSize() / compatCount < static_cast<int64_t>(instanceCount)) {
+      throw std::invalid_argument("Per-instance attribute " + a.name + " has size " +
+                                  std::to_string(a.buff->getDataSize()) + ", but " + std::to_string(instanceCount) +
+                                  " instances are drawn");
+    }
+  }
 }
 
 void GLShaderProgram::setPrimitiveRestartIndex(unsigned int restartIndex_) {
@@ -1654,15 +1787,58 @@ void GLShaderProgram::activateTextures() {
 
     t.textureBuffer->bind();
   }
+  static_cast<MockGLEngine*>(render::engine)->stateChangeCounts.textureBinds += textures.size();
+  frameStats().stateChanges.textureBinds += textures.size();
+}
+
+void GLShaderProgram::activateTextures(const std::vector<TextureBuffer*>& bindings) {
+  for (TextureBuffer* t : bindings) {
+    static_cast<GLTextureBuffer*>(t)->bind();
+  }
+  static_cast<MockGLEngine*>(render::engine)->stateChangeCounts.textureBinds += bindings.size();
+  frameStats().stateChanges.textureBinds += bindings.size();
+}
+
+uint64_t GLShaderProgram::textureKey() {
+  uint64_t key = 14695981039346656037ULL;
+  for (GLShaderTexture& t : textures) {
+    key = (key ^ t.textureBuffer->getUniqueID()) * 1099511628211ULL;
+  }
+  return key;
 }
 
 void GLShaderProgram::draw() {
   validateData();
 
-  if (usePrimitiveRestart) {
+  if (render::engine->renderQueueActive()) {
+    RenderQueueItem item = render::engine->newRenderQueueItem(this);
+    item.programKey = compiledProgram->getId();
+    item.textureKey = textureKey();
+    item.useDrawRanges = useDrawRanges;
+    item.drawRanges = drawRanges;
+    item.instanceCount = instanceCount;
+    for (GLShaderTexture& t : textures) {
+      item.textures.push_back(t.textureBuffer);
+      if (t.textureBufferOwned) item.ownedTextures.push_back(t.textureBufferOwned);
+    }
+    render::engine->enqueueDraw(std::move(item));
+    return;
   }
 
+  static_cast<MockGLEngine*>(render::engine)->recordProgramBind(compiledProgram.get());
   activateTextures();
+  drawGeometry(useDrawRanges ? &drawRanges : nullptr, instanceCount);
+}
+
+void GLShaderProgram::drawQueued(const RenderQueueItem& item) {
+  static_cast<MockGLEngine*>(render::engine)->recordProgramBind(compiledProgram.get());
+  if (!item.sameTexturesAsPrevious) activateTextures(item.textures);
+  drawGeometry(item.useDrawRanges ? &item.drawRanges : nullptr, item.instanceCount);
+}
+
+void GLShaderProgram::drawGeometry(const std::vector<DrawRange>* ranges, uint32_t drawInstanceCount) {
+  if (usePrimitiveRestart) {
+  }
 
   switch (drawMode) {
   case DrawMode::Points:
@@ -1694,6 +1870,18 @@ void GLShaderProgram::draw() {
   if (usePrimitiveRestart) {
   }
 
+  // Count the work which was submitted, as the GL backend would issue it: draw ranges go in a single multi-draw call
+  size_t nVertices = drawDataLength;
+  if (ranges != nullptr) {
+    nVertices = 0;
+    for (const DrawRange& r : *ranges) nVertices += r.count;
+  }
+  size_t nInstances = drawInstanceCount != INVALID_IND_32 ? drawInstanceCount : 1;
+  MockGLEngine::FrameStats& stats = frameStats();
+  stats.drawCalls++;
+  stats.verticesSubmitted += nVertices * nInstances;
+  stats.instancesSubmitted += nInstances;
+
   checkGLError();
 }
 
@@ -1805,7 +1993,10 @@ void MockGLEngine::shutdownImGui() {
   monoFont = nullptr;
 }
 
-void MockGLEngine::swapDisplayBuffers() {}
+void MockGLEngine::swapDisplayBuffers() {
+  lastFrameStats = currentFrameStats;
+  currentFrameStats = FrameStats();
+}
 
 std::vector<unsigned char> MockGLEngine::readDisplayBuffer() {
   // Get buffer size
@@ -1815,6 +2006,7 @@ std::vector<unsigned char> MockGLEngine::readDisplayBuffer() {
   // Read from openGL
   size_t buffSize = w * h * 4;
   std::vector<unsigned char> buff(buffSize, 0);
+  recordReadback(buffSize);
   return buff;
 }
 
@@ -1897,13 +2089,58 @@ void MockGLEngine::ImGuiRender() {
   clearResourcesPreservedForImguiFrame();
 }
 
-void MockGLEngine::setDepthMode(DepthMode newMode) {}
+void MockGLEngine::setDepthMode(DepthMode newMode) {
+  currDepthMode = newMode;
+  if (renderQueueActive()) return;
+  if (newMode != appliedDepthMode) {
+    stateChangeCounts.depthModes++;
+    currentFrameStats.stateChanges.depthModes++;
+  }
+  appliedDepthMode = newMode;
+}
+
+void MockGLEngine::setBlendMode(BlendMode newMode) {
+  currBlendMode = newMode;
+  if (renderQueueActive()) return;
+  if (newMode != appliedBlendMode) {
+    stateChangeCounts.blendModes++;
+    currentFrameStats.stateChanges.blendModes++;
+  }
+  appliedBlendMode = newMode;
+}
+
+void MockGLEngine::setColorMask(std::array<bool, 4> mask) {
+  currColorMask = mask;
+  if (renderQueueActive()) return;
+  if (mask != appliedColorMask) {
+    stateChangeCounts.colorMasks++;
+    currentFrameStats.stateChanges.colorMasks++;
+  }
+  appliedColorMask = mask;
+}
 
-void MockGLEngine::setBlendMode(BlendMode newMode) {}
+void MockGLEngine::setBackfaceCull(bool newVal) {
+  currBackfaceCull = newVal;
+  if (renderQueueActive()) return;
+  if (newVal != appliedBackfaceCull) {
+    stateChangeCounts.backfaceCulls++;
+    currentFrameStats.stateChanges.backfaceCulls++;
+  }
+  appliedBackfaceCull = newVal;
+}
 
-void MockGLEngine::setColorMask(std::array<bool, 4> mask) {}
+void MockGLEngine::recordProgramBind(const GLCompiledProgram* program) {
+  if (program != appliedProgram) {
+    stateChangeCounts.programBinds++;
+    currentFrameStats.stateChanges.programBinds++;
+  }
+  appliedProgram = program;
+}
 
-void MockGLEngine::setBackfaceCull(bool newVal) {}
+void MockGLEngine::resetFrameStats() {
+  currentFrameStats = FrameStats();
+  lastFrameStats = FrameStats();
+}
 
 std::string MockGLEngine::getClipboardText() {
   std::string clipboardData = "";
@@ -2091,7 +2328,12 @@ std::shared_ptr<GLCompiledProgram> MockGLEngine::getCompiledProgram(const std::s
     }
 
     // Actually apply rule substitutions
-    std::vector<ShaderStageSpecification> updatedStages = applyShaderReplacements(stages, rules);
+    // (pick programs get an integer output if the pick buffer uses one)
+    bool integerPick = defaults == ShaderReplacementDefaults::Pick && pickColorBuffer &&
+                       pickColorBuffer->getType() == RenderBufferType::UInt2;
+    std::vector<ShaderStageSpecification> updatedStages =
+        integerPick ? convertToIntegerPickOutput(applyShaderReplacements(stages, rules))
+                    : applyShaderReplacements(stages, rules);
 
     // Create a new compiled program (GL work happens in the constructor)
     compiledProgamCache[progKey] = std::shared_ptr<GLCompiledProgram>(new GLCompiledProgram(updatedStages, dm));
@@ -2108,6 +2350,27 @@ std::shared_ptr<ShaderProgram> MockGLEngine::requestShader(const std::string& pr
   return std::shared_ptr<ShaderProgram>(newP);
 }
 
+void MockGLEngine::startShaderWarmup(const ShaderWarmupRequest& request, bool background) {
+  getCompiledProgram(request.programName, request.customRules, request.defaults);
+}
+
+uint32_t MockGLEngine::recordGPUTimestamp() {
+  std::chrono::nanoseconds now = std::chrono::steady_clock::now().time_since_epoch();
+  uint32_t timestamp = nextTimestamp++;
+  timestamps[timestamp] = static_cast<uint64_t>(now.count());
+  return timestamp;
+}
+
+bool MockGLEngine::readGPUTimestamp(uint32_t timestamp, uint64_t& nanoseconds) {
+  std::unordered_map<uint32_t, uint64_t>::iterator it = timestamps.find(timestamp);
+  if (it == timestamps.end()) exception("invalid GPU timestamp");
+  nanoseconds = it->second;
+  timestamps.erase(it);
+  return true;
+}
+
+void MockGLEngine::releaseGPUTimestamp(uint32_t timestamp) { timestamps.erase(timestamp); }
+
 void MockGLEngine::registerShaderProgram(const std::string& name, const std::vector<ShaderStageSpecification>& spec,
                                          const DrawMode& dm) {
   registeredShaderPrograms.insert({name, {spec, dm}});
@@ -2163,6 +2426,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
 
   // Utility rules
   registerShaderRule("GLSL_VERSION", GLSL_VERSION);
+  registerShaderRule("FRAME_UNIFORM_BLOCK", FRAME_UNIFORM_BLOCK);
   registerShaderRule("GLOBAL_FRAGMENT_FILTER", GLOBAL_FRAGMENT_FILTER);
   registerShaderRule("DOWNSAMPLE_RESOLVE_1", DOWNSAMPLE_RESOLVE_1);
   registerShaderRule("DOWNSAMPLE_RESOLVE_2", DOWNSAMPLE_RESOLVE_2);
@@ -2178,6 +2442,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("COMPUTE_SHADE_NORMAL_FROM_POSITION", COMPUTE_SHADE_NORMAL_FROM_POSITION);
   registerShaderRule("PREMULTIPLY_LIT_COLOR", PREMULTIPLY_LIT_COLOR);
   registerShaderRule("CULL_POS_FROM_VIEW", CULL_POS_FROM_VIEW);
+  registerShaderRule("INSTANCE_TRANSFORM", INSTANCE_TRANSFORM);
   registerShaderRule("PROJ_AND_INV_PROJ_MAT", PROJ_AND_INV_PROJ_MAT);
   registerShaderRule("BUILD_RAY_FOR_FRAGMENT_PERSPECTIVE", BUILD_RAY_FOR_FRAGMENT_PERSPECTIVE);
   registerShaderRule("BUILD_RAY_FOR_FRAGMENT_ORTHOGRAPHIC", BUILD_RAY_FOR_FRAGMENT_ORTHOGRAPHIC);
@@ -2228,6 +2493,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("MESH_PROPAGATE_VALUE2", MESH_PROPAGATE_VALUE2);
   registerShaderRule("MESH_PROPAGATE_TCOORD", MESH_PROPAGATE_TCOORD);
   registerShaderRule("MESH_PROPAGATE_COLOR", MESH_PROPAGATE_COLOR);
+  registerShaderRule("MESH_PROPAGATE_INSTANCE_COLOR", MESH_PROPAGATE_INSTANCE_COLOR);
   registerShaderRule("MESH_PROPAGATE_HALFEDGE_VALUE", MESH_PROPAGATE_HALFEDGE_VALUE);
   registerShaderRule("MESH_PROPAGATE_CULLPOS", MESH_PROPAGATE_CULLPOS);
   registerShaderRule("MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE", MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE);
@@ -2252,6 +2518,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("SPHERE_PROPAGATE_VALUEALPHA", SPHERE_PROPAGATE_VALUEALPHA);
   registerShaderRule("SPHERE_PROPAGATE_VALUE2", SPHERE_PROPAGATE_VALUE2);
   registerShaderRule("SPHERE_PROPAGATE_COLOR", SPHERE_PROPAGATE_COLOR);
+  registerShaderRule("SPHERE_PROPAGATE_INSTANCE_COLOR", SPHERE_PROPAGATE_INSTANCE_COLOR);
   registerShaderRule("SPHERE_CULLPOS_FROM_CENTER", SPHERE_CULLPOS_FROM_CENTER);
   registerShaderRule("SPHERE_CULLPOS_FROM_CENTER_QUAD", SPHERE_CULLPOS_FROM_CENTER_QUAD);
   registerShaderRule("SPHERE_VARIABLE_SIZE", SPHERE_VARIABLE_SIZE);
@@ -2266,6 +2533,7 @@ void MockGLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("CYLINDER_PROPAGATE_BLEND_VALUE", CYLINDER_PROPAGATE_BLEND_VALUE);
   registerShaderRule("CYLINDER_PROPAGATE_NEAREST_VALUE", CYLINDER_PROPAGATE_NEAREST_VALUE);
   registerShaderRule("CYLINDER_PROPAGATE_COLOR", CYLINDER_PROPAGATE_COLOR);
+  registerShaderRule("CYLINDER_PROPAGATE_INSTANCE_COLOR", CYLINDER_PROPAGATE_INSTANCE_COLOR);
   registerShaderRule("CYLINDER_PROPAGATE_BLEND_COLOR", CYLINDER_PROPAGATE_BLEND_COLOR);
   registerShaderRule("CYLINDER_PROPAGATE_PICK", CYLINDER_PROPAGATE_PICK);
   registerShaderRule("CYLINDER_CULLPOS_FROM_MID", CYLINDER_CULLPOS_FROM_MID);
@@ -2290,6 +2558,10 @@ void MockGLEngine::freeAllOwnedResources() {
   Engine::freeAllOwnedResources();
 }
 
+void MockGLEngine::uploadFrameUniforms(const FrameUniforms& data) {
+  currentFrameStats.uniformBlockBytesUploaded += sizeof(FrameUniforms);
+}
+
 void MockGLEngine::createSlicePlaneFliterRule(std::string uniquePostfix) {
   using namespace backend_openGL3;
   registeredShaderRules.insert({"SLICE_PLANE_CULL_" + uniquePostfix, generateSlicePlaneRule(uniquePostfix)});
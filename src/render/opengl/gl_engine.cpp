@@ -31,6 +31,11 @@
 #include "stb_image.h"
 
 #include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <set>
 
 namespace polyscope {
@@ -110,6 +115,7 @@ inline GLenum native(const RenderBufferType& x) {
     case RenderBufferType::Color:           return GL_RGB;
     case RenderBufferType::Depth:           return GL_DEPTH_COMPONENT;
     case RenderBufferType::Float4:          return GL_RGBA32F;
+    case RenderBufferType::UInt2:           return GL_RG32UI;
   }
   exception("bad enum");
   return GL_RGBA;
@@ -214,6 +220,272 @@ void printProgramInfoLog(GLuint handle) {
   }
 }
 
+namespace {
+
+// The program last bound with glUseProgram(), so that redundant binds can be skipped (0 if unknown)
+ProgramHandle boundProgram = 0;
+
+void useProgram(ProgramHandle handle) {
+  if (handle == boundProgram) return;
+  glUseProgram(handle);
+  boundProgram = handle;
+}
+
+// Uniform values are stored on the program as raw words when they are set, and uploaded when it draws
+void storeUniformValue(GLShaderUniform& u, const void* data, size_t nBytes) {
+  if (nBytes > sizeof(u.value)) exception("uniform " + u.name + " is too large");
+  std::memcpy(u.value.data(), data, nBytes);
+  u.isSet = true;
+}
+
+template <typename T>
+void storeUniformValue(GLShaderUniform& u, const T& val) {
+  storeUniformValue(u, &val, sizeof(T));
+}
+
+// Draw all of the vertices, or only those in the given ranges (clamped to the length). Instanced draws (when the count
+// is not INVALID_IND_32) always draw all of the vertices.
+void drawArrays(GLenum mode, uint32_t length, uint32_t instanceCount, const std::vector<DrawRange>* ranges) {
+  if (instanceCount != INVALID_IND_32) {
+    glDrawArraysInstanced(mode, 0, length, instanceCount);
+    return;
+  }
+  if (ranges == nullptr) {
+    glDrawArrays(mode, 0, length);
+    return;
+  }
+  std::vector<GLint> starts;
+  std::vector<GLsizei> counts;
+  for (const DrawRange& r : *ranges) {
+    if (r.start >= length) break;
+    starts.push_back(r.start);
+    counts.push_back(std::min(r.count, length - r.start));
+  }
+  if (starts.empty()) return;
+  glMultiDrawArrays(mode, &starts.front(), &counts.front(), static_cast<GLsizei>(starts.size()));
+}
+
+// Same as above, for ranges of the index buffer
+void drawElements(GLenum mode, uint32_t length, uint32_t instanceCount, const std::vector<DrawRange>* ranges) {
+  if (instanceCount != INVALID_IND_32) {
+    glDrawElementsInstanced(mode, length, GL_UNSIGNED_INT, 0, instanceCount);
+    return;
+  }
+  if (ranges == nullptr) {
+    glDrawElements(mode, length, GL_UNSIGNED_INT, 0);
+    return;
+  }
+  std::vector<GLsizei> counts;
+  std::vector<const void*> offsets;
+  for (const DrawRange& r : *ranges) {
+    if (r.start >= length) break;
+    counts.push_back(std::min(r.count, length - r.start));
+    offsets.push_back(reinterpret_cast<const void*>(static_cast<uintptr_t>(r.start) * sizeof(uint32_t)));
+  }
+  if (counts.empty()) return;
+  glMultiDrawElements(mode, &counts.front(), GL_UNSIGNED_INT, &offsets.front(), static_cast<GLsizei>(counts.size()));
+}
+
+} // namespace
+
+// =============================================================
+// ================= Program binary cache ======================
+// =============================================================
+
+// The bundled loader only covers openGL 3.3, so the program binary functions (core in 4.1, or from
+// ARB_get_program_binary) and the parallel shader compile functions (KHR/ARB_parallel_shader_compile) are resolved
+// separately by loadOptionalGLFunctions().
+
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+#ifndef GL_COMPLETION_STATUS_KHR
+#define GL_COMPLETION_STATUS_KHR 0x91B1
+#endif
+
+namespace {
+
+#ifdef _WIN32
+#define POLYSCOPE_GL_APIENTRY __stdcall
+#else
+#define POLYSCOPE_GL_APIENTRY
+#endif
+typedef void(POLYSCOPE_GL_APIENTRY* GetProgramBinaryProc)(GLuint, GLsizei, GLsizei*, GLenum*, void*);
+typedef void(POLYSCOPE_GL_APIENTRY* ProgramBinaryProc)(GLuint, GLenum, const void*, GLsizei);
+typedef void(POLYSCOPE_GL_APIENTRY* ProgramParameteriProc)(GLuint, GLenum, GLint);
+typedef void(POLYSCOPE_GL_APIENTRY* MaxShaderCompilerThreadsProc)(GLuint);
+#undef POLYSCOPE_GL_APIENTRY
+
+GetProgramBinaryProc getProgramBinaryFn = nullptr;
+ProgramBinaryProc programBinaryFn = nullptr;
+ProgramParameteriProc programParameteriFn = nullptr;
+
+// If set, the driver compiles and links in the background, and GL_COMPLETION_STATUS_KHR can be polled without blocking
+bool haveParallelShaderCompile = false;
+
+// Identifies the driver, binaries are only valid for the driver which produced them
+std::string driverString;
+
+bool programBinaryCacheEnabled() {
+  return !options::shaderCacheDirectory.empty() && getProgramBinaryFn != nullptr && programBinaryFn != nullptr &&
+         programParameteriFn != nullptr;
+}
+
+// 64 bit FNV-1a, stable across runs and platforms (unlike std::hash)
+uint64_t hashString(const std::string& s, uint64_t h = 14695981039346656037ULL) {
+  for (char c : s) {
+    h ^= static_cast<unsigned char>(c);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+uint64_t programBinaryCacheKey(const std::vector<ShaderStageSpecification>& stages, const char* commonSource) {
+  uint64_t h = hashString(driverString);
+  for (const ShaderStageSpecification& s : stages) {
+    h = hashString(std::to_string(static_cast<int>(s.stage)), h);
+    h = hashString(s.src, h);
+  }
+  h = hashString(commonSource, h);
+  return h;
+}
+
+std::string programBinaryCachePath(uint64_t key) {
+  char name[32];
+  std::snprintf(name, sizeof(name), "%016llx.bin", static_cast<unsigned long long>(key));
+  std::string dir = options::shaderCacheDirectory;
+  if (dir.back() != '/' && dir.back() != '\\') dir += '/';
+  return dir + name;
+}
+
+// Create a program from a cached binary. Returns 0 if there is no usable entry, either because it is missing, it is
+// truncated or corrupt, it came from a different driver, or the driver rejects it.
+ProgramHandle loadCachedProgramBinary(uint64_t key) {
+  std::ifstream inFile(programBinaryCachePath(key), std::ios::binary);
+  if (!inFile) return 0;
+  std::string contents((std::istreambuf_iterator<char>(inFile)), std::istreambuf_iterator<char>());
+
+  uint32_t format;
+  std::vector<char> binary;
+  if (!decodeProgramBinaryCacheEntry(contents, driverString, format, binary)) {
+    info(1, "shader cache entry " + programBinaryCachePath(key) + " is unusable, recompiling");
+    return 0;
+  }
+
+  ProgramHandle handle = glCreateProgram();
+  programBinaryFn(handle, format, &binary[0], static_cast<GLsizei>(binary.size()));
+  GLint status = 0;
+  glGetProgramiv(handle, GL_LINK_STATUS, &status);
+  if (!status) {
+    glDeleteProgram(handle);
+    while (glGetError() != GL_NO_ERROR) {
+    } // a rejected binary is expected after driver updates, don't report it as an error later
+    info(1, "shader cache entry " + programBinaryCachePath(key) + " was rejected by the driver, recompiling");
+    return 0;
+  }
+  return handle;
+}
+
+void saveCachedProgramBinary(ProgramHandle handle, uint64_t key) {
+  GLint len = 0;
+  glGetProgramiv(handle, GL_PROGRAM_BINARY_LENGTH, &len);
+  if (len <= 0) return;
+
+  std::vector<char> binary(len);
+  GLsizei nWritten = 0;
+  GLenum format = 0;
+  getProgramBinaryFn(handle, len, &nWritten, &format, &binary[0]);
+  if (nWritten <= 0) return;
+  binary.resize(nWritten);
+  std::string entry = encodeProgramBinaryCacheEntry(static_cast<uint32_t>(format), driverString, binary);
+
+  // Write to a temporary file and move it in to place, so that another process (or a crash part way through) never
+  // leaves a partial entry under the real name
+  std::string path = programBinaryCachePath(key);
+  std::string tmpPath = path + ".tmp" + std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+  {
+    std::ofstream outFile(tmpPath, std::ios::binary);
+    outFile.write(entry.data(), entry.size());
+    outFile.close();
+    if (!outFile.good()) {
+      std::remove(tmpPath.c_str());
+      info(1, "could not write shader cache entry " + path);
+      return;
+    }
+  }
+  if (std::rename(tmpPath.c_str(), path.c_str()) != 0) {
+    std::remove(tmpPath.c_str()); // (e.g. on Windows, if another process already wrote the entry)
+    info(1, "could not write shader cache entry " + path);
+  }
+}
+
+} // namespace
+
+void loadOptionalGLFunctions(std::function<void*(const char* name)> getProcAddress) {
+  getProgramBinaryFn = nullptr;
+  programBinaryFn = nullptr;
+  programParameteriFn = nullptr;
+  haveParallelShaderCompile = false;
+
+  std::stringstream ss;
+  ss << glGetString(GL_VENDOR) << " | " << glGetString(GL_RENDERER) << " | " << glGetString(GL_VERSION);
+  driverString = ss.str();
+
+  std::vector<std::string> extensions;
+  GLint nExtensions = 0;
+  glGetIntegerv(GL_NUM_EXTENSIONS, &nExtensions);
+  for (GLint i = 0; i < nExtensions; i++) {
+    const GLubyte* ext = glGetStringi(GL_EXTENSIONS, i);
+    if (ext != nullptr) extensions.push_back(reinterpret_cast<const char*>(ext));
+  }
+  auto hasExtension = [&](const std::string& name) -> bool {
+    return std::find(extensions.begin(), extensions.end(), name) != extensions.end();
+  };
+
+  // Program binaries
+  GLint major = 0, minor = 0;
+  glGetIntegerv(GL_MAJOR_VERSION, &major);
+  glGetIntegerv(GL_MINOR_VERSION, &minor);
+  bool haveProgramBinary = major > 4 || (major == 4 && minor >= 1) || hasExtension("GL_ARB_get_program_binary");
+  if (haveProgramBinary) {
+    // some drivers expose the functions, but no formats to actually use them with
+    GLint nFormats = 0;
+    glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &nFormats);
+    haveProgramBinary = nFormats > 0;
+  }
+  if (haveProgramBinary) {
+    getProgramBinaryFn = reinterpret_cast<GetProgramBinaryProc>(getProcAddress("glGetProgramBinary"));
+    programBinaryFn = reinterpret_cast<ProgramBinaryProc>(getProcAddress("glProgramBinary"));
+    programParameteriFn = reinterpret_cast<ProgramParameteriProc>(getProcAddress("glProgramParameteri"));
+  }
+  if (!options::shaderCacheDirectory.empty() && !programBinaryCacheEnabled()) {
+    info("openGL driver does not support program binaries, options::shaderCacheDirectory will be ignored");
+  }
+
+  // Parallel shader compilation
+  MaxShaderCompilerThreadsProc maxShaderCompilerThreadsFn = nullptr;
+  if (hasExtension("GL_KHR_parallel_shader_compile")) {
+    maxShaderCompilerThreadsFn =
+        reinterpret_cast<MaxShaderCompilerThreadsProc>(getProcAddress("glMaxShaderCompilerThreadsKHR"));
+    haveParallelShaderCompile = true;
+  } else if (hasExtension("GL_ARB_parallel_shader_compile")) {
+    maxShaderCompilerThreadsFn =
+        reinterpret_cast<MaxShaderCompilerThreadsProc>(getProcAddress("glMaxShaderCompilerThreadsARB"));
+    haveParallelShaderCompile = true;
+  }
+  if (maxShaderCompilerThreadsFn != nullptr) {
+    maxShaderCompilerThreadsFn(0xFFFFFFFF); // let the driver choose how many threads to use
+  }
+
+  checkGLError();
+}
+
 // =============================================================
 // =================== Attribute buffer ========================
 // =============================================================
@@ -351,6 +623,151 @@ void GLAttributeBuffer::setData(const std::vector<glm::uvec4>& data) {
   setData_helper(data);
 }
 
+void GLAttributeBuffer::setData(const std::vector<uint8_t>& data) {
+  checkType(RenderDataType::UInt8);
+  setData_helper(data);
+}
+void GLAttributeBuffer::setData(const std::vector<uint16_t>& data) {
+  checkType(RenderDataType::UInt16);
+  setData_helper(data);
+}
+void GLAttributeBuffer::setData(const std::vector<glm::u8vec4>& data) {
+  checkType(RenderDataType::Vector4UInt8);
+  setData_helper(data);
+}
+
+// === set ranges of values
+
+template <typename T>
+void GLAttributeBuffer::setDataRange_helper(const std::vector<T>& data, size_t start) {
+  if (!isSet()) exception("setDataRange() called on a buffer which has not been set");
+  if (start > static_cast<size_t>(dataSize)) exception("setDataRange() would leave a gap in the buffer");
+
+  bind();
+  size_t end = start + data.size();
+
+  // if the range no longer fits, grow the allocation (at least doubling), copying the existing entries on the GPU
+  // rather than uploading them again
+  if (end > bufferSize) {
+    uint64_t newSize = std::max(static_cast<uint64_t>(end), 2 * bufferSize);
+    size_t keepBytes = static_cast<size_t>(dataSize) * sizeof(T);
+
+    GLuint tmpBuffer;
+    glGenBuffers(1, &tmpBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, tmpBuffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, keepBytes, NULL, GL_STREAM_COPY);
+    glBindBuffer(GL_COPY_READ_BUFFER, VBOLoc);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepBytes);
+
+    // re-specify the storage of this same buffer object, so programs which already refer to it stay valid
+    glBufferData(GL_COPY_READ_BUFFER, newSize * sizeof(T), NULL, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_READ_BUFFER, tmpBuffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, VBOLoc);
+    glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, keepBytes);
+    glDeleteBuffers(1, &tmpBuffer);
+
+    bufferSize = newSize;
+    bind();
+  }
+
+  if (!data.empty()) {
+    glBufferSubData(getTarget(), start * sizeof(T), data.size() * sizeof(T), data.data());
+  }
+  dataSize = std::max(static_cast<size_t>(dataSize), end);
+
+  checkGLError();
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec2>& data, size_t start) {
+  checkType(RenderDataType::Vector2Float);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec3>& data, size_t start) {
+  checkType(RenderDataType::Vector3Float);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::vec4>& data, size_t start) {
+  checkType(RenderDataType::Vector4Float);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<float>& data, size_t start) {
+  checkType(RenderDataType::Float);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<double>& data, size_t start) {
+  checkType(RenderDataType::Float);
+
+  // Convert input data to floats
+  std::vector<float> floatData(data.size());
+  for (unsigned int i = 0; i < data.size(); i++) {
+    floatData[i] = static_cast<float>(data[i]);
+  }
+
+  setDataRange_helper(floatData, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<int32_t>& data, size_t start) {
+  checkType(RenderDataType::Int);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::ivec2>& data, size_t start) {
+  checkType(RenderDataType::Vector2Int);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::ivec3>& data, size_t start) {
+  checkType(RenderDataType::Vector3Int);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::ivec4>& data, size_t start) {
+  checkType(RenderDataType::Vector4Int);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<uint32_t>& data, size_t start) {
+  checkType(RenderDataType::UInt);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec2>& data, size_t start) {
+  checkType(RenderDataType::Vector2UInt);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec3>& data, size_t start) {
+  checkType(RenderDataType::Vector3UInt);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<glm::uvec4>& data, size_t start) {
+  checkType(RenderDataType::Vector4UInt);
+  setDataRange_helper(data, start);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<uint8_t>& data, size_t start) {
+  checkType(RenderDataType::UInt8);
+  setDataRange_helper(data, start);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<uint16_t>& data, size_t start) {
+  checkType(RenderDataType::UInt16);
+  setDataRange_helper(data, start);
+}
+
+void GLAttributeBuffer::setDataRange(const std::vector<glm::u8vec4>& data, size_t start) {
+  checkType(RenderDataType::Vector4UInt8);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 2>>& data, size_t start) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(2);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 3>>& data, size_t start) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(3);
+  setDataRange_helper(data, start);
+}
+void GLAttributeBuffer::setDataRange(const std::vector<std::array<glm::vec3, 4>>& data, size_t start) {
+  checkType(RenderDataType::Vector3Float);
+  checkArray(4);
+  setDataRange_helper(data, start);
+}
+
 // === get single data values
 
 template <typename T>
@@ -413,6 +830,18 @@ glm::uvec4 GLAttributeBuffer::getData_uvec4(size_t ind) {
   if (getType() != RenderDataType::Vector4UInt) exception("bad getData type");
   return getData_helper<glm::uvec4>(ind);
 }
+uint8_t GLAttributeBuffer::getData_uint8(size_t ind) {
+  if (getType() != RenderDataType::UInt8) exception("bad getData type");
+  return getData_helper<uint8_t>(ind);
+}
+uint16_t GLAttributeBuffer::getData_uint16(size_t ind) {
+  if (getType() != RenderDataType::UInt16) exception("bad getData type");
+  return getData_helper<uint16_t>(ind);
+}
+glm::u8vec4 GLAttributeBuffer::getData_u8vec4(size_t ind) {
+  if (getType() != RenderDataType::Vector4UInt8) exception("bad getData type");
+  return getData_helper<glm::u8vec4>(ind);
+}
 
 // === get ranges of values
 
@@ -483,6 +912,18 @@ std::vector<glm::uvec4> GLAttributeBuffer::getDataRange_uvec4(size_t start, size
   if (getType() != RenderDataType::Vector4UInt) exception("bad getData type");
   return getDataRange_helper<glm::uvec4>(start, count);
 }
+std::vector<uint8_t> GLAttributeBuffer::getDataRange_uint8(size_t start, size_t count) {
+  if (getType() != RenderDataType::UInt8) exception("bad getData type");
+  return getDataRange_helper<uint8_t>(start, count);
+}
+std::vector<uint16_t> GLAttributeBuffer::getDataRange_uint16(size_t start, size_t count) {
+  if (getType() != RenderDataType::UInt16) exception("bad getData type");
+  return getDataRange_helper<uint16_t>(start, count);
+}
+std::vector<glm::u8vec4> GLAttributeBuffer::getDataRange_u8vec4(size_t start, size_t count) {
+  if (getType() != RenderDataType::Vector4UInt8) exception("bad getData type");
+  return getDataRange_helper<glm::u8vec4>(start, count);
+}
 
 
 uint32_t GLAttributeBuffer::getNativeBufferID() { return static_cast<uint32_t>(VBOLoc); }
@@ -715,6 +1156,33 @@ void GLTextureBuffer::setData(const std::vector<uint32_t>& data) { exception("no
 void GLTextureBuffer::setData(const std::vector<glm::uvec2>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<glm::uvec3>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<glm::uvec4>& data) { exception("not implemented"); };
+
+void GLTextureBuffer::setData(const std::vector<glm::u8vec4>& data) {
+
+  bind();
+
+  if (data.size() != getTotalSize()) {
+    exception("OpenGL error: texture buffer data is not the right size.");
+  }
+  if (format != TextureFormat::RGBA8) {
+    exception("OpenGL error: byte color data can only be uploaded to an RGBA8 texture.");
+  }
+
+  switch (dim) {
+  case 1:
+    glTexSubImage1D(GL_TEXTURE_1D, 0, 0, sizeX, formatF(format), GL_UNSIGNED_BYTE, &data.front().x);
+    break;
+  case 2:
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, sizeX, sizeY, formatF(format), GL_UNSIGNED_BYTE, &data.front().x);
+    break;
+  case 3:
+    glTexSubImage3D(GL_TEXTURE_3D, 0, 0, 0, 0, sizeX, sizeY, sizeZ, formatF(format), GL_UNSIGNED_BYTE,
+                    &data.front().x);
+    break;
+  }
+
+  checkGLError();
+};
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 2>>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 3>>& data) { exception("not implemented"); };
 void GLTextureBuffer::setData(const std::vector<std::array<glm::vec3, 4>>& data) { exception("not implemented"); };
@@ -854,6 +1322,9 @@ GLFrameBuffer::~GLFrameBuffer() {
   if (handle != 0) {
     glDeleteFramebuffers(1, &handle);
   }
+  if (asyncReadFence != nullptr) glDeleteSync(asyncReadFence);
+  if (asyncColorPBO != 0) glDeleteBuffers(1, &asyncColorPBO);
+  if (asyncDepthPBO != 0) glDeleteBuffers(1, &asyncDepthPBO);
 }
 
 void GLFrameBuffer::bind() {
@@ -985,6 +1456,15 @@ void GLFrameBuffer::clear() {
   glClearColor(clearColor[0], clearColor[1], clearColor[2], clearAlpha);
   glClearDepth(clearDepth);
   glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+
+  // Integer buffers are not cleared by the above, clear them to zero
+  // (assumes render buffers are attached before any textures, so the indices match the draw buffers)
+  for (size_t i = 0; i < renderBuffersColor.size(); i++) {
+    if (renderBuffersColor[i]->getType() == RenderBufferType::UInt2) {
+      GLuint zeros[4] = {0, 0, 0, 0};
+      glClearBufferuiv(GL_COLOR, i, zeros);
+    }
+  }
 }
 
 std::array<float, 4> GLFrameBuffer::readFloat4(int xPos, int yPos) {
@@ -1019,6 +1499,173 @@ float GLFrameBuffer::readDepth(int xPos, int yPos) {
   return result;
 }
 
+std::vector<float> GLFrameBuffer::readFloat4Region(int xStart, int yStart, int w, int h) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  // Read from the buffer
+  std::vector<float> result(4 * static_cast<size_t>(std::max(w, 0)) * std::max(h, 0));
+  if (result.empty()) return result;
+  glReadPixels(xStart, yStart, w, h, GL_RGBA, GL_FLOAT, &result.front());
+
+  return result;
+}
+
+namespace {
+
+// Read scattered pixels after a single sync. If they are clustered, read their whole bounding block in one call
+// instead of issuing a call per pixel.
+template <typename T>
+void readPixelsBatched(const std::vector<glm::ivec2>& positions, GLenum format, GLenum type, int nComponents, T* out) {
+  if (positions.empty()) return;
+
+  glm::ivec2 lower = positions[0];
+  glm::ivec2 upper = positions[0];
+  for (const glm::ivec2& p : positions) {
+    lower = glm::min(lower, p);
+    upper = glm::max(upper, p);
+  }
+  int w = upper.x - lower.x + 1;
+  int h = upper.y - lower.y + 1;
+
+  const size_t maxBlockPixelsPerQuery = 16;
+  if (static_cast<size_t>(w) * h <= maxBlockPixelsPerQuery * positions.size()) {
+    std::vector<T> block(static_cast<size_t>(nComponents) * w * h);
+    glReadPixels(lower.x, lower.y, w, h, format, type, &block.front());
+    for (size_t i = 0; i < positions.size(); i++) {
+      size_t iBlock = static_cast<size_t>(positions[i].y - lower.y) * w + (positions[i].x - lower.x);
+      std::copy_n(&block[nComponents * iBlock], nComponents, out + nComponents * i);
+    }
+  } else {
+    for (size_t i = 0; i < positions.size(); i++) {
+      glReadPixels(positions[i].x, positions[i].y, 1, 1, format, type, out + nComponents * i);
+    }
+  }
+  checkGLError();
+}
+
+} // namespace
+
+std::vector<std::array<float, 4>> GLFrameBuffer::readFloat4Pixels(const std::vector<glm::ivec2>& positions) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  std::vector<std::array<float, 4>> result(positions.size());
+  if (!result.empty()) readPixelsBatched(positions, GL_RGBA, GL_FLOAT, 4, &result.front()[0]);
+  return result;
+}
+
+std::vector<float> GLFrameBuffer::readDepthPixels(const std::vector<glm::ivec2>& positions) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  std::vector<float> result(positions.size(), 1.);
+  if (!result.empty()) readPixelsBatched(positions, GL_DEPTH_COMPONENT, GL_FLOAT, 1, &result.front());
+  return result;
+}
+
+std::array<uint32_t, 2> GLFrameBuffer::readUInt2(int xPos, int yPos) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  // Read from the buffer
+  std::array<uint32_t, 2> result;
+  glReadPixels(xPos, yPos, 1, 1, GL_RG_INTEGER, GL_UNSIGNED_INT, &result);
+
+  return result;
+}
+
+std::vector<uint32_t> GLFrameBuffer::readUInt2Region(int xStart, int yStart, int w, int h) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  // Read from the buffer
+  std::vector<uint32_t> result(2 * static_cast<size_t>(std::max(w, 0)) * std::max(h, 0));
+  if (result.empty()) return result;
+  glReadPixels(xStart, yStart, w, h, GL_RG_INTEGER, GL_UNSIGNED_INT, &result.front());
+
+  return result;
+}
+
+std::vector<std::array<uint32_t, 2>> GLFrameBuffer::readUInt2Pixels(const std::vector<glm::ivec2>& positions) {
+
+  glFlush();
+  glFinish();
+  bind();
+
+  std::vector<std::array<uint32_t, 2>> result(positions.size());
+  if (!result.empty()) readPixelsBatched(positions, GL_RG_INTEGER, GL_UNSIGNED_INT, 2, &result.front()[0]);
+  return result;
+}
+
+void GLFrameBuffer::requestAsyncReadPixel(int xPos, int yPos) {
+
+  // Drop any read which has not finished yet
+  if (asyncReadFence != nullptr) {
+    glDeleteSync(asyncReadFence);
+    asyncReadFence = nullptr;
+  }
+
+  if (asyncColorPBO == 0) {
+    glGenBuffers(1, &asyncColorPBO);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, asyncColorPBO);
+    glBufferData(GL_PIXEL_PACK_BUFFER, 4 * sizeof(float), nullptr, GL_STREAM_READ);
+    glGenBuffers(1, &asyncDepthPBO);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, asyncDepthPBO);
+    glBufferData(GL_PIXEL_PACK_BUFFER, sizeof(float), nullptr, GL_STREAM_READ);
+  }
+
+  bind();
+
+  // With a pack buffer bound, these return immediately and the copy happens when rendering reaches it
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, asyncColorPBO);
+  if (hasIntegerColorBuffer()) {
+    glReadPixels(xPos, yPos, 1, 1, GL_RG_INTEGER, GL_UNSIGNED_INT, nullptr);
+  } else {
+    glReadPixels(xPos, yPos, 1, 1, GL_RGBA, GL_FLOAT, nullptr);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, asyncDepthPBO);
+  glReadPixels(xPos, yPos, 1, 1, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  asyncReadFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  glFlush(); // make sure the fence is submitted, otherwise it might never signal
+  checkGLError();
+}
+
+bool GLFrameBuffer::pollAsyncReadPixel(PixelReadResult& result) {
+  if (asyncReadFence == nullptr) return false;
+
+  GLenum status = glClientWaitSync(asyncReadFence, 0, 0);
+  if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) return false;
+  glDeleteSync(asyncReadFence);
+  asyncReadFence = nullptr;
+
+  result = PixelReadResult();
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, asyncColorPBO);
+  if (hasIntegerColorBuffer()) {
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(result.uint2), &result.uint2.front());
+  } else {
+    glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(result.float4), &result.float4.front());
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, asyncDepthPBO);
+  glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, sizeof(float), &result.depth);
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+  checkGLError();
+
+  return true;
+}
+
 std::vector<unsigned char> GLFrameBuffer::readBuffer() {
 
   glFlush();
@@ -1059,7 +1706,13 @@ uint32_t GLFrameBuffer::getNativeBufferID() { return handle; }
 // =============================================================
 
 
-GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>& stages, DrawMode dm) : drawMode(dm) {
+namespace {
+uint64_t nextCompiledProgramId = 1;
+} // namespace
+
+GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>& stages, DrawMode dm,
+                                     bool deferLink)
+    : id(nextCompiledProgramId++), drawMode(dm) {
 
   // Collect attributes and uniforms from all of the shaders
   for (const ShaderStageSpecification& s : stages) {
@@ -1073,31 +1726,147 @@ GLCompiledProgram::GLCompiledProgram(const std::vector<ShaderStageSpecification>
       addUniqueTexture(t);
     }
   }
+  for (size_t i = 0; i < uniforms.size(); i++) {
+    uniformIndices[uniforms[i].name] = static_cast<int32_t>(i);
+  }
+  pushedUniformValues.resize(uniforms.size());
+  pushedUniformValid.resize(uniforms.size(), false);
 
   if (attributes.size() == 0) {
     throw std::invalid_argument("Uh oh... GLProgram has no attributes");
   }
 
   // Perform setup tasks
-  compileGLProgram(stages);
+  beginCompileGLProgram(stages);
   checkGLError();
 
+  if (!deferLink) {
+    finishLinking();
+  }
+}
+
+GLCompiledProgram::~GLCompiledProgram() {
+  for (ShaderHandle h : pendingShaderHandles) {
+    glDeleteShader(h);
+  }
+  if (boundProgram == programHandle) boundProgram = 0;
+  glDeleteProgram(programHandle);
+}
+
+bool GLCompiledProgram::linkCompletePending() {
+  if (!compilePending) return true;
+  if (!haveParallelShaderCompile) return false;
+  GLint done = GL_FALSE;
+  glGetProgramiv(programHandle, GL_COMPLETION_STATUS_KHR, &done);
+  return done == GL_TRUE;
+}
+
+void GLCompiledProgram::finishLinking() {
+  if (linked) return;
+
+  if (compilePending) {
+    finishCompileGLProgram();
+    checkGLError();
+  }
+
   setDataLocations();
   checkGLError();
+  linked = true;
+}
+
+int32_t GLCompiledProgram::getUniformIndex(const std::string& name) const {
+  std::unordered_map<std::string, int32_t>::const_iterator it = uniformIndices.find(name);
+  if (it == uniformIndices.end()) return -1;
+  return it->second;
 }
 
-GLCompiledProgram::~GLCompiledProgram() { glDeleteProgram(programHandle); }
+void GLCompiledProgram::pushUniform(size_t iUniform, const uint32_t* value) {
+  const GLShaderUniform& u = uniforms[iUniform];
+  if (u.location == -1) return;
 
-void GLCompiledProgram::compileGLProgram(const std::vector<ShaderStageSpecification>& stages) {
+  std::array<uint32_t, 16>& pushed = pushedUniformValues[iUniform];
+  if (pushedUniformValid[iUniform] && std::equal(pushed.begin(), pushed.end(), value)) return;
+  std::copy(value, value + pushed.size(), pushed.begin());
+  pushedUniformValid[iUniform] = true;
 
+  const GLint* intVal = reinterpret_cast<const GLint*>(value);
+  const GLuint* uintVal = reinterpret_cast<const GLuint*>(value);
+  const GLfloat* floatVal = reinterpret_cast<const GLfloat*>(value);
 
-  // Compile all of the shaders
-  std::vector<ShaderHandle> handles;
+  // clang-format off
+  switch (u.type) {
+    case RenderDataType::Int:           glUniform1iv(u.location, 1, intVal); break;
+    case RenderDataType::UInt:          glUniform1uiv(u.location, 1, uintVal); break;
+    case RenderDataType::Float:         glUniform1fv(u.location, 1, floatVal); break;
+    case RenderDataType::Matrix44Float: glUniformMatrix4fv(u.location, 1, false, floatVal); break;
+    case RenderDataType::Vector2Float:  glUniform2fv(u.location, 1, floatVal); break;
+    case RenderDataType::Vector3Float:  glUniform3fv(u.location, 1, floatVal); break;
+    case RenderDataType::Vector4Float:  glUniform4fv(u.location, 1, floatVal); break;
+    case RenderDataType::Vector2Int:    glUniform2iv(u.location, 1, intVal); break;
+    case RenderDataType::Vector3Int:    glUniform3iv(u.location, 1, intVal); break;
+    case RenderDataType::Vector4Int:    glUniform4iv(u.location, 1, intVal); break;
+    case RenderDataType::Vector2UInt:   glUniform2uiv(u.location, 1, uintVal); break;
+    case RenderDataType::Vector3UInt:   glUniform3uiv(u.location, 1, uintVal); break;
+    case RenderDataType::Vector4UInt:   glUniform4uiv(u.location, 1, uintVal); break;
+    default: exception("uniform " + u.name + " has a type which cannot be uploaded");
+  }
+  // clang-format on
+}
+
+void GLCompiledProgram::beginCompileGLProgram(const std::vector<ShaderStageSpecification>& stages) {
+
+  std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+  // Try the on-disk cache first
+  pendingUseCache = programBinaryCacheEnabled();
+  if (pendingUseCache) {
+    pendingCacheKey = programBinaryCacheKey(stages, shaderCommonSource);
+    programHandle = loadCachedProgramBinary(pendingCacheKey);
+    if (programHandle != 0) {
+      std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+      render::engine->shaderProgramStats.nLoadedFromCache++;
+      render::engine->shaderProgramStats.loadFromCacheSeconds += elapsed.count();
+      checkGLError();
+      return;
+    }
+  }
+
+  // Submit all of the shaders. Nothing here queries the results, so where the driver compiles in parallel these return
+  // immediately and the work happens in the background.
   for (const ShaderStageSpecification& s : stages) {
     ShaderHandle h = glCreateShader(native(s.stage));
     std::array<const char*, 2> srcs = {s.src.c_str(), shaderCommonSource};
     glShaderSource(h, 2, &(srcs[0]), nullptr);
     glCompileShader(h);
+    pendingShaderHandles.push_back(h);
+    pendingShaderSources.push_back(s.src);
+  }
+
+  // Create the program, attach the shaders, and link
+  programHandle = glCreateProgram();
+  for (ShaderHandle h : pendingShaderHandles) {
+    glAttachShader(programHandle, h);
+  }
+  if (pendingUseCache) {
+    programParameteriFn(programHandle, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+  }
+  glLinkProgram(programHandle);
+  compilePending = true;
+
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  pendingCompileSeconds = elapsed.count();
+
+  checkGLError();
+}
+
+void GLCompiledProgram::finishCompileGLProgram() {
+
+  std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+
+  // Check each of the shaders
+  for (size_t i = 0; i < pendingShaderHandles.size(); i++) {
+    ShaderHandle h = pendingShaderHandles[i];
+    const std::string& src = pendingShaderSources[i];
 
     // Catch the error here, so we can print shader source before re-throwing
     try {
@@ -1107,7 +1876,7 @@ void GLCompiledProgram::compileGLProgram(const std::vector<ShaderStageSpecificat
       if (!status) {
         printShaderInfoLog(h);
         std::cout << "Program text:" << std::endl;
-        std::cout << s.src.c_str() << std::endl;
+        std::cout << src.c_str() << std::endl;
         exception("[polyscope] GL shader compile failed");
       }
 
@@ -1116,7 +1885,7 @@ void GLCompiledProgram::compileGLProgram(const std::vector<ShaderStageSpecificat
       }
       if (options::verbosity > 200) {
         std::cout << "Program text:" << std::endl;
-        std::cout << s.src.c_str() << std::endl;
+        std::cout << src.c_str() << std::endl;
       }
 
       checkGLError();
@@ -1124,7 +1893,7 @@ void GLCompiledProgram::compileGLProgram(const std::vector<ShaderStageSpecificat
       std::cout << "GLError() after shader compilation! Program text:" << std::endl;
 
       // process shader line-by-line to print line numbers:
-      std::stringstream ss(s.src);
+      std::stringstream ss(src);
       std::string line;
       size_t lineNo = 1;
       while (std::getline(ss, line, '\n')) {
@@ -1133,18 +1902,9 @@ void GLCompiledProgram::compileGLProgram(const std::vector<ShaderStageSpecificat
       }
       throw;
     }
-
-    handles.push_back(h);
-  }
-
-  // Create the program and attach the shaders
-  programHandle = glCreateProgram();
-  for (ShaderHandle h : handles) {
-    glAttachShader(programHandle, h);
   }
 
-  // Link the program
-  glLinkProgram(programHandle);
+  // Check the link
   if (options::verbosity > 2) {
     printProgramInfoLog(programHandle);
   }
@@ -1156,15 +1916,33 @@ void GLCompiledProgram::compileGLProgram(const std::vector<ShaderStageSpecificat
   }
 
   // Delete the shaders we just compiled, they aren't used after link
-  for (ShaderHandle h : handles) {
+  for (ShaderHandle h : pendingShaderHandles) {
     glDeleteShader(h);
   }
+  pendingShaderHandles.clear();
+  pendingShaderSources.clear();
+  compilePending = false;
+
+  if (pendingUseCache) {
+    saveCachedProgramBinary(programHandle, pendingCacheKey);
+  }
+
+  // (time spent waiting between begin and finish is not counted, the driver may have been compiling in the background)
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - startTime;
+  render::engine->shaderProgramStats.nCompiled++;
+  render::engine->shaderProgramStats.compileSeconds += pendingCompileSeconds + elapsed.count();
 
   checkGLError();
 }
 
 void GLCompiledProgram::setDataLocations() {
-  glUseProgram(programHandle);
+  useProgram(programHandle);
+
+  // Shared uniform blocks
+  GLuint frameBlockIndex = glGetUniformBlockIndex(programHandle, "PolyscopeFrameUniforms");
+  if (frameBlockIndex != GL_INVALID_INDEX) {
+    glUniformBlockBinding(programHandle, frameBlockIndex, frameUniformBlockBinding);
+  }
 
   // Uniforms
   for (GLShaderUniform& u : uniforms) {
@@ -1206,11 +1984,14 @@ void GLCompiledProgram::addUniqueAttribute(ShaderSpecAttribute newAttribute) {
       // if it occurs twice, confirm that the occurences match
       if (a.type != newAttribute.type)
         exception("attribute " + a.name + " appears twice in program with different types");
+      if (a.perInstance != newAttribute.perInstance)
+        exception("attribute " + a.name + " appears twice in program, both per-vertex and per-instance");
 
       return;
     }
   }
-  attributes.push_back(GLShaderAttribute{newAttribute.name, newAttribute.type, newAttribute.arrayCount, -1, nullptr});
+  attributes.push_back(GLShaderAttribute{newAttribute.name, newAttribute.type, newAttribute.arrayCount,
+                                        newAttribute.perInstance, -1, nullptr});
 }
 
 void GLCompiledProgram::addUniqueUniform(ShaderSpecUniform newUniform) {
@@ -1328,6 +2109,30 @@ void GLShaderProgram::assignBufferToVAO(GLShaderAttribute& a) {
   for (int iArrInd = 0; iArrInd < a.arrayCount; iArrInd++) {
 
     glEnableVertexAttribArray(a.location + iArrInd);
+    glVertexAttribDivisor(a.location + iArrInd, a.perInstance ? 1 : 0);
+
+    // Compact buffers bound to float attributes, which are converted as they are fetched
+    // (these are never array-valued)
+    switch (a.buff->getType()) {
+    case RenderDataType::UInt8:
+      glVertexAttribPointer(a.location, 1, GL_UNSIGNED_BYTE, GL_FALSE, sizeof(uint8_t), reinterpret_cast<void*>(0));
+      continue;
+    case RenderDataType::UInt16:
+      glVertexAttribPointer(a.location, 1, GL_UNSIGNED_SHORT, GL_FALSE, sizeof(uint16_t), reinterpret_cast<void*>(0));
+      continue;
+    case RenderDataType::Vector4UInt8:
+      glVertexAttribPointer(a.location, a.type == RenderDataType::Vector3Float ? 3 : 4, GL_UNSIGNED_BYTE, GL_TRUE,
+                            sizeof(glm::u8vec4), reinterpret_cast<void*>(0));
+      continue;
+    case RenderDataType::Int:
+      if (a.type == RenderDataType::Float) {
+        glVertexAttribPointer(a.location, 1, GL_INT, GL_FALSE, sizeof(int32_t), reinterpret_cast<void*>(0));
+        continue;
+      }
+      break;
+    default:
+      break;
+    }
 
     switch (a.type) {
     case RenderDataType::Float:
@@ -1408,318 +2213,164 @@ void GLShaderProgram::ensureBufferExists(GLShaderAttribute& a) {
 }
 
 bool GLShaderProgram::hasUniform(std::string name) {
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name && u.location != -1) {
-      return true;
-    }
+  int32_t index = compiledProgram->getUniformIndex(name);
+  return index != -1 && uniforms[index].location != -1;
+}
+
+UniformHandle GLShaderProgram::getUniformHandle(std::string name) {
+  UniformHandle handle = lookupUniformHandle(name);
+  if (!handle.isValid()) {
+    throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
   }
-  return false;
+  return handle;
 }
 
-// Set an integer
-void GLShaderProgram::setUniform(std::string name, int val) {
-  glUseProgram(compiledProgram->getHandle());
+UniformHandle GLShaderProgram::lookupUniformHandle(const std::string& name) {
+  UniformHandle handle;
+  handle.index = compiledProgram->getUniformIndex(name);
+  return handle;
+}
 
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Int) {
-        glUniform1i(u.location, val);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
+GLShaderUniform* GLShaderProgram::getUniformToSet(UniformHandle handle, RenderDataType type) {
+  if (handle.index < 0 || static_cast<size_t>(handle.index) >= uniforms.size()) {
+    throw std::invalid_argument("Tried to set uniform with invalid handle");
   }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+  GLShaderUniform& u = uniforms[handle.index];
+  if (u.location == -1) return nullptr; // optimized out, setting it does nothing
+  if (u.type != type) {
+    throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
+  }
+  return &u;
 }
 
-// Set an unsigned integer
-void GLShaderProgram::setUniform(std::string name, unsigned int val) {
-  glUseProgram(compiledProgram->getHandle());
+// Set an integer
+void GLShaderProgram::setUniform(UniformHandle handle, int val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Int);
+  if (!u) return;
+  storeUniformValue(*u, static_cast<int32_t>(val));
+}
+void GLShaderProgram::setUniform(std::string name, int val) { setUniform(getUniformHandle(name), val); }
 
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::UInt) {
-        glUniform1ui(u.location, val);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+// Set an unsigned integer
+void GLShaderProgram::setUniform(UniformHandle handle, unsigned int val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::UInt);
+  if (!u) return;
+  storeUniformValue(*u, static_cast<uint32_t>(val));
 }
+void GLShaderProgram::setUniform(std::string name, unsigned int val) { setUniform(getUniformHandle(name), val); }
 
 // Set a float
-void GLShaderProgram::setUniform(std::string name, float val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Float) {
-        glUniform1f(u.location, val);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, float val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Float);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, float val) { setUniform(getUniformHandle(name), val); }
 
 // Set a double --- WARNING casts down to float
-void GLShaderProgram::setUniform(std::string name, double val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Float) {
-        glUniform1f(u.location, static_cast<float>(val));
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, double val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Float);
+  if (!u) return;
+  storeUniformValue(*u, static_cast<float>(val));
 }
+void GLShaderProgram::setUniform(std::string name, double val) { setUniform(getUniformHandle(name), val); }
 
 // Set a 4x4 uniform matrix
 // TODO why do we use a pointer here... makes no sense
-void GLShaderProgram::setUniform(std::string name, float* val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Matrix44Float) {
-        glUniformMatrix4fv(u.location, 1, false, val);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, float* val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Matrix44Float);
+  if (!u) return;
+  storeUniformValue(*u, val, 16 * sizeof(float));
 }
+void GLShaderProgram::setUniform(std::string name, float* val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vector2 uniform
-void GLShaderProgram::setUniform(std::string name, glm::vec2 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector2Float) {
-        glUniform2f(u.location, val.x, val.y);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::vec2 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector2Float);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::vec2 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vector3 uniform
-void GLShaderProgram::setUniform(std::string name, glm::vec3 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector3Float) {
-        glUniform3f(u.location, val.x, val.y, val.z);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::vec3 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector3Float);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::vec3 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vector4 uniform
-void GLShaderProgram::setUniform(std::string name, glm::vec4 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector4Float) {
-        glUniform4f(u.location, val.x, val.y, val.z, val.w);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::vec4 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector4Float);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::vec4 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vector3 uniform from a float array
-void GLShaderProgram::setUniform(std::string name, std::array<float, 3> val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector3Float) {
-        glUniform3f(u.location, val[0], val[1], val[2]);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, std::array<float, 3> val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector3Float);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, std::array<float, 3> val) { setUniform(getUniformHandle(name), val); }
 
 // Set a vec4 uniform
-void GLShaderProgram::setUniform(std::string name, float x, float y, float z, float w) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector4Float) {
-        glUniform4f(u.location, x, y, z, w);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, float x, float y, float z, float w) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector4Float);
+  if (!u) return;
+  storeUniformValue(*u, glm::vec4{x, y, z, w});
 }
+void GLShaderProgram::setUniform(std::string name, float x, float y, float z, float w) { setUniform(getUniformHandle(name), x, y, z, w); }
 
 // Set a int vector2 uniform
-void GLShaderProgram::setUniform(std::string name, glm::ivec2 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector2Int) {
-        glUniform2i(u.location, val.x, val.y);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::ivec2 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector2Int);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::ivec2 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a int vector3 uniform
-void GLShaderProgram::setUniform(std::string name, glm::ivec3 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector3Int) {
-        glUniform3i(u.location, val.x, val.y, val.z);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::ivec3 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector3Int);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::ivec3 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a int vector4 uniform
-void GLShaderProgram::setUniform(std::string name, glm::ivec4 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector4Int) {
-        glUniform4i(u.location, val.x, val.y, val.z, val.w);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::ivec4 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector4Int);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::ivec4 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a uint vector2 uniform
-void GLShaderProgram::setUniform(std::string name, glm::uvec2 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector2UInt) {
-        glUniform2ui(u.location, val.x, val.y);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::uvec2 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector2UInt);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::uvec2 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a uint vector3 uniform
-void GLShaderProgram::setUniform(std::string name, glm::uvec3 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector3UInt) {
-        glUniform3ui(u.location, val.x, val.y, val.z);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::uvec3 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector3UInt);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::uvec3 val) { setUniform(getUniformHandle(name), val); }
 
 // Set a uint vector4 uniform
-void GLShaderProgram::setUniform(std::string name, glm::uvec4 val) {
-  glUseProgram(compiledProgram->getHandle());
-
-  for (GLShaderUniform& u : uniforms) {
-    if (u.name == name) {
-      if (u.location == -1) return;
-      if (u.type == RenderDataType::Vector4UInt) {
-        glUniform4ui(u.location, val.x, val.y, val.z, val.w);
-        u.isSet = true;
-      } else {
-        throw std::invalid_argument("Tried to set GLShaderUniform with wrong type");
-      }
-      return;
-    }
-  }
-  throw std::invalid_argument("Tried to set nonexistent uniform with name " + name);
+void GLShaderProgram::setUniform(UniformHandle handle, glm::uvec4 val) {
+  GLShaderUniform* u = getUniformToSet(handle, RenderDataType::Vector4UInt);
+  if (!u) return;
+  storeUniformValue(*u, val);
 }
+void GLShaderProgram::setUniform(std::string name, glm::uvec4 val) { setUniform(getUniformHandle(name), val); }
 
 bool GLShaderProgram::hasAttribute(std::string name) {
   for (GLShaderAttribute& a : attributes) {
@@ -2002,7 +2653,7 @@ void GLShaderProgram::setTexture2D(std::string name, unsigned char* texData, uns
 }
 
 void GLShaderProgram::setTextureFromBuffer(std::string name, TextureBuffer* textureBuffer) {
-  glUseProgram(compiledProgram->getHandle());
+  useProgram(compiledProgram->getHandle());
 
   // Find the right texture
   for (GLShaderTexture& t : textures) {
@@ -2108,6 +2759,11 @@ void GLShaderProgram::setIndex(std::shared_ptr<AttributeBuffer> externalBuffer)
   case RenderDataType::Matrix44Float:
     throw std::invalid_argument("index buffer should be integer type");
     break;
+  case RenderDataType::UInt8:
+  case RenderDataType::UInt16:
+  case RenderDataType::Vector4UInt8:
+    throw std::invalid_argument("index buffer should be 32-bit integer type");
+    break;
   }
 
   indexBuffer = engineExtBuff;
@@ -2145,6 +2801,10 @@ void GLShaderProgram::validateData() {
 
     int compatCount = renderDataTypeCountCompatbility(a.type, a.buff->getType());
 
+    if (a.perInstance) { // sized by the instance count instead, checked below
+      continue;
+    }
+
     if (attributeSize == -1) { // first one we've seen
       attributeSize = a.buff->getDataSize() / (compatCount);
     } else { // not the first one we've seen
@@ -2177,11 +2837,25 @@ void GLShaderProgram::validateData() {
   }
 
   // Check instanced (if applicable)
-  if (drawMode == DrawMode::TrianglesInstanced || drawMode == DrawMode::TriangleStripInstanced) {
+  bool hasPerInstanceAttributes = false;
+  for (GLShaderAttribute& a : attributes) {
+    if (a.perInstance && a.buff) hasPerInstanceAttributes = true;
+  }
+  if (drawMode == DrawMode::TrianglesInstanced || drawMode == DrawMode::TriangleStripInstanced ||
+      hasPerInstanceAttributes) {
     if (instanceCount == INVALID_IND_32) {
       throw std::invalid_argument("Must set instance count to use instanced drawing");
     }
   }
+  for (GLShaderAttribute& a : attributes) {
+    if (!a.perInstance || !a.buff) continue;
+    int compatCount = renderDataTypeCountCompatbility(a.type, a.buff->getType());
+    if (a.buff->getDataSize() / compatCount < static_cast<int64_t>(instanceCount)) {
+      throw std::invalid_argument("Per-instance attribute " + a.name + " has size " +
+                                  std::to_string(a.buff->getDataSize()) + ", but " + std::to_string(instanceCount) +
+                                  " instances are drawn");
+    }
+  }
 }
 
 void GLShaderProgram::setPrimitiveRestartIndex(unsigned int restartIndex_) {
@@ -2204,10 +2878,66 @@ void GLShaderProgram::activateTextures() {
   }
 }
 
+void GLShaderProgram::activateTextures(const std::vector<TextureBuffer*>& bindings) {
+  for (size_t i = 0; i < textures.size(); i++) {
+    GLShaderTexture& t = textures[i];
+    if (t.location == -1) continue;
+
+    glActiveTexture(GL_TEXTURE0 + t.index);
+    static_cast<GLTextureBuffer*>(bindings[i])->bind();
+    glUniform1i(t.location, t.index);
+  }
+}
+
+uint64_t GLShaderProgram::textureKey() {
+  uint64_t key = 14695981039346656037ULL;
+  for (GLShaderTexture& t : textures) {
+    if (t.location == -1) continue;
+    key = (key ^ t.textureBuffer->getUniqueID()) * 1099511628211ULL;
+  }
+  return key;
+}
+
 void GLShaderProgram::draw() {
   validateData();
 
-  glUseProgram(compiledProgram->getHandle());
+  if (render::engine->renderQueueActive()) {
+    RenderQueueItem item = render::engine->newRenderQueueItem(this);
+    item.programKey = compiledProgram->getId();
+    item.textureKey = textureKey();
+    item.useDrawRanges = useDrawRanges;
+    item.drawRanges = drawRanges;
+    item.instanceCount = instanceCount;
+    for (GLShaderTexture& t : textures) {
+      item.textures.push_back(t.textureBuffer);
+      if (t.textureBufferOwned) item.ownedTextures.push_back(t.textureBufferOwned);
+    }
+    item.uniformData.resize(16 * uniforms.size());
+    for (size_t i = 0; i < uniforms.size(); i++) {
+      std::copy(uniforms[i].value.begin(), uniforms[i].value.end(), item.uniformData.begin() + 16 * i);
+    }
+    render::engine->enqueueDraw(std::move(item));
+    return;
+  }
+
+  useProgram(compiledProgram->getHandle());
+  for (size_t i = 0; i < uniforms.size(); i++) {
+    if (uniforms[i].isSet) compiledProgram->pushUniform(i, uniforms[i].value.data());
+  }
+  activateTextures();
+  drawGeometry(useDrawRanges ? &drawRanges : nullptr, instanceCount);
+}
+
+void GLShaderProgram::drawQueued(const RenderQueueItem& item) {
+  useProgram(compiledProgram->getHandle());
+  for (size_t i = 0; i < uniforms.size(); i++) {
+    if (uniforms[i].isSet) compiledProgram->pushUniform(i, &item.uniformData[16 * i]);
+  }
+  if (!item.sameTexturesAsPrevious) activateTextures(item.textures);
+  drawGeometry(item.useDrawRanges ? &item.drawRanges : nullptr, item.instanceCount);
+}
+
+void GLShaderProgram::drawGeometry(const std::vector<DrawRange>* ranges, uint32_t drawInstanceCount) {
   glBindVertexArray(vaoHandle);
 
   if (usePrimitiveRestart) {
@@ -2215,49 +2945,47 @@ void GLShaderProgram::draw() {
     glPrimitiveRestartIndex(restartIndex);
   }
 
-  activateTextures();
-
   switch (drawMode) {
   case DrawMode::Points:
-    glDrawArrays(GL_POINTS, 0, drawDataLength);
+    drawArrays(GL_POINTS, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::Triangles:
-    glDrawArrays(GL_TRIANGLES, 0, drawDataLength);
+    drawArrays(GL_TRIANGLES, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::Lines:
-    glDrawArrays(GL_LINES, 0, drawDataLength);
+    drawArrays(GL_LINES, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::TrianglesAdjacency:
-    glDrawArrays(GL_TRIANGLES_ADJACENCY, 0, drawDataLength);
+    drawArrays(GL_TRIANGLES_ADJACENCY, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::LinesAdjacency:
-    glDrawArrays(GL_LINES_ADJACENCY, 0, drawDataLength);
+    drawArrays(GL_LINES_ADJACENCY, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::IndexedLines:
     // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexVBO); // TODO delete these
-    glDrawElements(GL_LINES, drawDataLength, GL_UNSIGNED_INT, 0);
+    drawElements(GL_LINES, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::IndexedLineStrip:
     // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexVBO);
-    glDrawElements(GL_LINE_STRIP, drawDataLength, GL_UNSIGNED_INT, 0);
+    drawElements(GL_LINE_STRIP, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::IndexedLinesAdjacency:
     // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexVBO);
-    glDrawElements(GL_LINES_ADJACENCY, drawDataLength, GL_UNSIGNED_INT, 0);
+    drawElements(GL_LINES_ADJACENCY, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::IndexedLineStripAdjacency:
     // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexVBO);
-    glDrawElements(GL_LINE_STRIP_ADJACENCY, drawDataLength, GL_UNSIGNED_INT, 0);
+    drawElements(GL_LINE_STRIP_ADJACENCY, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::IndexedTriangles:
     // glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexVBO);
-    glDrawElements(GL_TRIANGLES, drawDataLength, GL_UNSIGNED_INT, 0);
+    drawElements(GL_TRIANGLES, drawDataLength, drawInstanceCount, ranges);
     break;
   case DrawMode::TrianglesInstanced:
-    glDrawArraysInstanced(GL_TRIANGLES, 0, drawDataLength, instanceCount);
+    glDrawArraysInstanced(GL_TRIANGLES, 0, drawDataLength, drawInstanceCount);
     break;
   case DrawMode::TriangleStripInstanced:
-    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, drawDataLength, instanceCount);
+    glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, drawDataLength, drawInstanceCount);
     break;
   }
 
@@ -2295,6 +3023,8 @@ std::vector<unsigned char> GLEngine::readDisplayBuffer() {
 
 
 void GLEngine::setDepthMode(DepthMode newMode) {
+  currDepthMode = newMode;
+  if (renderQueueActive()) return; // applied when the queued draws execute
   switch (newMode) {
   case DepthMode::Less:
     glEnable(GL_DEPTH_TEST);
@@ -2329,6 +3059,8 @@ void GLEngine::setDepthMode(DepthMode newMode) {
 }
 
 void GLEngine::setBlendMode(BlendMode newMode) {
+  currBlendMode = newMode;
+  if (renderQueueActive()) return; // applied when the queued draws execute
   switch (newMode) {
   case BlendMode::AlphaOver:
     glEnable(GL_BLEND);
@@ -2365,9 +3097,15 @@ void GLEngine::setBlendMode(BlendMode newMode) {
   }
 }
 
-void GLEngine::setColorMask(std::array<bool, 4> mask) { glColorMask(mask[0], mask[1], mask[2], mask[3]); }
+void GLEngine::setColorMask(std::array<bool, 4> mask) {
+  currColorMask = mask;
+  if (renderQueueActive()) return;
+  glColorMask(mask[0], mask[1], mask[2], mask[3]);
+}
 
 void GLEngine::setBackfaceCull(bool newVal) {
+  currBackfaceCull = newVal;
+  if (renderQueueActive()) return; // applied when the queued draws execute
   if (newVal) {
     glEnable(GL_CULL_FACE);
     glCullFace(GL_BACK);
@@ -2507,7 +3245,7 @@ std::string GLEngine::programKeyFromRules(const std::string& programName, const
 
 std::shared_ptr<GLCompiledProgram> GLEngine::getCompiledProgram(const std::string& programName,
                                                                 const std::vector<std::string>& customRules,
-                                                                ShaderReplacementDefaults defaults) {
+                                                                ShaderReplacementDefaults defaults, bool deferLink) {
 
   // Build a cache key for the program
   std::string progKey = programKeyFromRules(programName, customRules, defaults);
@@ -2578,14 +3316,41 @@ std::shared_ptr<GLCompiledProgram> GLEngine::getCompiledProgram(const std::strin
     }
 
     // Actually apply rule substitutions
-    std::vector<ShaderStageSpecification> updatedStages = applyShaderReplacements(stages, rules);
+    // (pick programs get an integer output if the pick buffer uses one)
+    bool integerPick = defaults == ShaderReplacementDefaults::Pick && pickColorBuffer &&
+                       pickColorBuffer->getType() == RenderBufferType::UInt2;
+    std::vector<ShaderStageSpecification> updatedStages =
+        integerPick ? convertToIntegerPickOutput(applyShaderReplacements(stages, rules))
+                    : applyShaderReplacements(stages, rules);
 
     // Create a new compiled program (GL work happens in the constructor)
-    compiledProgamCache[progKey] = std::shared_ptr<GLCompiledProgram>(new GLCompiledProgram(updatedStages, dm));
+    compiledProgamCache[progKey] =
+        std::shared_ptr<GLCompiledProgram>(new GLCompiledProgram(updatedStages, dm, deferLink));
   }
 
   // Now that the cache must contain the compiled program, just return it
-  return compiledProgamCache[progKey];
+  // (if it is still warming up, it must be finished before it can be used)
+  std::shared_ptr<GLCompiledProgram> program = compiledProgamCache[progKey];
+  if (!deferLink) {
+    finishLinkingOrEvict(program);
+  }
+  return program;
+}
+
+void GLEngine::finishLinkingOrEvict(std::shared_ptr<GLCompiledProgram> program) {
+  try {
+    program->finishLinking();
+  } catch (...) {
+    for (auto it = compiledProgamCache.begin(); it != compiledProgamCache.end(); it++) {
+      if (it->second == program) {
+        compiledProgamCache.erase(it);
+        break;
+      }
+    }
+    linkingShaderWarmups.erase(std::remove(linkingShaderWarmups.begin(), linkingShaderWarmups.end(), program),
+                               linkingShaderWarmups.end());
+    throw;
+  }
 }
 
 std::shared_ptr<ShaderProgram> GLEngine::requestShader(const std::string& programName,
@@ -2595,6 +3360,55 @@ std::shared_ptr<ShaderProgram> GLEngine::requestShader(const std::string& progra
   return std::shared_ptr<ShaderProgram>(newP);
 }
 
+bool GLEngine::supportsBackgroundShaderWarmup() { return haveParallelShaderCompile; }
+
+void GLEngine::startShaderWarmup(const ShaderWarmupRequest& request, bool background) {
+  std::shared_ptr<GLCompiledProgram> program =
+      getCompiledProgram(request.programName, request.customRules, request.defaults, background);
+  if (!program->isLinked()) linkingShaderWarmups.push_back(program);
+}
+
+void GLEngine::pollShaderWarmups(bool block) {
+  for (size_t i = 0; i < linkingShaderWarmups.size();) {
+    std::shared_ptr<GLCompiledProgram> program = linkingShaderWarmups[i];
+    if (block || program->linkCompletePending()) {
+      // (remove it first, so a failure leaves the list consistent)
+      linkingShaderWarmups[i] = linkingShaderWarmups.back();
+      linkingShaderWarmups.pop_back();
+      finishLinkingOrEvict(program);
+    } else {
+      i++;
+    }
+  }
+}
+
+size_t GLEngine::nPendingShaderWarmups() { return shaderWarmupQueue.size() + linkingShaderWarmups.size(); }
+
+
+uint32_t GLEngine::recordGPUTimestamp() {
+  GLuint query;
+  if (freeTimestampQueries.empty()) {
+    glGenQueries(1, &query);
+  } else {
+    query = freeTimestampQueries.back();
+    freeTimestampQueries.pop_back();
+  }
+  glQueryCounter(query, GL_TIMESTAMP);
+  return query;
+}
+
+bool GLEngine::readGPUTimestamp(uint32_t timestamp, uint64_t& nanoseconds) {
+  GLint available = GL_FALSE;
+  glGetQueryObjectiv(timestamp, GL_QUERY_RESULT_AVAILABLE, &available);
+  if (!available) return false;
+  GLuint64 result = 0;
+  glGetQueryObjectui64v(timestamp, GL_QUERY_RESULT, &result);
+  nanoseconds = static_cast<uint64_t>(result);
+  releaseGPUTimestamp(timestamp);
+  return true;
+}
+
+void GLEngine::releaseGPUTimestamp(uint32_t timestamp) { freeTimestampQueries.push_back(timestamp); }
 
 void GLEngine::registerShaderProgram(const std::string& name, const std::vector<ShaderStageSpecification>& spec,
                                      const DrawMode& dm) {
@@ -2646,6 +3460,7 @@ void GLEngine::populateDefaultShadersAndRules() {
 
   // Utility rules
   registerShaderRule("GLSL_VERSION", GLSL_VERSION);
+  registerShaderRule("FRAME_UNIFORM_BLOCK", FRAME_UNIFORM_BLOCK);
   registerShaderRule("GLOBAL_FRAGMENT_FILTER", GLOBAL_FRAGMENT_FILTER);
   registerShaderRule("DOWNSAMPLE_RESOLVE_1", DOWNSAMPLE_RESOLVE_1);
   registerShaderRule("DOWNSAMPLE_RESOLVE_2", DOWNSAMPLE_RESOLVE_2);
@@ -2661,6 +3476,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("COMPUTE_SHADE_NORMAL_FROM_POSITION", COMPUTE_SHADE_NORMAL_FROM_POSITION);
   registerShaderRule("PREMULTIPLY_LIT_COLOR", PREMULTIPLY_LIT_COLOR);
   registerShaderRule("CULL_POS_FROM_VIEW", CULL_POS_FROM_VIEW);
+  registerShaderRule("INSTANCE_TRANSFORM", INSTANCE_TRANSFORM);
   registerShaderRule("PROJ_AND_INV_PROJ_MAT", PROJ_AND_INV_PROJ_MAT);
   registerShaderRule("BUILD_RAY_FOR_FRAGMENT_PERSPECTIVE", BUILD_RAY_FOR_FRAGMENT_PERSPECTIVE);
   registerShaderRule("BUILD_RAY_FOR_FRAGMENT_ORTHOGRAPHIC", BUILD_RAY_FOR_FRAGMENT_ORTHOGRAPHIC);
@@ -2711,6 +3527,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("MESH_PROPAGATE_VALUE2", MESH_PROPAGATE_VALUE2);
   registerShaderRule("MESH_PROPAGATE_TCOORD", MESH_PROPAGATE_TCOORD);
   registerShaderRule("MESH_PROPAGATE_COLOR", MESH_PROPAGATE_COLOR);
+  registerShaderRule("MESH_PROPAGATE_INSTANCE_COLOR", MESH_PROPAGATE_INSTANCE_COLOR);
   registerShaderRule("MESH_PROPAGATE_HALFEDGE_VALUE", MESH_PROPAGATE_HALFEDGE_VALUE);
   registerShaderRule("MESH_PROPAGATE_CULLPOS", MESH_PROPAGATE_CULLPOS);
   registerShaderRule("MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE", MESH_PROPAGATE_TYPE_AND_BASECOLOR2_SHADE);
@@ -2735,6 +3552,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("SPHERE_PROPAGATE_VALUEALPHA", SPHERE_PROPAGATE_VALUEALPHA);
   registerShaderRule("SPHERE_PROPAGATE_VALUE2", SPHERE_PROPAGATE_VALUE2);
   registerShaderRule("SPHERE_PROPAGATE_COLOR", SPHERE_PROPAGATE_COLOR);
+  registerShaderRule("SPHERE_PROPAGATE_INSTANCE_COLOR", SPHERE_PROPAGATE_INSTANCE_COLOR);
   registerShaderRule("SPHERE_CULLPOS_FROM_CENTER", SPHERE_CULLPOS_FROM_CENTER);
   registerShaderRule("SPHERE_CULLPOS_FROM_CENTER_QUAD", SPHERE_CULLPOS_FROM_CENTER_QUAD);
   registerShaderRule("SPHERE_VARIABLE_SIZE", SPHERE_VARIABLE_SIZE);
@@ -2749,6 +3567,7 @@ void GLEngine::populateDefaultShadersAndRules() {
   registerShaderRule("CYLINDER_PROPAGATE_BLEND_VALUE", CYLINDER_PROPAGATE_BLEND_VALUE);
   registerShaderRule("CYLINDER_PROPAGATE_NEAREST_VALUE", CYLINDER_PROPAGATE_NEAREST_VALUE);
   registerShaderRule("CYLINDER_PROPAGATE_COLOR", CYLINDER_PROPAGATE_COLOR);
+  registerShaderRule("CYLINDER_PROPAGATE_INSTANCE_COLOR", CYLINDER_PROPAGATE_INSTANCE_COLOR);
   registerShaderRule("CYLINDER_PROPAGATE_BLEND_COLOR", CYLINDER_PROPAGATE_BLEND_COLOR);
   registerShaderRule("CYLINDER_PROPAGATE_PICK", CYLINDER_PROPAGATE_PICK);
   registerShaderRule("CYLINDER_CULLPOS_FROM_MID", CYLINDER_CULLPOS_FROM_MID);
@@ -2767,13 +3586,38 @@ void GLEngine::populateDefaultShadersAndRules() {
 
 void GLEngine::freeAllOwnedResources() {
 
+  if (frameUniformBuffer != 0) {
+    glDeleteBuffers(1, &frameUniformBuffer);
+    frameUniformBuffer = 0;
+    frameUniformsValid = false;
+  }
+
   registeredShaderPrograms.clear();
   registeredShaderRules.clear();
+  linkingShaderWarmups.clear();
   compiledProgamCache.clear();
 
+  if (!freeTimestampQueries.empty()) {
+    glDeleteQueries(static_cast<GLsizei>(freeTimestampQueries.size()), &freeTimestampQueries[0]);
+    freeTimestampQueries.clear();
+  }
+
   Engine::freeAllOwnedResources();
 }
 
+void GLEngine::uploadFrameUniforms(const FrameUniforms& data) {
+  if (frameUniformBuffer == 0) {
+    glGenBuffers(1, &frameUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameUniforms), nullptr, GL_DYNAMIC_DRAW);
+    glBindBufferBase(GL_UNIFORM_BUFFER, frameUniformBlockBinding, frameUniformBuffer);
+  }
+
+  glBindBuffer(GL_UNIFORM_BUFFER, frameUniformBuffer);
+  glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameUniforms), &data);
+  checkGLError();
+}
+
 void GLEngine::createSlicePlaneFliterRule(std::string uniquePostfix) {
   registeredShaderRules.insert({"SLICE_PLANE_CULL_" + uniquePostfix, generateSlicePlaneRule(uniquePostfix)});
   registeredShaderRules.insert(
@@ -251,6 +251,7 @@ void GLEngineEGL::initialize() {
     exception(options::printPrefix + "ERROR: Failed to load openGL using GLAD");
   }
 #endif
+  loadOptionalGLFunctions([&](const char* name) { return reinterpret_cast<void*>(eglGetProcAddress(name)); });
 
   {
     std::stringstream ss;
@@ -105,6 +105,7 @@ void GLEngineGLFW::initialize() {
     exception("ERROR: Failed to load openGL using GLAD");
   }
 #endif
+  loadOptionalGLFunctions([](const char* name) { return reinterpret_cast<void*>(glfwGetProcAddress(name)); });
 
   {
     std::stringstream ss;
@@ -39,8 +39,10 @@ R"(
         
         void main()
         {
-            gl_Position = u_modelView * vec4(a_position_tail, 1.0);
-            position_tip = u_modelView * vec4(a_position_tip, 1.0);
+            mat4 modelView = u_modelView;
+            ${ VERT_MODIFY_MODEL_VIEW }$
+            gl_Position = modelView * vec4(a_position_tail, 1.0);
+            position_tip = modelView * vec4(a_position_tip, 1.0);
 
             ${ VERT_ASSIGNMENTS }$
         }
@@ -363,6 +365,37 @@ const ShaderReplacementRule CYLINDER_PROPAGATE_COLOR (
     /* textures */ {}
 );
 
+const ShaderReplacementRule CYLINDER_PROPAGATE_INSTANCE_COLOR (
+    /* rule name */ "CYLINDER_PROPAGATE_INSTANCE_COLOR",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec3 a_instanceColor;
+          out vec3 a_instanceColorToGeom;
+        )"},
+      {"VERT_ASSIGNMENTS", R"(
+          a_instanceColorToGeom = a_instanceColor;
+        )"},
+      {"GEOM_DECLARATIONS", R"(
+          in vec3 a_instanceColorToGeom[];
+          flat out vec3 a_instanceColorToFrag;
+        )"},
+      {"GEOM_PER_EMIT", R"(
+          a_instanceColorToFrag = a_instanceColorToGeom[0]; 
+        )"},
+      {"FRAG_DECLARATIONS", R"(
+          flat in vec3 a_instanceColorToFrag;
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          vec3 shadeColor = a_instanceColorToFrag;
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_instanceColor", RenderDataType::Vector3Float, 1, true},
+    },
+    /* textures */ {}
+);
+
 // like propagate color, but takes two values at tip and taail and linearly interpolates
 const ShaderReplacementRule CYLINDER_PROPAGATE_BLEND_COLOR (
     /* rule name */ "CYLINDER_PROPAGATE_BLEND_COLOR",
@@ -17,6 +17,30 @@ const ShaderReplacementRule GLSL_VERSION(
     }
 );
 
+// camera and viewport uniforms which are the same for all programs, from a uniform buffer written once per view
+// (matches the layout of render::FrameUniforms)
+const ShaderReplacementRule FRAME_UNIFORM_BLOCK(
+    /* rule name */ "FRAME_UNIFORM_BLOCK",
+    { /* replacement sources */
+      {"GLSL_VERSION", R"(
+        layout(std140) uniform PolyscopeFrameUniforms {
+          mat4 u_projMatrix;
+          mat4 u_invProjMatrix;
+          vec4 u_viewport;
+          vec2 u_viewportDim;
+        };
+        #define u_invProjMatrix_viewPos u_invProjMatrix
+        #define u_viewport_viewPos u_viewport
+      )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {},
+    /* textures */ {},
+    /* block uniforms */ {
+      "u_projMatrix", "u_invProjMatrix", "u_viewport", "u_viewportDim", "u_invProjMatrix_viewPos", "u_viewport_viewPos"
+    }
+);
+
 // possibly discards a fragment due to global rules
 const ShaderReplacementRule GLOBAL_FRAGMENT_FILTER(
     /* rule name */ "GLOBAL_FRAGMENT_FILTER",
@@ -405,6 +429,25 @@ const ShaderReplacementRule GENERATE_VIEW_POS (
     /* textures */ {}
 );
 
+// per-instance affine transforms, applied in object space before the model-view matrix, for instanced draws
+const ShaderReplacementRule INSTANCE_TRANSFORM (
+    /* rule name */ "INSTANCE_TRANSFORM",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec3 a_instanceTransform[4]; // columns of the upper 3x4 block
+        )"},
+      {"VERT_MODIFY_MODEL_VIEW", R"(
+          modelView = modelView * mat4(vec4(a_instanceTransform[0], 0.), vec4(a_instanceTransform[1], 0.), 
+                                       vec4(a_instanceTransform[2], 0.), vec4(a_instanceTransform[3], 1.));
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_instanceTransform", RenderDataType::Vector3Float, 4, true},
+    },
+    /* textures */ {}
+);
+
 const ShaderReplacementRule PROJ_AND_INV_PROJ_MAT (
     /* rule name */ "PROJ_AND_INV_PROJ_MAT",
     { /* replacement sources */
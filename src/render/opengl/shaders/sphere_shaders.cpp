@@ -36,7 +36,9 @@ R"(
         
         void main()
         {
-            gl_Position = u_modelView * vec4(a_position, 1.0);
+            mat4 modelView = u_modelView;
+            ${ VERT_MODIFY_MODEL_VIEW }$
+            gl_Position = modelView * vec4(a_position, 1.0);
 
             ${ VERT_ASSIGNMENTS }$
         }
@@ -483,6 +485,37 @@ const ShaderReplacementRule SPHERE_PROPAGATE_COLOR (
     /* textures */ {}
 );
 
+const ShaderReplacementRule SPHERE_PROPAGATE_INSTANCE_COLOR (
+    /* rule name */ "SPHERE_PROPAGATE_INSTANCE_COLOR",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec3 a_instanceColor;
+          out vec3 a_instanceColorToGeom;
+        )"},
+      {"VERT_ASSIGNMENTS", R"(
+          a_instanceColorToGeom = a_instanceColor;
+        )"},
+      {"GEOM_DECLARATIONS", R"(
+          in vec3 a_instanceColorToGeom[];
+          flat out vec3 a_instanceColorToFrag;
+        )"},
+      {"GEOM_PER_EMIT", R"(
+          a_instanceColorToFrag = a_instanceColorToGeom[0]; 
+        )"},
+      {"FRAG_DECLARATIONS", R"(
+          flat in vec3 a_instanceColorToFrag;
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          vec3 shadeColor = a_instanceColorToFrag;
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_instanceColor", RenderDataType::Vector3Float, 1, true},
+    },
+    /* textures */ {}
+);
+
 const ShaderReplacementRule SPHERE_CULLPOS_FROM_CENTER(
     /* rule name */ "SPHERE_CULLPOS_FROM_CENTER",
     { /* replacement sources */
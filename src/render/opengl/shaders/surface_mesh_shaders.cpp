@@ -47,9 +47,11 @@ R"(
         
         void main()
         {
-            gl_Position = u_projMatrix * u_modelView * vec4(a_vertexPositions,1.);
+            mat4 modelView = u_modelView;
+            ${ VERT_MODIFY_MODEL_VIEW }$
+            gl_Position = u_projMatrix * modelView * vec4(a_vertexPositions,1.);
             
-            a_vertexNormalToFrag = mat3(u_modelView) * a_vertexNormals;
+            a_vertexNormalToFrag = mat3(modelView) * a_vertexNormals;
             a_barycoordToFrag = a_barycoord;
 
             ${ VERT_ASSIGNMENTS }$
@@ -417,6 +419,30 @@ const ShaderReplacementRule MESH_PROPAGATE_COLOR (
     /* textures */ {}
 );
 
+const ShaderReplacementRule MESH_PROPAGATE_INSTANCE_COLOR (
+    /* rule name */ "MESH_PROPAGATE_INSTANCE_COLOR",
+    { /* replacement sources */
+      {"VERT_DECLARATIONS", R"(
+          in vec3 a_instanceColor;
+          flat out vec3 a_instanceColorToFrag;
+        )"},
+      {"VERT_ASSIGNMENTS", R"(
+          a_instanceColorToFrag = a_instanceColor;
+        )"},
+      {"FRAG_DECLARATIONS", R"(
+          flat in vec3 a_instanceColorToFrag;
+        )"},
+      {"GENERATE_SHADE_VALUE", R"(
+          vec3 shadeColor = a_instanceColorToFrag;
+        )"},
+    },
+    /* uniforms */ {},
+    /* attributes */ {
+      {"a_instanceColor", RenderDataType::Vector3Float, 1, true},
+    },
+    /* textures */ {}
+);
+
 const ShaderReplacementRule MESH_PROPAGATE_VALUE2 (
     /* rule name */ "MESH_PROPAGATE_VALUE2",
     { /* replacement sources */
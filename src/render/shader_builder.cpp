@@ -4,6 +4,8 @@
 
 #include "polyscope/messages.h"
 
+#include <cstring>
+#include <regex>
 
 namespace polyscope {
 namespace render {
@@ -65,6 +67,15 @@ applyShaderReplacements(const std::vector<ShaderStageSpecification>& stages,
       }
     }
 
+    // Remove plain declarations of uniforms which a rule provides through a uniform block, they would conflict with
+    // the block members. (They are left in the uniform listing, they simply have no location.)
+    for (const ShaderReplacementRule& rule : replacementRules) {
+      for (const std::string& name : rule.blockUniforms) {
+        const std::regex plainDecl("uniform\\s+\\w+\\s+" + name + "\\s*;");
+        resultText = std::regex_replace(resultText, plainDecl, "// " + name + " from uniform block");
+      }
+    }
+
     // For now, we put the uniform listings on the all stages, attributes on vertex shaders, and textures on fragment
     // shaders, since this is where they are mostly commonly used. These listings are only used internally by Polyscope
     // to check inputs, so this should be fine even if they happen to be used elsewhere.
@@ -165,5 +176,119 @@ applyShaderReplacements(const std::vector<ShaderStageSpecification>& stages,
   return replacedStages;
 }
 
+std::vector<ShaderStageSpecification> convertToIntegerPickOutput(const std::vector<ShaderStageSpecification>& stages) {
+
+  const std::regex outputDecl(R"(layout\s*\(\s*location\s*=\s*0\s*\)\s*out\s+vec4\s+outputF\s*;)");
+  const std::regex mainDecl(R"(void\s+main\s*\(\s*\))");
+
+  // The pick color packs three 22 bit integers as floats in [0,1), see pick::indToVec()
+  const std::string newMain = R"(
+        uvec2 pickColorToID(vec3 color) {
+          uvec3 k = uvec3(round(color * 4194304.));
+          return uvec2(k.x | (k.y << 22u), (k.y >> 10u) | (k.z << 12u));
+        }
+
+        void main() {
+          pickMain();
+          outputPickID = pickColorToID(outputF.rgb);
+        }
+)";
+
+  std::vector<ShaderStageSpecification> convertedStages;
+  for (const ShaderStageSpecification& stage : stages) {
+    if (stage.stage != ShaderStageType::Fragment) {
+      convertedStages.push_back(stage);
+      continue;
+    }
+
+    // Any other output would silently be written as a float pick color, which cannot be decoded as an integer
+    if (!std::regex_search(stage.src, outputDecl) || !std::regex_search(stage.src, mainDecl)) {
+      exception("ShaderBuilder: cannot convert pick program to integer output, its fragment shader must declare "
+                "'layout(location = 0) out vec4 outputF;' and 'void main()'");
+    }
+
+    std::string src = stage.src;
+    src = std::regex_replace(src, outputDecl, "vec4 outputF;\n        layout(location = 0) out uvec2 outputPickID;");
+    src = std::regex_replace(src, mainDecl, "void pickMain()");
+    src += newMain;
+
+    ShaderStageSpecification newStage{stage.stage, stage.uniforms, stage.attributes, stage.textures, src};
+    convertedStages.push_back(newStage);
+  }
+
+  return convertedStages;
+}
+
+namespace {
+
+const char programBinaryMagic[4] = {'P', 'S', 'P', 'B'};
+
+// 64 bit FNV-1a
+uint64_t checksum(const char* data, size_t n) {
+  uint64_t h = 14695981039346656037ULL;
+  for (size_t i = 0; i < n; i++) {
+    h ^= static_cast<unsigned char>(data[i]);
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+// Layout: magic, binary format, driver string length, binary length, binary checksum, driver string, binary
+const size_t headerSize = sizeof(programBinaryMagic) + 2 * sizeof(uint32_t) + 2 * sizeof(uint64_t);
+
+template <typename T>
+void appendBytes(std::string& out, const T& val) {
+  out.append(reinterpret_cast<const char*>(&val), sizeof(T));
+}
+
+template <typename T>
+T readBytes(const std::string& in, size_t& offset) {
+  T val;
+  std::memcpy(&val, &in[offset], sizeof(T));
+  offset += sizeof(T);
+  return val;
+}
+
+} // namespace
+
+std::string encodeProgramBinaryCacheEntry(uint32_t format, const std::string& driver, const std::vector<char>& binary) {
+  std::string entry;
+  entry.reserve(headerSize + driver.size() + binary.size());
+  entry.append(programBinaryMagic, sizeof(programBinaryMagic));
+  appendBytes(entry, format);
+  appendBytes(entry, static_cast<uint32_t>(driver.size()));
+  appendBytes(entry, static_cast<uint64_t>(binary.size()));
+  appendBytes(entry, checksum(binary.data(), binary.size()));
+  entry += driver;
+  entry.append(binary.data(), binary.size());
+  return entry;
+}
+
+bool decodeProgramBinaryCacheEntry(const std::string& entry, const std::string& driver, uint32_t& formatOut,
+                                   std::vector<char>& binaryOut) {
+  if (entry.size() < headerSize || entry.compare(0, sizeof(programBinaryMagic), programBinaryMagic,
+                                                 sizeof(programBinaryMagic)) != 0) {
+    return false;
+  }
+
+  size_t offset = sizeof(programBinaryMagic);
+  uint32_t format = readBytes<uint32_t>(entry, offset);
+  uint32_t driverLen = readBytes<uint32_t>(entry, offset);
+  uint64_t binaryLen = readBytes<uint64_t>(entry, offset);
+  uint64_t binaryChecksum = readBytes<uint64_t>(entry, offset);
+
+  // (the sizes are checked separately, so a corrupt length can't overflow the sum)
+  size_t remaining = entry.size() - headerSize;
+  if (binaryLen == 0 || driverLen > remaining || binaryLen != remaining - driverLen) return false;
+  if (entry.compare(headerSize, driverLen, driver) != 0) return false;
+
+  const char* binary = &entry[headerSize + driverLen];
+  if (checksum(binary, binaryLen) != binaryChecksum) return false;
+
+  formatOut = format;
+  binaryOut.assign(binary, binary + binaryLen);
+  return true;
+}
+
 } // namespace render
 } // namespace polyscope
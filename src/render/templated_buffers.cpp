@@ -100,6 +100,21 @@ std::shared_ptr<AttributeBuffer> generateAttributeBuffer<glm::uvec4>(Engine* eng
   return engine->generateAttributeBuffer(RenderDataType::Vector4UInt);
 }
 
+template <>
+std::shared_ptr<AttributeBuffer> generateAttributeBuffer<uint8_t>(Engine* engine) {
+  return engine->generateAttributeBuffer(RenderDataType::UInt8);
+}
+
+template <>
+std::shared_ptr<AttributeBuffer> generateAttributeBuffer<uint16_t>(Engine* engine) {
+  return engine->generateAttributeBuffer(RenderDataType::UInt16);
+}
+
+template <>
+std::shared_ptr<AttributeBuffer> generateAttributeBuffer<glm::u8vec4>(Engine* engine) {
+  return engine->generateAttributeBuffer(RenderDataType::Vector4UInt8);
+}
+
 
 // == Get buffer data at a single location
 
@@ -197,6 +212,21 @@ glm::uvec4 getAttributeBufferData<glm::uvec4>(AttributeBuffer& buff, size_t ind)
   return buff.getData_uvec4(ind);
 }
 
+template <>
+uint8_t getAttributeBufferData<uint8_t>(AttributeBuffer& buff, size_t ind) {
+  return buff.getData_uint8(ind);
+}
+
+template <>
+uint16_t getAttributeBufferData<uint16_t>(AttributeBuffer& buff, size_t ind) {
+  return buff.getData_uint16(ind);
+}
+
+template <>
+glm::u8vec4 getAttributeBufferData<glm::u8vec4>(AttributeBuffer& buff, size_t ind) {
+  return buff.getData_u8vec4(ind);
+}
+
 // == Get buffer data at a range of locations
 
 template <>
@@ -313,6 +343,21 @@ std::vector<glm::uvec4> getAttributeBufferDataRange<glm::uvec4>(AttributeBuffer&
   return buff.getDataRange_uvec4(ind, count);
 }
 
+template <>
+std::vector<uint8_t> getAttributeBufferDataRange<uint8_t>(AttributeBuffer& buff, size_t ind, size_t count) {
+  return buff.getDataRange_uint8(ind, count);
+}
+
+template <>
+std::vector<uint16_t> getAttributeBufferDataRange<uint16_t>(AttributeBuffer& buff, size_t ind, size_t count) {
+  return buff.getDataRange_uint16(ind, count);
+}
+
+template <>
+std::vector<glm::u8vec4> getAttributeBufferDataRange<glm::u8vec4>(AttributeBuffer& buff, size_t ind, size_t count) {
+  return buff.getDataRange_u8vec4(ind, count);
+}
+
 // ==========================================================
 // === Texture buffers
 // ==========================================================
@@ -379,6 +424,21 @@ std::shared_ptr<TextureBuffer> generateTextureBuffer<glm::vec4, DeviceBufferType
   return engine->generateTextureBuffer(TextureFormat::RGBA32F, 0, 0, 0, (float*)nullptr);
 }
 
+template <>
+std::shared_ptr<TextureBuffer> generateTextureBuffer<glm::u8vec4, DeviceBufferType::Texture1d>(Engine* engine) {
+  return engine->generateTextureBuffer(TextureFormat::RGBA8, 0, (unsigned char*)nullptr);
+}
+
+template <>
+std::shared_ptr<TextureBuffer> generateTextureBuffer<glm::u8vec4, DeviceBufferType::Texture2d>(Engine* engine) {
+  return engine->generateTextureBuffer(TextureFormat::RGBA8, 0, 0, (unsigned char*)nullptr);
+}
+
+template <>
+std::shared_ptr<TextureBuffer> generateTextureBuffer<glm::u8vec4, DeviceBufferType::Texture3d>(Engine* engine) {
+  return engine->generateTextureBuffer(TextureFormat::RGBA8, 0, 0, 0, (unsigned char*)nullptr);
+}
+
 // general version which dispatches on D
 
 template <typename T>
@@ -419,6 +479,10 @@ template std::shared_ptr<TextureBuffer> generateTextureBuffer<glm::uvec2>(Device
 template std::shared_ptr<TextureBuffer> generateTextureBuffer<glm::uvec3>(DeviceBufferType D, Engine* engine);
 template std::shared_ptr<TextureBuffer> generateTextureBuffer<glm::uvec4>(DeviceBufferType D, Engine* engine);
 
+template std::shared_ptr<TextureBuffer> generateTextureBuffer<uint8_t    >(DeviceBufferType D, Engine* engine);
+template std::shared_ptr<TextureBuffer> generateTextureBuffer<uint16_t   >(DeviceBufferType D, Engine* engine);
+template std::shared_ptr<TextureBuffer> generateTextureBuffer<glm::u8vec4>(DeviceBufferType D, Engine* engine);
+
 template std::shared_ptr<TextureBuffer> generateTextureBuffer<std::array<glm::vec3, 2>>(DeviceBufferType D, Engine* engine);
 template std::shared_ptr<TextureBuffer> generateTextureBuffer<std::array<glm::vec3, 3>>(DeviceBufferType D, Engine* engine);
 template std::shared_ptr<TextureBuffer> generateTextureBuffer<std::array<glm::vec3, 4>>(DeviceBufferType D, Engine* engine);
@@ -0,0 +1,299 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/scalar_statistics.h"
+
+#include "polyscope/affine_remapper.h"
+#include "polyscope/messages.h"
+#include "polyscope/parallel_helpers.h"
+#include "polyscope/quantile_sketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <string>
+
+namespace polyscope {
+
+std::pair<double, double> ScalarStatistics::robustRange(double rangeEPS) const {
+  if (nNonFinite == nValues) {
+    return std::make_pair(-1.0, 1.0);
+  }
+  return padRobustRange(minVal, maxVal, rangeEPS);
+}
+
+size_t ScalarStatistics::histogramBinOf(double val) const {
+  double nBins = histogramBinCounts.size();
+  double iBinf = nBins * (val - histogramRange.first) / (histogramRange.second - histogramRange.first);
+  return std::floor(std::min(std::max(iBinf, 0.0), nBins - 1));
+}
+
+bool ScalarStatistics::replaceValue(double oldVal, double newVal) {
+  bool oldFinite = std::isfinite(oldVal);
+  bool newFinite = std::isfinite(newVal);
+  if (nNonFinite == nValues) return false; // minVal/maxVal are meaningless
+  if (newFinite && (newVal < histogramRange.first || newVal > histogramRange.second)) return false;
+
+  // replacing an extreme value might shrink the range, which can only be found by rescanning
+  if (oldFinite && oldVal != newVal && (oldVal == minVal || oldVal == maxVal)) return false;
+
+  if (oldFinite) {
+    if (!histogramBinCounts.empty()) histogramBinCounts[histogramBinOf(oldVal)] -= 1.;
+  } else {
+    nNonFinite--;
+  }
+
+  if (newFinite) {
+    if (!histogramBinCounts.empty()) histogramBinCounts[histogramBinOf(newVal)] += 1.;
+    minVal = std::min(minVal, newVal);
+    maxVal = std::max(maxVal, newVal);
+  } else {
+    nNonFinite++;
+  }
+
+  return true;
+}
+
+namespace {
+
+// Sum per-chunk bin counts in to the final histogram
+void mergeChunkBins(const std::vector<std::vector<size_t>>& chunkBins, size_t nBins, ScalarStatistics& stats) {
+  stats.histogramBinCounts = std::vector<double>(nBins, 0.);
+  for (const std::vector<size_t>& bins : chunkBins) {
+    for (size_t iBin = 0; iBin < nBins; iBin++) {
+      stats.histogramBinCounts[iBin] += bins[iBin];
+    }
+  }
+}
+
+template <typename T>
+ScalarStatistics computeIntegerStatistics(const std::vector<T>& values, size_t nBins) {
+  ScalarStatistics stats;
+  size_t N = values.size();
+  stats.nValues = N;
+  if (N == 0) {
+    stats.histogramBinCounts = std::vector<double>(nBins, 0.);
+    return stats;
+  }
+
+  // == Sweep 1: range
+  size_t nChunks = parallelChunkCount(N);
+  std::vector<T> chunkMin(nChunks, std::numeric_limits<T>::max());
+  std::vector<T> chunkMax(nChunks, std::numeric_limits<T>::lowest());
+  parallelForChunks(N, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    T minVal = std::numeric_limits<T>::max();
+    T maxVal = std::numeric_limits<T>::lowest();
+    for (size_t i = iStart; i < iEnd; i++) {
+      minVal = std::min(minVal, values[i]);
+      maxVal = std::max(maxVal, values[i]);
+    }
+    chunkMin[iChunk] = minVal;
+    chunkMax[iChunk] = maxVal;
+  });
+  int64_t minVal = *std::min_element(chunkMin.begin(), chunkMin.end());
+  int64_t maxVal = *std::max_element(chunkMax.begin(), chunkMax.end());
+  stats.minVal = minVal;
+  stats.maxVal = maxVal;
+  if (minVal == maxVal) {
+    stats.histogramRange = std::make_pair(minVal - 0.5, maxVal + 0.5);
+  } else {
+    stats.histogramRange = std::make_pair(static_cast<double>(minVal), static_cast<double>(maxVal));
+  }
+
+  if (nBins == 0) return stats;
+
+  // == Sweep 2: bins
+  // Same rule as the float case, in integer arithmetic. A constant lands in the middle bin.
+  auto binOf = [&](int64_t v) -> size_t {
+    if (minVal == maxVal) return nBins / 2;
+    int64_t iBin = (v - minVal) * static_cast<int64_t>(nBins) / (maxVal - minVal);
+    return std::min(static_cast<size_t>(iBin), nBins - 1);
+  };
+
+  std::vector<std::vector<size_t>> chunkBins(nChunks);
+  uint64_t nDistinct = static_cast<uint64_t>(maxVal - minVal) + 1;
+  if (nDistinct <= (1u << 16)) {
+    // Small ranges (all 8- and 16-bit data): tally each value, then fold the tallies in to bins
+    parallelForChunks(N, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+      std::vector<size_t> valueCounts(nDistinct, 0);
+      for (size_t i = iStart; i < iEnd; i++) {
+        valueCounts[static_cast<int64_t>(values[i]) - minVal]++;
+      }
+      std::vector<size_t>& bins = chunkBins[iChunk];
+      bins.resize(nBins, 0);
+      for (uint64_t iVal = 0; iVal < nDistinct; iVal++) {
+        if (valueCounts[iVal] > 0) bins[binOf(minVal + static_cast<int64_t>(iVal))] += valueCounts[iVal];
+      }
+    });
+  } else {
+    parallelForChunks(N, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+      std::vector<size_t>& bins = chunkBins[iChunk];
+      bins.resize(nBins, 0);
+      for (size_t i = iStart; i < iEnd; i++) {
+        bins[binOf(values[i])]++;
+      }
+    });
+  }
+  mergeChunkBins(chunkBins, nBins, stats);
+
+  return stats;
+}
+
+template <typename T>
+void rebinImpl(ScalarStatistics& stats, const std::vector<T>& values, std::pair<double, double> range) {
+  size_t nBins = stats.histogramBinCounts.size();
+  stats.histogramRange = range;
+  if (nBins == 0) return;
+
+  std::vector<std::vector<size_t>> chunkBins(parallelChunkCount(values.size()));
+  parallelForChunks(values.size(), [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    std::vector<size_t>& bins = chunkBins[iChunk];
+    bins.resize(nBins, 0);
+    for (size_t i = iStart; i < iEnd; i++) {
+      double v = values[i];
+      if (!std::isfinite(v)) continue;
+      bins[stats.histogramBinOf(v)]++;
+    }
+  });
+  mergeChunkBins(chunkBins, nBins, stats);
+}
+
+template <typename T>
+std::pair<double, double> percentilesImpl(const std::vector<T>& values, double lowerPercentile,
+                                          double upperPercentile) {
+  if (!(lowerPercentile >= 0. && lowerPercentile <= upperPercentile && upperPercentile <= 100.)) {
+    exception("invalid percentiles [" + std::to_string(lowerPercentile) + "," + std::to_string(upperPercentile) +
+              "], should be increasing and in [0,100]");
+  }
+
+  // Sketch each chunk in parallel, then merge
+  size_t N = values.size();
+  std::vector<QuantileSketch> chunkSketches(parallelChunkCount(N));
+  std::vector<double> chunkMin(chunkSketches.size(), std::numeric_limits<double>::infinity());
+  std::vector<double> chunkMax(chunkSketches.size(), -std::numeric_limits<double>::infinity());
+  parallelForChunks(N, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    QuantileSketch& sketch = chunkSketches[iChunk];
+    for (size_t i = iStart; i < iEnd; i++) {
+      double v = values[i];
+      if (!std::isfinite(v)) continue;
+      sketch.add(v);
+      chunkMin[iChunk] = std::min(chunkMin[iChunk], v);
+      chunkMax[iChunk] = std::max(chunkMax[iChunk], v);
+    }
+  });
+  QuantileSketch& sketch = chunkSketches[0];
+  for (size_t iChunk = 1; iChunk < chunkSketches.size(); iChunk++) {
+    sketch.merge(chunkSketches[iChunk]);
+  }
+
+  if (sketch.count() == 0) {
+    return std::make_pair(-1.0, 1.0);
+  }
+
+  double minVal = *std::min_element(chunkMin.begin(), chunkMin.end());
+  double maxVal = *std::max_element(chunkMax.begin(), chunkMax.end());
+  double low = lowerPercentile == 0. ? minVal : sketch.quantile(lowerPercentile / 100.);
+  double high = upperPercentile == 100. ? maxVal : sketch.quantile(upperPercentile / 100.);
+  return std::make_pair(low, high);
+}
+
+} // namespace
+
+ScalarStatistics computeScalarStatistics(const std::vector<float>& values, size_t nBins) {
+  ScalarStatistics stats;
+  size_t N = values.size();
+  stats.nValues = N;
+
+  // == Sweep 1: finiteness and range
+  size_t nChunks = parallelChunkCount(N);
+  std::vector<size_t> chunkNonFinite(nChunks, 0);
+  std::vector<float> chunkMin(nChunks, std::numeric_limits<float>::infinity());
+  std::vector<float> chunkMax(nChunks, -std::numeric_limits<float>::infinity());
+  parallelForChunks(N, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    size_t nNonFinite = 0;
+    float minVal = std::numeric_limits<float>::infinity();
+    float maxVal = -std::numeric_limits<float>::infinity();
+    for (size_t i = iStart; i < iEnd; i++) {
+      float v = values[i];
+      if (!std::isfinite(v)) {
+        nNonFinite++;
+        continue;
+      }
+      minVal = std::min(minVal, v);
+      maxVal = std::max(maxVal, v);
+    }
+    chunkNonFinite[iChunk] = nNonFinite;
+    chunkMin[iChunk] = minVal;
+    chunkMax[iChunk] = maxVal;
+  });
+  for (size_t iChunk = 0; iChunk < nChunks; iChunk++) {
+    stats.nNonFinite += chunkNonFinite[iChunk];
+  }
+  if (stats.nNonFinite < N) {
+    stats.minVal = *std::min_element(chunkMin.begin(), chunkMin.end());
+    stats.maxVal = *std::max_element(chunkMax.begin(), chunkMax.end());
+  }
+  stats.histogramRange = stats.robustRange(1e-12);
+
+  if (nBins == 0) return stats;
+
+  // == Sweep 2: bins
+  stats.histogramBinCounts.resize(nBins); // (sizes the bins for histogramBinOf(), counts are filled below)
+  std::vector<std::vector<size_t>> chunkBins(nChunks);
+  parallelForChunks(N, [&](size_t iChunk, size_t iStart, size_t iEnd) {
+    std::vector<size_t>& bins = chunkBins[iChunk];
+    bins.resize(nBins, 0);
+    for (size_t i = iStart; i < iEnd; i++) {
+      float v = values[i];
+      if (!std::isfinite(v)) continue;
+      bins[stats.histogramBinOf(v)]++;
+    }
+  });
+  mergeChunkBins(chunkBins, nBins, stats);
+
+  return stats;
+}
+
+ScalarStatistics computeScalarStatistics(const std::vector<uint8_t>& values, size_t nBins) {
+  return computeIntegerStatistics(values, nBins);
+}
+ScalarStatistics computeScalarStatistics(const std::vector<uint16_t>& values, size_t nBins) {
+  return computeIntegerStatistics(values, nBins);
+}
+ScalarStatistics computeScalarStatistics(const std::vector<int32_t>& values, size_t nBins) {
+  return computeIntegerStatistics(values, nBins);
+}
+
+void rebinScalarStatistics(ScalarStatistics& stats, const std::vector<float>& values, std::pair<double, double> range) {
+  rebinImpl(stats, values, range);
+}
+void rebinScalarStatistics(ScalarStatistics& stats, const std::vector<uint8_t>& values,
+                           std::pair<double, double> range) {
+  rebinImpl(stats, values, range);
+}
+void rebinScalarStatistics(ScalarStatistics& stats, const std::vector<uint16_t>& values,
+                           std::pair<double, double> range) {
+  rebinImpl(stats, values, range);
+}
+void rebinScalarStatistics(ScalarStatistics& stats, const std::vector<int32_t>& values,
+                           std::pair<double, double> range) {
+  rebinImpl(stats, values, range);
+}
+
+std::pair<double, double> computeScalarPercentiles(const std::vector<float>& values, double lowerPercentile,
+                                                   double upperPercentile) {
+  return percentilesImpl(values, lowerPercentile, upperPercentile);
+}
+std::pair<double, double> computeScalarPercentiles(const std::vector<uint8_t>& values, double lowerPercentile,
+                                                   double upperPercentile) {
+  return percentilesImpl(values, lowerPercentile, upperPercentile);
+}
+std::pair<double, double> computeScalarPercentiles(const std::vector<uint16_t>& values, double lowerPercentile,
+                                                   double upperPercentile) {
+  return percentilesImpl(values, lowerPercentile, upperPercentile);
+}
+std::pair<double, double> computeScalarPercentiles(const std::vector<int32_t>& values, double lowerPercentile,
+                                                   double upperPercentile) {
+  return percentilesImpl(values, lowerPercentile, upperPercentile);
+}
+
+} // namespace polyscope
@@ -3,6 +3,7 @@
 #include "polyscope/screenshot.h"
 
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 
 #include "stb_image_write.h"
 
@@ -40,6 +41,7 @@ bool hasExtension(std::string str, std::string ext) {
 // Helper to actually do the render pass and return the result in a buffer
 std::vector<unsigned char> getRenderInBuffer(const ScreenshotOptions& options = {}) {
   checkInitialized();
+  POLYSCOPE_PROFILE_SCOPE("screenshot");
 
   if (options.includeUI && internal::contextStackSize > 1) {
     error("Screenshot with includeUI=true is not supported within show(). See docs for details and workarounds.");
@@ -125,7 +127,11 @@ std::vector<unsigned char> getRenderInBuffer(const ScreenshotOptions& options =
   // these _should_ always be accurate
   int w = view::bufferWidth;
   int h = view::bufferHeight;
-  std::vector<unsigned char> buff = render::engine->displayBufferAlt->readBuffer();
+  std::vector<unsigned char> buff;
+  {
+    POLYSCOPE_PROFILE_SCOPE("screenshot readback");
+    buff = render::engine->displayBufferAlt->readBuffer();
+  }
 
   // Set alpha to 1
   if (!options.transparentBackground) {
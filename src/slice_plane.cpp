@@ -121,7 +121,8 @@ SlicePlane::SlicePlane(std::string name_)
       sliceBufferArr{{{nullptr, uniquePrefix() + "#slice1", sliceBufferDataArr[0]},
                       {nullptr, uniquePrefix() + "#slice2", sliceBufferDataArr[1]},
                       {nullptr, uniquePrefix() + "#slice3", sliceBufferDataArr[2]},
-                      {nullptr, uniquePrefix() + "#slice4", sliceBufferDataArr[3]}}}
+                      {nullptr, uniquePrefix() + "#slice4", sliceBufferDataArr[3]}}},
+      sliceNormalUniform("u_slicePlaneNormal_" + postfix), sliceCenterUniform("u_slicePlaneCenter_" + postfix)
 
 {
   render::engine->addSlicePlane(postfix);
@@ -386,7 +387,8 @@ void SlicePlane::buildGUI() {
 }
 
 void SlicePlane::setSceneObjectUniforms(render::ShaderProgram& p, bool alwaysPass) {
-  if (!p.hasUniform("u_slicePlaneNormal_" + postfix)) {
+  render::UniformHandle normalHandle = p.findUniform(sliceNormalUniform);
+  if (!normalHandle.isValid()) {
     return;
   }
 
@@ -401,8 +403,8 @@ void SlicePlane::setSceneObjectUniforms(render::ShaderProgram& p, bool alwaysPas
     center = glm::vec3(viewMat * glm::vec4(getCenter(), 1.));
   }
 
-  p.setUniform("u_slicePlaneNormal_" + postfix, normal);
-  p.setUniform("u_slicePlaneCenter_" + postfix, center);
+  p.setUniform(normalHandle, normal);
+  p.setUniform(p.findUniform(sliceCenterUniform), center);
 }
 
 glm::vec3 SlicePlane::getCenter() {
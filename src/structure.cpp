@@ -142,6 +142,11 @@ void Structure::buildUI() {
     // Do any structure-specific stuff here
     this->buildCustomUI();
 
+    // Playback controls, if animated
+    if (hasTimeSeries()) {
+      timeSeries->buildUI();
+    }
+
     // Build quantities list, in the common case of a Structure
     this->buildQuantitiesUI();
 
@@ -203,6 +208,46 @@ float Structure::lengthScale() {
   return transScale * objectSpaceLengthScale;
 }
 
+void Structure::growObjectSpaceBounds(const std::vector<glm::vec3>& newPoints) {
+
+  glm::vec3 oldMin = std::get<0>(objectSpaceBoundingBox);
+  glm::vec3 oldMax = std::get<1>(objectSpaceBoundingBox);
+  glm::vec3 min = oldMin;
+  glm::vec3 max = oldMax;
+  for (const glm::vec3& p : newPoints) {
+    min = componentwiseMin(min, p);
+    max = componentwiseMax(max, p);
+  }
+  objectSpaceBoundingBox = std::make_tuple(min, max);
+
+  // The existing points are within the old radius of the old center, so they are within (old radius + shift) of the
+  // new center. That bound is also clamped to the half-diagonal of the new bounding box, which contains every point.
+  glm::vec3 oldCenter = 0.5f * (oldMin + oldMax);
+  glm::vec3 center = 0.5f * (min + max);
+  float radius = 0.5f * objectSpaceLengthScale + glm::length(center - oldCenter);
+  radius = std::min(radius, 0.5f * glm::length(max - min));
+  float radius2 = radius * radius;
+  for (const glm::vec3& p : newPoints) {
+    radius2 = std::max(radius2, glm::length2(p - center));
+  }
+  objectSpaceLengthScale = 2 * std::sqrt(radius2);
+}
+
+TimeSeries& Structure::getTimeSeries() {
+  if (!timeSeries) {
+    timeSeries.reset(new TimeSeries());
+  }
+  return *timeSeries;
+}
+
+bool Structure::hasTimeSeries() { return timeSeries && timeSeries->nFrames() > 0; }
+
+void Structure::updateTimeSeries() {
+  if (timeSeries) {
+    timeSeries->update();
+  }
+}
+
 void Structure::setTransform(glm::mat4x4 transform) {
   objectTransform = transform;
   updateStructureExtents();
@@ -251,6 +296,114 @@ void Structure::rescaleToUnit() {
 
 bool Structure::hasExtents() { return true; }
 
+bool Structure::mayBeInView() {
+  if (!options::frustumCulling || !hasExtents()) return true;
+  float margin = frustumCullingMargin();
+  if (margin < 0.) return true;
+  return boxMayBeInView(objectSpaceBoundingBox, margin);
+}
+
+bool Structure::boxMayBeInView(const std::tuple<glm::vec3, glm::vec3>& objectSpaceBox, float margin) {
+  glm::vec3 boxMin = std::get<0>(objectSpaceBox);
+  glm::vec3 boxMax = std::get<1>(objectSpaceBox);
+  const glm::mat4x4& T = objectTransform.get();
+
+  if (margin > 0.) {
+    // pad the box in object space, by the margin under the smallest scaling of the transform
+    glm::mat3x3 T3(T);
+    float minScale = std::min(std::min(glm::length(T3[0]), glm::length(T3[1])), glm::length(T3[2])) / T[3][3];
+    if (!(minScale > 0.)) return true;
+    glm::vec3 pad = glm::vec3(margin / minScale);
+    boxMin -= pad;
+    boxMax += pad;
+  }
+
+  return view::boxMayBeVisible(T, boxMin, boxMax);
+}
+
+float Structure::frustumCullingMargin() {
+  for (auto& x : quantities) {
+    if (x.second->isEnabled() && !x.second->isDrawnWithinParentBounds()) return -1.;
+  }
+  for (auto& x : floatingQuantities) {
+    if (x.second->isEnabled() && !x.second->isDrawnWithinParentBounds()) return -1.;
+  }
+  return 0.;
+}
+
+const size_t Structure::cullingChunkSize = 1 << 14;
+
+void Structure::updateVisibleChunks(uint32_t verticesPerElement, bool countStats) {
+  allChunksVisible = true;
+  visibleChunkRanges.clear();
+  if (cullingChunkBounds.size() < 2 || !options::frustumCulling) return;
+  float margin = frustumCullingMargin();
+  if (margin < 0.) return;
+
+  CullingStats& stats = state::globalContext.cullingStats;
+  uint32_t chunkVerts = static_cast<uint32_t>(cullingChunkSize) * verticesPerElement;
+  for (size_t iChunk = 0; iChunk < cullingChunkBounds.size(); iChunk++) {
+    if (!boxMayBeInView(cullingChunkBounds[iChunk], margin)) {
+      allChunksVisible = false;
+      if (countStats) stats.nChunksCulled++;
+      continue;
+    }
+    if (countStats) stats.nChunksDrawn++;
+
+    // the last range is clamped to the number of vertices when drawn
+    uint32_t start = static_cast<uint32_t>(iChunk) * chunkVerts;
+    if (!visibleChunkRanges.empty() &&
+        visibleChunkRanges.back().start + visibleChunkRanges.back().count == start) {
+      visibleChunkRanges.back().count += chunkVerts;
+    } else {
+      visibleChunkRanges.push_back(render::DrawRange{start, chunkVerts});
+    }
+  }
+}
+
+void Structure::applyChunkCulling(render::ShaderProgram& p) {
+  if (allChunksVisible) {
+    p.clearDrawRanges();
+  } else {
+    p.setDrawRanges(visibleChunkRanges);
+  }
+}
+
+std::vector<std::array<glm::vec3, 4>> Structure::packInstanceTransforms(const std::vector<glm::mat4>& transforms) {
+  std::vector<std::array<glm::vec3, 4>> packed(transforms.size());
+  for (size_t iInst = 0; iInst < transforms.size(); iInst++) {
+    const glm::mat4& T = transforms[iInst];
+    if (T[0][3] != 0. || T[1][3] != 0. || T[2][3] != 0. || T[3][3] != 1.) {
+      exception("instance transform " + std::to_string(iInst) + " of structure [" + name +
+                "] is not affine, its last row must be (0, 0, 0, 1)");
+    }
+    for (int iCol = 0; iCol < 4; iCol++) {
+      packed[iInst][iCol] = glm::vec3(T[iCol]);
+    }
+  }
+  return packed;
+}
+
+void Structure::applyInstancesToObjectSpaceBounds(const std::vector<std::array<glm::vec3, 4>>& instances) {
+  if (instances.empty()) return;
+
+  glm::vec3 boxMin = std::get<0>(objectSpaceBoundingBox);
+  glm::vec3 boxMax = std::get<1>(objectSpaceBoundingBox);
+  glm::vec3 newMin = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
+  glm::vec3 newMax = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
+  for (const std::array<glm::vec3, 4>& inst : instances) {
+    for (int iCorner = 0; iCorner < 8; iCorner++) {
+      glm::vec3 c{(iCorner & 1) ? boxMax.x : boxMin.x, (iCorner & 2) ? boxMax.y : boxMin.y,
+                  (iCorner & 4) ? boxMax.z : boxMin.z};
+      glm::vec3 p = c.x * inst[0] + c.y * inst[1] + c.z * inst[2] + inst[3];
+      newMin = componentwiseMin(newMin, p);
+      newMax = componentwiseMax(newMax, p);
+    }
+  }
+  objectSpaceBoundingBox = std::make_tuple(newMin, newMax);
+  objectSpaceLengthScale = glm::length(newMax - newMin);
+}
+
 glm::mat4 Structure::getModelView() { return view::getCameraViewMatrix() * objectTransform.get(); }
 
 std::vector<std::string> Structure::addStructureRules(std::vector<std::string> initRules) {
@@ -264,26 +417,40 @@ std::vector<std::string> Structure::addStructureRules(std::vector<std::string> i
   return initRules;
 }
 
+namespace {
+// Set on every structure program every frame, so their handles are cached by each program
+const render::UniformName uModelView("u_modelView");
+const render::UniformName uProjMatrix("u_projMatrix");
+const render::UniformName uTransparency("u_transparency");
+const render::UniformName uViewportDim("u_viewportDim");
+const render::UniformName uViewportViewPos("u_viewport_viewPos");
+const render::UniformName uInvProjMatrixViewPos("u_invProjMatrix_viewPos");
+} // namespace
+
 void Structure::setStructureUniforms(render::ShaderProgram& p) {
-  if (p.hasUniform("u_modelView")) {
+  render::UniformHandle modelViewHandle = p.findUniform(uModelView);
+  if (modelViewHandle.isValid()) {
     glm::mat4 viewMat = getModelView();
-    p.setUniform("u_modelView", glm::value_ptr(viewMat));
+    p.setUniform(modelViewHandle, glm::value_ptr(viewMat));
   }
 
-  if (p.hasUniform("u_projMatrix")) {
+  render::UniformHandle projMatrixHandle = p.findUniform(uProjMatrix);
+  if (projMatrixHandle.isValid()) {
     glm::mat4 projMat = view::getCameraPerspectiveMatrix();
-    p.setUniform("u_projMatrix", glm::value_ptr(projMat));
+    p.setUniform(projMatrixHandle, glm::value_ptr(projMat));
   }
 
   if (render::engine->transparencyEnabled()) {
-    if (p.hasUniform("u_transparency")) {
-      p.setUniform("u_transparency", transparency.get());
+    render::UniformHandle transparencyHandle = p.findUniform(uTransparency);
+    if (transparencyHandle.isValid()) {
+      p.setUniform(transparencyHandle, transparency.get());
     }
 
-    if (p.hasUniform("u_viewportDim")) {
+    render::UniformHandle viewportDimHandle = p.findUniform(uViewportDim);
+    if (viewportDimHandle.isValid()) {
       glm::vec4 viewport = render::engine->getCurrentViewport();
       glm::vec2 viewportDim{viewport[2], viewport[3]};
-      p.setUniform("u_viewportDim", viewportDim);
+      p.setUniform(viewportDimHandle, viewportDim);
     }
 
     // Attach the min depth texture, if needed
@@ -302,14 +469,16 @@ void Structure::setStructureUniforms(render::ShaderProgram& p) {
 
   // TODO this chain if "if"s is not great. Set up some system in the render engine to conditionally set these? Maybe
   // a list of lambdas? Ugh.
-  if (p.hasUniform("u_viewport_viewPos")) {
+  render::UniformHandle viewportViewPosHandle = p.findUniform(uViewportViewPos);
+  if (viewportViewPosHandle.isValid()) {
     glm::vec4 viewport = render::engine->getCurrentViewport();
-    p.setUniform("u_viewport_viewPos", viewport);
+    p.setUniform(viewportViewPosHandle, viewport);
   }
-  if (p.hasUniform("u_invProjMatrix_viewPos")) {
+  render::UniformHandle invProjMatrixViewPosHandle = p.findUniform(uInvProjMatrixViewPos);
+  if (invProjMatrixViewPosHandle.isValid()) {
     glm::mat4 P = view::getCameraPerspectiveMatrix();
     glm::mat4 Pinv = glm::inverse(P);
-    p.setUniform("u_invProjMatrix_viewPos", glm::value_ptr(Pinv));
+    p.setUniform(invProjMatrixViewPosHandle, glm::value_ptr(Pinv));
   }
 }
 
@@ -424,6 +593,11 @@ void Structure::removeQuantity(std::string name, bool errorIfAbsent) {
     return;
   }
 
+  // stop animating the quantity, if it was loaded from a time series
+  if (timeSeries && (quantityExists || floatingQuantityExists)) {
+    timeSeries->removeTrack(quantityTrackName(name));
+  }
+
   // delete standard quantities
   if (quantityExists) {
     // If this is the active quantity, clear it
@@ -433,11 +607,13 @@ void Structure::removeQuantity(std::string name, bool errorIfAbsent) {
     }
 
     // Delete the quantity
+    pick::releasePickBufferRange(&q);
     quantities.erase(name);
   }
 
   // delete floating quantities
   if (floatingQuantityExists) {
+    pick::releasePickBufferRange(floatingQuantities[name].get());
     floatingQuantities.erase(name);
   }
 }
@@ -6,6 +6,7 @@
 #include "polyscope/elementary_geometry.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 
 #include "imgui.h"
@@ -55,6 +56,10 @@ vertexAreas(            this, uniquePrefix() + "vertexAreas",         vertexArea
 defaultFaceTangentBasisX(   this, uniquePrefix() + "defaultFaceTangentBasisX",  defaultFaceTangentBasisXData,  std::bind(&SurfaceMesh::computeDefaultFaceTangentBasisX, this)),
 defaultFaceTangentBasisY(   this, uniquePrefix() + "defaultFaceTangentBasisY",  defaultFaceTangentBasisYData,  std::bind(&SurfaceMesh::computeDefaultFaceTangentBasisY, this)),
 
+// instancing
+instanceTransforms(     this, uniquePrefix() + "instanceTransforms",  instanceTransformsData),
+instanceColors(         this, uniquePrefix() + "instanceColors",      instanceColorsData),
+
 // == persistent options
 surfaceColor(           uniquePrefix() + "surfaceColor",    getNextUniqueColor()),
 edgeColor(              uniquePrefix() + "edgeColor",       glm::vec3{0., 0., 0.}), material(uniquePrefix() + "material", "clay"),
@@ -722,11 +727,24 @@ void SurfaceMesh::ensureHaveManifoldConnectivity() {
   }
 }
 
+namespace {
+// Set every frame, so their handles are cached by each program
+const render::UniformName uEdgeWidth("u_edgeWidth");
+const render::UniformName uEdgeColor("u_edgeColor");
+const render::UniformName uBackfaceColor("u_backfaceColor");
+const render::UniformName uInvProjMatrix("u_invProjMatrix");
+const render::UniformName uViewport("u_viewport");
+const render::UniformName uBaseColor("u_baseColor");
+} // namespace
+
 void SurfaceMesh::draw() {
   if (!isEnabled()) {
     return;
   }
 
+  ensureCullingChunkBoundsComputed();
+  updateVisibleChunks(3);
+
   render::engine->setBackfaceCull(backFacePolicy.get() == BackFacePolicy::Cull);
 
   // If no quantity is drawing the surface, we should draw it
@@ -742,7 +760,7 @@ void SurfaceMesh::draw() {
     // Set uniforms
     setStructureUniforms(*program);
     setSurfaceMeshUniforms(*program);
-    program->setUniform("u_baseColor", getSurfaceColor());
+    program->setUniform(program->findUniform(uBaseColor), getSurfaceColor());
     render::engine->setMaterialUniforms(*program, getMaterial());
 
     program->draw();
@@ -783,6 +801,9 @@ void SurfaceMesh::drawPick() {
     return;
   }
 
+  ensureCullingChunkBoundsComputed();
+  updateVisibleChunks(3, false);
+
   if (pickProgram == nullptr) {
     preparePick();
   }
@@ -807,6 +828,8 @@ void SurfaceMesh::drawPick() {
     }
     pickProgram->setUniform("u_vertPickRadius", radVal);
   }
+  applyChunkCulling(*pickProgram);
+  pickProgram->setInstanceCount(isInstanced() ? nInstances() : INVALID_IND_32);
 
   pickProgram->draw();
 
@@ -835,20 +858,39 @@ void SurfaceMesh::drawPickDelayed() {
 }
 
 void SurfaceMesh::prepare() {
+  POLYSCOPE_PROFILE_SCOPE("prepare");
+  bool useInstanceColors = !instanceColors.data.empty();
+
   // clang-format off
   program = render::engine->requestShader( "MESH", 
       render::engine->addMaterialRules(getMaterial(),
-        addSurfaceMeshRules({"SHADE_BASECOLOR"})
+        addSurfaceMeshRules(useInstanceColors ? std::vector<std::string>{"MESH_PROPAGATE_INSTANCE_COLOR", "SHADE_COLOR"} : 
+                                                std::vector<std::string>{"SHADE_BASECOLOR"})
       )
   );
   // clang-format on
 
   // Populate draw buffers
   setMeshGeometryAttributes(*program);
+  if (useInstanceColors) {
+    program->setAttribute("a_instanceColor", instanceColors.getRenderAttributeBuffer());
+  }
   render::engine->setMaterial(*program, getMaterial());
 }
 
 void SurfaceMesh::preparePick() {
+  POLYSCOPE_PROFILE_SCOPE("prepare pick");
+
+  if (isInstanced()) {
+    // the whole of each instance is picked as one, so there is no need for per-element pick data
+    usingSimplePick = false;
+    pickProgram =
+        render::engine->requestShader("MESH", addSurfaceMeshRules({"MESH_PROPAGATE_INSTANCE_COLOR"}, true, false),
+                                      render::ShaderReplacementDefaults::Pick);
+    setMeshGeometryAttributes(*pickProgram);
+    setMeshInstancePickAttributes(*pickProgram);
+    return;
+  }
 
   switch (selectionMode.get()) {
   case MeshSelectionMode::Auto:
@@ -902,6 +944,9 @@ void SurfaceMesh::setMeshGeometryAttributes(render::ShaderProgram& p) {
   if (wantsCullPosition()) {
     p.setAttribute("a_cullPos", faceCenters.getIndexedRenderAttributeBuffer(triangleFaceInds));
   }
+  if (isInstanced()) {
+    p.setAttribute("a_instanceTransform", instanceTransforms.getRenderAttributeBuffer());
+  }
 
   if (transparencyQuantityName != "") {
     SurfaceScalarQuantity& transparencyQ = resolveTransparencyQuantity();
@@ -1048,6 +1093,15 @@ void SurfaceMesh::setMeshPickAttributes(render::ShaderProgram& p) {
   }
 }
 
+void SurfaceMesh::setMeshInstancePickAttributes(render::ShaderProgram& p) {
+  size_t pickStart = pick::requestPickBufferRange(this, nInstances());
+  std::vector<glm::vec3> instancePickColors(nInstances());
+  for (size_t iInst = 0; iInst < nInstances(); iInst++) {
+    instancePickColors[iInst] = pick::indToVec(pickStart + iInst);
+  }
+  p.setAttribute("a_instanceColor", instancePickColors);
+}
+
 
 std::vector<std::string> SurfaceMesh::addSurfaceMeshRules(std::vector<std::string> initRules, bool withMesh,
                                                           bool withSurfaceShade) {
@@ -1094,24 +1148,30 @@ std::vector<std::string> SurfaceMesh::addSurfaceMeshRules(std::vector<std::strin
     if (transparencyQuantityName != "") {
       initRules.push_back("MESH_PROPAGATE_VALUEALPHA");
     }
+
+    if (isInstanced()) {
+      initRules.push_back("INSTANCE_TRANSFORM");
+    }
   }
   return initRules;
 }
 
 void SurfaceMesh::setSurfaceMeshUniforms(render::ShaderProgram& p) {
   if (getEdgeWidth() > 0) {
-    p.setUniform("u_edgeWidth", getEdgeWidth() * render::engine->getCurrentPixelScaling());
-    p.setUniform("u_edgeColor", getEdgeColor());
+    p.setUniform(p.findUniform(uEdgeWidth), getEdgeWidth() * render::engine->getCurrentPixelScaling());
+    p.setUniform(p.findUniform(uEdgeColor), getEdgeColor());
   }
   if (backFacePolicy.get() == BackFacePolicy::Custom) {
-    p.setUniform("u_backfaceColor", getBackFaceColor());
+    p.setUniform(p.findUniform(uBackfaceColor), getBackFaceColor());
   }
   if (shadeStyle.get() == MeshShadeStyle::TriFlat) {
     glm::mat4 P = view::getCameraPerspectiveMatrix();
     glm::mat4 Pinv = glm::inverse(P);
-    p.setUniform("u_invProjMatrix", glm::value_ptr(Pinv));
-    p.setUniform("u_viewport", render::engine->getCurrentViewport());
+    p.setUniform(p.findUniform(uInvProjMatrix), glm::value_ptr(Pinv));
+    p.setUniform(p.findUniform(uViewport), render::engine->getCurrentViewport());
   }
+  applyChunkCulling(p);
+  p.setInstanceCount(isInstanced() ? nInstances() : INVALID_IND_32);
 }
 
 
@@ -1119,6 +1179,11 @@ void SurfaceMesh::buildPickUI(const PickResult& rawResult) {
 
   SurfaceMeshPickResult result = interpretPickResult(rawResult);
 
+  if (result.instanceIndex >= 0) {
+    ImGui::TextUnformatted(("instance #" + std::to_string(result.instanceIndex)).c_str());
+    return;
+  }
+
   switch (result.elementType) {
   case MeshElement::VERTEX: {
     buildVertexInfoGui(result);
@@ -1498,6 +1563,42 @@ void SurfaceMesh::updateObjectSpaceBounds() {
     lengthScale = std::max(lengthScale, glm::length2(p - center));
   }
   objectSpaceLengthScale = 2 * std::sqrt(lengthScale);
+
+  // the culling chunks are only needed if culling is on, they are computed before the next draw
+  cullingChunkBounds.clear();
+  cullingChunkBoundsStale = true;
+
+  if (isInstanced()) {
+    applyInstancesToObjectSpaceBounds(instanceTransforms.data);
+  }
+}
+
+void SurfaceMesh::ensureCullingChunkBoundsComputed() {
+  if (!cullingChunkBoundsStale || !options::frustumCulling) return;
+  cullingChunkBoundsStale = false;
+
+  // instanced draws are never split in to chunks
+  if (isInstanced()) return;
+
+  // culling chunks, over the triangles of the triangulated faces in the order they are drawn
+  vertexPositions.ensureHostBufferPopulated();
+  triangleVertexInds.ensureHostBufferPopulated();
+  const std::vector<uint32_t>& triInds = triangleVertexInds.data;
+  size_t nTris = triInds.size() / 3;
+  size_t nChunks = (nTris + cullingChunkSize - 1) / cullingChunkSize;
+  if (nChunks < 2) return;
+  cullingChunkBounds.resize(nChunks);
+  for (size_t iChunk = 0; iChunk < nChunks; iChunk++) {
+    glm::vec3 chunkMin = glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
+    glm::vec3 chunkMax = -glm::vec3{1, 1, 1} * std::numeric_limits<float>::infinity();
+    size_t iEnd = 3 * std::min((iChunk + 1) * cullingChunkSize, nTris);
+    for (size_t i = 3 * iChunk * cullingChunkSize; i < iEnd; i++) {
+      const glm::vec3& p = vertexPositions.data[triInds[i]];
+      chunkMin = componentwiseMin(chunkMin, p);
+      chunkMax = componentwiseMax(chunkMax, p);
+    }
+    cullingChunkBounds[iChunk] = std::make_tuple(chunkMin, chunkMax);
+  }
 }
 
 std::string SurfaceMesh::typeName() { return structureTypeName; }
@@ -1512,6 +1613,14 @@ SurfaceMeshPickResult SurfaceMesh::interpretPickResult(const PickResult& rawResu
 
   SurfaceMeshPickResult result;
 
+  if (isInstanced()) {
+    if (rawResult.localIndex >= nInstances()) exception("Bad pick index in surface mesh");
+    result.elementType = MeshElement::FACE;
+    result.index = -1;
+    result.instanceIndex = rawResult.localIndex;
+    return result;
+  }
+
   if (rawResult.localIndex < facePickIndStart) {
     // Vertex pick
     result.elementType = MeshElement::VERTEX;
@@ -1567,6 +1676,41 @@ SurfaceMeshPickResult SurfaceMesh::interpretPickResult(const PickResult& rawResu
   return result;
 }
 
+SurfaceMeshPickRegionResult SurfaceMesh::interpretPickRegionResult(const PickRegionResult& rawResult) {
+
+  if (rawResult.structure != this) {
+    exception("called interpretPickRegionResult(), but the pick result is not from this structure");
+  }
+
+  // The local indices are sorted, and the element ranges are laid out in order, so each list comes out sorted too
+  SurfaceMeshPickRegionResult result;
+  if (isInstanced()) {
+    for (uint64_t localInd : rawResult.localIndices) {
+      if (localInd >= nInstances()) exception("Bad pick index in surface mesh");
+      result.instances.push_back(localInd);
+    }
+    return result;
+  }
+
+  for (uint64_t localInd : rawResult.localIndices) {
+    if (localInd < facePickIndStart) {
+      result.vertices.push_back(localInd);
+    } else if (localInd < edgePickIndStart) {
+      result.faces.push_back(localInd - facePickIndStart);
+    } else if (localInd < halfedgePickIndStart) {
+      result.edges.push_back(localInd - edgePickIndStart);
+    } else if (localInd < cornerPickIndStart) {
+      result.halfedges.push_back(localInd - halfedgePickIndStart);
+    } else if (localInd < cornerPickIndStart + nCorners()) {
+      result.corners.push_back(localInd - cornerPickIndStart);
+    } else {
+      exception("Bad pick index in surface mesh");
+    }
+  }
+
+  return result;
+}
+
 long long int SurfaceMesh::selectVertex() {
 
   // Make sure we can see edges
@@ -1668,6 +1812,42 @@ void SurfaceMesh::clearTransparencyQuantity() {
   refresh();
 }
 
+void SurfaceMesh::setInstances(const std::vector<glm::mat4>& transforms) {
+  if (transforms.empty()) exception("surface mesh [" + name + "] needs at least one instance, use clearInstances()");
+  bool sameCount = transforms.size() == nInstances();
+
+  instanceTransforms.data = packInstanceTransforms(transforms);
+  instanceTransforms.markHostBufferUpdated();
+
+  if (sameCount) {
+    // the programs are unchanged, only the transforms need uploading
+    updateObjectSpaceBounds();
+    requestRedraw();
+    return;
+  }
+
+  instanceColors.data.clear(); // no longer one per instance
+  refresh();
+}
+
+void SurfaceMesh::clearInstances() {
+  if (!isInstanced()) return;
+  instanceTransforms.data.clear();
+  instanceColors.data.clear();
+  refresh();
+}
+
+bool SurfaceMesh::isInstanced() { return !instanceTransforms.data.empty(); }
+
+size_t SurfaceMesh::nInstances() { return instanceTransforms.data.size(); }
+
+void SurfaceMesh::clearInstanceColors() {
+  if (instanceColors.data.empty()) return;
+  instanceColors.data.clear();
+  program.reset();
+  requestRedraw();
+}
+
 SurfaceScalarQuantity& SurfaceMesh::resolveTransparencyQuantity() {
   SurfaceScalarQuantity* transparencyScalarQ = nullptr;
   SurfaceMeshQuantity* anyQ = getStructureQuantity<SurfaceMeshQuantity>(transparencyQuantityName);
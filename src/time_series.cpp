@@ -0,0 +1,168 @@
+// Copyright 2017-2023, Nicholas Sharp and the Polyscope contributors. https://polyscope.run
+
+#include "polyscope/time_series.h"
+
+#include "polyscope/polyscope.h"
+
+#include "imgui.h"
+
+#include <algorithm>
+
+namespace polyscope {
+
+TimeSeriesTrack::TimeSeriesTrack(std::string name_, size_t nFrames_) : name(name_), nFrames(nFrames_) {}
+
+TimeSeriesTrack::~TimeSeriesTrack() {}
+
+std::string quantityTrackName(std::string quantityName) { return "quantity: " + quantityName; }
+
+TimeSeries::TimeSeries() : lastAdvanceTime(std::chrono::steady_clock::now()) {}
+
+TimeSeries::~TimeSeries() {}
+
+void TimeSeries::addTrack(std::unique_ptr<TimeSeriesTrack> track) {
+  if (track->nFrames == 0) exception("time series track [" + track->name + "] has no frames");
+
+  removeTrack(track->name);
+  tracks.push_back(std::move(track));
+
+  TimeSeriesTrack& newTrack = *tracks.back();
+  newTrack.setFrame(std::min(currentFrame, newTrack.nFrames - 1));
+  prefetchAhead();
+}
+
+void TimeSeries::removeTrack(std::string name) {
+  tracks.erase(std::remove_if(tracks.begin(), tracks.end(),
+                              [&](const std::unique_ptr<TimeSeriesTrack>& t) -> bool { return t->name == name; }),
+               tracks.end());
+  if (tracks.empty()) {
+    currentFrame = 0;
+    playing = false;
+  }
+}
+
+bool TimeSeries::hasTrack(std::string name) {
+  for (std::unique_ptr<TimeSeriesTrack>& t : tracks) {
+    if (t->name == name) return true;
+  }
+  return false;
+}
+
+size_t TimeSeries::nFrames() {
+  size_t n = 0;
+  for (std::unique_ptr<TimeSeriesTrack>& t : tracks) {
+    n = std::max(n, t->nFrames);
+  }
+  return n;
+}
+
+void TimeSeries::setFrame(size_t iFrame) {
+  size_t n = nFrames();
+  if (n == 0) return;
+  currentFrame = std::min(iFrame, n - 1);
+
+  for (std::unique_ptr<TimeSeriesTrack>& t : tracks) {
+    t->setFrame(std::min(currentFrame, t->nFrames - 1));
+  }
+  prefetchAhead();
+  requestRedraw();
+}
+
+size_t TimeSeries::getFrame() { return currentFrame; }
+
+void TimeSeries::prefetchAhead() {
+  size_t n = nFrames();
+  for (std::unique_ptr<TimeSeriesTrack>& t : tracks) {
+    // the current frame occupies one slot of the ring, fill the rest with the frames that follow
+    for (size_t iAhead = 1; iAhead < t->ringSize(); iAhead++) {
+      size_t iFrame = currentFrame + iAhead;
+      if (iFrame >= n) {
+        if (!loop) break;
+        iFrame = iFrame % n;
+      }
+      if (iFrame >= t->nFrames) continue; // past the end of a short track, it holds its last frame
+      t->prefetch(iFrame);
+    }
+  }
+}
+
+void TimeSeries::setPlaying(bool newVal) {
+  playing = newVal;
+  lastAdvanceTime = std::chrono::steady_clock::now();
+  requestRedraw();
+}
+bool TimeSeries::getPlaying() { return playing; }
+
+void TimeSeries::setFramesPerSecond(float newVal) {
+  if (!(newVal > 0.)) exception("time series frames per second must be positive");
+  framesPerSecond = newVal;
+}
+float TimeSeries::getFramesPerSecond() { return framesPerSecond; }
+
+void TimeSeries::setLoop(bool newVal) {
+  loop = newVal;
+  prefetchAhead();
+}
+bool TimeSeries::getLoop() { return loop; }
+
+void TimeSeries::update() {
+  if (!playing) return;
+
+  size_t n = nFrames();
+  if (n == 0) {
+    playing = false;
+    return;
+  }
+
+  std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+  std::chrono::duration<float> frameDuration(1. / framesPerSecond);
+  if (now - lastAdvanceTime < frameDuration) return;
+
+  // Advance at most one frame per iteration; if we fell behind, don't try to catch up
+  if (now - lastAdvanceTime < 2 * frameDuration) {
+    lastAdvanceTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(frameDuration);
+  } else {
+    lastAdvanceTime = now;
+  }
+
+  if (currentFrame + 1 < n) {
+    setFrame(currentFrame + 1);
+  } else if (loop) {
+    setFrame(0);
+  } else {
+    playing = false;
+  }
+}
+
+void TimeSeries::buildUI() {
+  size_t n = nFrames();
+  if (n == 0) return;
+
+  ImGui::PushID("time series");
+
+  if (ImGui::Button(playing ? "Pause" : "Play")) {
+    setPlaying(!playing);
+  }
+  ImGui::SameLine();
+
+  ImGui::PushItemWidth(150);
+  int frame = static_cast<int>(currentFrame);
+  if (ImGui::SliderInt("frame", &frame, 0, static_cast<int>(n - 1))) {
+    setFrame(static_cast<size_t>(frame));
+  }
+  ImGui::PopItemWidth();
+
+  ImGui::PushItemWidth(75);
+  if (ImGui::InputFloat("fps", &framesPerSecond, 0, 0, "%.1f")) {
+    framesPerSecond = std::max(framesPerSecond, 0.1f);
+  }
+  ImGui::PopItemWidth();
+  ImGui::SameLine();
+  if (ImGui::Checkbox("loop", &loop)) {
+    setLoop(loop);
+  }
+
+  ImGui::PopID();
+}
+
+} // namespace polyscope
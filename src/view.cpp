@@ -10,6 +10,8 @@
 #include "nlohmann/json.hpp"
 using json = nlohmann::json;
 
+#include <cmath>
+
 namespace polyscope {
 namespace view {
 
@@ -803,6 +805,32 @@ glm::vec3 getLookVec() {
   return Rt * glm::vec3(0.0, 0.0, -1.0);
 }
 
+bool boxMayBeVisible(const glm::mat4& objectTransform, glm::vec3 boxMin, glm::vec3 boxMax) {
+  for (int j = 0; j < 3; j++) {
+    if (!std::isfinite(boxMin[j]) || !std::isfinite(boxMax[j]) || boxMin[j] > boxMax[j]) return true;
+  }
+
+  glm::mat4 viewProj = getCameraPerspectiveMatrix() * viewMat * objectTransform;
+  std::array<glm::vec4, 8> corners;
+  for (int i = 0; i < 8; i++) {
+    glm::vec3 c{(i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z};
+    corners[i] = viewProj * glm::vec4(c, 1.);
+  }
+
+  // In clip space the view volume is -w <= x,y,z <= w. Testing against these planes before dividing by w stays
+  // correct for corners behind the camera.
+  for (int j = 0; j < 3; j++) {
+    bool allBelow = true;
+    bool allAbove = true;
+    for (const glm::vec4& c : corners) {
+      allBelow = allBelow && c[j] < -c.w;
+      allAbove = allAbove && c[j] > c.w;
+    }
+    if (allBelow || allAbove) return false;
+  }
+  return true;
+}
+
 glm::vec3 screenCoordsToWorldRay(glm::vec2 screenCoords) {
 
   glm::mat4 view = getCameraViewMatrix();
@@ -845,7 +873,9 @@ std::tuple<float, float> computeClipPlanes() {
   return std::make_tuple(absNearClip, absFarClip);
 }
 
-glm::vec3 screenCoordsAndDepthToWorldPosition(glm::vec2 screenCoords, float clipDepth) {
+namespace {
+glm::vec3 unprojectScreenCoords(glm::vec2 screenCoords, float clipDepth, const glm::mat4& viewInv,
+                                const glm::mat4& projInv) {
 
   if (clipDepth == 1.) {
     // if we didn't hit anything in the depth buffer, just return infinity
@@ -853,11 +883,6 @@ glm::vec3 screenCoordsAndDepthToWorldPosition(glm::vec2 screenCoords, float clip
     return glm::vec3{inf, inf, inf};
   }
 
-
-  glm::mat4 view = getCameraViewMatrix();
-  glm::mat4 viewInv = glm::inverse(view);
-  glm::mat4 proj = getCameraPerspectiveMatrix();
-  glm::mat4 projInv = glm::inverse(proj);
   // glm::vec2 depthRange = {0., 1.}; // no support for nonstandard depth range, currently
 
   // convert depth to world units
@@ -873,6 +898,34 @@ glm::vec3 screenCoordsAndDepthToWorldPosition(glm::vec2 screenCoords, float clip
 
   return glm::vec3(worldPos);
 }
+} // namespace
+
+glm::vec3 screenCoordsAndDepthToWorldPosition(glm::vec2 screenCoords, float clipDepth) {
+  glm::mat4 viewInv = glm::inverse(getCameraViewMatrix());
+  glm::mat4 projInv = glm::inverse(getCameraPerspectiveMatrix());
+  return unprojectScreenCoords(screenCoords, clipDepth, viewInv, projInv);
+}
+
+glm::vec3 screenCoordsAndDepthToWorldPosition(glm::vec2 screenCoords, float clipDepth, const glm::mat4& viewMat,
+                                              const glm::mat4& projMat) {
+  return unprojectScreenCoords(screenCoords, clipDepth, glm::inverse(viewMat), glm::inverse(projMat));
+}
+
+std::vector<glm::vec3> screenCoordsAndDepthToWorldPosition(const std::vector<glm::vec2>& screenCoords,
+                                                           const std::vector<float>& clipDepths) {
+  if (screenCoords.size() != clipDepths.size()) {
+    exception("screenCoordsAndDepthToWorldPosition(): got " + std::to_string(screenCoords.size()) +
+              " coordinates but " + std::to_string(clipDepths.size()) + " depths");
+  }
+
+  glm::mat4 viewInv = glm::inverse(getCameraViewMatrix());
+  glm::mat4 projInv = glm::inverse(getCameraPerspectiveMatrix());
+  std::vector<glm::vec3> result(screenCoords.size());
+  for (size_t i = 0; i < screenCoords.size(); i++) {
+    result[i] = unprojectScreenCoords(screenCoords[i], clipDepths[i], viewInv, projInv);
+  }
+  return result;
+}
 
 void startFlightTo(const CameraParameters& p, float flightLengthInSeconds) {
   startFlightTo(p.getE(), p.getFoVVerticalDegrees(), flightLengthInSeconds);
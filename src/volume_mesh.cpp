@@ -6,6 +6,7 @@
 #include "polyscope/combining_hash_functions.h"
 #include "polyscope/pick.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
 #include "polyscope/render/engine.h"
 #include "polyscope/utilities.h"
 #include "polyscope/volume_mesh_quantity.h"
@@ -659,6 +660,7 @@ void VolumeMesh::drawPickDelayed() {
 }
 
 void VolumeMesh::prepare() {
+  POLYSCOPE_PROFILE_SCOPE("prepare");
   // clang-format off
   program = render::engine->requestShader("MESH", 
       render::engine->addMaterialRules(getMaterial(),
@@ -674,6 +676,7 @@ void VolumeMesh::prepare() {
 }
 
 void VolumeMesh::preparePick() {
+  POLYSCOPE_PROFILE_SCOPE("prepare pick");
 
   // Create a new program
   pickProgram = render::engine->requestShader("MESH", addVolumeMeshRules({"MESH_PROPAGATE_PICK_SIMPLE"}),
@@ -1187,6 +1190,7 @@ void VolumeMesh::refresh() {
 
 void VolumeMesh::geometryChanged() {
   recomputeGeometryIfPopulated();
+  updateObjectSpaceBounds(); // keep culling bounds current, without changing the scene extents
   requestRedraw();
   Structure::refresh(); // TODO fixme unneeded, right?
 }
@@ -6,6 +6,10 @@
 #include "polyscope/pick.h"
 #include "polyscope/point_cloud.h"
 #include "polyscope/polyscope.h"
+#include "polyscope/profiler.h"
+#include "polyscope/render/engine.h"
+#include "polyscope/render/mock_opengl/mock_gl_engine.h"
+#include "polyscope/render/shader_builder.h"
 #include "polyscope/surface_mesh.h"
 #include "polyscope/types.h"
 #include "polyscope/volume_mesh.h"
@@ -282,3 +286,349 @@ TEST_F(PolyscopeTest, GroundPlaneTest) {
 
   polyscope::removeAllStructures();
 }
+
+TEST_F(PolyscopeTest, ShaderProgramStats) {
+  auto psPoints = registerPointCloud();
+  polyscope::show(3);
+
+  // the mock backend has no program binaries, so everything is compiled
+  EXPECT_GT(polyscope::render::engine->shaderProgramStats.nCompiled, 0u);
+  EXPECT_EQ(polyscope::render::engine->shaderProgramStats.nLoadedFromCache, 0u);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, ShaderCacheEntry) {
+  std::vector<char> binary = {'a', 'b', 'c', 'd', 'e', 'f'};
+  std::string entry = polyscope::render::encodeProgramBinaryCacheEntry(7, "driver", binary);
+
+  uint32_t format = 0;
+  std::vector<char> decoded;
+  EXPECT_TRUE(polyscope::render::decodeProgramBinaryCacheEntry(entry, "driver", format, decoded));
+  EXPECT_EQ(format, 7u);
+  EXPECT_EQ(decoded, binary);
+
+  // entries which can't be used fall back to a normal compile
+  EXPECT_FALSE(polyscope::render::decodeProgramBinaryCacheEntry(entry, "other driver", format, decoded));
+  std::string truncated = entry.substr(0, entry.size() - 2);
+  EXPECT_FALSE(polyscope::render::decodeProgramBinaryCacheEntry(truncated, "driver", format, decoded));
+  std::string corrupt = entry;
+  corrupt.back() = 'x';
+  EXPECT_FALSE(polyscope::render::decodeProgramBinaryCacheEntry(corrupt, "driver", format, decoded));
+  EXPECT_FALSE(polyscope::render::decodeProgramBinaryCacheEntry("", "driver", format, decoded));
+}
+
+TEST_F(PolyscopeTest, ShaderWarmup) {
+  polyscope::render::engine->requestShaderWarmup("RAYCAST_SPHERE", {"SHADE_BASECOLOR"});
+  polyscope::render::engine->requestShaderWarmup("RAYCAST_SPHERE", {"SHADE_BASECOLOR"}, // pick programs too
+                                                 polyscope::render::ShaderReplacementDefaults::Pick);
+  EXPECT_EQ(polyscope::render::engine->nPendingShaderWarmups(), 2u);
+
+  // each frame makes progress
+  polyscope::show(3);
+  polyscope::render::engine->finishShaderWarmup();
+  EXPECT_EQ(polyscope::render::engine->nPendingShaderWarmups(), 0u);
+
+  // warmed-up programs come from the cache
+  size_t nCompiled = polyscope::render::engine->shaderProgramStats.nCompiled;
+  polyscope::render::engine->requestShader("RAYCAST_SPHERE", {"SHADE_BASECOLOR"});
+  polyscope::render::engine->requestShader("RAYCAST_SPHERE", {"SHADE_BASECOLOR"},
+                                           polyscope::render::ShaderReplacementDefaults::Pick);
+  EXPECT_EQ(polyscope::render::engine->shaderProgramStats.nCompiled, nCompiled);
+
+  // unknown programs are reported when the warm-up reaches them
+  polyscope::render::engine->requestShaderWarmup("NOT_A_PROGRAM", {});
+  EXPECT_THROW(polyscope::render::engine->finishShaderWarmup(), std::runtime_error);
+  EXPECT_EQ(polyscope::render::engine->nPendingShaderWarmups(), 0u);
+  EXPECT_NO_THROW(polyscope::render::engine->finishShaderWarmup()); // (reported only once)
+}
+
+TEST_F(PolyscopeTest, UniformHandles) {
+  std::shared_ptr<polyscope::render::ShaderProgram> program =
+      polyscope::render::engine->requestShader("RAYCAST_SPHERE", {"SHADE_BASECOLOR"});
+
+  polyscope::render::UniformHandle radius = program->getUniformHandle("u_pointRadius");
+  program->setUniform(radius, 0.5f);
+  program->setUniform("u_pointRadius", 0.5f);
+
+  EXPECT_THROW(program->setUniform(radius, glm::vec3{1., 2., 3.}), std::invalid_argument);
+  EXPECT_THROW(program->getUniformHandle("u_notAUniform"), std::invalid_argument);
+  EXPECT_THROW(program->setUniform("u_notAUniform", 0.5f), std::invalid_argument);
+
+  // findUniform() resolves each name once per program, missing uniforms give an invalid handle
+  using polyscope::render::backend_openGL_mock::MockGLEngine;
+  MockGLEngine* mockEngine = dynamic_cast<MockGLEngine*>(polyscope::render::engine);
+  ASSERT_NE(mockEngine, nullptr);
+  polyscope::render::UniformName radiusName("u_pointRadius");
+  polyscope::render::UniformName missingName("u_notAUniform");
+  EXPECT_EQ(program->findUniform(radiusName).index, radius.index);
+  EXPECT_FALSE(program->findUniform(missingName).isValid());
+  mockEngine->resetFrameStats();
+  program->findUniform(radiusName);
+  program->findUniform(missingName);
+  EXPECT_EQ(mockEngine->getCurrentFrameStats().uniformLookups, 0u);
+
+  // Drawing point clouds looks up no uniforms by name once their programs have resolved them
+  registerPointCloud("points0");
+  polyscope::show(3);
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  size_t oneCloudLookups = mockEngine->getLastFrameStats().uniformLookups;
+  for (int i = 1; i < 4; i++) {
+    registerPointCloud("points" + std::to_string(i));
+  }
+  polyscope::show(3);
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  EXPECT_EQ(mockEngine->getLastFrameStats().uniformLookups, oneCloudLookups);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, UniformBlockRule) {
+  using namespace polyscope::render;
+  ShaderStageSpecification vert{ShaderStageType::Vertex,
+                                {{"u_projMatrix", RenderDataType::Matrix44Float}, {"u_pointRadius", RenderDataType::Float}},
+                                {},
+                                {},
+                                R"(
+        ${ GLSL_VERSION }$
+        uniform mat4 u_projMatrix;
+        uniform float u_pointRadius;
+  )"};
+  ShaderReplacementRule blockRule("BLOCK", {{"GLSL_VERSION", "layout(std140) uniform Block { mat4 u_projMatrix; };"}},
+                                  {}, {}, {}, {"u_projMatrix"});
+
+  std::vector<ShaderStageSpecification> replaced = applyShaderReplacements({vert}, {blockRule});
+  ASSERT_EQ(replaced.size(), 1u);
+  EXPECT_EQ(replaced[0].src.find("uniform mat4 u_projMatrix;"), std::string::npos);
+  EXPECT_NE(replaced[0].src.find("uniform float u_pointRadius;"), std::string::npos);
+  EXPECT_EQ(replaced[0].uniforms.size(), 2u);
+
+  // The shared block is uploaded once in a frame which changes the projection, and not at all while it is unchanged
+  using polyscope::render::backend_openGL_mock::MockGLEngine;
+  MockGLEngine* mockEngine = dynamic_cast<MockGLEngine*>(polyscope::render::engine);
+  ASSERT_NE(mockEngine, nullptr);
+  polyscope::GroundPlaneMode savedGroundPlaneMode = polyscope::options::groundPlaneMode;
+  polyscope::options::groundPlaneMode = polyscope::GroundPlaneMode::None; // (its reflected pass changes the view)
+  registerPointCloud();
+  polyscope::show(3);
+  float savedFov = polyscope::view::fov;
+  polyscope::view::fov = savedFov + 5.;
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  EXPECT_EQ(mockEngine->getLastFrameStats().uniformBlockBytesUploaded, sizeof(FrameUniforms));
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  EXPECT_EQ(mockEngine->getLastFrameStats().uniformBlockBytesUploaded, 0u);
+
+  polyscope::view::fov = savedFov;
+  polyscope::options::groundPlaneMode = savedGroundPlaneMode;
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SortedDrawCalls) {
+  using polyscope::render::backend_openGL_mock::MockGLEngine;
+  MockGLEngine* mockEngine = dynamic_cast<MockGLEngine*>(polyscope::render::engine);
+  ASSERT_NE(mockEngine, nullptr);
+
+  // Alternate the back face policy, so drawing in registration order toggles culling for every mesh
+  for (int i = 0; i < 6; i++) {
+    polyscope::SurfaceMesh* psMesh = registerTriangleMesh("mesh" + std::to_string(i));
+    psMesh->setBackFacePolicy(i % 2 == 0 ? polyscope::BackFacePolicy::Cull : polyscope::BackFacePolicy::Different);
+  }
+  polyscope::show(3);
+
+  polyscope::options::sortDrawCalls = false;
+  mockEngine->stateChangeCounts = MockGLEngine::StateChangeCounts();
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  size_t unsortedCullChanges = mockEngine->stateChangeCounts.backfaceCulls;
+
+  polyscope::options::sortDrawCalls = true;
+  mockEngine->stateChangeCounts = MockGLEngine::StateChangeCounts();
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  size_t sortedCullChanges = mockEngine->stateChangeCounts.backfaceCulls;
+
+  EXPECT_LT(sortedCullChanges, unsortedCullChanges);
+
+  // draws which don't both test and write depth keep their back-to-front order
+  polyscope::render::engine->beginRenderQueue();
+  polyscope::render::engine->setDepthMode(polyscope::DepthMode::Less);
+  EXPECT_FALSE(polyscope::render::engine->newRenderQueueItem(nullptr).orderDependent);
+  polyscope::render::engine->setDepthMode(polyscope::DepthMode::LEqualReadOnly);
+  EXPECT_TRUE(polyscope::render::engine->newRenderQueueItem(nullptr).orderDependent);
+  polyscope::render::engine->setDepthMode(polyscope::DepthMode::Disable);
+  EXPECT_TRUE(polyscope::render::engine->newRenderQueueItem(nullptr).orderDependent);
+  polyscope::render::engine->setDepthMode(polyscope::DepthMode::Less);
+  polyscope::render::engine->endRenderQueue();
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, MockFrameStats) {
+  using polyscope::render::backend_openGL_mock::MockGLEngine;
+  MockGLEngine* mockEngine = dynamic_cast<MockGLEngine*>(polyscope::render::engine);
+  ASSERT_NE(mockEngine, nullptr);
+
+  std::vector<polyscope::SurfaceMesh*> meshes;
+  for (int i = 0; i < 4; i++) {
+    meshes.push_back(registerTriangleMesh("mesh" + std::to_string(i)));
+  }
+  polyscope::show(3);
+
+  // A steady frame draws the meshes
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  MockGLEngine::FrameStats allVisible = mockEngine->getLastFrameStats();
+  EXPECT_GT(allVisible.drawCalls, 0u);
+  EXPECT_GE(allVisible.verticesSubmitted, allVisible.drawCalls);
+  EXPECT_GE(allVisible.instancesSubmitted, allVisible.drawCalls);
+  EXPECT_GT(allVisible.stateChanges.programBinds, 0u);
+
+  // Hiding structures means less work
+  meshes[0]->setEnabled(false);
+  meshes[1]->setEnabled(false);
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  MockGLEngine::FrameStats someHidden = mockEngine->getLastFrameStats();
+  EXPECT_LT(someHidden.drawCalls, allVisible.drawCalls);
+  EXPECT_LT(someHidden.verticesSubmitted, allVisible.verticesSubmitted);
+
+  // A new structure uploads its data on the frame it is first drawn
+  polyscope::registerPointCloud("points", getPoints());
+  polyscope::show(1);
+  EXPECT_GT(mockEngine->getLastFrameStats().attributeBytesUploaded, 0u);
+
+  // A partial update counts only the range it uploads
+  std::shared_ptr<polyscope::render::AttributeBuffer> buff =
+      polyscope::render::engine->generateAttributeBuffer(polyscope::RenderDataType::Vector3Float);
+  buff->setData(std::vector<glm::vec3>(10));
+  mockEngine->resetFrameStats();
+  buff->setDataRange(std::vector<glm::vec3>(2), 3);
+  EXPECT_EQ(mockEngine->getCurrentFrameStats().attributeBytesUploaded, 2 * sizeof(glm::vec3));
+
+  // Reading back the display counts as a readback
+  mockEngine->resetFrameStats();
+  polyscope::render::engine->readDisplayBuffer();
+  EXPECT_EQ(mockEngine->getCurrentFrameStats().framebufferReadbacks, 1u);
+  EXPECT_GT(mockEngine->getCurrentFrameStats().bytesReadBack, 0u);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, FrustumCulling) {
+  // A small cloud in front of the camera and one behind it
+  std::vector<glm::vec3> smallPoints{{0., 0., 0.}, {1., 1., 1.}};
+  polyscope::registerPointCloud("in front", smallPoints);
+  polyscope::PointCloud* behind = polyscope::registerPointCloud("behind", smallPoints);
+  behind->setPosition(glm::vec3{0., 0., 100.});
+
+  // A large cloud along a line, most of whose chunks are far off to the side
+  std::vector<glm::vec3> linePoints(100000);
+  for (size_t i = 0; i < linePoints.size(); i++) {
+    linePoints[i] = glm::vec3{-50. + 0.001 * i, 0., 0.};
+  }
+  polyscope::registerPointCloud("line", linePoints);
+
+  polyscope::view::lookAt(glm::vec3{0., 0., 10.}, glm::vec3{0., 0., 0.});
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  polyscope::CullingStats stats = polyscope::getCullingStats();
+  EXPECT_GT(stats.nStructuresCulled, 0);
+  EXPECT_GT(stats.nStructuresDrawn, 0);
+  EXPECT_GT(stats.nChunksCulled, 0);
+  EXPECT_GT(stats.nChunksDrawn, 0);
+
+  // Nothing is culled with the option off
+  polyscope::options::frustumCulling = false;
+  polyscope::requestRedraw();
+  polyscope::show(1);
+  stats = polyscope::getCullingStats();
+  EXPECT_EQ(stats.nStructuresCulled, 0);
+  EXPECT_EQ(stats.nChunksCulled, 0);
+  polyscope::options::frustumCulling = true;
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, Profiler) {
+  if (!polyscope::profiler::isCompiledIn()) return;
+  const std::deque<polyscope::profiler::FrameTiming>& frames = polyscope::profiler::getFrames();
+
+  auto psPoints = registerPointCloud();
+  polyscope::options::enableProfiler = true;
+  polyscope::profiler::clear();
+  polyscope::requestRedraw();
+  polyscope::show(2);
+  ASSERT_GT(frames.size(), 0u);
+
+  // the scene render is timed on the GPU, and the point cloud is drawn within it
+  bool foundScene = false, foundPoints = false;
+  for (const polyscope::profiler::ScopeTiming& scope : frames.front().scopes) {
+    if (scope.name == "render scene") {
+      foundScene = true;
+      EXPECT_GE(scope.gpuDurationMs, 0.);
+    }
+    if (scope.name == psPoints->name) {
+      foundPoints = true;
+      EXPECT_GT(scope.depth, 0);
+    }
+  }
+  EXPECT_TRUE(foundScene);
+  EXPECT_TRUE(foundPoints);
+
+  // a screenshot outside of the main loop is recorded as a frame of its own
+  size_t nFrames = frames.size();
+  polyscope::screenshotToBuffer();
+  ASSERT_EQ(frames.size(), nFrames + 1);
+  EXPECT_EQ(frames.back().scopes.front().name, "screenshot");
+
+  std::string trace = polyscope::profiler::getChromeTrace();
+  EXPECT_NE(trace.find("traceEvents"), std::string::npos);
+  EXPECT_NE(trace.find("screenshot readback"), std::string::npos);
+
+  // nothing is recorded with the option off
+  polyscope::options::enableProfiler = false;
+  polyscope::profiler::clear();
+  polyscope::show(1);
+  EXPECT_EQ(frames.size(), 0u);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PickRangeLookup) {
+  // Ranges are only ever looked up by pointer, so stand-in structure pointers are fine here
+  const size_t nStructures = 100000;
+  std::vector<polyscope::Structure*> owners(nStructures);
+  std::vector<uint64_t> starts(nStructures);
+  for (size_t i = 0; i < nStructures; i++) {
+    owners[i] = reinterpret_cast<polyscope::Structure*>(static_cast<uintptr_t>(16 * (i + 1)));
+    starts[i] = polyscope::pick::requestPickBufferRange(owners[i], 1 + i % 7);
+  }
+
+  for (size_t i = 0; i < nStructures; i += 997) {
+    uint64_t localInd = i % 7;
+    std::tuple<polyscope::Structure*, polyscope::Quantity*, uint64_t> pick =
+        polyscope::pick::globalIndexToLocal(starts[i] + localInd);
+    EXPECT_EQ(std::get<0>(pick), owners[i]);
+    EXPECT_EQ(std::get<1>(pick), nullptr);
+    EXPECT_EQ(std::get<2>(pick), localInd);
+  }
+
+  // Freed ranges no longer resolve
+  polyscope::pick::releasePickBufferRange(owners[5]);
+  EXPECT_EQ(std::get<0>(polyscope::pick::globalIndexToLocal(starts[5])), nullptr);
+  EXPECT_EQ(std::get<0>(polyscope::pick::globalIndexToLocal(starts[6])), owners[6]);
+
+  // Requesting again replaces the old range
+  uint64_t newStart = polyscope::pick::requestPickBufferRange(owners[6], 3);
+  EXPECT_EQ(std::get<0>(polyscope::pick::globalIndexToLocal(starts[6])), nullptr);
+  EXPECT_EQ(std::get<0>(polyscope::pick::globalIndexToLocal(newStart + 2)), owners[6]);
+
+  for (polyscope::Structure* s : owners) {
+    polyscope::pick::releasePickBufferRange(s);
+  }
+  EXPECT_EQ(std::get<0>(polyscope::pick::globalIndexToLocal(newStart)), nullptr);
+}
@@ -26,6 +26,25 @@ TEST_F(PolyscopeTest, EmptyCurveNetwork) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, CurveNetworkAppendNodesEdges) {
+  auto psCurve = registerCurveNetwork();
+  size_t nNodes = psCurve->nNodes();
+  size_t nEdges = psCurve->nEdges();
+  polyscope::show(3);
+
+  psCurve->appendNodes(std::vector<glm::vec3>{{5., 5., 5.}, {6., 5., 5.}});
+  psCurve->appendEdges(std::vector<std::array<size_t, 2>>{{0, nNodes}, {nNodes, nNodes + 1}});
+  EXPECT_EQ(psCurve->nNodes(), nNodes + 2);
+  EXPECT_EQ(psCurve->nEdges(), nEdges + 2);
+  EXPECT_EQ(psCurve->nodeDegrees[nNodes], 2);
+  polyscope::show(3);
+
+  // bad indices
+  EXPECT_THROW(psCurve->appendEdges(std::vector<std::array<size_t, 2>>{{0, nNodes + 2}}), std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, CurveNetworkAppearance) {
   auto psCurve = registerCurveNetwork();
 
@@ -61,6 +80,28 @@ TEST_F(PolyscopeTest, CurveNetworkPick) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, CurveNetworkInstancing) {
+  auto psCurve = registerCurveNetwork();
+  std::vector<glm::mat4> transforms(4, glm::mat4(1.));
+  for (size_t i = 0; i < transforms.size(); i++) {
+    transforms[i][3] = glm::vec4(0., 0., 2. * i, 1.);
+  }
+
+  psCurve->setInstances(transforms);
+  EXPECT_EQ(psCurve->nInstances(), 4u);
+  polyscope::show(3);
+
+  psCurve->setInstanceColors(std::vector<glm::vec3>(4, glm::vec3{0.2, 0.4, 0.6}));
+  polyscope::show(3);
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+
+  psCurve->clearInstanceColors();
+  psCurve->clearInstances();
+  EXPECT_FALSE(psCurve->isInstanced());
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
 
 TEST_F(PolyscopeTest, CurveNetworkColorNode) {
   auto psCurve = registerCurveNetwork();
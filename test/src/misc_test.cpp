@@ -2,6 +2,14 @@
 
 #include "polyscope_test.h"
 
+#include "polyscope/affine_remapper.h"
+#include "polyscope/colormap_evaluation.h"
+#include "polyscope/quantile_sketch.h"
+#include "polyscope/scalar_statistics.h"
+
+#include <cmath>
+#include <limits>
+
 // ============================================================
 // =============== Scalar Quantity Tests
 // ============================================================
@@ -52,6 +60,192 @@ TEST_F(PolyscopeTest, TestScalarColormapQuantity) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, TestScalarStatistics) {
+  // large enough to be split across threads
+  size_t N = 300000;
+  std::vector<float> vals(N);
+  for (size_t i = 0; i < N; i++) {
+    vals[i] = std::sin(0.001f * i) * 10.f;
+  }
+  vals[12] = std::numeric_limits<float>::quiet_NaN();
+  vals[N - 1] = std::numeric_limits<float>::infinity();
+
+  polyscope::ScalarStatistics stats = polyscope::computeScalarStatistics(vals, 51);
+  EXPECT_EQ(stats.nValues, N);
+  EXPECT_EQ(stats.nNonFinite, 2u);
+  EXPECT_FALSE(stats.allFinite());
+  EXPECT_EQ(stats.robustRange(1e-12), polyscope::robustMinMax(vals, 1e-12));
+  EXPECT_EQ(stats.robustRange(1e-5), polyscope::robustMinMax(vals, 1e-5));
+
+  double total = 0.;
+  for (double c : stats.histogramBinCounts) total += c;
+  EXPECT_EQ(stats.histogramBinCounts.size(), 51u);
+  EXPECT_EQ(total, static_cast<double>(N - 2));
+
+  // integers are ranged exactly
+  std::vector<int32_t> intVals(N);
+  for (size_t i = 0; i < N; i++) {
+    intVals[i] = static_cast<int32_t>(i % 1000) - 500;
+  }
+  polyscope::ScalarStatistics intStats = polyscope::computeScalarStatistics(intVals, 51);
+  EXPECT_EQ(intStats.histogramRange, std::make_pair(-500., 499.));
+  EXPECT_EQ(intStats.histogramBinCounts.front(), 20. * (N / 1000));
+
+  // the scalar quantity keeps the statistics it was built from
+  auto psPoints = registerPointCloud();
+  std::vector<double> vScalar(psPoints->nPoints(), 7.);
+  auto q1 = psPoints->addScalarQuantity("vScalar", vScalar);
+  EXPECT_EQ(q1->getStatistics().nValues, psPoints->nPoints());
+  EXPECT_TRUE(q1->getStatistics().allFinite());
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, TestScalarQuantityUpdateStatistics) {
+  auto psPoints = registerPointCloud();
+  size_t N = psPoints->nPoints();
+
+  std::vector<double> vScalar(N);
+  for (size_t i = 0; i < N; i++) vScalar[i] = i;
+  auto q1 = psPoints->addScalarQuantity("vScalar", vScalar);
+  q1->setEnabled(true);
+  polyscope::show(3);
+
+  // the histogram is only built once something asks for it
+  EXPECT_EQ(q1->getStatistics().histogramBinCounts.size(), polyscope::ColorBar::rawHistBinCount);
+
+  // partial updates within the range adjust the counts in place
+  std::vector<double> vPart = {2.};
+  q1->updateDataPartial(1, vPart);
+  polyscope::ScalarStatistics stats = q1->getStatistics();
+  double total = 0.;
+  for (double c : stats.histogramBinCounts) total += c;
+  EXPECT_EQ(total, static_cast<double>(N));
+  EXPECT_EQ(stats.histogramBinCounts[17], 0.); // the 1 was replaced
+  EXPECT_EQ(stats.histogramBinCounts[34], 2.); // (bin of the value 2 when the range is [0,3])
+  EXPECT_EQ(q1->values.getValue(1), 2.f);
+  polyscope::show(3);
+
+  // full updates rebuild lazily
+  for (size_t i = 0; i < N; i++) vScalar[i] = 2. * i;
+  q1->updateData(vScalar);
+  polyscope::show(3);
+  EXPECT_NEAR(q1->getDataRange().second, 2. * (N - 1), 1e-3);
+
+  // a partial update outside the range forces a rebuild
+  std::vector<double> vBig = {1000. * N};
+  q1->updateDataPartial(N - 1, vBig);
+  EXPECT_NEAR(q1->getDataRange().second, 1000. * N, 1e-3);
+
+  // a partial update which replaces the maximum shrinks the range
+  std::vector<double> vSmall = {0.};
+  q1->updateDataPartial(N - 1, vSmall);
+  EXPECT_NEAR(q1->getDataRange().second, 2. * (N - 2), 1e-3);
+
+  EXPECT_THROW(q1->updateDataPartial(N, vPart), std::runtime_error);
+
+  // with a percentile range, partial updates recompute the percentiles
+  std::vector<double> vMany(100);
+  for (size_t i = 0; i < vMany.size(); i++) vMany[i] = i;
+  auto psMany = polyscope::registerPointCloud("many", std::vector<glm::vec3>(vMany.size()));
+  auto q2 = psMany->addScalarQuantity("vMany", vMany);
+  q2->setPercentileRange(0., 50.);
+  EXPECT_LT(q2->getDataRange().second, 60.);
+  q2->updateDataPartial(1, std::vector<double>(50, 90.));
+  EXPECT_GT(q2->getDataRange().second, 80.);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, TestQuantileSketch) {
+  // a permutation of 0..N-1, so the exact quantiles are known
+  size_t N = 1000000;
+  polyscope::QuantileSketch sketchA, sketchB;
+  for (size_t i = 0; i < N; i++) {
+    double v = (i * 7919) % N;
+    if (i % 2 == 0) {
+      sketchA.add(v);
+    } else {
+      sketchB.add(v);
+    }
+  }
+  sketchA.merge(sketchB);
+  EXPECT_EQ(sketchA.count(), N);
+  for (double q : {0.01, 0.25, 0.5, 0.99}) {
+    EXPECT_NEAR(sketchA.quantile(q), q * N, 0.02 * N);
+  }
+}
+
+TEST_F(PolyscopeTest, TestScalarPercentileRange) {
+  // one huge outlier should not affect a percentile range
+  size_t N = 200000;
+  std::vector<float> vals(N);
+  for (size_t i = 0; i < N; i++) vals[i] = static_cast<float>(i % 100);
+  vals[7] = 1e9;
+
+  std::pair<double, double> range = polyscope::computeScalarPercentiles(vals, 1., 99.);
+  EXPECT_NEAR(range.first, 1., 2.);
+  EXPECT_NEAR(range.second, 98., 2.);
+  EXPECT_EQ(polyscope::computeScalarPercentiles(vals, 0., 100.), std::make_pair(0., 1e9));
+
+  auto psPoints = registerPointCloud();
+  std::vector<double> vScalar = {0., 1., 2., 1000.};
+  auto q1 = psPoints->addScalarQuantity("vScalar", vScalar);
+  q1->setEnabled(true);
+  q1->setPercentileRange(0., 50.);
+  EXPECT_TRUE(q1->getPercentileRangeEnabled());
+  EXPECT_LT(q1->getDataRange().second, 1000.);
+  EXPECT_EQ(q1->getMapRange(), q1->getDataRange());
+  polyscope::show(3);
+
+  q1->clearPercentileRange();
+  EXPECT_EQ(q1->getDataRange().second, 1000.);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, TestScalarColorMapEvaluation) {
+  auto psPoints = registerPointCloud();
+  std::vector<double> vScalar = {-1., 0.25, 0.5, 2.};
+  auto q1 = psPoints->addScalarQuantity("vScalar", vScalar);
+  q1->setEnabled(true);
+  q1->setMapRange({0., 1.});
+  polyscope::show(3);
+
+  // values outside the map range get exactly the end colors of the map
+  const polyscope::render::ValueColorMap& cmap = polyscope::render::engine->getColorMap(q1->getColorMap());
+  std::vector<glm::vec3> colors = q1->evaluateColors();
+  ASSERT_EQ(colors.size(), vScalar.size());
+  EXPECT_EQ(colors[0], cmap.values.front());
+  EXPECT_EQ(colors[3], cmap.values.back());
+
+  // in between, the colormap texture is sampled with linear filtering
+  glm::vec3 expectedMid = polyscope::render::sampleColorMapTexture(cmap, 0.5f);
+  EXPECT_EQ(colors[2], expectedMid);
+  EXPECT_NEAR(colors[2].x, cmap.getValue(0.5).x, 0.01);
+
+  // stripe isolines darken alternating bands
+  q1->setIsolinesEnabled(true);
+  q1->setIsolinePeriod(0.4, false);
+  q1->setIsolineDarkness(0.5);
+  std::vector<glm::vec3> stripedColors = q1->evaluateColors();
+  EXPECT_EQ(stripedColors[1], colors[1]);        // mod(0.25, 0.8) is in the light band
+  EXPECT_EQ(stripedColors[2], colors[2] * 0.5f); // mod(0.5, 0.8) is in the dark band
+  polyscope::show(3);
+
+  // categorical, for an arbitrary array
+  polyscope::ScalarColorMapParams params;
+  params.colorMap = "rainbow";
+  params.dataType = polyscope::DataType::CATEGORICAL;
+  std::vector<glm::vec4> catColors = polyscope::evaluateScalarColorMapRGBA({0.f, 1.f, 1.2f}, params);
+  EXPECT_EQ(catColors[1], catColors[2]);
+  EXPECT_NE(catColors[0], catColors[1]);
+  EXPECT_EQ(catColors[0].a, 1.f);
+
+  polyscope::removeAllStructures();
+}
+
 // ============================================================
 // =============== Materials tests
 // ============================================================
@@ -67,6 +261,25 @@ TEST_F(PolyscopeTest, FlatMaterialTest) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, LazyMaterialTest) {
+  auto psMesh = registerTriangleMesh();
+
+  // The built-in materials are decoded on first use; jade uses one image for all four channels
+  polyscope::render::Material& jade = polyscope::render::engine->getMaterial("jade");
+  psMesh->setMaterial("jade");
+  polyscope::show(3);
+  EXPECT_EQ(jade.encodedTextures[0], nullptr);
+  ASSERT_NE(jade.textureBuffers[0], nullptr);
+  EXPECT_EQ(jade.textureBuffers[0], jade.textureBuffers[3]);
+
+  // A material which no test uses is never decoded (wax is used by other tests in this suite)
+  polyscope::render::Material& candy = polyscope::render::engine->getMaterial("candy");
+  EXPECT_NE(candy.encodedTextures[0], nullptr);
+  EXPECT_EQ(candy.textureBuffers[0], nullptr);
+
+  polyscope::removeAllStructures();
+}
+
 // ============================================================
 // =============== Transformation Gizmo Tests
 // ============================================================
@@ -5,13 +5,21 @@
 
 #include "polyscope/curve_network.h"
 #include "polyscope/pick.h"
+#include "polyscope/render/mock_opengl/mock_gl_engine.h"
+#include "polyscope/render/shader_builder.h"
 #include "polyscope/point_cloud.h"
 #include "polyscope/polyscope.h"
 #include "polyscope/surface_mesh.h"
 #include "polyscope/volume_mesh.h"
 
+#include "polyscope/ply_loader.h"
+
 #include "gtest/gtest.h"
 
+#include <atomic>
+#include <cstdio>
+#include <fstream>
+
 #include <array>
 #include <iostream>
 #include <list>
@@ -44,6 +52,102 @@ TEST_F(PolyscopeTest, PointCloudUpdateGeometry) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, PointCloudAppendPoints) {
+  auto psPoints = registerPointCloud();
+  size_t nInitial = psPoints->nPoints();
+  polyscope::show(3);
+
+  std::vector<glm::vec3> newPoints = {{10., 0., 0.}, {0., -10., 0.}};
+  psPoints->appendPoints(newPoints);
+  EXPECT_EQ(psPoints->nPoints(), nInitial + 2);
+  EXPECT_EQ(psPoints->getPointPosition(nInitial), newPoints[0]);
+  polyscope::show(3);
+
+  // the bounds must contain the new points
+  std::tuple<glm::vec3, glm::vec3> bbox = psPoints->boundingBox();
+  EXPECT_GE(std::get<1>(bbox).x, 10.);
+  EXPECT_LE(std::get<0>(bbox).y, -10.);
+
+  // the pick range is regrown with room to spare, after which appends reuse it
+  polyscope::pickAtScreenCoords(glm::vec2{0.5, 0.5});
+  psPoints->appendPoints(newPoints);
+  polyscope::pickAtScreenCoords(glm::vec2{0.5, 0.5});
+  std::tuple<uint64_t, uint64_t> pickRange = polyscope::state::globalContext.structureRanges.at(psPoints);
+  psPoints->appendPoints(newPoints);
+  polyscope::pickAtScreenCoords(glm::vec2{0.5, 0.5});
+  EXPECT_EQ(polyscope::state::globalContext.structureRanges.at(psPoints), pickRange);
+  EXPECT_GE(std::get<1>(pickRange) - std::get<0>(pickRange), psPoints->nPoints());
+
+  // ring buffer: the oldest points get dropped, then overwritten
+  psPoints->setMaxPointCount(3);
+  EXPECT_EQ(psPoints->nPoints(), 3);
+  EXPECT_EQ(psPoints->getPointPosition(1), newPoints[0]);
+  psPoints->appendPoints2D(std::vector<glm::vec2>{{1., 2.}});
+  EXPECT_EQ(psPoints->nPoints(), 3);
+  EXPECT_EQ(psPoints->getPointPosition(0), glm::vec3(1., 2., 0.));
+  polyscope::show(3);
+
+  // not allowed with quantities
+  psPoints->addScalarQuantity("vals", std::vector<double>(psPoints->nPoints(), 0.));
+  EXPECT_THROW(psPoints->appendPoints(newPoints), std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PointCloudTimeSeries) {
+  auto psPoints = registerPointCloud();
+  size_t N = psPoints->nPoints();
+
+  // positions from arrays
+  std::vector<std::vector<glm::vec3>> positionFrames;
+  for (size_t iFrame = 0; iFrame < 5; iFrame++) {
+    positionFrames.push_back(std::vector<glm::vec3>(N, glm::vec3{static_cast<float>(iFrame), 0., 0.}));
+  }
+  psPoints->addPointPositionFrames(positionFrames);
+
+  // scalars from a loader
+  auto q = psPoints->addScalarQuantityFrameLoader("anim scalar", 8, [N](size_t iFrame) {
+    return std::vector<float>(N, static_cast<float>(iFrame));
+  });
+  q->setEnabled(true);
+
+  polyscope::TimeSeries& series = psPoints->getTimeSeries();
+  EXPECT_TRUE(psPoints->hasTimeSeries());
+  EXPECT_EQ(series.nFrames(), 8);
+
+  series.setFrame(3);
+  EXPECT_EQ(psPoints->getPointPosition(0).x, 3.);
+  EXPECT_EQ(q->values.getValue(0), 3.);
+  polyscope::show(3);
+
+  // the shorter track holds its last frame
+  series.setFrame(7);
+  EXPECT_EQ(psPoints->getPointPosition(0).x, 4.);
+  EXPECT_EQ(q->values.getValue(0), 7.);
+
+  series.setFramesPerSecond(1000.);
+  series.setPlaying(true);
+  polyscope::show(3);
+  series.setPlaying(false);
+
+  // the first frame is loaded only once, for both the quantity and its track
+  std::shared_ptr<std::atomic<int>> firstFrameLoads(new std::atomic<int>(0));
+  series.setFrame(0);
+  psPoints->addColorQuantityFrameLoader("anim color", 4, [N, firstFrameLoads](size_t iFrame) {
+    if (iFrame == 0) (*firstFrameLoads)++;
+    return std::vector<glm::vec3>(N, glm::vec3{static_cast<float>(iFrame), 0., 0.});
+  });
+  EXPECT_EQ(firstFrameLoads->load(), 1);
+
+  // removing a quantity removes its track
+  EXPECT_TRUE(series.hasTrack(polyscope::quantityTrackName("anim color")));
+  psPoints->removeQuantity("anim color");
+  EXPECT_FALSE(series.hasTrack(polyscope::quantityTrackName("anim color")));
+  series.setFrame(2);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, PointCloudAppearance) {
   auto psPoints = registerPointCloud();
 
@@ -76,6 +180,141 @@ TEST_F(PolyscopeTest, PointCloudSphereOrthographicRendering) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, PointCloudPickBatch) {
+  auto psPoints = registerPointCloud();
+
+  std::vector<glm::ivec2> queryInds = {glm::ivec2(77, 88), glm::ivec2(12, 34), glm::ivec2(-5, 3)};
+  std::vector<polyscope::PickResult> results = polyscope::pickAtBufferInds(queryInds);
+  ASSERT_EQ(results.size(), queryInds.size());
+  EXPECT_EQ(results[1].bufferInds, queryInds[1]);
+  EXPECT_FALSE(results[2].isHit); // outside of the buffer
+
+  std::vector<glm::vec2> queryCoords = {glm::vec2(0.3, 0.8), glm::vec2(200., 100.)};
+  EXPECT_EQ(polyscope::pickAtScreenCoords(queryCoords).size(), queryCoords.size());
+  EXPECT_TRUE(polyscope::pickAtScreenCoords(std::vector<glm::vec2>()).empty());
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PickIntegerEncoding) {
+  std::vector<uint64_t> inds = {1, 12345, (1ull << 22) + 3, (1ull << 40) + 7, (1ull << 63) + (1ull << 44) + 5};
+  for (uint64_t ind : inds) {
+    glm::uvec2 packed = polyscope::pick::indToUVec2(ind);
+    EXPECT_EQ(polyscope::pick::uvec2ToInd(packed), ind);
+
+    // mirror the shader conversion from the float pick color
+    glm::vec3 color = polyscope::pick::indToVec(ind);
+    glm::uvec3 k = glm::uvec3(glm::round(color * 4194304.f));
+    glm::uvec2 fromColor{k.x | (k.y << 22u), (k.y >> 10u) | (k.z << 12u)};
+    EXPECT_EQ(fromColor, packed);
+  }
+
+  polyscope::render::ShaderStageSpecification frag{polyscope::render::ShaderStageType::Fragment, {}, {}, {}, R"(
+        layout(location = 0) out vec4 outputF;
+        void main() { outputF = vec4(1.); }
+  )"};
+  std::vector<polyscope::render::ShaderStageSpecification> converted =
+      polyscope::render::convertToIntegerPickOutput({frag});
+  ASSERT_EQ(converted.size(), 1u);
+  EXPECT_NE(converted[0].src.find("out uvec2 outputPickID"), std::string::npos);
+  EXPECT_NE(converted[0].src.find("void pickMain()"), std::string::npos);
+
+  // a pick fragment shader with any other output can't be converted
+  polyscope::render::ShaderStageSpecification badFrag{polyscope::render::ShaderStageType::Fragment, {}, {}, {}, R"(
+        layout(location = 0) out vec4 outputVal;
+        void main() { outputVal = vec4(1.); }
+  )"};
+  EXPECT_THROW(polyscope::render::convertToIntegerPickOutput({badFrag}), std::runtime_error);
+}
+
+TEST_F(PolyscopeTest, PointCloudPickAsync) {
+  auto psPoints = registerPointCloud();
+
+  // The first call only starts a query, the next one picks up its result
+  polyscope::pickAtScreenCoordsAsync(glm::vec2(0.3, 0.8));
+  polyscope::AsyncPickResult result = polyscope::pickAtScreenCoordsAsync(glm::vec2(0.3, 0.8));
+  EXPECT_TRUE(result.isAvailable);
+  EXPECT_EQ(result.framesOld, 0u);
+
+  polyscope::show(1);
+  result = polyscope::pickAtScreenCoordsAsync(glm::vec2(0.3, 0.8));
+  EXPECT_TRUE(result.isAvailable);
+  EXPECT_GE(result.framesOld, 1u);
+
+  // Queries outside of the window are answered right away
+  result = polyscope::pickAtScreenCoordsAsync(glm::vec2(-10., -10.));
+  EXPECT_TRUE(result.isAvailable);
+  EXPECT_FALSE(result.pick.isHit);
+  EXPECT_EQ(result.framesOld, 0u);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PointCloudPickBufferCache) {
+  auto psPoints = registerPointCloud();
+
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+  EXPECT_TRUE(polyscope::state::globalContext.pickBufferCacheValid);
+  uint64_t renderedGeneration = polyscope::state::globalContext.pickBufferCacheKey.sceneGeneration;
+
+  // Nothing changed, the previous render is reused
+  polyscope::pickAtBufferInds(glm::ivec2(12, 34));
+  EXPECT_EQ(polyscope::state::globalContext.pickBufferCacheKey.sceneGeneration, renderedGeneration);
+
+  // Changing the scene re-renders
+  psPoints->setPointRadius(0.02);
+  polyscope::pickAtBufferInds(glm::ivec2(12, 34));
+  EXPECT_GT(polyscope::state::globalContext.pickBufferCacheKey.sceneGeneration, renderedGeneration);
+
+  // A repeated query with no scene change issues no draws, a redraw or a view change renders the pick buffer again
+  using polyscope::render::backend_openGL_mock::MockGLEngine;
+  MockGLEngine* mockEngine = dynamic_cast<MockGLEngine*>(polyscope::render::engine);
+  ASSERT_NE(mockEngine, nullptr);
+  polyscope::pickAtScreenCoords(glm::vec2(0.3, 0.8));
+  mockEngine->resetFrameStats();
+  polyscope::pickAtScreenCoords(glm::vec2(0.3, 0.8));
+  EXPECT_EQ(mockEngine->getCurrentFrameStats().drawCalls, 0u);
+
+  polyscope::requestRedraw();
+  polyscope::pickAtScreenCoords(glm::vec2(0.3, 0.8));
+  EXPECT_GT(mockEngine->getCurrentFrameStats().drawCalls, 0u);
+
+  mockEngine->resetFrameStats();
+  polyscope::view::lookAt(glm::vec3{0., 0., 7.}, glm::vec3{0., 0., 0.});
+  polyscope::pickAtScreenCoords(glm::vec2(0.3, 0.8));
+  EXPECT_GT(mockEngine->getCurrentFrameStats().drawCalls, 0u);
+
+  polyscope::pick::invalidatePickBuffer();
+  EXPECT_FALSE(polyscope::state::globalContext.pickBufferCacheValid);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, PointCloudPickRegion) {
+  auto psPoints = registerPointCloud();
+
+  // The mock backend doesn't render anything, but make sure the region queries run
+  polyscope::pickInRect(glm::vec2(10, 20), glm::vec2(300, 200));
+  polyscope::pickInRect(glm::vec2(300, 200), glm::vec2(10, 20));
+  polyscope::pickInPolygon({glm::vec2(10, 20), glm::vec2(300, 40), glm::vec2(100, 200)});
+  EXPECT_TRUE(polyscope::pickInPolygon({glm::vec2(10, 20), glm::vec2(300, 40)}).empty());
+
+  // regions partly or entirely off screen are clamped to the buffer
+  polyscope::pickInRect(glm::vec2(-50, -50), glm::vec2(1e5, 1e5));
+  EXPECT_TRUE(polyscope::pickInRect(glm::vec2(-100, 20), glm::vec2(-10, 200)).empty());
+
+  polyscope::PickRegionResult region;
+  region.structure = psPoints;
+  region.localIndices = {0, 2, 3};
+  polyscope::PointCloudPickRegionResult result = psPoints->interpretPickRegionResult(region);
+  EXPECT_EQ(result.indices, (std::vector<int64_t>{0, 2, 3}));
+
+  region.localIndices = {7};
+  EXPECT_THROW(psPoints->interpretPickRegionResult(region), std::runtime_error);
+
+  polyscope::removeAllStructures();
+}
+
 
 TEST_F(PolyscopeTest, PointCloudPick) {
   auto psPoints = registerPointCloud();
@@ -157,6 +396,53 @@ TEST_F(PolyscopeTest, PointCloudScalarCategorical) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, PointCloudIntegerScalarAndByteColor) {
+  auto psPoints = registerPointCloud();
+  size_t N = psPoints->nPoints();
+
+  std::vector<uint8_t> vUInt8(N);
+  std::vector<uint16_t> vUInt16(N);
+  std::vector<int32_t> vInt32(N);
+  for (size_t i = 0; i < N; i++) {
+    vUInt8[i] = static_cast<uint8_t>(i % 7);
+    vUInt16[i] = static_cast<uint16_t>(1000 * i);
+    vInt32[i] = static_cast<int32_t>(i) - 5;
+  }
+
+  auto q1 = psPoints->addIntegerScalarQuantity("vUInt8", vUInt8, polyscope::DataType::CATEGORICAL);
+  auto q2 = psPoints->addIntegerScalarQuantity("vUInt16", vUInt16);
+  auto q3 = psPoints->addIntegerScalarQuantity("vInt32", vInt32, polyscope::DataType::SYMMETRIC);
+  EXPECT_EQ(q1->getStorageType(), polyscope::ScalarStorageType::UInt8);
+  EXPECT_EQ(q1->nValues(), N);
+  EXPECT_EQ(q3->getScalarValue(0), -5.f);
+
+  q1->setEnabled(true);
+  polyscope::show(3);
+  q2->setEnabled(true);
+  polyscope::show(3);
+  q3->setEnabled(true);
+  psPoints->setPointRadiusQuantity(q2);
+  polyscope::show(3);
+
+  vInt32[0] = 12;
+  q3->updateData(vInt32);
+  EXPECT_EQ(q3->getScalarValue(0), 12.f);
+  EXPECT_EQ(q3->values.getValue(0), 12.f); // widened copy stays in sync
+  polyscope::show(3);
+
+  std::vector<glm::u8vec3> vColors(N, glm::u8vec3{51, 102, 255});
+  auto q4 = psPoints->addByteColorQuantity("vcolor", vColors);
+  EXPECT_TRUE(q4->hasByteColors());
+  EXPECT_FLOAT_EQ(q4->getColorValue(0).y, 0.4f);
+  q4->setEnabled(true);
+  polyscope::show(3);
+
+  q4->updateData(vColors);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, PointCloudVector) {
   auto psPoints = registerPointCloud();
 
@@ -269,3 +555,37 @@ TEST_F(PolyscopeTest, PointCloudScalarTransparency) {
 
   polyscope::removeAllStructures();
 }
+
+
+TEST_F(PolyscopeTest, PointCloudLoadPLY) {
+  std::vector<glm::vec3> points = getPoints();
+
+  // Write a small ascii file with normals and a scalar
+  std::string filename = "test_point_cloud_load.ply";
+  {
+    std::ofstream out(filename);
+    out << "ply\n";
+    out << "format ascii 1.0\n";
+    out << "comment written by the polyscope tests\n";
+    out << "element vertex " << points.size() << "\n";
+    out << "property float x\nproperty float y\nproperty float z\n";
+    out << "property float nx\nproperty float ny\nproperty float nz\n";
+    out << "property double intensity\n";
+    out << "end_header\n";
+    for (size_t i = 0; i < points.size(); i++) {
+      out << points[i].x << " " << points[i].y << " " << points[i].z << " 0 0 1 " << (0.25 * i) << "\n";
+    }
+  }
+
+  polyscope::PointCloud* psPoints = polyscope::loadPointCloudPLY("ply cloud", filename);
+  std::remove(filename.c_str());
+
+  EXPECT_TRUE(polyscope::hasPointCloud("ply cloud"));
+  EXPECT_EQ(psPoints->nPoints(), points.size());
+  EXPECT_EQ(psPoints->getPointPosition(1), points[1]);
+  EXPECT_NE(psPoints->getQuantity("normal"), nullptr);
+  EXPECT_NE(psPoints->getQuantity("intensity"), nullptr);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
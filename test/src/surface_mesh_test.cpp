@@ -2,6 +2,12 @@
 
 #include "polyscope_test.h"
 
+#include "polyscope/ply_loader.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
 // ============================================================
 // =============== Surface mesh tests
 // ============================================================
@@ -121,6 +127,49 @@ TEST_F(PolyscopeTest, SurfaceMeshPick) {
   polyscope::removeAllStructures();
 }
 
+TEST_F(PolyscopeTest, SurfaceMeshInstancing) {
+  auto psMesh = registerTriangleMesh();
+  std::vector<glm::mat4> transforms(3, glm::mat4(1.));
+  for (size_t i = 0; i < transforms.size(); i++) {
+    transforms[i][3] = glm::vec4(3. * i, 0., 0., 1.);
+  }
+
+  psMesh->setInstances(transforms);
+  EXPECT_TRUE(psMesh->isInstanced());
+  EXPECT_EQ(psMesh->nInstances(), 3u);
+  polyscope::show(3);
+
+  // The bounds cover every instance
+  EXPECT_GE(std::get<1>(psMesh->boundingBox()).x, 6.);
+
+  std::vector<glm::vec3> colors{{1., 0., 0.}, {0., 1., 0.}, {0., 0., 1.}};
+  psMesh->setInstanceColors(colors);
+  psMesh->addVertexScalarQuantity("vScalar", std::vector<double>(psMesh->nVertices(), 1.))->setEnabled(true);
+  polyscope::show(3);
+  polyscope::pickAtBufferInds(glm::ivec2(77, 88));
+
+  // Moving the instances keeps the programs, changing their number rebuilds them
+  transforms[0][3] = glm::vec4(0., 2., 0., 1.);
+  psMesh->setInstances(transforms);
+  transforms.pop_back();
+  psMesh->setInstances(transforms);
+  EXPECT_EQ(psMesh->nInstances(), 2u);
+  polyscope::show(3);
+
+  // Bad inputs
+  EXPECT_THROW(psMesh->setInstanceColors(colors), std::runtime_error);
+  EXPECT_THROW(psMesh->setInstances(std::vector<glm::mat4>()), std::runtime_error);
+  glm::mat4 projective(1.);
+  projective[2][3] = 1.;
+  EXPECT_THROW(psMesh->setInstances(std::vector<glm::mat4>{projective}), std::runtime_error);
+
+  psMesh->clearInstances();
+  EXPECT_FALSE(psMesh->isInstanced());
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
 TEST_F(PolyscopeTest, SurfaceMeshMark) {
   auto psMesh = registerTriangleMesh();
 
@@ -665,3 +714,110 @@ TEST_F(PolyscopeTest, SimpleTriangleMesUpdate) {
 
   polyscope::removeAllStructures();
 }
+
+
+TEST_F(PolyscopeTest, SurfaceMeshLoadPLY) {
+  std::vector<glm::vec3> points;
+  std::vector<std::vector<size_t>> faces;
+  std::tie(points, faces) = getTriangleMesh();
+
+  // Write a small binary file with extra properties
+  // (assumes a little-endian host, which is all we test on)
+  std::string filename = "test_surface_mesh_load.ply";
+  {
+    std::ofstream out(filename, std::ios::binary);
+    out << "ply\n";
+    out << "format binary_little_endian 1.0\n";
+    out << "element vertex " << points.size() << "\n";
+    out << "property float x\nproperty float y\nproperty float z\n";
+    out << "property uchar red\nproperty uchar green\nproperty uchar blue\n";
+    out << "property float quality\n";
+    out << "element face " << faces.size() << "\n";
+    out << "property list uchar int vertex_indices\n";
+    out << "property int label\n";
+    out << "end_header\n";
+    for (size_t i = 0; i < points.size(); i++) {
+      out.write(reinterpret_cast<const char*>(&points[i][0]), 3 * sizeof(float));
+      unsigned char rgb[3] = {255, 0, static_cast<unsigned char>(10 * i)};
+      out.write(reinterpret_cast<const char*>(rgb), 3);
+      float quality = 0.5f * i;
+      out.write(reinterpret_cast<const char*>(&quality), sizeof(float));
+    }
+    for (size_t i = 0; i < faces.size(); i++) {
+      unsigned char degree = static_cast<unsigned char>(faces[i].size());
+      out.write(reinterpret_cast<const char*>(&degree), 1);
+      for (size_t v : faces[i]) {
+        int32_t ind = static_cast<int32_t>(v);
+        out.write(reinterpret_cast<const char*>(&ind), sizeof(int32_t));
+      }
+      int32_t label = static_cast<int32_t>(i % 2);
+      out.write(reinterpret_cast<const char*>(&label), sizeof(int32_t));
+    }
+  }
+
+  polyscope::SurfaceMesh* psMesh = polyscope::loadSurfaceMeshPLY("ply mesh", filename);
+  std::remove(filename.c_str());
+
+  EXPECT_TRUE(polyscope::hasSurfaceMesh("ply mesh"));
+  EXPECT_EQ(psMesh->nVertices(), points.size());
+  EXPECT_EQ(psMesh->nFaces(), faces.size());
+  EXPECT_EQ(psMesh->vertexPositions.getValue(2), points[2]);
+  EXPECT_NE(psMesh->getQuantity("color"), nullptr);
+  EXPECT_NE(psMesh->getQuantity("quality"), nullptr);
+  EXPECT_NE(psMesh->getQuantity("label"), nullptr);
+  polyscope::show(3);
+
+  polyscope::removeAllStructures();
+}
+
+TEST_F(PolyscopeTest, SurfaceMeshLoadPLYMixedDegreeAndCorrupt) {
+  // Faces of differing degree, with a property after the list
+  std::string filename = "test_surface_mesh_load_mixed.ply";
+  {
+    std::ofstream out(filename);
+    out << "ply\nformat ascii 1.0\n";
+    out << "element vertex 5\nproperty float x\nproperty float y\nproperty float z\n";
+    out << "element face 2\nproperty list uchar int vertex_indices\nproperty int label\n";
+    out << "end_header\n";
+    out << "0 0 0\n1 0 0\n1 1 0\n0 1 0\n2 2 0\n";
+    out << "4 0 1 2 3 7\n";
+    out << "3 1 4 2 9\n";
+  }
+  polyscope::SurfaceMesh* psMesh = polyscope::loadSurfaceMeshPLY("ply mesh", filename);
+  std::remove(filename.c_str());
+  EXPECT_EQ(psMesh->nFaces(), 2u);
+  EXPECT_EQ(psMesh->nCorners(), 7u);
+  EXPECT_NE(psMesh->getQuantity("label"), nullptr);
+  polyscope::removeAllStructures();
+
+  // A negative list length is rejected rather than read past the end of the file
+  filename = "test_surface_mesh_load_corrupt.ply";
+  {
+    std::ofstream out(filename);
+    out << "ply\nformat ascii 1.0\n";
+    out << "element vertex 3\nproperty float x\nproperty float y\nproperty float z\n";
+    out << "element face 1\nproperty list char int vertex_indices\n";
+    out << "end_header\n";
+    out << "0 0 0\n1 0 0\n1 1 0\n";
+    out << "-3 0 1 2\n";
+  }
+  EXPECT_THROW(polyscope::loadSurfaceMeshPLY("ply mesh", filename), std::runtime_error);
+  std::remove(filename.c_str());
+  EXPECT_FALSE(polyscope::hasSurfaceMesh("ply mesh"));
+
+  // As is a negative or fractional vertex index
+  for (std::string badFace : {"3 0 -1 2\n", "3 0 1.5 2\n"}) {
+    {
+      std::ofstream out(filename);
+      out << "ply\nformat ascii 1.0\n";
+      out << "element vertex 3\nproperty float x\nproperty float y\nproperty float z\n";
+      out << "element face 1\nproperty list uchar int vertex_indices\n";
+      out << "end_header\n";
+      out << "0 0 0\n1 0 0\n1 1 0\n";
+      out << badFace;
+    }
+    EXPECT_THROW(polyscope::loadSurfaceMeshPLY("ply mesh", filename), std::runtime_error);
+    std::remove(filename.c_str());
+    EXPECT_FALSE(polyscope::hasSurfaceMesh("ply mesh"));
+  }
+}